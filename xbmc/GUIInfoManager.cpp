@@ -40,6 +40,7 @@
 #include "music/tags/MusicInfoTag.h"
 #include "guilib/IGUIContainer.h"
 #include "guilib/GUIWindowManager.h"
+#include "guilib/GUIFrameProfiler.h"
 #include "playlists/PlayList.h"
 #include "profiles/ProfilesManager.h"
 #include "utils/TuxBoxUtil.h"
@@ -68,6 +69,7 @@
 #include "storage/MediaManager.h"
 #include "utils/TimeUtils.h"
 #include "threads/SingleLock.h"
+#include "threads/Atomics.h"
 #include "utils/log.h"
 
 #include "pvr/PVRManager.h"
@@ -117,7 +119,11 @@ CGUIInfoManager::CGUIInfoManager(void) :
   m_currentSlide = new CFileItem;
   m_frameCounter = 0;
   m_lastFPSTime = 0;
-  m_updateTime = 1;
+  m_changeStamp = 1;
+  for (unsigned int i = 0; i <= INFO_DEPENDS_ALL; i++)
+    m_changeTime[i] = 1;
+  m_boolEvaluations = 0;
+  m_boolEvaluationsPerFrame = 0.0f;
   m_playerShowTime = false;
   m_playerShowCodec = false;
   m_playerShowInfo = false;
@@ -789,6 +795,23 @@ int CGUIInfoManager::TranslateSingleString(const CStdString &strCondition)
   strTest.TrimLeft(" \t\r\n");
   strTest.TrimRight(" \t\r\n");
 
+  // labels and skin variables may translate differently depending on when and where
+  // they're used, so only plain conditions are looked up from the cache
+  if (strTest.find('$') != std::string::npos)
+    return TranslateSingleStringUncached(strTest);
+
+  CSingleLock lock(m_critInfo);
+  TranslationCache::const_iterator it = m_translated.find(strTest);
+  if (it != m_translated.end())
+    return it->second;
+
+  int info = TranslateSingleStringUncached(strTest);
+  m_translated.insert(make_pair(strTest, info));
+  return info;
+}
+
+int CGUIInfoManager::TranslateSingleStringUncached(const CStdString &strTest)
+{
   vector< Property> info;
   SplitInfoString(strTest, info);
 
@@ -2043,18 +2066,20 @@ unsigned int CGUIInfoManager::Register(const CStdString &expression, int context
 
   CSingleLock lock(m_critInfo);
   // do we have the boolean expression already registered?
-  InfoBool test(condition, context);
-  for (unsigned int i = 0; i < m_bools.size(); ++i)
-  {
-    if (*m_bools[i] == test)
-      return i+1;
-  }
+  CStdString key(condition);
+  key.ToLower();
+  InfoBoolIndex::const_iterator it = m_boolIndex.find(make_pair(std::string(key), context));
+  if (it != m_boolIndex.end())
+    return it->second;
 
+  InfoBool *info;
   if (condition.find_first_of("|+[]!") != condition.npos)
-    m_bools.push_back(new InfoExpression(condition, context));
+    info = new InfoExpression(condition, context);
   else
-    m_bools.push_back(new InfoSingle(condition, context));
+    info = new InfoSingle(condition, context);
 
+  m_bools.push_back(info);
+  m_boolIndex.insert(make_pair(make_pair(std::string(key), context), (unsigned int)m_bools.size()));
   return m_bools.size();
 }
 
@@ -2068,30 +2093,108 @@ bool CGUIInfoManager::EvaluateBool(const CStdString &expression, int contextWind
 }
 
 /*
- TODO: what to do with item-based infobools...
- these crop up:
- 1. if condition is between LISTITEM_START and LISTITEM_END
- 2. if condition is STRING_IS_EMPTY, STRING_COMPARE, STRING_STR, INTEGER_GREATER_THAN and the
-    corresponding label is between LISTITEM_START and LISTITEM_END
-
- In both cases they shouldn't be in our cache as they depend on items outside of our control atm.
-
- We only pass a listitem object in for controls inside a listitemlayout, so I think it's probably OK
- to not cache these, as they're "pushed" out anyway.
-
- The problem is how do we avoid these?  The only thing we have to go on is the expression here, so I
- guess what we have to do is call through via Update.  One thing we don't handle, however, is that the
- majority of conditions (even inside lists) don't depend on the listitem at all.
-
- Advantage is that we know this at creation time I think, so could perhaps signal it in IsDirty()?
+ Item-based infobools: conditions between LISTITEM_START and LISTITEM_END (or string/integer
+ comparisons against such labels) depend on the item they're evaluated against, so they're
+ always evaluated when an item is passed in. Everything else is cached until one of the inputs
+ it depends on is invalidated (see GetDependencies), even when evaluated inside a list layout.
  */
 bool CGUIInfoManager::GetBoolValue(unsigned int expression, const CGUIListItem *item)
 {
   if (expression && --expression < m_bools.size())
-    return m_bools[expression]->Get(m_updateTime, item);
+  {
+    InfoBool *info = m_bools[expression];
+    unsigned int time = m_changeTime[info->GetDependencies()];
+    if (info->IsDirty(time, item))
+    {
+      m_boolEvaluations++;
+      CGUIFrameProfilerInfoScope profile;
+      return info->Get(time, item);
+    }
+    return info->Get(time, item);
+  }
   return false;
 }
 
+unsigned int CGUIInfoManager::GetBoolDependencies(unsigned int expression) const
+{
+  if (expression && --expression < m_bools.size())
+    return m_bools[expression]->GetDependencies();
+  return INFO_DEPENDS_NONE;
+}
+
+CStdString CGUIInfoManager::GetBoolExpression(unsigned int expression) const
+{
+  if (expression && --expression < m_bools.size())
+    return m_bools[expression]->GetExpression();
+  return "";
+}
+
+void CGUIInfoManager::InvalidateBools(unsigned int dependencies)
+{
+  // a bool is stale once the newest change of any input it reads differs from the
+  // one it was last evaluated at, so stamp every dependency mask including these inputs
+  unsigned int stamp = (unsigned int)AtomicIncrement(&m_changeStamp);
+  for (unsigned int mask = 0; mask <= INFO_DEPENDS_ALL; mask++)
+  {
+    if (mask & dependencies)
+      m_changeTime[mask] = stamp;
+  }
+}
+
+static inline bool IsListItemInfo(int info)
+{
+  return info >= LISTITEM_START && info <= LISTITEM_END;
+}
+
+unsigned int CGUIInfoManager::GetDependencies(int condition) const
+{
+  condition = abs(condition);
+  if (condition == SYSTEM_ALWAYS_TRUE || condition == SYSTEM_ALWAYS_FALSE ||
+      condition == SYSTEM_ETHERNET_LINK_ACTIVE || condition == SYSTEM_HAS_PVR ||
+     (condition >= SYSTEM_PLATFORM_LINUX && condition <= SYSTEM_PLATFORM_ANDROID))
+    return INFO_DEPENDS_NONE;
+
+  if (condition >= LIBRARY_HAS_MUSIC && condition <= LIBRARY_HAS_MUSICVIDEOS)
+    return INFO_DEPENDS_LIBRARY;
+
+  // without an item we fall back to the focused item of a container
+  if (IsListItemInfo(condition))
+    return INFO_DEPENDS_FRAME | INFO_DEPENDS_LISTITEM;
+
+  if (condition >= MULTI_INFO_START && condition <= MULTI_INFO_END &&
+      condition - MULTI_INFO_START < (int)m_multiInfo.size())
+  {
+    const GUIInfo &info = m_multiInfo[condition - MULTI_INFO_START];
+    int multiCondition = abs(info.m_info);
+    if (IsListItemInfo(multiCondition))
+      return INFO_DEPENDS_FRAME | INFO_DEPENDS_LISTITEM;
+
+    switch (multiCondition)
+    {
+      case SKIN_BOOL:
+      case SKIN_STRING:
+        return INFO_DEPENDS_SETTINGS;
+      case STRING_COMPARE:
+        if (info.GetData2() < 0 && IsListItemInfo(-info.GetData2()))
+          return INFO_DEPENDS_FRAME | INFO_DEPENDS_LISTITEM;
+        // fall through
+      case STRING_IS_EMPTY:
+      case INTEGER_GREATER_THAN:
+      case STRING_STR:
+      case STRING_STR_LEFT:
+      case STRING_STR_RIGHT:
+        if (IsListItemInfo((int)info.GetData1()))
+          return INFO_DEPENDS_FRAME | INFO_DEPENDS_LISTITEM;
+        break;
+      default:
+        break;
+    }
+  }
+
+  // anything else is polled, and may change from one frame to the next
+  return INFO_DEPENDS_FRAME;
+}
+
 // checks the condition and returns it as necessary.  Currently used
 // for toggle button controls and visibility of images.
 bool CGUIInfoManager::GetBool(int condition1, int contextWindow, const CGUIListItem *item)
@@ -4103,6 +4206,8 @@ void CGUIInfoManager::Clear()
   for (unsigned int i = 0; i < m_bools.size(); ++i)
     delete m_bools[i];
   m_bools.clear();
+  m_boolIndex.clear();
+  m_translated.clear();
 
   m_skinVariableStrings.clear();
 }
@@ -4117,6 +4222,8 @@ void CGUIInfoManager::UpdateFPS()
   {
     fTimeSpan /= 1000.0f;
     m_fps = m_frameCounter / fTimeSpan;
+    m_boolEvaluationsPerFrame = (float)m_boolEvaluations / m_frameCounter;
+    m_boolEvaluations = 0;
     m_lastFPSTime = curTime;
     m_frameCounter = 0;
   }
@@ -5040,7 +5147,7 @@ void CGUIInfoManager::ResetCache()
 {
   // reset any animation triggers as well
   m_containerMoves.clear();
-  m_updateTime++;
+  InvalidateBools(INFO_DEPENDS_FRAME);
 }
 
 // Called from tuxbox service thread to update current status
@@ -5243,6 +5350,7 @@ void CGUIInfoManager::SetLibraryBool(int condition, bool value)
     default:
       break;
   }
+  InvalidateBools(INFO_DEPENDS_LIBRARY);
 }
 
 void CGUIInfoManager::ResetLibraryBools()
@@ -5252,6 +5360,7 @@ void CGUIInfoManager::ResetLibraryBools()
   m_libraryHasTVShows = -1;
   m_libraryHasMusicVideos = -1;
   m_libraryHasMovieSets = -1;
+  InvalidateBools(INFO_DEPENDS_LIBRARY);
 }
 
 bool CGUIInfoManager::GetLibraryBool(int condition)
@@ -33,10 +33,12 @@
 #include "XBDateTime.h"
 #include "utils/Observer.h"
 #include "interfaces/info/SkinVariable.h"
+#include "interfaces/info/InfoBool.h"
 #include "cores/IPlayer.h"
 
 #include <list>
 #include <map>
+#include <boost/unordered_map.hpp>
 
 namespace MUSIC_INFO
 {
@@ -48,7 +50,6 @@ class CGUIListItem;
 class CDateTime;
 namespace INFO
 {
-  class InfoBool;
   class InfoSingle;
 }
 
@@ -724,6 +725,34 @@ public:
    */
   bool GetBoolValue(unsigned int expression, const CGUIListItem *item = NULL);
 
+  /*! \brief Mark registered boolean expressions reading the given inputs as stale
+   Expressions are only re-evaluated once one of the inputs they depend on has changed
+   since their last evaluation. ResetCache() invalidates the polled (per frame) inputs.
+   \param dependencies the INFO::INFO_DEPENDS_* flags of the inputs that changed
+   \sa GetDependencies
+   */
+  void InvalidateBools(unsigned int dependencies);
+
+  /*! \brief Get the inputs a translated condition reads
+   \param condition the condition as returned from TranslateString
+   \return the INFO::INFO_DEPENDS_* flags of the condition
+   */
+  unsigned int GetDependencies(int condition) const;
+
+  /*! \brief Get the inputs a registered boolean expression reads
+   \sa Register, GetDependencies
+   */
+  unsigned int GetBoolDependencies(unsigned int expression) const;
+
+  /*! \brief Get the expression a boolean expression was registered with
+   \sa Register
+   */
+  CStdString GetBoolExpression(unsigned int expression) const;
+
+  /*! \brief Average number of boolean expressions evaluated per frame, for profiling
+   */
+  float GetBoolEvaluations() const { return m_boolEvaluationsPerFrame; };
+
   /*! \brief Evaluate a boolean expression
    \param expression the expression to evaluate
    \param context the context in which to evaluate the expression (currently windows)
@@ -865,6 +894,7 @@ protected:
   bool GetMultiInfoBool(const GUIInfo &info, int contextWindow = 0, const CGUIListItem *item = NULL);
   bool GetMultiInfoInt(int &value, const GUIInfo &info, int contextWindow = 0) const;
   CStdString GetMultiInfoLabel(const GUIInfo &info, int contextWindow = 0, CStdString *fallback = NULL);
+  int TranslateSingleStringUncached(const CStdString &strCondition);
   int TranslateListItem(const Property &info);
   int TranslateMusicPlayerString(const CStdString &info) const;
   TIME_FORMAT TranslateTimeFormat(const CStdString &format);
@@ -932,9 +962,17 @@ protected:
   int m_nextWindowID;
   int m_prevWindowID;
 
+  typedef boost::unordered_map<std::pair<std::string, int>, unsigned int> InfoBoolIndex;
+  typedef boost::unordered_map<std::string, int> TranslationCache;
+
   std::vector<INFO::InfoBool*> m_bools;
+  InfoBoolIndex m_boolIndex;            ///< lower cased expression and context -> position in m_bools
+  TranslationCache m_translated;        ///< single conditions already run through TranslateSingleString
   std::vector<INFO::CSkinVariableString> m_skinVariableStrings;
-  unsigned int m_updateTime;
+  unsigned int m_changeTime[INFO::INFO_DEPENDS_ALL + 1]; ///< last change of any of the inputs in a dependency mask
+  volatile long m_changeStamp;
+  unsigned int m_boolEvaluations;       ///< expressions evaluated since the last FPS update
+  float m_boolEvaluationsPerFrame;
 
   int m_libraryHasMusic;
   int m_libraryHasMovies;
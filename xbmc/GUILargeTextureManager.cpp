@@ -29,6 +29,8 @@
 #include "utils/log.h"
 #include "TextureCache.h"
 
+#include <algorithm>
+
 using namespace std;
 
 
@@ -78,6 +80,7 @@ CGUILargeTextureManager::CLargeTexture::CLargeTexture(const CStdString &path)
   m_path = path;
   m_refCount = 1;
   m_timeToDelete = 0;
+  m_prefetched = false;
 }
 
 CGUILargeTextureManager::CLargeTexture::~CLargeTexture()
@@ -157,7 +160,14 @@ bool CGUILargeTextureManager::GetImage(const CStdString &path, CTextureArray &te
     if (image->GetPath() == path)
     {
       if (firstRequest)
+      {
         image->AddRef();
+        if (image->IsPrefetched())
+        {
+          m_prefetchStats.hits++;
+          image->SetPrefetched(false);
+        }
+      }
       texture = image->GetTexture();
       return texture.size() > 0;
     }
@@ -197,7 +207,7 @@ void CGUILargeTextureManager::ReleaseImage(const CStdString &path, bool immediat
 }
 
 // queue the image, and start the background loader if necessary
-void CGUILargeTextureManager::QueueImage(const CStdString &path)
+void CGUILargeTextureManager::QueueImage(const CStdString &path, bool prefetch)
 {
   CSingleLock lock(m_listSection);
   for (queueIterator it = m_queued.begin(); it != m_queued.end(); ++it)
@@ -206,16 +216,106 @@ void CGUILargeTextureManager::QueueImage(const CStdString &path)
     if (image->GetPath() == path)
     {
       image->AddRef();
+      if (!prefetch && image->IsPrefetched())
+      { // requested before the prefetch finished - bump it up to normal priority if it hasn't started
+        m_prefetchStats.late++;
+        image->SetPrefetched(false);
+        if (CJobManager::GetInstance().CancelQueuedJob(it->first))
+          it->first = CJobManager::GetInstance().AddJob(new CImageLoader(path), this, CJob::PRIORITY_NORMAL);
+      }
       return; // already queued
     }
   }
 
   // queue the item
   CLargeTexture *image = new CLargeTexture(path);
-  unsigned int jobID = CJobManager::GetInstance().AddJob(new CImageLoader(path), this, CJob::PRIORITY_NORMAL);
+  if (prefetch)
+  {
+    image->SetPrefetched(true);
+    m_prefetchStats.requested++;
+  }
+  unsigned int jobID = CJobManager::GetInstance().AddJob(new CImageLoader(path), this, prefetch ? CJob::PRIORITY_LOW : CJob::PRIORITY_NORMAL);
   m_queued.push_back(make_pair(jobID, image));
 }
 
+void CGUILargeTextureManager::Prefetch(const void *owner, const vector<CStdString> &paths)
+{
+  CSingleLock lock(m_listSection);
+  vector<CStdString> &current = m_prefetched[owner];
+  if (current == paths)
+    return;
+
+  vector<CStdString> wanted;
+  for (vector<CStdString>::const_iterator it = paths.begin(); it != paths.end(); ++it)
+  {
+    if (!it->IsEmpty() && find(wanted.begin(), wanted.end(), *it) == wanted.end())
+      wanted.push_back(*it);
+  }
+
+  // reference the new images before releasing the old ones, so images in both sets stay loaded
+  for (vector<CStdString>::const_iterator it = wanted.begin(); it != wanted.end(); ++it)
+  {
+    if (find(current.begin(), current.end(), *it) != current.end())
+      continue;
+
+    bool allocated = false;
+    for (listIterator image = m_allocated.begin(); image != m_allocated.end(); ++image)
+    {
+      if ((*image)->GetPath() == *it)
+      {
+        (*image)->AddRef();
+        allocated = true;
+        break;
+      }
+    }
+    if (!allocated)
+      QueueImage(*it, true);
+  }
+  for (vector<CStdString>::const_iterator it = current.begin(); it != current.end(); ++it)
+  {
+    if (find(wanted.begin(), wanted.end(), *it) == wanted.end())
+      ReleasePrefetched(*it);
+  }
+
+  if (wanted.empty())
+    m_prefetched.erase(owner);
+  else
+    current = wanted;
+}
+
+void CGUILargeTextureManager::CancelPrefetch(const void *owner)
+{
+  CSingleLock lock(m_listSection);
+  PrefetchMap::iterator it = m_prefetched.find(owner);
+  if (it == m_prefetched.end())
+    return;
+
+  for (vector<CStdString>::const_iterator path = it->second.begin(); path != it->second.end(); ++path)
+    ReleasePrefetched(*path);
+  m_prefetched.erase(it);
+}
+
+void CGUILargeTextureManager::ReleasePrefetched(const CStdString &path)
+{
+  for (listIterator it = m_allocated.begin(); it != m_allocated.end(); ++it)
+  {
+    if ((*it)->GetPath() == path && (*it)->IsPrefetched())
+      m_prefetchStats.unused++;
+  }
+  for (queueIterator it = m_queued.begin(); it != m_queued.end(); ++it)
+  {
+    if (it->second->GetPath() == path && it->second->IsPrefetched())
+      m_prefetchStats.unused++;
+  }
+  ReleaseImage(path);
+}
+
+CGUILargeTextureManager::PrefetchStats CGUILargeTextureManager::GetPrefetchStats()
+{
+  CSingleLock lock(m_listSection);
+  return m_prefetchStats;
+}
+
 void CGUILargeTextureManager::OnJobComplete(unsigned int jobID, bool success, CJob *job)
 {
   // see if we still have this job id
@@ -24,6 +24,9 @@
 #include "utils/Job.h"
 #include "guilib/TextureManager.h"
 
+#include <map>
+#include <vector>
+
 /*!
  \ingroup textures,jobs
  \brief Image loader job class
@@ -111,6 +114,42 @@ public:
    */
   void CleanupUnusedImages(bool immediately = false);
 
+  /*!
+   \brief Load images that are likely to be needed soon.
+
+   Used by containers to decode the art of items just off screen before they are scrolled into view.
+   Prefetched images are loaded at a lower priority than requested ones, and are promoted if they are
+   requested while still queued. Each owner has one set of prefetched images: images from the owner's
+   previous set that aren't in the new one are released, cancelling their load if it hasn't finished.
+
+   \param owner the object the images are prefetched for, usually the calling container.
+   \param paths paths of the images to prefetch.
+   \sa CancelPrefetch
+   */
+  void Prefetch(const void *owner, const std::vector<CStdString> &paths);
+
+  /*!
+   \brief Release all images prefetched for an owner.
+   \param owner the object the images were prefetched for.
+   \sa Prefetch
+   */
+  void CancelPrefetch(const void *owner);
+
+  struct PrefetchStats
+  {
+    PrefetchStats() : requested(0), hits(0), late(0), unused(0) {}
+    unsigned int requested; ///< images queued by Prefetch()
+    unsigned int hits;      ///< prefetched images that were loaded by the time they were requested
+    unsigned int late;      ///< prefetched images that were requested while still loading
+    unsigned int unused;    ///< prefetched images released without being requested
+  };
+
+  /*!
+   \brief Get the prefetch counters, to judge how well prefetching anticipates requests.
+   \sa Prefetch
+   */
+  PrefetchStats GetPrefetchStats();
+
 private:
   class CLargeTexture
   {
@@ -126,6 +165,9 @@ private:
     const CStdString &GetPath() const { return m_path; };
     const CTextureArray &GetTexture() const { return m_texture; };
 
+    bool IsPrefetched() const { return m_prefetched; };
+    void SetPrefetched(bool prefetched) { m_prefetched = prefetched; };
+
   private:
     static const unsigned int TIME_TO_DELETE = 2000;
 
@@ -133,15 +175,21 @@ private:
     CStdString m_path;
     CTextureArray m_texture;
     unsigned int m_timeToDelete;
+    bool m_prefetched; ///< loaded by Prefetch() and not requested since
   };
 
-  void QueueImage(const CStdString &path);
+  void QueueImage(const CStdString &path, bool prefetch = false);
+  void ReleasePrefetched(const CStdString &path);
 
   std::vector< std::pair<unsigned int, CLargeTexture *> > m_queued;
   std::vector<CLargeTexture *> m_allocated;
   typedef std::vector<CLargeTexture *>::iterator listIterator;
   typedef std::vector< std::pair<unsigned int, CLargeTexture *> >::iterator queueIterator;
 
+  typedef std::map<const void *, std::vector<CStdString> > PrefetchMap;
+  PrefetchMap m_prefetched;  ///< images each owner holds a prefetch reference on
+  PrefetchStats m_prefetchStats;
+
   CCriticalSection m_listSection;
 };
 
@@ -96,6 +96,7 @@ public:
   static bool TranslateResolution(const CStdString &name, RESOLUTION_INFO &res);
 
   void ResolveIncludes(TiXmlElement *node, std::map<int, bool>* xmlIncludeConditions = NULL);
+  const std::vector<CStdString> &GetIncludeFiles() const { return m_includes.GetFiles(); };
 
   float GetEffectsSlowdown() const { return m_effectsSlowDown; };
 
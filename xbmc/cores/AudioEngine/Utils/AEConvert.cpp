@@ -25,6 +25,7 @@
 #include "AEUtil.h"
 #include "utils/MathUtils.h"
 #include "utils/EndianSwap.h"
+#include "utils/CPUInfo.h"
 #include <stdint.h>
 
 #if defined(TARGET_WINDOWS)
@@ -60,8 +61,75 @@ static inline int safeRound(double f)
   return MathUtils::round_int(f);
 }
 
+#if defined(__SSE2__)
+static inline __m128i ByteSwap16(__m128i v)
+{
+  return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+
+static inline __m128i ByteSwap32(__m128i v)
+{
+  v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+  v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+  return ByteSwap16(v);
+}
+
+/* gather four packed 3 byte samples into the low 3 bytes of each lane, reads 16 bytes */
+static inline __m128i Load24x4(const uint8_t *data)
+{
+  __m128i v  = _mm_loadu_si128((const __m128i*)data);
+  __m128i ab = _mm_unpacklo_epi32(v, _mm_srli_si128(v, 3));
+  __m128i cd = _mm_unpacklo_epi32(_mm_srli_si128(v, 6), _mm_srli_si128(v, 9));
+  return _mm_unpacklo_epi64(ab, cd);
+}
+
+/* same rounding as safeRound, ie. round half up and clamp to INT_MAX on overflow */
+static inline __m128i RoundHalfUp(__m128 x)
+{
+  MEMALIGN(16, static const __m128 half) = _mm_set_ps1(0.5f);
+  MEMALIGN(16, static const __m128 over) = _mm_set_ps1(2147483648.0f);
+
+  __m128i r   = _mm_cvtps_epi32(x); /* nearest even */
+  __m128  tie = _mm_cmpeq_ps(_mm_sub_ps(x, _mm_cvtepi32_ps(r)), half);
+  r = _mm_sub_epi32(r, _mm_castps_si128(tie));
+
+  __m128i big = _mm_castps_si128(_mm_cmpge_ps(x, over));
+  return _mm_or_si128(_mm_andnot_si128(big, r), _mm_and_si128(big, _mm_set1_epi32(INT_MAX)));
+}
+#endif
+
 CAEConvert::AEConvertToFn CAEConvert::ToFloat(enum AEDataFormat dataFormat)
 {
+  return ToFloat(dataFormat, g_cpuInfo.GetCPUFeatures());
+}
+
+CAEConvert::AEConvertFrFn CAEConvert::FrFloat(enum AEDataFormat dataFormat)
+{
+  return FrFloat(dataFormat, g_cpuInfo.GetCPUFeatures());
+}
+
+CAEConvert::AEConvertToFn CAEConvert::ToFloat(enum AEDataFormat dataFormat, unsigned int cpuFeatures)
+{
+#if defined(__SSE2__)
+  if (cpuFeatures & CPU_FEATURE_SSE2)
+  {
+    switch (dataFormat)
+    {
+      case AE_FMT_S16NE :
+      case AE_FMT_S16LE : return &S16LE_Float_SSE2;
+      case AE_FMT_S16BE : return &S16BE_Float_SSE2;
+      case AE_FMT_S24NE4:
+      case AE_FMT_S24LE4: return &S24LE4_Float_SSE2;
+      case AE_FMT_S24BE4: return &S24BE4_Float_SSE2;
+      case AE_FMT_S24NE3:
+      case AE_FMT_S24LE3: return &S24LE3_Float_SSE2;
+      case AE_FMT_S24BE3: return &S24BE3_Float_SSE2;
+      default:
+        break;
+    }
+  }
+#endif
+
   switch (dataFormat)
   {
     case AE_FMT_U8    : return &U8_Float;
@@ -97,8 +165,24 @@ CAEConvert::AEConvertToFn CAEConvert::ToFloat(enum AEDataFormat dataFormat)
   }
 }
 
-CAEConvert::AEConvertFrFn CAEConvert::FrFloat(enum AEDataFormat dataFormat)
+CAEConvert::AEConvertFrFn CAEConvert::FrFloat(enum AEDataFormat dataFormat, unsigned int cpuFeatures)
 {
+#if defined(__SSE2__)
+  if (cpuFeatures & CPU_FEATURE_SSE2)
+  {
+    switch (dataFormat)
+    {
+      case AE_FMT_S16NE :
+      case AE_FMT_S16LE : return &Float_S16LE_SSE2;
+      case AE_FMT_S16BE : return &Float_S16BE_SSE2;
+      case AE_FMT_S24NE4: return &Float_S24NE4_SSE2;
+      case AE_FMT_S24NE3: return &Float_S24NE3_SSE2;
+      default:
+        break;
+    }
+  }
+#endif
+
   switch (dataFormat)
   {
     case AE_FMT_U8    : return &Float_U8;
@@ -179,6 +263,27 @@ unsigned int CAEConvert::S16LE_Float(uint8_t* data, const unsigned int samples,
   return samples;
 }
 
+unsigned int CAEConvert::S16LE_Float_SSE2(uint8_t *data, const unsigned int samples, float *dest)
+{
+#if defined(__SSE2__)
+  const __m128 mul = _mm_set_ps1(1.0f / (INT16_MAX + 0.5f));
+  unsigned int i = 0;
+
+  for (; i + 8 <= samples; i += 8, data += 16, dest += 8)
+  {
+    __m128i in = _mm_loadu_si128((const __m128i*)data);
+    __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(in, in), 16);
+    __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(in, in), 16);
+    _mm_storeu_ps(dest    , _mm_mul_ps(_mm_cvtepi32_ps(lo), mul));
+    _mm_storeu_ps(dest + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), mul));
+  }
+
+  /* process any remaining samples */
+  S16LE_Float(data, samples - i, dest);
+#endif
+  return samples;
+}
+
 unsigned int CAEConvert::S16BE_Float(uint8_t* data, const unsigned int samples, float *dest)
 {
   static const float mul = 1.0f / (INT16_MAX + 0.5f);
@@ -204,12 +309,33 @@ unsigned int CAEConvert::S16BE_Float(uint8_t* data, const unsigned int samples,
   }
 #else
   for (unsigned int i = 0; i < samples; ++i, data += 2)
-    *dest++ = Endian_SwapBE16(*(int16_t*)data) * mul;
+    *dest++ = (int16_t)Endian_SwapBE16(*(uint16_t*)data) * mul;
 #endif
 
   return samples;
 }
 
+unsigned int CAEConvert::S16BE_Float_SSE2(uint8_t *data, const unsigned int samples, float *dest)
+{
+#if defined(__SSE2__)
+  const __m128 mul = _mm_set_ps1(1.0f / (INT16_MAX + 0.5f));
+  unsigned int i = 0;
+
+  for (; i + 8 <= samples; i += 8, data += 16, dest += 8)
+  {
+    __m128i in = ByteSwap16(_mm_loadu_si128((const __m128i*)data));
+    __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(in, in), 16);
+    __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(in, in), 16);
+    _mm_storeu_ps(dest    , _mm_mul_ps(_mm_cvtepi32_ps(lo), mul));
+    _mm_storeu_ps(dest + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), mul));
+  }
+
+  /* process any remaining samples */
+  S16BE_Float(data, samples - i, dest);
+#endif
+  return samples;
+}
+
 unsigned int CAEConvert::S24LE4_Float(uint8_t *data, const unsigned int samples, float *dest)
 {
   for (unsigned int i = 0; i < samples; ++i, data += 4)
@@ -220,6 +346,24 @@ unsigned int CAEConvert::S24LE4_Float(uint8_t *data, const unsigned int samples,
   return samples;
 }
 
+unsigned int CAEConvert::S24LE4_Float_SSE2(uint8_t *data, const unsigned int samples, float *dest)
+{
+#if defined(__SSE2__)
+  const __m128 mul = _mm_set_ps1(INT32_SCALE);
+  unsigned int i = 0;
+
+  for (; i + 4 <= samples; i += 4, data += 16, dest += 4)
+  {
+    __m128i in = _mm_slli_epi32(_mm_loadu_si128((const __m128i*)data), 8);
+    _mm_storeu_ps(dest, _mm_mul_ps(_mm_cvtepi32_ps(in), mul));
+  }
+
+  /* process any remaining samples */
+  S24LE4_Float(data, samples - i, dest);
+#endif
+  return samples;
+}
+
 unsigned int CAEConvert::S24BE4_Float(uint8_t *data, const unsigned int samples, float *dest)
 {
   for (unsigned int i = 0; i < samples; ++i, data += 4)
@@ -230,6 +374,25 @@ unsigned int CAEConvert::S24BE4_Float(uint8_t *data, const unsigned int samples,
   return samples;
 }
 
+unsigned int CAEConvert::S24BE4_Float_SSE2(uint8_t *data, const unsigned int samples, float *dest)
+{
+#if defined(__SSE2__)
+  const __m128  mul  = _mm_set_ps1(INT32_SCALE);
+  const __m128i mask = _mm_set1_epi32(0xFFFFFF00);
+  unsigned int i = 0;
+
+  for (; i + 4 <= samples; i += 4, data += 16, dest += 4)
+  {
+    __m128i in = _mm_and_si128(ByteSwap32(_mm_loadu_si128((const __m128i*)data)), mask);
+    _mm_storeu_ps(dest, _mm_mul_ps(_mm_cvtepi32_ps(in), mul));
+  }
+
+  /* process any remaining samples */
+  S24BE4_Float(data, samples - i, dest);
+#endif
+  return samples;
+}
+
 unsigned int CAEConvert::S24LE3_Float(uint8_t *data, const unsigned int samples, float *dest)
 {
   for (unsigned int i = 0; i < samples; ++i, data += 3)
@@ -240,16 +403,55 @@ unsigned int CAEConvert::S24LE3_Float(uint8_t *data, const unsigned int samples,
   return samples;
 }
 
+unsigned int CAEConvert::S24LE3_Float_SSE2(uint8_t *data, const unsigned int samples, float *dest)
+{
+#if defined(__SSE2__)
+  const __m128 mul = _mm_set_ps1(INT32_SCALE);
+  unsigned int i = 0;
+
+  /* Load24x4 reads 16 bytes, stop while at least 6 samples are left */
+  for (; i + 6 <= samples; i += 4, data += 12, dest += 4)
+  {
+    __m128i in = _mm_slli_epi32(Load24x4(data), 8);
+    _mm_storeu_ps(dest, _mm_mul_ps(_mm_cvtepi32_ps(in), mul));
+  }
+
+  /* process any remaining samples */
+  S24LE3_Float(data, samples - i, dest);
+#endif
+  return samples;
+}
+
 unsigned int CAEConvert::S24BE3_Float(uint8_t *data, const unsigned int samples, float *dest)
 {
   for (unsigned int i = 0; i < samples; ++i, data += 3)
   {
-    int s = (data[1] << 24) | (data[2] << 16) | (data[3] << 8);
+    int s = (data[0] << 24) | (data[1] << 16) | (data[2] << 8);
     *dest++ = (float)s * INT32_SCALE;
   }
   return samples;
 }
 
+unsigned int CAEConvert::S24BE3_Float_SSE2(uint8_t *data, const unsigned int samples, float *dest)
+{
+#if defined(__SSE2__)
+  const __m128  mul  = _mm_set_ps1(INT32_SCALE);
+  const __m128i mask = _mm_set1_epi32(0xFFFFFF00);
+  unsigned int i = 0;
+
+  /* Load24x4 reads 16 bytes, stop while at least 6 samples are left */
+  for (; i + 6 <= samples; i += 4, data += 12, dest += 4)
+  {
+    __m128i in = _mm_and_si128(ByteSwap32(Load24x4(data)), mask);
+    _mm_storeu_ps(dest, _mm_mul_ps(_mm_cvtepi32_ps(in), mul));
+  }
+
+  /* process any remaining samples */
+  S24BE3_Float(data, samples - i, dest);
+#endif
+  return samples;
+}
+
 unsigned int CAEConvert::S32LE_Float(uint8_t *data, const unsigned int samples, float *dest)
 {
   static const float factor = 1.0f / (float)INT32_MAX;
@@ -521,113 +723,6 @@ unsigned int CAEConvert::Float_S8(float *data, const unsigned int samples, uint8
 unsigned int CAEConvert::Float_S16LE(float *data, const unsigned int samples, uint8_t *dest)
 {
   int16_t *dst = (int16_t*)dest;
-  #ifdef __SSE2__
-
-  unsigned int count     = samples;
-  unsigned int unaligned = (0x10 - ((uintptr_t)data & 0xF)) >> 2;
-  if (unaligned == 4)
-    unaligned = 0;
-
-  /*
-    if we are only out by one, dont use SSE to correct it.
-    this must run before we do any SSE work so that the FPU
-    is in a working state without having to first call
-    _mm_empty()
-  */
-  if (unaligned == 1)
-    dst[0] = Endian_SwapLE16(safeRound(data[0] * ((float)INT16_MAX + CAEUtil::FloatRand1(-0.5f, 0.5f))));
-
-  MEMALIGN(16, static const __m128  mul) = _mm_set_ps1((float)INT16_MAX);
-  MEMALIGN(16, __m128  rand);
-  MEMALIGN(16, __m128  in  );
-  MEMALIGN(16, __m128i con );
-
-  /* if unaligned is greater then one, use SSE to correct it */
-  if (unaligned > 1)
-  {
-    switch (unaligned)
-    {
-      case 1: in = _mm_setr_ps(data[0], 0      , 0      , 0); break;
-      case 2: in = _mm_setr_ps(data[0], data[1], 0      , 0); break;
-      case 3: in = _mm_setr_ps(data[0], data[1], data[2], 0); break;
-    }
-
-    /* random round to dither */
-    CAEUtil::FloatRand4(-0.5f, 0.5f, NULL, &rand);
-    in  = _mm_mul_ps(in, _mm_add_ps(mul, rand));
-    con = _mm_cvtps_epi32(in);
-
-    #ifdef __BIG_ENDIAN__
-    con = _mm_or_si128(_mm_slli_epi16(con, 8), _mm_srli_epi16(con, 8));
-    #endif
-
-    dst[0] = _mm_extract_epi16(con, 0);
-    if (unaligned == 3)
-    {
-      dst[1] = _mm_extract_epi16(con, 2);
-      dst[2] = _mm_extract_epi16(con, 4);
-    }
-    else if (unaligned == 2)
-      dst[1] = _mm_extract_epi16(con, 2);
-  }
-
-  /* update our pointers and sample count */
-  data  += unaligned;
-  dst   += unaligned;
-  count -= unaligned;
-
-  const uint32_t even = count & ~0x3;
-  for (uint32_t i = 0; i < even; i += 4, data += 4, dst += 4)
-  {
-    /* random round to dither */
-    CAEUtil::FloatRand4(-0.5f, 0.5f, NULL, &rand);
-    in   = _mm_mul_ps(_mm_load_ps(data), _mm_add_ps(mul, rand));
-    con  = _mm_cvtps_epi32(in);
-
-    #ifdef __BIG_ENDIAN__
-    con = _mm_or_si128(_mm_slli_epi16(con, 8), _mm_srli_epi16(con, 8));
-    #endif
-
-    dst[0] = _mm_extract_epi16(con, 0);
-    dst[1] = _mm_extract_epi16(con, 2);
-    dst[2] = _mm_extract_epi16(con, 4);
-    dst[3] = _mm_extract_epi16(con, 6);
-  }
-
-  /* calculate the final unaligned samples if there is any */
-  if (samples != even)
-  {
-    unaligned = samples - even;
-    switch (unaligned)
-    {
-      case 1: in = _mm_setr_ps(data[0], 0      , 0      , 0); break;
-      case 2: in = _mm_setr_ps(data[0], data[1], 0      , 0); break;
-      case 3: in = _mm_setr_ps(data[0], data[1], data[2], 0); break;
-    }
-
-    /* random round to dither */
-    CAEUtil::FloatRand4(-0.5f, 0.5f, NULL, &rand);
-    in  = _mm_mul_ps(in, _mm_add_ps(mul, rand));
-    con = _mm_cvtps_epi32(in);
-
-    #ifdef __BIG_ENDIAN__
-    con = _mm_or_si128(_mm_slli_epi16(con, 8), _mm_srli_epi16(con, 8));
-    #endif
-
-    dst[0] = _mm_extract_epi16(con, 0);
-    if (unaligned == 3)
-    {
-      dst[1] = _mm_extract_epi16(con, 2);
-      dst[2] = _mm_extract_epi16(con, 4);
-    }
-    else if (unaligned == 2)
-      dst[1] = _mm_extract_epi16(con, 2);
-  }
-
-  /* cleanup */
-  _mm_empty();
-
-  #else /* no SSE2 */
 
   uint32_t i    = 0;
   uint32_t even = samples & ~0x3;
@@ -647,121 +742,40 @@ unsigned int CAEConvert::Float_S16LE(float *data, const unsigned int samples, ui
   for(; i < samples; ++i)
     *dst++ = Endian_SwapLE16(safeRound(*data++ * ((float)INT16_MAX + CAEUtil::FloatRand1(-0.5f, 0.5f))));
 
-  #endif
-
   return samples << 1;
 }
 
-unsigned int CAEConvert::Float_S16BE(float *data, const unsigned int samples, uint8_t *dest)
+unsigned int CAEConvert::Float_S16LE_SSE2(float *data, const unsigned int samples, uint8_t *dest)
 {
+#if defined(__SSE2__)
+  const __m128 mul = _mm_set_ps1((float)INT16_MAX);
   int16_t *dst = (int16_t*)dest;
-  #ifdef __SSE2__
+  unsigned int i = 0;
 
-  unsigned int count     = samples;
-  unsigned int unaligned = (0x10 - ((uintptr_t)data & 0xF)) >> 2;
-  if (unaligned == 4)
-    unaligned = 0;
-
-  /*
-    if we are only out by one, dont use SSE to correct it.
-    this must run before we do any SSE work so that the FPU
-    is in a working state without having to first call
-    _mm_empty()
-  */
-  if (unaligned == 1)
-     dst[0] = Endian_SwapBE16(safeRound(data[0] * ((float)INT16_MAX + CAEUtil::FloatRand1(-0.5f, 0.5f))));
-
-  MEMALIGN(16, static const __m128  mul) = _mm_set_ps1((float)INT16_MAX);
-  MEMALIGN(16, __m128  rand);
-  MEMALIGN(16, __m128  in  ) = _mm_setr_ps(0, 0, 0, 0);
-  MEMALIGN(16, __m128i con );
-
-  /* if unaligned is greater then one, use SSE to correct it */
-  if (unaligned > 1)
+  for (; i + 8 <= samples; i += 8, data += 8, dst += 8)
   {
-    switch (unaligned)
-    {
-      case 1: in = _mm_setr_ps(data[0], 0      , 0      , 0); break;
-      case 2: in = _mm_setr_ps(data[0], data[1], 0      , 0); break;
-      case 3: in = _mm_setr_ps(data[0], data[1], data[2], 0); break;
-    }
-
     /* random round to dither */
-    CAEUtil::FloatRand4(-0.5f, 0.5f, NULL, &rand);
-    in  = _mm_mul_ps(in, _mm_add_ps(mul, rand));
-    con = _mm_cvtps_epi32(in);
-
-    #ifndef __BIG_ENDIAN__
-    con = _mm_or_si128(_mm_slli_epi16(con, 8), _mm_srli_epi16(con, 8));
-    #endif
-
-    dst[0] = _mm_extract_epi16(con, 0);
-    if (unaligned == 3)
-    {
-      dst[1] = _mm_extract_epi16(con, 2);
-      dst[2] = _mm_extract_epi16(con, 4);
-    }
-    else if (unaligned == 2)
-      dst[1] = _mm_extract_epi16(con, 2);
+    __m128 rand1, rand2;
+    CAEUtil::FloatRand4(-0.5f, 0.5f, NULL, &rand1);
+    CAEUtil::FloatRand4(-0.5f, 0.5f, NULL, &rand2);
+    __m128i lo = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(data    ), _mm_add_ps(mul, rand1)));
+    __m128i hi = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(data + 4), _mm_add_ps(mul, rand2)));
+
+    /* keep the low 16 bits like the C version does, so packing does not saturate */
+    lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+    hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+    _mm_storeu_si128((__m128i*)dst, _mm_packs_epi32(lo, hi));
   }
 
-  /* update our pointers and sample count */
-  data  += unaligned;
-  dst   += unaligned;
-  count -= unaligned;
-
-  const uint32_t even = count & ~0x3;
-  for (uint32_t i = 0; i < even; i += 4, data += 4, dst += 4)
-  {
-    /* random round to dither */
-    CAEUtil::FloatRand4(-0.5f, 0.5f, NULL, &rand);
-    in   = _mm_mul_ps(_mm_load_ps(data), _mm_add_ps(mul, rand));
-    con  = _mm_cvtps_epi32(in);
-
-    #ifndef __BIG_ENDIAN__
-    con = _mm_or_si128(_mm_slli_epi16(con, 8), _mm_srli_epi16(con, 8));
-    #endif
-
-    dst[0] = _mm_extract_epi16(con, 0);
-    dst[1] = _mm_extract_epi16(con, 2);
-    dst[2] = _mm_extract_epi16(con, 4);
-    dst[3] = _mm_extract_epi16(con, 6);
-  }
-
-  /* calculate the final unaligned samples if there is any */
-  if (samples != even)
-  {
-    unaligned = samples - even;
-    switch (unaligned)
-    {
-      case 1: in = _mm_setr_ps(data[0], 0      , 0      , 0); break;
-      case 2: in = _mm_setr_ps(data[0], data[1], 0      , 0); break;
-      case 3: in = _mm_setr_ps(data[0], data[1], data[2], 0); break;
-    }
-
-    /* random round to dither */
-    CAEUtil::FloatRand4(-0.5f, 0.5f, NULL, &rand);
-    in  = _mm_mul_ps(in, _mm_add_ps(mul, rand));
-    con = _mm_cvtps_epi32(in);
-
-    #ifndef __BIG_ENDIAN__
-    con = _mm_or_si128(_mm_slli_epi16(con, 8), _mm_srli_epi16(con, 8));
-    #endif
-
-    dst[0] = _mm_extract_epi16(con, 0);
-    if (unaligned == 3)
-    {
-      dst[1] = _mm_extract_epi16(con, 2);
-      dst[2] = _mm_extract_epi16(con, 4);
-    }
-    else if (unaligned == 2)
-      dst[1] = _mm_extract_epi16(con, 2);
-  }
-
-  /* cleanup */
-  _mm_empty();
+  /* process any remaining samples */
+  Float_S16LE(data, samples - i, (uint8_t*)dst);
+#endif
+  return samples << 1;
+}
 
-  #else /* no SSE2 */
+unsigned int CAEConvert::Float_S16BE(float *data, const unsigned int samples, uint8_t *dest)
+{
+  int16_t *dst = (int16_t*)dest;
 
   uint32_t i    = 0;
   uint32_t even = samples & ~0x3;
@@ -778,72 +792,66 @@ unsigned int CAEConvert::Float_S16BE(float *data, const unsigned int samples, ui
     *dst++ = Endian_SwapBE16(safeRound(*data++ * ((float)INT16_MAX + rand[3])));
   }
 
-  for(; i < samples; ++i, data++, dst++)
+  for(; i < samples; ++i)
     *dst++ = Endian_SwapBE16(safeRound(*data++ * ((float)INT16_MAX + CAEUtil::FloatRand1(-0.5f, 0.5f))));
 
-  #endif
+  return samples << 1;
+}
+
+unsigned int CAEConvert::Float_S16BE_SSE2(float *data, const unsigned int samples, uint8_t *dest)
+{
+#if defined(__SSE2__)
+  const __m128 mul = _mm_set_ps1((float)INT16_MAX);
+  int16_t *dst = (int16_t*)dest;
+  unsigned int i = 0;
+
+  for (; i + 8 <= samples; i += 8, data += 8, dst += 8)
+  {
+    /* random round to dither */
+    __m128 rand1, rand2;
+    CAEUtil::FloatRand4(-0.5f, 0.5f, NULL, &rand1);
+    CAEUtil::FloatRand4(-0.5f, 0.5f, NULL, &rand2);
+    __m128i lo = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(data    ), _mm_add_ps(mul, rand1)));
+    __m128i hi = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(data + 4), _mm_add_ps(mul, rand2)));
+
+    /* keep the low 16 bits like the C version does, so packing does not saturate */
+    lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+    hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+    _mm_storeu_si128((__m128i*)dst, ByteSwap16(_mm_packs_epi32(lo, hi)));
+  }
 
+  /* process any remaining samples */
+  Float_S16BE(data, samples - i, (uint8_t*)dst);
+#endif
   return samples << 1;
 }
 
 unsigned int CAEConvert::Float_S24NE4(float *data, const unsigned int samples, uint8_t *dest)
 {
   int32_t *dst = (int32_t*)dest;
-  #ifdef __SSE2__
 
-  const __m128 mul = _mm_set_ps1((float)INT24_MAX+.5f);
-  unsigned int count = samples;
+  for (uint32_t i = 0; i < samples; ++i)
+    *dst++ = (safeRound(*data++ * ((float)INT24_MAX+.5f)) & 0xFFFFFF) << 8;
 
-  /* work around invalid alignment */
-  while ((((uintptr_t)data & 0xF) || ((uintptr_t)dest & 0xF)) && count > 0)
-  {
-    dst[0] = (safeRound(data[0] * ((float)INT24_MAX+.5f)) & 0xFFFFFF) << 8;
-    ++data;
-    ++dst;
-    --count;
-  }
+  return samples << 2;
+}
 
-  const uint32_t even = count & ~0x3;
-  for (uint32_t i = 0; i < even; i += 4, data += 4, dst += 4)
-  {
-    __m128  in  = _mm_mul_ps(_mm_load_ps(data), mul);
-    __m128i con = _mm_cvtps_epi32(in);
-    con         = _mm_slli_epi32(con, 8);
-    memcpy(dst, &con, sizeof(int32_t) * 4);
-  }
+unsigned int CAEConvert::Float_S24NE4_SSE2(float *data, const unsigned int samples, uint8_t *dest)
+{
+#if defined(__SSE2__)
+  const __m128 mul = _mm_set_ps1((float)INT24_MAX+.5f);
+  int32_t *dst = (int32_t*)dest;
+  unsigned int i = 0;
 
-  if (count != even)
+  for (; i + 4 <= samples; i += 4, data += 4, dst += 4)
   {
-    const uint32_t odd = count - even;
-    if (odd == 1)
-      dst[0] = (safeRound(data[0] * ((float)INT24_MAX+.5f)) & 0xFFFFFF) << 8;
-    else
-    {
-      __m128 in;
-      if (odd == 2)
-      {
-        in = _mm_setr_ps(data[0], data[1], 0, 0);
-        in = _mm_mul_ps(in, mul);
-        __m64 con = _mm_cvtps_pi32(in);
-        con       = _mm_slli_pi32(con, 8);
-        memcpy(dst, &con, sizeof(int32_t) * 2);
-      }
-      else
-      {
-        in = _mm_setr_ps(data[0], data[1], data[2], 0);
-        in = _mm_mul_ps(in, mul);
-        __m128i con = _mm_cvtps_epi32(in);
-        con         = _mm_slli_epi32(con, 8);
-        memcpy(dst, &con, sizeof(int32_t) * 3);
-      }
-    }
+    __m128i con = RoundHalfUp(_mm_mul_ps(_mm_loadu_ps(data), mul));
+    _mm_storeu_si128((__m128i*)dst, _mm_slli_epi32(con, 8));
   }
-  _mm_empty();
-  #else /* no SSE2 */
-  for (uint32_t i = 0; i < samples; ++i)
-    *dst++ = (safeRound(*data++ * ((float)INT24_MAX+.5f)) & 0xFFFFFF) << 8;
-  #endif
 
+  /* process any remaining samples */
+  Float_S24NE4(data, samples - i, (uint8_t*)dst);
+#endif
   return samples << 2;
 }
 
@@ -858,71 +866,37 @@ unsigned int CAEConvert::Float_S24NE3(float *data, const unsigned int samples, u
     0;
 #endif
 
-  /* disabled as it does not currently work */
-  #if 0 && defined(__SSE__)
-  int32_t *dst = (int32_t*)dest;
+  for (uint32_t i = 0; i < samples; ++i, ++data, dest += 3)
+    *((uint32_t*)(dest)) = (safeRound(*data * ((float)INT24_MAX+.5f)) & 0xFFFFFF) << leftShift;
 
-  const __m128 mul = _mm_set_ps1((float)INT24_MAX+.5f);
-  unsigned int count = samples;
+  return samples * 3;
+}
 
-  /* work around invalid alignment */
-  while ((((uintptr_t)data & 0xF) || ((uintptr_t)dest & 0xF)) && count > 0)
+unsigned int CAEConvert::Float_S24NE3_SSE2(float *data, const unsigned int samples, uint8_t *dest)
+{
+#if defined(__SSE2__)
+  const __m128  mul   = _mm_set_ps1((float)INT24_MAX+.5f);
+  const __m128i lo24  = _mm_set_epi32(0, 0x00FFFFFF, 0, 0x00FFFFFF);
+  const __m128i hi24  = _mm_set_epi32(0x0000FFFF, 0xFF000000, 0x0000FFFF, 0xFF000000);
+  const __m128i lane0 = _mm_set_epi32(0, 0, -1, -1);
+  unsigned int i = 0;
+
+  for (; i + 4 <= samples; i += 4, data += 4, dest += 12)
   {
-    *((uint32_t*)(dest)) = (safeRound(*data * ((float)INT24_MAX+.5f)) & 0xFFFFFF) << leftShift;
-    ++dest;
-    --count;
-  }
+    __m128i con = RoundHalfUp(_mm_mul_ps(_mm_loadu_ps(data), mul));
 
-  const uint32_t even = count & ~0x3;
-  for (uint32_t i = 0; i < count; i += 4, data += 4, dest += 12)
-  {
-    __m128  in  = _mm_mul_ps(_mm_load_ps(data), mul);
-    __m128i con = _mm_cvtps_epi32(in);
-    con         = _mm_slli_epi32(con, 8);
-    memcpy(dst, &con, sizeof(int32_t) * 4);
-    *((uint32_t*)(dest + 0)) = (dst[0] & 0xFFFFFF) << leftShift;
-    *((uint32_t*)(dest + 3)) = (dst[1] & 0xFFFFFF) << leftShift;
-    *((uint32_t*)(dest + 6)) = (dst[2] & 0xFFFFFF) << leftShift;
-    *((uint32_t*)(dest + 9)) = (dst[3] & 0xFFFFFF) << leftShift;
-  }
+    /* pack the low 3 bytes of each lane, 6 bytes per 64 bit half, then join the halves */
+    con = _mm_or_si128(_mm_and_si128(con, lo24), _mm_and_si128(_mm_srli_epi64(con, 8), hi24));
+    con = _mm_or_si128(_mm_and_si128(con, lane0), _mm_srli_si128(_mm_andnot_si128(lane0, con), 2));
 
-  if (count != even)
-  {
-    const uint32_t odd = count - even;
-    if (odd == 1)
-      dst[0] = safeRound(data[0] * ((float)INT24_MAX+.5f)) & 0xFFFFFF;
-    else
-    {
-      __m128 in;
-      if (odd == 2)
-      {
-        in = _mm_setr_ps(data[0], data[1], 0, 0);
-        in = _mm_mul_ps(in, mul);
-        __m64 con = _mm_cvtps_pi32(in);
-        con       = _mm_slli_pi32(con, 8);
-        memcpy(dst, &con, sizeof(int32_t) * 2);
-        *((uint32_t*)(dest + 0)) = (dst[0] & 0xFFFFFF) << leftShift;
-        *((uint32_t*)(dest + 3)) = (dst[1] & 0xFFFFFF) << leftShift;
-      }
-      else
-      {
-        in = _mm_setr_ps(data[0], data[1], data[2], 0);
-        in = _mm_mul_ps(in, mul);
-        __m128i con = _mm_cvtps_epi32(in);
-        con         = _mm_slli_epi32(con, 8);
-        memcpy(dst, &con, sizeof(int32_t) * 3);
-        *((uint32_t*)(dest + 0)) = (dst[0] & 0xFFFFFF) << leftShift;
-        *((uint32_t*)(dest + 3)) = (dst[1] & 0xFFFFFF) << leftShift;
-        *((uint32_t*)(dest + 6)) = (dst[2] & 0xFFFFFF) << leftShift;
-      }
-    }
+    _mm_storel_epi64((__m128i*)dest, con);
+    int32_t last = _mm_cvtsi128_si32(_mm_srli_si128(con, 8));
+    memcpy(dest + 8, &last, sizeof(last));
   }
-  _mm_empty();
-  #else /* no SSE */
-  for (uint32_t i = 0; i < samples; ++i, ++data, dest += 3)
-    *((uint32_t*)(dest)) = (safeRound(*data * ((float)INT24_MAX+.5f)) & 0xFFFFFF) << leftShift;
-  #endif
 
+  /* process any remaining samples */
+  Float_S24NE3(data, samples - i, dest);
+#endif
   return samples * 3;
 }
 
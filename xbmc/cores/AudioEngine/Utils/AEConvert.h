@@ -53,11 +53,28 @@ private:
   static unsigned int Float_S32LE_Neon (float   *data, const unsigned int samples, uint8_t *dest);
   static unsigned int Float_S32BE_Neon (float   *data, const unsigned int samples, uint8_t *dest);
 
+  static unsigned int S16LE_Float_SSE2 (uint8_t *data, const unsigned int samples, float   *dest);
+  static unsigned int S16BE_Float_SSE2 (uint8_t *data, const unsigned int samples, float   *dest);
+  static unsigned int S24LE4_Float_SSE2(uint8_t *data, const unsigned int samples, float   *dest);
+  static unsigned int S24BE4_Float_SSE2(uint8_t *data, const unsigned int samples, float   *dest);
+  static unsigned int S24LE3_Float_SSE2(uint8_t *data, const unsigned int samples, float   *dest);
+  static unsigned int S24BE3_Float_SSE2(uint8_t *data, const unsigned int samples, float   *dest);
+  static unsigned int Float_S16LE_SSE2 (float   *data, const unsigned int samples, uint8_t *dest);
+  static unsigned int Float_S16BE_SSE2 (float   *data, const unsigned int samples, uint8_t *dest);
+  static unsigned int Float_S24NE4_SSE2(float   *data, const unsigned int samples, uint8_t *dest);
+  static unsigned int Float_S24NE3_SSE2(float   *data, const unsigned int samples, uint8_t *dest);
+
 public:
   typedef unsigned int (*AEConvertToFn)(uint8_t *data, const unsigned int samples, float   *dest);
   typedef unsigned int (*AEConvertFrFn)(float   *data, const unsigned int samples, uint8_t *dest);
 
   static AEConvertToFn ToFloat(enum AEDataFormat dataFormat);
   static AEConvertFrFn FrFloat(enum AEDataFormat dataFormat);
+
+  /*! \brief Get the converter for the given format, only using the x86 SIMD versions
+   enabled in cpuFeatures (CPU_FEATURE_* flags). Pass 0 to get the plain C version.
+   */
+  static AEConvertToFn ToFloat(enum AEDataFormat dataFormat, unsigned int cpuFeatures);
+  static AEConvertFrFn FrFloat(enum AEDataFormat dataFormat, unsigned int cpuFeatures);
 };
 
@@ -28,9 +28,12 @@
 
 using namespace std;
 
-CAERemap::CAERemap() : m_inChannels(0), m_outChannels(0) 
+CAERemap::CAERemap() : m_inChannels(0), m_outChannels(0), m_mode(REMAP_REORDER), m_mixCount(0)
 {
   memset(m_mixInfo, 0, sizeof(m_mixInfo));
+  memset(m_copyIndex, 0, sizeof(m_copyIndex));
+  memset(m_mixChannel, 0, sizeof(m_mixChannel));
+  memset(m_mixLevels, 0, sizeof(m_mixLevels));
 }
 
 CAERemap::~CAERemap()
@@ -87,7 +90,10 @@ bool CAERemap::Initialize(CAEChannelInfo input, CAEChannelInfo output, bool fina
 
   /* the final stage does not need any down/upmix */
   if (finalStage)
+  {
+    BuildPlan();
     return true;
+  }
 
   /* downmix from the specified channel to the specified list of channels */
   #define RM(from, ...) \
@@ -253,9 +259,65 @@ bool CAERemap::Initialize(CAEChannelInfo input, CAEChannelInfo output, bool fina
   CLog::Log(LOGINFO, "====================\n");
 #endif
 
+  BuildPlan();
   return true;
 }
 
+void CAERemap::BuildPlan()
+{
+  /* see if every output is a plain copy of one input, or silent */
+  bool reorder = true;
+  bool copy    = m_inChannels == m_outChannels;
+  for (int o = 0; o < m_outChannels; ++o)
+  {
+    const AEMixInfo *info = &m_mixInfo[m_output[o]];
+    if (!info->in_dst || info->srcCount == 0)
+      m_copyIndex[o] = -1;
+    else if (info->srcCount == 1)
+      m_copyIndex[o] = info->srcIndex[0].index;
+    else
+      reorder = false;
+
+    if (m_copyIndex[o] != o)
+      copy = false;
+  }
+
+  if (reorder)
+  {
+    m_mode = copy ? REMAP_COPY : REMAP_REORDER;
+    return;
+  }
+
+  /* turn the matrix around, so every input that is used has the levels it gets in each output */
+  m_mode     = REMAP_MIX;
+  m_mixCount = 0;
+  memset(m_mixLevels, 0, sizeof(m_mixLevels));
+
+  int column[AE_CH_MAX];
+  for (int i = 0; i < AE_CH_MAX; ++i)
+    column[i] = -1;
+
+  for (int o = 0; o < m_outChannels; ++o)
+  {
+    const AEMixInfo *info = &m_mixInfo[m_output[o]];
+    if (!info->in_dst)
+      continue;
+
+    for (int s = 0; s < info->srcCount; ++s)
+    {
+      int index = info->srcIndex[s].index;
+      if (column[index] < 0)
+      {
+        column[index] = m_mixCount;
+        m_mixChannel[m_mixCount++] = index;
+      }
+
+      /* a single source is copied as is, see RemapMatrix */
+      m_mixLevels[column[index]][o] += info->srcCount == 1 ? 1.0f : info->srcIndex[s].level;
+    }
+  }
+}
+
 void CAERemap::ResolveMix(const AEChannel from, CAEChannelInfo to)
 {
   AEMixInfo *fromInfo = &m_mixInfo[from];
@@ -295,6 +357,117 @@ void CAERemap::ResolveMix(const AEChannel from, CAEChannelInfo to)
 
 /* This method has unrolled loop for higher performance */
 void CAERemap::Remap(float * const in, float * const out, const unsigned int frames) const
+{
+  switch (m_mode)
+  {
+    case REMAP_COPY:
+      if (in != out)
+        memcpy(out, in, frames * m_outChannels * sizeof(float));
+      break;
+
+    case REMAP_REORDER:
+      RemapReorder(in, out, frames);
+      break;
+
+    case REMAP_MIX:
+#ifdef __SSE__
+      RemapMix(in, out, frames);
+#else
+      RemapMatrix(in, out, frames);
+#endif
+      break;
+  }
+}
+
+void CAERemap::RemapReorder(float * const in, float * const out, const unsigned int frames) const
+{
+  const float *src = in;
+  float       *dst = out;
+  for (unsigned int f = 0; f < frames; ++f, src += m_inChannels, dst += m_outChannels)
+  {
+    for (int o = 0; o < m_outChannels; ++o)
+      dst[o] = m_copyIndex[o] < 0 ? 0.0f : src[m_copyIndex[o]];
+  }
+}
+
+void CAERemap::RemapMix(float * const in, float * const out, const unsigned int frames) const
+{
+#ifdef __SSE__
+  const float *src = in;
+  float       *dst = out;
+
+  /* every frame is the sum of the used inputs times their level columns, four outputs at
+     a time. Stores are done a full vector at a time, which writes past the end of the
+     frame into the following ones; the last few frames go through a temporary to stay
+     in bounds. */
+  MEMALIGN(16, float last[(AE_CH_MAX + 3) & ~3]);
+  const unsigned int pad  = ((m_outChannels + 3) & ~3) - m_outChannels;
+  const unsigned int tail = (pad + m_outChannels - 1) / m_outChannels;
+
+  if (m_outChannels <= 4)
+  {
+    /* stereo, 2.1, quad... the common downmix targets */
+    for (unsigned int f = 0; f < frames; ++f, src += m_inChannels, dst += m_outChannels)
+    {
+      __m128 acc = _mm_setzero_ps();
+      for (int k = 0; k < m_mixCount; ++k)
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(src[m_mixChannel[k]]), _mm_loadu_ps(m_mixLevels[k])));
+
+      if (f + tail < frames)
+        _mm_storeu_ps(dst, acc);
+      else
+      {
+        _mm_store_ps(last, acc);
+        memcpy(dst, last, m_outChannels * sizeof(float));
+      }
+    }
+  }
+  else if (m_outChannels <= 8)
+  {
+    /* 5.1 and 7.1 */
+    for (unsigned int f = 0; f < frames; ++f, src += m_inChannels, dst += m_outChannels)
+    {
+      __m128 acc1 = _mm_setzero_ps();
+      __m128 acc2 = _mm_setzero_ps();
+      for (int k = 0; k < m_mixCount; ++k)
+      {
+        __m128 sample = _mm_set1_ps(src[m_mixChannel[k]]);
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(sample, _mm_loadu_ps(m_mixLevels[k])));
+        acc2 = _mm_add_ps(acc2, _mm_mul_ps(sample, _mm_loadu_ps(m_mixLevels[k] + 4)));
+      }
+
+      if (f + tail < frames)
+      {
+        _mm_storeu_ps(dst    , acc1);
+        _mm_storeu_ps(dst + 4, acc2);
+      }
+      else
+      {
+        _mm_store_ps(last    , acc1);
+        _mm_store_ps(last + 4, acc2);
+        memcpy(dst, last, m_outChannels * sizeof(float));
+      }
+    }
+  }
+  else
+  {
+    const int groups = (m_outChannels + 3) >> 2;
+    for (unsigned int f = 0; f < frames; ++f, src += m_inChannels, dst += m_outChannels)
+    {
+      for (int g = 0; g < groups; ++g)
+      {
+        __m128 acc = _mm_setzero_ps();
+        for (int k = 0; k < m_mixCount; ++k)
+          acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(src[m_mixChannel[k]]), _mm_loadu_ps(m_mixLevels[k] + g * 4)));
+        _mm_store_ps(last + g * 4, acc);
+      }
+      memcpy(dst, last, m_outChannels * sizeof(float));
+    }
+  }
+#endif
+}
+
+void CAERemap::RemapMatrix(float * const in, float * const out, const unsigned int frames) const
 {
   const unsigned int frameBlocks = frames & ~0x3;
 
@@ -29,6 +29,11 @@ public:
   bool Initialize(CAEChannelInfo input, CAEChannelInfo output, bool finalStage, bool forceNormalize = false, enum AEStdChLayout stdChLayout = AE_CH_LAYOUT_INVALID);
   void Remap(float * const in, float * const out, const unsigned int frames) const;
 
+  /*! \brief Remap by walking the mix matrix, without the precompiled plan used by Remap().
+   Slower, this is the reference implementation Remap() must match.
+   */
+  void RemapMatrix(float * const in, float * const out, const unsigned int frames) const;
+
 private:
   typedef struct {
     int       index;
@@ -44,12 +49,28 @@ private:
     int               cpyCount; /* the number of times the channel has been cloned */
   } AEMixInfo;
 
+  /* how Remap() processes the frames, chosen by BuildPlan() */
+  enum RemapMode {
+    REMAP_COPY,    /* the output is the input */
+    REMAP_REORDER, /* every output is a copy of one input or silent */
+    REMAP_MIX      /* at least one output mixes several inputs */
+  };
+
   AEMixInfo      m_mixInfo[AE_CH_MAX+1];
   CAEChannelInfo m_output;
   int            m_inChannels;
   int            m_outChannels;
 
+  RemapMode      m_mode;
+  int            m_copyIndex[AE_CH_MAX];  /* source of each output for REMAP_REORDER, -1 for silence */
+  int            m_mixCount;              /* number of inputs used by REMAP_MIX */
+  int            m_mixChannel[AE_CH_MAX]; /* the input index of each of those */
+  float          m_mixLevels[AE_CH_MAX][(AE_CH_MAX + 3) & ~3]; /* their level in every output, padded to 4 */
+
   void ResolveMix(const AEChannel from, CAEChannelInfo to);
   void BuildUpmixMatrix(const CAEChannelInfo& input, const CAEChannelInfo& output);
+  void BuildPlan();
+  void RemapReorder(float * const in, float * const out, const unsigned int frames) const;
+  void RemapMix    (float * const in, float * const out, const unsigned int frames) const;
 };
 
@@ -0,0 +1,185 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "cores/AudioEngine/Utils/AEConvert.h"
+#include "cores/AudioEngine/Utils/AEUtil.h"
+#include "threads/SystemClock.h"
+#include "utils/CPUInfo.h"
+
+#include "gtest/gtest.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+#include <vector>
+
+/* odd sample count so the tail handling gets exercised too */
+#define SAMPLES 1027
+
+static const AEDataFormat s_formats[] =
+{
+  AE_FMT_S16LE, AE_FMT_S16BE, AE_FMT_S24LE4, AE_FMT_S24BE4, AE_FMT_S24LE3, AE_FMT_S24BE3
+};
+
+static void FillRandom(std::vector<uint8_t> &data)
+{
+  srand(1234);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = rand() & 0xFF;
+}
+
+static void FillSamples(std::vector<float> &data)
+{
+  srand(1234);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = (float)rand() / RAND_MAX * 2.2f - 1.1f;
+
+  /* full scale, silence and rounding ties */
+  const float special[] = { 1.0f, -1.0f, 0.0f, -0.0f, 0.5f / 8388607.5f, -0.5f / 8388607.5f,
+                            1.5f / 8388607.5f, -2.5f / 8388607.5f, 300.0f, -300.0f };
+  for (size_t i = 0; i < sizeof(special) / sizeof(special[0]); ++i)
+    data[i * 7] = special[i];
+}
+
+static unsigned int GetSIMDFeatures()
+{
+  return CPU_FEATURE_SSE | CPU_FEATURE_SSE2;
+}
+
+TEST(TestAEConvert, ToFloat)
+{
+  std::vector<uint8_t> input(SAMPLES * 4 + 1);
+  FillRandom(input);
+
+  for (size_t f = 0; f < sizeof(s_formats) / sizeof(s_formats[0]); ++f)
+  {
+    CAEConvert::AEConvertToFn plain = CAEConvert::ToFloat(s_formats[f], 0);
+    CAEConvert::AEConvertToFn simd  = CAEConvert::ToFloat(s_formats[f], GetSIMDFeatures());
+    ASSERT_TRUE(plain && simd);
+
+    /* also run from an unaligned source and destination */
+    for (unsigned int offset = 0; offset < 2; ++offset)
+    {
+      std::vector<float> expected(SAMPLES + 1), actual(SAMPLES + 1);
+      EXPECT_EQ(SAMPLES - offset, plain(&input[offset], SAMPLES - offset, &expected[offset]));
+      EXPECT_EQ(SAMPLES - offset, simd (&input[offset], SAMPLES - offset, &actual  [offset]));
+      EXPECT_EQ(0, memcmp(&expected[0], &actual[0], expected.size() * sizeof(float)))
+        << "format " << CAEUtil::DataFormatToStr(s_formats[f]) << " offset " << offset;
+    }
+  }
+}
+
+TEST(TestAEConvert, FrFloat)
+{
+  std::vector<float> input(SAMPLES + 1);
+  FillSamples(input);
+
+  const AEDataFormat formats[] = { AE_FMT_S24NE4, AE_FMT_S24NE3, AE_FMT_S16LE, AE_FMT_S16BE };
+  for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); ++f)
+  {
+    CAEConvert::AEConvertFrFn plain = CAEConvert::FrFloat(formats[f], 0);
+    CAEConvert::AEConvertFrFn simd  = CAEConvert::FrFloat(formats[f], GetSIMDFeatures());
+    ASSERT_TRUE(plain && simd);
+
+    const unsigned int bytes = CAEUtil::DataFormatToBits(formats[f]) >> 3;
+    for (unsigned int offset = 0; offset < 2; ++offset)
+    {
+      /* the C version of S24NE3 writes one byte past the last sample */
+      std::vector<uint8_t> expected(SAMPLES * 4 + 8), actual(SAMPLES * 4 + 8);
+      EXPECT_EQ((SAMPLES - offset) * bytes, plain(&input[offset], SAMPLES - offset, &expected[offset]));
+      EXPECT_EQ((SAMPLES - offset) * bytes, simd (&input[offset], SAMPLES - offset, &actual  [offset]));
+
+      if (bytes == 2)
+      {
+        /* 16 bit output is dithered, the two versions may be one step apart */
+        for (unsigned int i = 0; i < SAMPLES - offset; ++i)
+        {
+          /* the dither scales with the input, so out of range samples are further apart */
+          if (fabs(input[offset + i]) > 1.0f)
+            continue;
+
+          int a, b;
+          if (formats[f] == AE_FMT_S16LE)
+          {
+            a = (int16_t)(expected[offset + i * 2] | expected[offset + i * 2 + 1] << 8);
+            b = (int16_t)(actual  [offset + i * 2] | actual  [offset + i * 2 + 1] << 8);
+          }
+          else
+          {
+            a = (int16_t)(expected[offset + i * 2] << 8 | expected[offset + i * 2 + 1]);
+            b = (int16_t)(actual  [offset + i * 2] << 8 | actual  [offset + i * 2 + 1]);
+          }
+          /* full scale plus dither wraps around in both versions */
+          if (abs(a - b) > 1)
+            EXPECT_EQ(65535, abs(a - b)) << "sample " << i << " offset " << offset;
+        }
+      }
+      else
+        EXPECT_EQ(0, memcmp(&expected[offset], &actual[offset], (SAMPLES - offset) * bytes))
+          << "format " << CAEUtil::DataFormatToStr(formats[f]) << " offset " << offset;
+    }
+  }
+}
+
+TEST(TestAEConvert, Benchmark)
+{
+  const AEDataFormat formats[] =
+  {
+    AE_FMT_S16LE, AE_FMT_S16BE, AE_FMT_S24NE4, AE_FMT_S24BE4, AE_FMT_S24NE3, AE_FMT_S24BE3
+  };
+  const unsigned int rounds = 20000;
+  std::vector<uint8_t> raw(SAMPLES * 4);
+  std::vector<float>   samples(SAMPLES);
+  FillRandom(raw);
+  FillSamples(samples);
+
+  for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); ++f)
+  {
+    for (int simd = 0; simd < 2; ++simd)
+    {
+      unsigned int features = simd ? GetSIMDFeatures() : 0;
+      CAEConvert::AEConvertToFn to = CAEConvert::ToFloat(formats[f], features);
+      CAEConvert::AEConvertFrFn fr = CAEConvert::FrFloat(formats[f], features);
+
+      unsigned int start = XbmcThreads::SystemClockMillis();
+      for (unsigned int i = 0; i < rounds; ++i)
+        to(&raw[0], SAMPLES, &samples[0]);
+      unsigned int toTime = XbmcThreads::SystemClockMillis() - start;
+
+      FillSamples(samples);
+      unsigned int frTime = 0;
+      if (fr)
+      {
+        start = XbmcThreads::SystemClockMillis();
+        for (unsigned int i = 0; i < rounds; ++i)
+          fr(&samples[0], SAMPLES, &raw[0]);
+        frTime = XbmcThreads::SystemClockMillis() - start;
+      }
+
+      std::cout << CAEUtil::DataFormatToStr(formats[f]) << (simd ? " SIMD" : " C   ")
+                << ": to float " << (uint64_t)rounds * SAMPLES / std::max(1U, toTime) / 1000 << " Msamples/s";
+      if (fr)
+        std::cout << ", from float " << (uint64_t)rounds * SAMPLES / std::max(1U, frTime) / 1000 << " Msamples/s";
+      std::cout << std::endl;
+    }
+  }
+}
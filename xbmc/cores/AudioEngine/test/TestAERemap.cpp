@@ -0,0 +1,109 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "cores/AudioEngine/Utils/AERemap.h"
+#include "threads/SystemClock.h"
+
+#include "gtest/gtest.h"
+
+#include <stdlib.h>
+#include <iostream>
+#include <vector>
+
+static void FillSamples(std::vector<float> &data)
+{
+  srand(1234);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = (float)rand() / RAND_MAX * 2.0f - 1.0f;
+}
+
+static void CompareRemap(const CAEChannelInfo &input, const CAEChannelInfo &output)
+{
+  /* odd frame count so the last frame handling gets exercised too */
+  const unsigned int frames = 1023;
+
+  CAERemap remap;
+  ASSERT_TRUE(remap.Initialize(input, output, false, true));
+
+  std::vector<float> in(frames * input.Count());
+  std::vector<float> expected(frames * output.Count(), 1.0f);
+  std::vector<float> actual  (frames * output.Count(), 2.0f);
+  FillSamples(in);
+
+  remap.RemapMatrix(&in[0], &expected[0], frames);
+  remap.Remap      (&in[0], &actual  [0], frames);
+
+  for (size_t i = 0; i < expected.size(); ++i)
+    ASSERT_NEAR(expected[i], actual[i], 1e-6f)
+      << (std::string)input << " -> " << (std::string)output << " sample " << i;
+}
+
+TEST(TestAERemap, Copy)
+{
+  CompareRemap(AE_CH_LAYOUT_2_0, AE_CH_LAYOUT_2_0);
+  CompareRemap(AE_CH_LAYOUT_5_1, AE_CH_LAYOUT_5_1);
+}
+
+TEST(TestAERemap, Reorder)
+{
+  static AEChannel in [] = { AE_CH_FL, AE_CH_FR, AE_CH_FC, AE_CH_LFE, AE_CH_BL, AE_CH_BR, AE_CH_NULL };
+  static AEChannel out[] = { AE_CH_FL, AE_CH_FR, AE_CH_BL, AE_CH_BR, AE_CH_FC, AE_CH_LFE, AE_CH_NULL };
+  CompareRemap(CAEChannelInfo(in), CAEChannelInfo(out));
+
+  /* outputs without a source are silent */
+  CompareRemap(AE_CH_LAYOUT_2_0, AE_CH_LAYOUT_2_1);
+}
+
+TEST(TestAERemap, Downmix)
+{
+  CompareRemap(AE_CH_LAYOUT_7_1, AE_CH_LAYOUT_2_0);
+  CompareRemap(AE_CH_LAYOUT_5_1, AE_CH_LAYOUT_2_0);
+  CompareRemap(AE_CH_LAYOUT_7_1, AE_CH_LAYOUT_5_1);
+  CompareRemap(AE_CH_LAYOUT_7_1, AE_CH_LAYOUT_4_0);
+  CompareRemap(AE_CH_LAYOUT_5_1, AE_CH_LAYOUT_1_0);
+}
+
+TEST(TestAERemap, Benchmark)
+{
+  /* one second of 192kHz 7.1 down to stereo */
+  const unsigned int frames = 192000;
+  const unsigned int rounds = 20;
+
+  CAERemap remap;
+  ASSERT_TRUE(remap.Initialize(AE_CH_LAYOUT_7_1, AE_CH_LAYOUT_2_0, false, true));
+
+  std::vector<float> in(frames * 8), out(frames * 2);
+  FillSamples(in);
+
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  for (unsigned int i = 0; i < rounds; ++i)
+    remap.RemapMatrix(&in[0], &out[0], frames);
+  unsigned int matrixTime = XbmcThreads::SystemClockMillis() - start;
+
+  start = XbmcThreads::SystemClockMillis();
+  for (unsigned int i = 0; i < rounds; ++i)
+    remap.Remap(&in[0], &out[0], frames);
+  unsigned int planTime = XbmcThreads::SystemClockMillis() - start;
+
+  std::cout << "CAERemap 7.1 -> 2.0: matrix " << (uint64_t)rounds * frames / std::max(1U, matrixTime) / 1000
+            << " Mframes/s, plan " << (uint64_t)rounds * frames / std::max(1U, planTime) / 1000
+            << " Mframes/s" << std::endl;
+}
@@ -18,15 +18,30 @@
  *
  */
 
+
 #include "DVDMessageQueue.h"
 #include "DVDDemuxers/DVDDemuxUtils.h"
 #include "utils/log.h"
+#include "threads/Atomics.h"
 #include "threads/SingleLock.h"
 #include "DVDClock.h"
 #include "utils/MathUtils.h"
 
 using namespace std;
 
+// read a counter shared with the other side, the locked add doubles as a full barrier
+static inline long AtomicLoad(volatile long* pAddr)
+{
+  return AtomicAdd(pAddr, 0);
+}
+
+static inline DemuxPacket* GetDemuxPacket(CDVDMsg* pMsg)
+{
+  if (pMsg->IsType(CDVDMsg::DEMUXER_PACKET))
+    return ((CDVDMsgDemuxerPacket*)pMsg)->GetPacket();
+  return NULL;
+}
+
 CDVDMessageQueue::CDVDMessageQueue(const string &owner) : m_hEvent(true), m_owner(owner)
 {
   m_iDataSize     = 0;
@@ -39,12 +54,21 @@ CDVDMessageQueue::CDVDMessageQueue(const string &owner) : m_hEvent(true), m_owne
   m_TimeFront     = DVD_NOPTS_VALUE;
   m_TimeSize      = 1.0 / 4.0; /* 4 seconds */
   m_iMaxDataSize  = 0;
+
+  m_ring          = new CDVDMsg*[RingSize];
+  m_head          = 0;
+  m_tail          = 0;
+  m_iPackets      = 0;
+  m_overflowCount = 0;
+  m_listCount     = 0;
+  m_waiting       = 0;
 }
 
 CDVDMessageQueue::~CDVDMessageQueue()
 {
   // remove all remaining messages
-  Flush();
+  Flush(CDVDMsg::NONE);
+  delete[] m_ring;
 }
 
 void CDVDMessageQueue::Init()
@@ -59,12 +83,47 @@ void CDVDMessageQueue::Init()
 
 void CDVDMessageQueue::Flush(CDVDMsg::Message type)
 {
+  CSingleLock producer(m_producer);
+  CSingleLock consumer(m_consumer);
   CSingleLock lock(m_section);
 
   for(SList::iterator it = m_list.begin(); it != m_list.end();)
   {
     if (it->message->IsType(type) ||  type == CDVDMsg::NONE)
+    {
       it = m_list.erase(it);
+      AtomicDecrement(&m_listCount);
+    }
+    else
+      ++it;
+  }
+
+  // both sides are locked out, so the ring can be edited in place. removed
+  // messages leave a hole which the consumer skips.
+  for(unsigned long i = m_tail; i != (unsigned long)m_head; i++)
+  {
+    CDVDMsg*& msg = m_ring[i % RingSize];
+    if (msg && (msg->IsType(type) || type == CDVDMsg::NONE))
+    {
+      if (msg->IsType(CDVDMsg::DEMUXER_PACKET))
+        AtomicDecrement(&m_iPackets);
+      msg->Release();
+      msg = NULL;
+    }
+  }
+  while(m_tail != m_head && m_ring[(unsigned long)m_tail % RingSize] == NULL)
+    AtomicIncrement(&m_tail);
+
+  for(list<CDVDMsg*>::iterator it = m_overflow.begin(); it != m_overflow.end();)
+  {
+    if ((*it)->IsType(type) || type == CDVDMsg::NONE)
+    {
+      if ((*it)->IsType(CDVDMsg::DEMUXER_PACKET))
+        AtomicDecrement(&m_iPackets);
+      (*it)->Release();
+      it = m_overflow.erase(it);
+      AtomicDecrement(&m_overflowCount);
+    }
     else
       ++it;
   }
@@ -89,8 +148,6 @@ void CDVDMessageQueue::Abort()
 
 void CDVDMessageQueue::End()
 {
-  CSingleLock lock(m_section);
-
   Flush();
 
   m_bInitialized  = false;
@@ -98,11 +155,19 @@ void CDVDMessageQueue::End()
   m_bAbortRequest = false;
 }
 
+bool CDVDMessageQueue::RingPush(CDVDMsg* pMsg)
+{
+  long head = m_head;
+  if ((unsigned long)(head - AtomicLoad(&m_tail)) >= RingSize)
+    return false;
+
+  m_ring[(unsigned long)head % RingSize] = pMsg;
+  AtomicIncrement(&m_head); // publish the slot to the consumer
+  return true;
+}
 
 MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority)
 {
-  CSingleLock lock(m_section);
-
   if (!m_bInitialized)
   {
     CLog::Log(LOGWARNING, "CDVDMessageQueue(%s)::Put MSGQ_NOT_INITIALIZED", m_owner.c_str());
@@ -115,40 +180,151 @@ MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority)
     return MSGQ_INVALID_MSG;
   }
 
-  SList::iterator it = m_list.begin();
-  while(it != m_list.end())
+  if (priority != 0)
   {
-    if(priority <= it->priority)
-      break;
-    ++it;
+    CSingleLock lock(m_section);
+
+    SList::iterator it = m_list.begin();
+    while(it != m_list.end())
+    {
+      if(priority <= it->priority)
+        break;
+      ++it;
+    }
+    m_list.insert(it, DVDMessageListItem(pMsg, priority));
+    AtomicIncrement(&m_listCount);
+
+    pMsg->Release();
+
+    m_hEvent.Set(); // inform waiter for new packet
+
+    return MSGQ_OK;
+  }
+
+  CSingleLock producer(m_producer);
+
+  // account before publishing, so the consumer never sees the sizes go negative
+  if (pMsg->IsType(CDVDMsg::DEMUXER_PACKET))
+    AtomicIncrement(&m_iPackets);
+
+  DemuxPacket* packet = GetDemuxPacket(pMsg);
+  if (packet)
+  {
+    if     (packet->dts != DVD_NOPTS_VALUE)
+      m_TimeFront = packet->dts;
+    else if(packet->pts != DVD_NOPTS_VALUE)
+      m_TimeFront = packet->pts;
+    if(m_TimeBack == DVD_NOPTS_VALUE)
+      m_TimeBack = m_TimeFront;
+    AtomicAdd(&m_iDataSize, packet->iSize);
+  }
+
+  // the queue takes over the callers reference. once anything went to the overflow
+  // list, keep appending there until the consumer drained it to preserve ordering
+  if (m_overflowCount > 0 || !RingPush(pMsg))
+  {
+    CSingleLock lock(m_section);
+    m_overflow.push_back(pMsg);
+    AtomicIncrement(&m_overflowCount);
+  }
+
+  if (m_waiting)
+    m_hEvent.Set(); // inform waiter for new packet
+
+  return MSGQ_OK;
+}
+
+CDVDMsg* CDVDMessageQueue::PopNormal()
+{
+  while (m_tail != AtomicLoad(&m_head))
+  {
+    CDVDMsg* msg = m_ring[(unsigned long)m_tail % RingSize];
+    AtomicIncrement(&m_tail); // hand the slot back to the producer
+    if (msg)
+      return msg;
+  }
+
+  // the ring is empty, anything in the overflow list is newer than what was in it
+  if (m_overflowCount > 0)
+  {
+    CSingleLock lock(m_section);
+    if (!m_overflow.empty())
+    {
+      CDVDMsg* msg = m_overflow.front();
+      m_overflow.pop_front();
+      AtomicDecrement(&m_overflowCount);
+      return msg;
+    }
   }
-  m_list.insert(it, DVDMessageListItem(pMsg, priority));
+  return NULL;
+}
+
+bool CDVDMessageQueue::TryGet(CDVDMsg** pMsg, int &priority)
+{
+  if (m_bCaching)
+    return false;
 
-  if (pMsg->IsType(CDVDMsg::DEMUXER_PACKET) && priority == 0)
+  if (m_listCount > 0)
   {
-    DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)pMsg)->GetPacket();
-    if(packet)
+    CSingleLock lock(m_section);
+    if (!m_list.empty() && m_list.back().priority > 0 && m_list.back().priority >= priority)
     {
-      m_iDataSize += packet->iSize;
-      if     (packet->dts != DVD_NOPTS_VALUE)
-        m_TimeFront = packet->dts;
-      else if(packet->pts != DVD_NOPTS_VALUE)
-        m_TimeFront = packet->pts;
-      if(m_TimeBack == DVD_NOPTS_VALUE)
-        m_TimeBack = m_TimeFront;
+      DVDMessageListItem& item(m_list.back());
+      priority = item.priority;
+      *pMsg = item.message->Acquire();
+      m_list.pop_back();
+      AtomicDecrement(&m_listCount);
+      return true;
     }
   }
 
-  pMsg->Release();
+  if (priority <= 0)
+  {
+    CDVDMsg* msg = PopNormal();
+    if (msg)
+    {
+      if (msg->IsType(CDVDMsg::DEMUXER_PACKET))
+        AtomicDecrement(&m_iPackets);
 
-  m_hEvent.Set(); // inform waiter for new packet
+      DemuxPacket* packet = GetDemuxPacket(msg);
+      if (packet)
+      {
+        AtomicSubtract(&m_iDataSize, packet->iSize);
+        if     (packet->dts != DVD_NOPTS_VALUE)
+          m_TimeBack = packet->dts;
+        else if(packet->pts != DVD_NOPTS_VALUE)
+          m_TimeBack = packet->pts;
 
-  return MSGQ_OK;
+      }
+
+      if(m_bEmptied && m_iDataSize > 0)
+        m_bEmptied = false;
+      priority = 0;
+      *pMsg = msg;
+      return true;
+    }
+  }
+
+  // messages put with a negative priority are only returned once the ring is empty
+  if (m_listCount > 0)
+  {
+    CSingleLock lock(m_section);
+    if (!m_list.empty() && m_list.back().priority >= priority)
+    {
+      DVDMessageListItem& item(m_list.back());
+      priority = item.priority;
+      *pMsg = item.message->Acquire();
+      m_list.pop_back();
+      AtomicDecrement(&m_listCount);
+      return true;
+    }
+  }
+  return false;
 }
 
 MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutInMilliSeconds, int &priority)
 {
-  CSingleLock lock(m_section);
+  CSingleLock lock(m_consumer);
 
   *pMsg = NULL;
 
@@ -160,7 +336,8 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
     return MSGQ_NOT_INITIALIZED;
   }
 
-  if(m_list.empty() && m_bEmptied == false && priority == 0 && m_owner != "teletext")
+  if(m_listCount == 0 && m_tail == AtomicLoad(&m_head) && m_overflowCount == 0
+  && m_bEmptied == false && priority == 0 && m_owner != "teletext")
   {
 #if !defined(TARGET_RASPBERRY_PI)
     CLog::Log(LOGWARNING, "CDVDMessageQueue(%s)::Get - asked for new data packet, with nothing available", m_owner.c_str());
@@ -168,32 +345,11 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
     m_bEmptied = true;
   }
 
+  bool waiting = false;
   while (!m_bAbortRequest)
   {
-    if(!m_list.empty() && m_list.back().priority >= priority && !m_bCaching)
+    if (TryGet(pMsg, priority))
     {
-      DVDMessageListItem& item(m_list.back());
-      priority = item.priority;
-
-      if (item.message->IsType(CDVDMsg::DEMUXER_PACKET) && item.priority == 0)
-      {
-        DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)item.message)->GetPacket();
-        if(packet)
-        {
-          m_iDataSize -= packet->iSize;
-          if     (packet->dts != DVD_NOPTS_VALUE)
-            m_TimeBack = packet->dts;
-          else if(packet->pts != DVD_NOPTS_VALUE)
-            m_TimeBack = packet->pts;
-        }
-
-        if(m_bEmptied && m_iDataSize > 0)
-          m_bEmptied = false;
-      }
-
-      *pMsg = item.message->Acquire();
-      m_list.pop_back();
-
       ret = MSGQ_OK;
       break;
     }
@@ -202,19 +358,33 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
       ret = MSGQ_TIMEOUT;
       break;
     }
-    else
+    else if (!waiting)
     {
+      // announce the wait, then check once more so a concurrent Put either
+      // sees m_waiting or its message is found by the check
       m_hEvent.Reset();
+      AtomicIncrement(&m_waiting);
+      waiting = true;
+    }
+    else
+    {
       lock.Leave();
 
       // wait for a new message
-      if (!m_hEvent.WaitMSec(iTimeoutInMilliSeconds))
-        return MSGQ_TIMEOUT;
+      bool signaled = m_hEvent.WaitMSec(iTimeoutInMilliSeconds);
 
       lock.Enter();
+      AtomicDecrement(&m_waiting);
+      waiting = false;
+
+      if (!signaled)
+        return MSGQ_TIMEOUT;
     }
   }
 
+  if (waiting)
+    AtomicDecrement(&m_waiting);
+
   if (m_bAbortRequest) return MSGQ_ABORT;
 
   return (MsgQueueReturnCode)ret;
@@ -223,12 +393,34 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
 
 unsigned CDVDMessageQueue::GetPacketCount(CDVDMsg::Message type)
 {
-  CSingleLock lock(m_section);
-
   if (!m_bInitialized)
     return 0;
 
   unsigned count = 0;
+
+  // normal priority packets are counted as they pass, avoiding a walk of the ring
+  if (type == CDVDMsg::DEMUXER_PACKET)
+    count = (unsigned)std::max(0L, (long)m_iPackets);
+  else
+  {
+    CSingleLock consumer(m_consumer);
+    for(unsigned long i = m_tail; i != (unsigned long)AtomicLoad(&m_head); i++)
+    {
+      CDVDMsg* msg = m_ring[i % RingSize];
+      if(msg && msg->IsType(type))
+        count++;
+    }
+  }
+
+  CSingleLock lock(m_section);
+  if (type != CDVDMsg::DEMUXER_PACKET)
+  {
+    for(list<CDVDMsg*>::iterator it = m_overflow.begin(); it != m_overflow.end(); ++it)
+    {
+      if((*it)->IsType(type))
+        count++;
+    }
+  }
   for(SList::iterator it = m_list.begin(); it != m_list.end();++it)
   {
     if(it->message->IsType(type))
@@ -249,13 +441,14 @@ void CDVDMessageQueue::WaitUntilEmpty()
 
 int CDVDMessageQueue::GetLevel() const
 {
-  if(m_iDataSize > m_iMaxDataSize)
+  int dataSize = (int)m_iDataSize;
+  if(dataSize > m_iMaxDataSize)
     return 100;
-  if(m_iDataSize == 0)
+  if(dataSize <= 0)
     return 0;
 
   if(IsDataBased())
-    return min(100, 100 * m_iDataSize / m_iMaxDataSize);
+    return min(100, 100 * dataSize / m_iMaxDataSize);
 
   return min(100, MathUtils::round_int(100.0 * m_TimeSize * (m_TimeFront - m_TimeBack) / DVD_TIME_BASE ));
 }
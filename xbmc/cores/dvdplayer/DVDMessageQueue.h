@@ -105,7 +105,7 @@ public:
     return Get(pMsg, iTimeoutInMilliSeconds, priority);
   }
 
-  int GetDataSize() const               { return m_iDataSize; }
+  int GetDataSize() const               { return (int)m_iDataSize; }
   int GetTimeSize() const;
   unsigned GetPacketCount(CDVDMsg::Message type);
   bool ReceivedAbortRequest()           { return m_bAbortRequest; }
@@ -124,14 +124,29 @@ public:
 
 private:
 
+  /*! \brief Try to take the next message with at least the given priority, without waiting
+   Must be called with m_consumer held.
+   */
+  bool TryGet(CDVDMsg** pMsg, int &priority);
+  /*! \brief Pop the oldest priority 0 message from the ring or the overflow list
+   Must be called with m_consumer held.
+   */
+  CDVDMsg* PopNormal();
+  /*! \brief Append a priority 0 message to the ring, false if it is full
+   Must be called with m_producer held.
+   */
+  bool RingPush(CDVDMsg* pMsg);
+
   CEvent m_hEvent;
-  mutable CCriticalSection m_section;
+  mutable CCriticalSection m_section;   ///< protects m_list and m_overflow
+  CCriticalSection m_producer;          ///< serializes writers of the ring
+  mutable CCriticalSection m_consumer;  ///< serializes readers of the ring
 
   bool m_bAbortRequest;
   bool m_bInitialized;
   bool m_bCaching;
 
-  int m_iDataSize;
+  volatile long m_iDataSize;
   double m_TimeFront;
   double m_TimeBack;
   double m_TimeSize;
@@ -140,6 +155,19 @@ private:
   bool m_bEmptied;
   std::string m_owner;
 
+  /* priority 0 messages (demuxer packets and the control messages interleaved with
+     them) go through a single producer / single consumer ring, so the demuxer and the
+     decoder never contend on a lock. Only other priorities use the sorted list. */
+  static const unsigned long RingSize = 4096;
+  CDVDMsg**     m_ring;
+  volatile long m_head;           ///< next slot written by the producer
+  volatile long m_tail;           ///< next slot read by the consumer
+  volatile long m_iPackets;       ///< demuxer packets in the ring and overflow list
+  volatile long m_overflowCount;
+  volatile long m_listCount;
+  volatile long m_waiting;        ///< consumer is about to wait on m_hEvent
+  std::list<CDVDMsg*> m_overflow; ///< priority 0 messages put while the ring was full
+
   typedef std::list<DVDMessageListItem> SList;
   SList m_list;
 };
@@ -0,0 +1,205 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "cores/dvdplayer/DVDMessageQueue.h"
+#include "cores/dvdplayer/DVDDemuxers/DVDDemuxUtils.h"
+#include "cores/dvdplayer/DVDClock.h"
+#include "threads/SystemClock.h"
+#include "threads/Thread.h"
+
+#include "gtest/gtest.h"
+
+#include <iostream>
+
+static CDVDMsg* CreatePacket(int size, double dts)
+{
+  DemuxPacket* packet = CDVDDemuxUtils::AllocateDemuxPacket(0);
+  packet->iSize = size;
+  packet->dts   = dts;
+  return new CDVDMsgDemuxerPacket(packet);
+}
+
+static double GetPacketDts(CDVDMsg* msg)
+{
+  return ((CDVDMsgDemuxerPacket*)msg)->GetPacket()->dts;
+}
+
+class CPacketProducer : public IRunnable
+{
+public:
+  CPacketProducer(CDVDMessageQueue &queue, int count) : m_queue(queue), m_count(count) {}
+
+  virtual void Run()
+  {
+    for (int i = 0; i < m_count; i++)
+    {
+      // keep the queue bounded like the demuxer does
+      while (m_queue.GetDataSize() > 1024 * 1024)
+        XbmcThreads::ThreadSleep(0);
+      m_queue.Put(CreatePacket(100, i));
+    }
+    m_queue.Put(new CDVDMsg(CDVDMsg::GENERAL_EOF));
+  }
+
+private:
+  CDVDMessageQueue &m_queue;
+  int m_count;
+};
+
+TEST(TestDVDMessageQueue, PriorityOrder)
+{
+  CDVDMessageQueue queue("test");
+  queue.Init();
+
+  queue.Put(CreatePacket(10, 1 * DVD_TIME_BASE));
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_RESYNC));
+  queue.Put(CreatePacket(20, 2 * DVD_TIME_BASE));
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_FLUSH), 1);
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_EOF), -1);
+
+  EXPECT_EQ(30, queue.GetDataSize());
+  EXPECT_EQ(2U, queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+  EXPECT_EQ(1U, queue.GetPacketCount(CDVDMsg::GENERAL_RESYNC));
+
+  CDVDMsg* msg;
+  int priority = 1;
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0, priority));
+  EXPECT_TRUE(msg->IsType(CDVDMsg::GENERAL_FLUSH));
+  EXPECT_EQ(1, priority);
+  msg->Release();
+
+  priority = 1;
+  EXPECT_EQ(MSGQ_TIMEOUT, queue.Get(&msg, 0, priority));
+
+  // priority 0 messages keep the order they were put in
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+  EXPECT_TRUE(msg->IsType(CDVDMsg::DEMUXER_PACKET));
+  msg->Release();
+  EXPECT_EQ(20, queue.GetDataSize());
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+  EXPECT_TRUE(msg->IsType(CDVDMsg::GENERAL_RESYNC));
+  msg->Release();
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+  EXPECT_TRUE(msg->IsType(CDVDMsg::DEMUXER_PACKET));
+  msg->Release();
+  EXPECT_EQ(0, queue.GetDataSize());
+
+  priority = -1;
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0, priority));
+  EXPECT_TRUE(msg->IsType(CDVDMsg::GENERAL_EOF));
+  msg->Release();
+
+  EXPECT_EQ(MSGQ_TIMEOUT, queue.Get(&msg, 0));
+  queue.End();
+}
+
+TEST(TestDVDMessageQueue, Flush)
+{
+  CDVDMessageQueue queue("test");
+  queue.Init();
+
+  queue.Put(CreatePacket(10, 1 * DVD_TIME_BASE));
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_RESYNC));
+  queue.Put(CreatePacket(10, 2 * DVD_TIME_BASE));
+  queue.Put(new CDVDMsg(CDVDMsg::PLAYER_STARTED));
+
+  queue.Flush(CDVDMsg::PLAYER_STARTED);
+  EXPECT_EQ(0U, queue.GetPacketCount(CDVDMsg::PLAYER_STARTED));
+  EXPECT_EQ(2U, queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+
+  queue.Flush();
+  EXPECT_EQ(0U, queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+  EXPECT_EQ(0, queue.GetDataSize());
+  EXPECT_EQ(0, queue.GetLevel());
+
+  CDVDMsg* msg;
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+  EXPECT_TRUE(msg->IsType(CDVDMsg::GENERAL_RESYNC));
+  msg->Release();
+  EXPECT_EQ(MSGQ_TIMEOUT, queue.Get(&msg, 0));
+  queue.End();
+}
+
+TEST(TestDVDMessageQueue, Overflow)
+{
+  CDVDMessageQueue queue("test");
+  queue.Init();
+
+  // more than the ring holds, the rest has to wait in the overflow list
+  const int count = 10000;
+  for (int i = 0; i < count; i++)
+    queue.Put(CreatePacket(1, i));
+  EXPECT_EQ(count, queue.GetDataSize());
+  EXPECT_EQ((unsigned)count, queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+
+  for (int i = 0; i < count; i++)
+  {
+    CDVDMsg* msg;
+    ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+    ASSERT_EQ(i, GetPacketDts(msg));
+    msg->Release();
+    if (i == count / 2)
+      queue.Put(CreatePacket(1, count));
+  }
+
+  CDVDMsg* msg;
+  ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 0));
+  EXPECT_EQ(count, GetPacketDts(msg));
+  msg->Release();
+  EXPECT_EQ(0, queue.GetDataSize());
+  queue.End();
+}
+
+TEST(TestDVDMessageQueue, Throughput)
+{
+  CDVDMessageQueue queue("test");
+  queue.Init();
+
+  const int count = 200000;
+  CPacketProducer producer(queue, count);
+  CThread thread(&producer, "TestDVDMessageQueue");
+
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  thread.Create();
+
+  int received = 0;
+  while (true)
+  {
+    CDVDMsg* msg;
+    ASSERT_EQ(MSGQ_OK, queue.Get(&msg, 5000));
+    if (msg->IsType(CDVDMsg::GENERAL_EOF))
+    {
+      msg->Release();
+      break;
+    }
+    ASSERT_EQ(received, GetPacketDts(msg));
+    msg->Release();
+    received++;
+  }
+  unsigned int elapsed = XbmcThreads::SystemClockMillis() - start;
+  thread.WaitForThreadExit((unsigned int)-1);
+
+  EXPECT_EQ(count, received);
+  EXPECT_EQ(0, queue.GetDataSize());
+  std::cout << "CDVDMessageQueue: " << (uint64_t)count * 1000 / std::max(1U, elapsed)
+            << " packets/s" << std::endl;
+  queue.End();
+}
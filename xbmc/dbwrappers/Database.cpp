@@ -28,6 +28,7 @@
 #include "utils/log.h"
 #include "utils/SortUtils.h"
 #include "utils/URIUtils.h"
+#include "threads/SystemClock.h"
 #include "sqlitedataset.h"
 #include "DatabaseManager.h"
 #include "DbUrl.h"
@@ -41,6 +42,69 @@ using namespace dbiplus;
 
 #define MAX_COMPRESS_COUNT 20
 
+CDatabase::Params &CDatabase::Params::Add(int value)
+{
+  return Add((int64_t)value);
+}
+
+CDatabase::Params &CDatabase::Params::Add(int64_t value)
+{
+  Param param;
+  param.type = TypeInt64;
+  param.number = value;
+  m_params.push_back(param);
+  return *this;
+}
+
+CDatabase::Params &CDatabase::Params::Add(const std::string &value)
+{
+  Param param;
+  param.type = TypeString;
+  param.number = 0;
+  param.text = value;
+  m_params.push_back(param);
+  return *this;
+}
+
+CDatabase::Params &CDatabase::Params::AddNull()
+{
+  Param param;
+  param.type = TypeNull;
+  param.number = 0;
+  m_params.push_back(param);
+  return *this;
+}
+
+void CDatabase::Params::Bind(Dataset *ds) const
+{
+  for (unsigned int i = 0; i < m_params.size(); i++)
+  {
+    if (m_params[i].type == TypeInt64)
+      ds->bind_int64(i + 1, m_params[i].number);
+    else if (m_params[i].type == TypeString)
+      ds->bind_string(i + 1, m_params[i].text);
+    else
+      ds->bind_null(i + 1);
+  }
+}
+
+std::string CDatabase::Params::ToString() const
+{
+  CStdString ret;
+  for (unsigned int i = 0; i < m_params.size(); i++)
+  {
+    if (i)
+      ret += ", ";
+    if (m_params[i].type == TypeInt64)
+      ret.AppendFormat("%"PRId64, m_params[i].number);
+    else if (m_params[i].type == TypeString)
+      ret += "'" + m_params[i].text + "'";
+    else
+      ret += "NULL";
+  }
+  return ret;
+}
+
 void CDatabase::Filter::AppendField(const std::string &strField)
 {
   if (strField.empty())
@@ -105,6 +169,12 @@ CDatabase::CDatabase(void)
   m_openCount = 0;
   m_sqlite = true;
   m_bMultiWrite = false;
+  m_batch = false;
+  m_batchItems = 0;
+  m_batchDepth = 0;
+  m_batchMaxItems = 0;
+  m_batchMaxTime = 0;
+  m_batchStart = 0;
 }
 
 CDatabase::~CDatabase(void)
@@ -244,6 +314,46 @@ bool CDatabase::ExecuteQuery(const CStdString &strQuery)
   return bReturn;
 }
 
+bool CDatabase::ExecutePreparedQuery(const std::string &sql, const Params &params)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+    m_pDS->prepare_statement(sql);
+    params.Bind(m_pDS.get());
+    m_pDS->exec_prepared();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s - failed to execute query '%s' (%s)",
+        __FUNCTION__, sql.c_str(), params.ToString().c_str());
+  }
+  return false;
+}
+
+std::string CDatabase::GetSinglePreparedValue(const std::string &sql, const Params &params)
+{
+  std::string ret;
+  try
+  {
+    if (NULL == m_pDB.get()) return ret;
+    if (NULL == m_pDS.get()) return ret;
+    m_pDS->prepare_statement(sql);
+    params.Bind(m_pDS.get());
+    if (m_pDS->query_prepared() && m_pDS->next_row())
+      ret = m_pDS->column_string(0);
+    m_pDS->close();
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s - failed on query '%s' (%s)",
+        __FUNCTION__, sql.c_str(), params.ToString().c_str());
+  }
+  return ret;
+}
+
 bool CDatabase::ResultQuery(const CStdString &strQuery)
 {
   bool bReturn = false;
@@ -294,11 +404,21 @@ bool CDatabase::CommitInsertQueries()
     try
     {
       m_bMultiWrite = false;
+      // don't let the queue commit a pending batch behind our back, but keep it atomic
+      m_pDS2->set_autocommit(!m_batch);
+      if (m_batch)
+        m_pDB->savepoint("batchqueue");
       m_pDS2->post();
+      if (m_batch)
+        m_pDB->release_savepoint("batchqueue");
+      m_pDS2->set_autocommit(true);
       m_pDS2->clear_insert_sql();
     }
     catch(...)
     {
+      if (m_batch)
+        RollbackSavepoint("batchqueue");
+      m_pDS2->set_autocommit(true);
       bReturn = false;
       CLog::Log(LOGERROR, "%s - failed to execute queries",
           __FUNCTION__);
@@ -577,7 +697,21 @@ void CDatabase::Close()
   m_openCount = 0;
 
   if (NULL == m_pDB.get() ) return ;
+  if (m_batch)
+  { // commit whatever is still pending, we may be called from our destructor so stay non-virtual
+    CommitInsertQueries();
+    m_batch = false;
+    m_batchDepth = 0;
+    CDatabase::CommitTransaction();
+  }
   if (NULL != m_pDS.get()) m_pDS->close();
+  if (NULL != m_pDS2.get()) m_pDS2->close();
+
+  unsigned int hits, misses;
+  m_pDB->get_statement_stats(hits, misses);
+  if (hits + misses > 0)
+    CLog::Log(LOGDEBUG, "%s - %s statement cache: %u hits, %u misses", __FUNCTION__, m_pDB->getDatabase(), hits, misses);
+
   m_pDB->disconnect();
   m_pDB.reset();
   m_pDS.reset();
@@ -627,6 +761,24 @@ void CDatabase::Interupt()
 
 void CDatabase::BeginTransaction()
 {
+  if (m_batch)
+  {
+    // nest the transaction within the batch, so that it can be rolled back on its own
+    if (m_batchDepth == 0 && BatchDue())
+      CommitBatch();
+
+    try
+    {
+      m_pDB->savepoint(BatchSavepoint(m_batchDepth + 1).c_str());
+      m_batchDepth++;
+    }
+    catch (...)
+    {
+      CLog::Log(LOGERROR, "database:begintransaction failed to open savepoint");
+    }
+    return;
+  }
+
   try
   {
     if (NULL != m_pDB.get())
@@ -640,6 +792,28 @@ void CDatabase::BeginTransaction()
 
 bool CDatabase::CommitTransaction()
 {
+  if (m_batch)
+  {
+    bool ret = true;
+    if (m_batchDepth > 0)
+    {
+      try
+      {
+        m_pDB->release_savepoint(BatchSavepoint(m_batchDepth).c_str());
+      }
+      catch (...)
+      {
+        CLog::Log(LOGERROR, "database:committransaction failed to release savepoint");
+        ret = false;
+      }
+      m_batchDepth--;
+    }
+    // the writes are consistent again, so commit them if the batch has been open for long enough
+    if (m_batchDepth == 0 && BatchDue())
+      ret = CommitBatch() && ret;
+    return ret;
+  }
+
   try
   {
     if (NULL != m_pDB.get())
@@ -655,6 +829,19 @@ bool CDatabase::CommitTransaction()
 
 void CDatabase::RollbackTransaction()
 {
+  if (m_batch)
+  {
+    // writes made outside of a transaction would have been committed already without the batch
+    if (m_batchDepth == 0)
+    {
+      CLog::Log(LOGDEBUG, "%s - no transaction open within the batch, nothing to roll back", __FUNCTION__);
+      return;
+    }
+    RollbackSavepoint(BatchSavepoint(m_batchDepth));
+    m_batchDepth--;
+    return;
+  }
+
   try
   {
     if (NULL != m_pDB.get())
@@ -668,10 +855,138 @@ void CDatabase::RollbackTransaction()
 
 bool CDatabase::InTransaction()
 {
-  if (NULL != m_pDB.get()) return false;
+  if (NULL == m_pDB.get()) return false;
   return m_pDB->in_transaction();
 }
 
+void CDatabase::BeginBatch(unsigned int maxItems /* = 100 */, unsigned int maxTime /* = 2000 */)
+{
+  if (m_batch || NULL == m_pDB.get())
+    return;
+
+  // commit anything that was started outside of the batch
+  CommitInsertQueries();
+  if (m_pDB->in_transaction())
+    CommitTransaction();
+
+  m_batchMaxItems = maxItems;
+  m_batchMaxTime = maxTime;
+  m_batchItems = 0;
+  m_batchDepth = 0;
+  m_batchStart = XbmcThreads::SystemClockMillis();
+  m_batch = true;
+
+  try
+  {
+    // deferred, so the write lock is only taken once something is written
+    m_pDB->start_deferred_transaction();
+    // transactions within the batch are savepoints, without them they couldn't be rolled back
+    m_pDB->savepoint("batchcheck");
+    m_pDB->release_savepoint("batchcheck");
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s - failed to start batch, writes won't be batched", __FUNCTION__);
+    m_batch = false;
+    try
+    {
+      if (m_pDB->in_transaction())
+        m_pDB->rollback_transaction(); // nothing has been written yet
+    }
+    catch (...)
+    {
+    }
+  }
+}
+
+bool CDatabase::BatchItemsAdded(unsigned int items /* = 1 */)
+{
+  if (!m_batch)
+    return true;
+
+  if (m_batchDepth > 0)
+  {
+    CLog::Log(LOGWARNING, "%s - %u transactions left open within the batch", __FUNCTION__, m_batchDepth);
+    m_batchDepth = 0; // released by the commit
+  }
+
+  m_batchItems += items;
+  if (m_batchItems < m_batchMaxItems && !BatchDue())
+    return true;
+
+  return CommitBatch();
+}
+
+bool CDatabase::CommitPendingBatch()
+{
+  if (!m_batch || m_batchDepth > 0)
+    return true;
+
+  return CommitBatch();
+}
+
+bool CDatabase::BatchDue() const
+{
+  return XbmcThreads::SystemClockMillis() - m_batchStart >= m_batchMaxTime;
+}
+
+CStdString CDatabase::BatchSavepoint(unsigned int depth)
+{
+  CStdString name;
+  name.Format("batch%u", depth);
+  return name;
+}
+
+void CDatabase::RollbackSavepoint(const CStdString &name)
+{
+  try
+  {
+    m_pDB->rollback_to_savepoint(name.c_str());
+    m_pDB->release_savepoint(name.c_str());
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s - failed to roll back to %s", __FUNCTION__, name.c_str());
+  }
+}
+
+bool CDatabase::CommitBatch()
+{
+  if (NULL == m_pDB.get())
+    return false;
+
+  bool ret = CommitInsertQueries();
+  try
+  {
+    unsigned int start = XbmcThreads::SystemClockMillis();
+    m_pDB->commit_transaction();
+    CLog::Log(LOGDEBUG, "%s - committed %u items in %u ms (batch open for %u ms)", __FUNCTION__,
+              m_batchItems, XbmcThreads::SystemClockMillis() - start, start - m_batchStart);
+    m_batchItems = 0;
+    m_batchStart = XbmcThreads::SystemClockMillis();
+    m_pDB->start_deferred_transaction();
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s - failed to commit batch", __FUNCTION__);
+    ret = false;
+  }
+  return ret;
+}
+
+bool CDatabase::EndBatch()
+{
+  if (!m_batch)
+    return true;
+
+  bool ret = CommitInsertQueries();
+  m_batch = false;
+  m_batchItems = 0;
+  m_batchDepth = 0; // any savepoints left open are released by the commit
+  // the batch transaction is still open, hand it to the (possibly overridden) commit
+  return CommitTransaction() && ret;
+}
+
 bool CDatabase::CreateTables()
 {
 
@@ -28,6 +28,8 @@ namespace dbiplus {
 }
 
 #include <memory>
+#include <stdint.h>
+#include <vector>
 
 class DatabaseSettings; // forward
 class CDbUrl;
@@ -57,6 +59,31 @@ public:
     std::string limit;
   };
 
+  /*! \brief Values bound to the '?' placeholders of a prepared statement, in order
+   \sa ExecutePreparedQuery, GetSinglePreparedValue
+   */
+  class Params
+  {
+  public:
+    Params &Add(int value);
+    Params &Add(int64_t value);
+    Params &Add(const std::string &value);
+    Params &AddNull();
+
+    void Bind(dbiplus::Dataset *ds) const;
+    std::string ToString() const;
+
+  private:
+    enum Type { TypeNull, TypeInt, TypeInt64, TypeString };
+    struct Param
+    {
+      Type type;
+      int64_t number;
+      std::string text;
+    };
+    std::vector<Param> m_params;
+  };
+
   CDatabase(void);
   virtual ~CDatabase(void);
   bool IsOpen();
@@ -71,6 +98,43 @@ public:
   void RollbackTransaction();
   bool InTransaction();
 
+  /*! \brief Group subsequent writes into larger transactions.
+   While a batch is active the database stays inside a single transaction which is
+   committed, together with any queued insert queries, once maxItems items have been
+   reported through BatchItemsAdded() or maxTime ms have passed since the last commit.
+   The time limit is also checked whenever a transaction begins or commits outside of
+   any other. Begin/CommitTransaction() calls made while batching open and release a
+   savepoint within the batch, so RollbackTransaction() only discards the writes made
+   since the matching BeginTransaction(). Backends without savepoints aren't batched.
+   \param maxItems number of items after which the batch is committed.
+   \param maxTime time in ms after which the batch is committed.
+   \sa BatchItemsAdded, CommitPendingBatch, EndBatch
+   */
+  void BeginBatch(unsigned int maxItems = 100, unsigned int maxTime = 2000);
+
+  /*! \brief Report items written as part of the current batch.
+   Commits the batch if one of its thresholds has been reached, so should only be called
+   once the database is in a consistent state. Does nothing if no batch is active.
+   \param items the number of items written since the last call.
+   \return false if the batch failed to commit, true otherwise.
+   */
+  bool BatchItemsAdded(unsigned int items = 1);
+
+  /*! \brief Commit the writes pending in the current batch regardless of its thresholds.
+   To be called before lengthy work that doesn't touch the database, such as online lookups,
+   so other connections aren't locked out of writing meanwhile. Does nothing if no batch is
+   active or a transaction is open within it.
+   \return false if the batch failed to commit, true otherwise.
+   */
+  bool CommitPendingBatch();
+
+  /*! \brief Commit all pending batched writes and return to per-call transactions.
+   \return true if the pending writes were committed, false otherwise.
+   \sa BeginBatch
+   */
+  bool EndBatch();
+  bool InBatch() const { return m_batch; };
+
   static CStdString FormatSQL(CStdString strStmt, ...);
   CStdString PrepareSQL(CStdString strStmt, ...) const;
 
@@ -109,6 +173,23 @@ public:
    */
   bool ExecuteQuery(const CStdString &strQuery);
 
+  /*!
+   * @brief Execute a statement that does not return any result through the prepared statement cache.
+   * @remarks The statement text is compiled once per connection, so it must not contain any values.
+   * @param sql The statement with '?' placeholders for its values.
+   * @param params The values of the placeholders.
+   * @return True if the statement was executed successfully, false otherwise.
+   */
+  bool ExecutePreparedQuery(const std::string &sql, const Params &params);
+
+  /*!
+   * @brief Get a single value through the prepared statement cache.
+   * @param sql The query with '?' placeholders for its values.
+   * @param params The values of the placeholders.
+   * @return The first column of the first row, empty if there is none or the query failed.
+   */
+  std::string GetSinglePreparedValue(const std::string &sql, const Params &params);
+
   /*!
    * @brief Execute a query that returns a result.
    * @remarks Call m_pDS->close(); to clean up the dataset when done.
@@ -170,7 +251,18 @@ private:
   void InitSettings(DatabaseSettings &dbSettings);
   bool Connect(const CStdString &dbName, const DatabaseSettings &db, bool create);
   bool UpdateVersionNumber();
+  bool CommitBatch();
+  bool BatchDue() const;
+  static CStdString BatchSavepoint(unsigned int depth);
+  void RollbackSavepoint(const CStdString &name);
 
   bool m_bMultiWrite; /*!< True if there are any queries in the queue, false otherwise */
   unsigned int m_openCount;
+
+  bool m_batch;                 /*!< True while writes are grouped into batched transactions */
+  unsigned int m_batchItems;    /*!< Items written since the last batch commit */
+  unsigned int m_batchDepth;    /*!< Transactions open within the batch, each one a savepoint */
+  unsigned int m_batchMaxItems;
+  unsigned int m_batchMaxTime;
+  unsigned int m_batchStart;    /*!< Time of the last batch commit */
 };
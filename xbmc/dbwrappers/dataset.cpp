@@ -75,6 +75,18 @@ string Database::prepare(const char *format, ...)
   return result;
 }
 
+void Database::savepoint(const char *name) {
+  throw DbErrors("Savepoints are not supported");
+}
+
+void Database::release_savepoint(const char *name) {
+  throw DbErrors("Savepoints are not supported");
+}
+
+void Database::rollback_to_savepoint(const char *name) {
+  throw DbErrors("Savepoints are not supported");
+}
+
 //************* Dataset implementation ***************
 
 Dataset::Dataset() {
@@ -84,6 +96,7 @@ Dataset::Dataset() {
   frecno = 0;
   fbof = feof = true;
   autocommit = true;
+  cursor = cursor_started = false;
 
   select_sql = "";
 
@@ -101,6 +114,7 @@ Dataset::Dataset(Database *newDb) {
   frecno = 0;
   fbof = feof = true;
   autocommit = true;
+  cursor = cursor_started = false;
 
   select_sql = "";
 
@@ -198,6 +212,132 @@ void Dataset::close(void) {
   frecno = 0;
   fbof = feof = true;
   active = false;
+  cursor = cursor_started = false;
+}
+
+
+bool Dataset::query_cursor(const std::string &sql) {
+  if (!query(sql.c_str()))
+    return false;
+  cursor = true;
+  cursor_started = false;
+  return true;
+}
+
+
+bool Dataset::next_row() {
+  if (!cursor)
+    return false;
+  if (cursor_started)
+    next();
+  cursor_started = true;
+  return !eof();
+}
+
+
+bool Dataset::column_isnull(int index) {
+  return get_field_value(index).get_isNull();
+}
+
+
+int Dataset::column_int(int index) {
+  return get_field_value(index).get_asInt();
+}
+
+
+int64_t Dataset::column_int64(int index) {
+  return get_field_value(index).get_asInt64();
+}
+
+
+double Dataset::column_double(int index) {
+  return get_field_value(index).get_asDouble();
+}
+
+
+string Dataset::column_string(int index) {
+  return get_field_value(index).get_asString();
+}
+
+
+void Dataset::prepare_statement(const std::string &sql) {
+  prepared_sql = sql;
+  prepared_params.clear();
+}
+
+
+void Dataset::set_param(int index, const field_value &value) {
+  if (index < 1)
+    throw DbErrors("Parameter index out of range: %d", index);
+  if (prepared_params.size() < (unsigned int)index)
+    prepared_params.resize(index);
+  prepared_params[index-1] = value;
+}
+
+
+void Dataset::bind_null(int index) {
+  field_value v;
+  v.set_isNull();
+  set_param(index, v);
+}
+
+
+void Dataset::bind_int(int index, int value) {
+  set_param(index, field_value(value));
+}
+
+
+void Dataset::bind_int64(int index, int64_t value) {
+  set_param(index, field_value(value));
+}
+
+
+void Dataset::bind_double(int index, double value) {
+  set_param(index, field_value(value));
+}
+
+
+void Dataset::bind_string(int index, const std::string &value) {
+  set_param(index, field_value(value.c_str()));
+}
+
+
+string Dataset::build_prepared_sql() {
+  if (db == NULL) throw DbErrors("No Database Connection");
+
+  string query;
+  query.reserve(prepared_sql.size());
+  unsigned int param = 0;
+  bool quoted = false;
+  for (string::const_iterator i = prepared_sql.begin(); i != prepared_sql.end(); ++i)
+  {
+    if (*i == '\'')
+      quoted = !quoted;
+    if (*i != '?' || quoted)
+    {
+      query += *i;
+      continue;
+    }
+
+    if (param >= prepared_params.size() || prepared_params[param].get_isNull())
+      query += "NULL";
+    else if (prepared_params[param].get_fType() == ft_String)
+      query += db->prepare("'%s'", prepared_params[param].get_asString().c_str());
+    else
+      query += prepared_params[param].get_asString();
+    param++;
+  }
+  return query;
+}
+
+
+int Dataset::exec_prepared() {
+  return exec(build_prepared_sql());
+}
+
+
+bool Dataset::query_prepared() {
+  return query_cursor(build_prepared_sql());
 }
 
 
@@ -134,6 +134,13 @@ public:
   virtual void start_transaction() {};
   virtual void commit_transaction() {};
   virtual void rollback_transaction() {};
+/* start a transaction that only takes the write lock once it writes, if the backend can */
+  virtual void start_deferred_transaction() { start_transaction(); };
+
+/* virtual methods for savepoints, which nest within a transaction. Backends without them throw. */
+  virtual void savepoint(const char *name);
+  virtual void release_savepoint(const char *name);
+  virtual void rollback_to_savepoint(const char *name);
 
 /* virtual methods for formatting */
 
@@ -153,6 +160,9 @@ public:
 
   virtual bool in_transaction() {return false;};
 
+/* statistics of the prepared statement cache (if the backend has one) */
+  virtual void get_statement_stats(unsigned int &hits, unsigned int &misses) { hits = misses = 0; }
+
 };
 
 
@@ -199,6 +209,17 @@ protected:
   ParamList plist;              // Paramlist for locate
   bool fbof, feof;
   bool autocommit;		// for transactions
+  bool cursor;			// opened with query_cursor()
+  bool cursor_started;		// next_row() has been called on the cursor
+
+/* statement and parameters set up by prepare_statement() and bind_*() */
+  std::string prepared_sql;
+  std::vector<field_value> prepared_params;
+
+/* Sets a parameter of the prepared statement (index starting with 1) */
+  void set_param(int index, const field_value &value);
+/* Substitutes the bound parameters into the prepared statement */
+  std::string build_prepared_sql();
 
 
 /* Variables to store SQL statements */
@@ -296,6 +317,36 @@ public:
   virtual const void* getExecRes()=0;
 /* as open, but with our query exept Sql */
   virtual bool query(const char *sql) = 0;
+/* Open SQL query as a forward-only cursor. Rows are not read up front: step through
+   them with next_row(), and read the current row with the column_*() functions or
+   get_sql_record(). num_rows(), seek() and the other navigation functions are not
+   available on a cursor. The default implementation falls back to query(). */
+  virtual bool query_cursor(const std::string &sql);
+/* Step the cursor to the next (or first) row. Returns false once all rows are read */
+  virtual bool next_row();
+/* Check whether the dataset was opened with query_cursor() */
+  bool is_cursor() const { return cursor; }
+/* Typed access to a column of the current cursor row */
+  virtual bool column_isnull(int index);
+  virtual int column_int(int index);
+  virtual int64_t column_int64(int index);
+  virtual double column_double(int index);
+  virtual std::string column_string(int index);
+/* Prepare a statement with '?' placeholders for its parameters. Backends that support
+   it compile the statement once and keep it in a per-connection cache, so repeating
+   the same statement text skips parsing and planning. Bind the parameters with
+   bind_*() (index starting with 1), then run it with exec_prepared() or query_prepared().
+   The default implementation substitutes the parameters into the statement text. */
+  virtual void prepare_statement(const std::string &sql);
+  virtual void bind_null(int index);
+  virtual void bind_int(int index, int value);
+  virtual void bind_int64(int index, int64_t value);
+  virtual void bind_double(int index, double value);
+  virtual void bind_string(int index, const std::string &value);
+/* Run a prepared statement that returns no rows */
+  virtual int exec_prepared();
+/* Run a prepared select as a forward-only cursor (see query_cursor()) */
+  virtual bool query_prepared();
 /* Close SQL Query*/
   virtual void close();
 /* This function looks for field Field_name with value equal Field_value
@@ -390,7 +441,7 @@ public:
 
 /* --------------- for fast access ---------------- */
   const result_set& get_result_set() { return result; }
-  const sql_record* const get_sql_record();
+  virtual const sql_record* const get_sql_record();
 
  private:
   void set_ds_state(dsStates new_state) {ds_state = new_state;};	
@@ -387,6 +387,37 @@ void MysqlDatabase::rollback_transaction() {
   }
 }
 
+void MysqlDatabase::start_deferred_transaction() {
+  if (active)
+  {
+    // the connection commits each statement by itself, so savepoints need an explicit transaction
+    if (setErr(query_with_reconnect("START TRANSACTION"), "START TRANSACTION") != MYSQL_OK)
+      throw DbErrors(getErrorMsg());
+    CLog::Log(LOGDEBUG,"Mysql start deferred transaction");
+    _in_transaction = true;
+  }
+}
+
+void MysqlDatabase::savepoint(const char *name) {
+  exec_savepoint("SAVEPOINT", name);
+}
+
+void MysqlDatabase::release_savepoint(const char *name) {
+  exec_savepoint("RELEASE SAVEPOINT", name);
+}
+
+void MysqlDatabase::rollback_to_savepoint(const char *name) {
+  exec_savepoint("ROLLBACK TO SAVEPOINT", name);
+}
+
+void MysqlDatabase::exec_savepoint(const char *command, const char *name) {
+  if (!active) throw DbErrors("No Database Connection");
+
+  string sql = string(command) + " " + name;
+  if (setErr(query_with_reconnect(sql.c_str()), sql.c_str()) != MYSQL_OK)
+    throw DbErrors(getErrorMsg());
+}
+
 bool MysqlDatabase::exists(void) {
   bool ret = false;
 
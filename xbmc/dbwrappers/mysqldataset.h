@@ -76,6 +76,11 @@ public:
   virtual void start_transaction();
   virtual void commit_transaction();
   virtual void rollback_transaction();
+  virtual void start_deferred_transaction();
+
+  virtual void savepoint(const char *name);
+  virtual void release_savepoint(const char *name);
+  virtual void rollback_to_savepoint(const char *name);
 
 /* virtual methods for formatting */
   virtual std::string vprepare(const char *format, va_list args);
@@ -84,6 +89,8 @@ public:
   int query_with_reconnect(const char* query);
 
 private:
+/* runs a savepoint command, throwing on failure */
+  void exec_savepoint(const char *command, const char *name);
 
   typedef struct StrAccum StrAccum;
 
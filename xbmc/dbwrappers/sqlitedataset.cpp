@@ -79,6 +79,30 @@ int callback(void* res_ptr,int ncol, char** reslt,char** cols)
   return 0;  
 }
 
+static void get_column_value(sqlite3_stmt *stmt, int i, field_value &v)
+{
+  switch (sqlite3_column_type(stmt, i))
+  {
+  case SQLITE_INTEGER:
+    v.set_asInt64(sqlite3_column_int64(stmt, i));
+    break;
+  case SQLITE_FLOAT:
+    v.set_asDouble(sqlite3_column_double(stmt, i));
+    break;
+  case SQLITE_TEXT:
+    v.set_asString((const char *)sqlite3_column_text(stmt, i));
+    break;
+  case SQLITE_BLOB:
+    v.set_asString((const char *)sqlite3_column_text(stmt, i));
+    break;
+  case SQLITE_NULL:
+  default:
+    v.set_asString("");
+    v.set_isNull();
+    break;
+  }
+}
+
 static int busy_callback(void*, int busyCount)
 {
 	Sleep(100);
@@ -92,6 +116,7 @@ SqliteDatabase::SqliteDatabase() {
 
   active = false;	
   _in_transaction = false;		// for transaction
+  stmt_hits = stmt_misses = 0;
 
   error = "Unknown database error";//S_NO_CONNECTION;
   host = "localhost";
@@ -259,6 +284,7 @@ bool SqliteDatabase::exists(void)
 
 void SqliteDatabase::disconnect(void) {
   if (active == false) return;
+  clear_statements();
   sqlite3_close(conn);
   active = false;
 }
@@ -371,6 +397,97 @@ void SqliteDatabase::rollback_transaction() {
   }  
 }
 
+void SqliteDatabase::start_deferred_transaction() {
+  if (active) {
+    sqlite3_exec(conn,"begin",NULL,NULL,NULL);
+    _in_transaction = true;
+  }
+}
+
+void SqliteDatabase::savepoint(const char *name) {
+  exec_savepoint("savepoint", name);
+}
+
+void SqliteDatabase::release_savepoint(const char *name) {
+  exec_savepoint("release savepoint", name);
+}
+
+void SqliteDatabase::rollback_to_savepoint(const char *name) {
+  exec_savepoint("rollback to savepoint", name);
+}
+
+void SqliteDatabase::exec_savepoint(const char *command, const char *name) {
+  if (!active) throw DbErrors("No Database Connection");
+
+  string sql = string(command) + " " + name;
+  if (setErr(sqlite3_exec(conn,sql.c_str(),NULL,NULL,NULL),sql.c_str()) != SQLITE_OK)
+    throw DbErrors(getErrorMsg());
+}
+
+
+// prepared statement cache
+// ---------------------------------------------
+sqlite3_stmt *SqliteDatabase::acquire_statement(const string &sql) {
+  if (!active) throw DbErrors("No Database Connection");
+
+  map<string, StatementCache::iterator>::iterator i = stmt_index.find(sql);
+  if (i != stmt_index.end())
+  {
+    sqlite3_stmt *stmt = i->second->second;
+    stmt_cache.erase(i->second);
+    stmt_index.erase(i);
+    stmt_hits++;
+    return stmt;
+  }
+
+  stmt_misses++;
+  sqlite3_stmt *stmt = NULL;
+  if (setErr(sqlite3_prepare_v2(conn, sql.c_str(), -1, &stmt, NULL), sql.c_str()) != SQLITE_OK)
+  {
+    sqlite3_finalize(stmt);
+    throw DbErrors(getErrorMsg());
+  }
+  return stmt;
+}
+
+void SqliteDatabase::release_statement(const string &sql, sqlite3_stmt *stmt) {
+  if (!stmt)
+    return;
+
+  sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
+
+  // we already have a copy of this one (it was in use twice)
+  if (!active || stmt_index.find(sql) != stmt_index.end())
+  {
+    sqlite3_finalize(stmt);
+    return;
+  }
+
+  stmt_cache.push_front(make_pair(sql, stmt));
+  stmt_index[sql] = stmt_cache.begin();
+
+  // drop the least recently used statements
+  while (stmt_cache.size() > SQLITE_STATEMENT_CACHE_SIZE)
+  {
+    stmt_index.erase(stmt_cache.back().first);
+    sqlite3_finalize(stmt_cache.back().second);
+    stmt_cache.pop_back();
+  }
+}
+
+void SqliteDatabase::clear_statements() {
+  for (StatementCache::iterator i = stmt_cache.begin(); i != stmt_cache.end(); ++i)
+    sqlite3_finalize(i->second);
+  stmt_cache.clear();
+  stmt_index.clear();
+}
+
+void SqliteDatabase::get_statement_stats(unsigned int &hits, unsigned int &misses) {
+  hits = stmt_hits;
+  misses = stmt_misses;
+}
+
 
 // methods for formatting
 // ---------------------------------------------
@@ -408,6 +525,10 @@ string SqliteDatabase::vprepare(const char *format, va_list args)
 
 SqliteDataset::SqliteDataset():Dataset() {
   haveError = false;
+  cursor_stmt = NULL;
+  cursor_cached = false;
+  prepared_stmt = NULL;
+  cursor_row_valid = false;
   db = NULL;
   errmsg = NULL;
   autorefresh = false;
@@ -416,12 +537,17 @@ SqliteDataset::SqliteDataset():Dataset() {
 
 SqliteDataset::SqliteDataset(SqliteDatabase *newDb):Dataset(newDb) {
   haveError = false;
+  cursor_stmt = NULL;
+  cursor_cached = false;
+  prepared_stmt = NULL;
+  cursor_row_valid = false;
   db = newDb;
   errmsg = NULL;
   autorefresh = false;
 }
 
  SqliteDataset::~SqliteDataset(){
+   close();
    if (errmsg) sqlite3_free(errmsg);
  }
 
@@ -469,7 +595,8 @@ void SqliteDataset::make_query(StringList &_sql) {
 
  } // end of try
  catch(...) {
-  if (db->in_transaction()) db->rollback_transaction();
+  // only roll back the transaction we started, not one the caller has open
+  if (autocommit && db->in_transaction()) db->rollback_transaction();
   throw;
  }
 
@@ -622,29 +749,7 @@ bool SqliteDataset::query(const char *query) {
     sql_record *res = new sql_record;
     res->resize(numColumns);
     for (unsigned int i = 0; i < numColumns; i++)
-    {
-      field_value &v = res->at(i);
-      switch (sqlite3_column_type(stmt, i))
-      {
-      case SQLITE_INTEGER:
-        v.set_asInt64(sqlite3_column_int64(stmt, i));
-        break;
-      case SQLITE_FLOAT:
-        v.set_asDouble(sqlite3_column_double(stmt, i));
-        break;
-      case SQLITE_TEXT:
-        v.set_asString((const char *)sqlite3_column_text(stmt, i));
-        break;
-      case SQLITE_BLOB:
-        v.set_asString((const char *)sqlite3_column_text(stmt, i));
-        break;
-      case SQLITE_NULL:
-      default:
-        v.set_asString("");
-        v.set_isNull();
-        break;
-      }
-    }
+      get_column_value(stmt, i, res->at(i));
     result.records.push_back(res);
   }
   if (db->setErr(sqlite3_finalize(stmt),query) == SQLITE_OK)
@@ -664,6 +769,219 @@ bool SqliteDataset::query(const string &q){
   return query(q.c_str());
 }
 
+bool SqliteDataset::query_cursor(const string &query) {
+  if(!handle()) throw DbErrors("No Database Connection");
+  if (query.find("select") == string::npos && query.find("SELECT") == string::npos)
+    throw DbErrors("MUST be select SQL!");
+
+  close();
+
+  if (db->setErr(sqlite3_prepare_v2(handle(),query.c_str(),-1,&cursor_stmt, NULL),query.c_str()) != SQLITE_OK)
+  {
+    cursor_stmt = NULL;
+    throw DbErrors(db->getErrorMsg());
+  }
+
+  // column headers
+  const unsigned int numColumns = sqlite3_column_count(cursor_stmt);
+  result.record_header.resize(numColumns);
+  for (unsigned int i = 0; i < numColumns; i++)
+    result.record_header[i].name = sqlite3_column_name(cursor_stmt, i);
+
+  active = true;
+  ds_state = dsSelect;
+  cursor = true;
+  cursor_started = false;
+  fbof = true;
+  feof = false;
+  return true;
+}
+
+bool SqliteDataset::next_row() {
+  if (!cursor)
+    return false;
+  if (!cursor_stmt)
+    return false;
+
+  cursor_started = true;
+  cursor_row_valid = false;
+  int rc = sqlite3_step(cursor_stmt);
+  if (rc == SQLITE_ROW)
+  {
+    fbof = false;
+    return true;
+  }
+
+  // done (or failed) - release the statement straight away, we can't go back
+  feof = true;
+  string query = sqlite3_sql(cursor_stmt);
+  if (db->setErr(release_cursor(),query.c_str()) != SQLITE_OK)
+    throw DbErrors(db->getErrorMsg());
+  return false;
+}
+
+int SqliteDataset::release_cursor() {
+  if (!cursor_stmt)
+    return SQLITE_OK;
+
+  int rc;
+  if (cursor_cached)
+  {
+    // reset returns the error (if any) from the last step
+    rc = sqlite3_reset(cursor_stmt);
+    sqlite_db()->release_statement(cursor_sql, cursor_stmt);
+  }
+  else
+    rc = sqlite3_finalize(cursor_stmt);
+  cursor_stmt = NULL;
+  cursor_cached = false;
+  return rc;
+}
+
+void SqliteDataset::prepare_statement(const string &sql) {
+  if(!handle()) throw DbErrors("No Database Connection");
+  if (prepared_stmt)
+    sqlite_db()->release_statement(prepared_sql, prepared_stmt);
+  prepared_stmt = NULL;
+  prepared_sql = sql;
+  prepared_stmt = sqlite_db()->acquire_statement(sql);
+}
+
+void SqliteDataset::check_bind(int rc) {
+  if (db->setErr(rc, prepared_sql.c_str()) != SQLITE_OK)
+    throw DbErrors(db->getErrorMsg());
+}
+
+void SqliteDataset::bind_null(int index) {
+  if (!prepared_stmt) throw DbErrors("No prepared statement");
+  check_bind(sqlite3_bind_null(prepared_stmt, index));
+}
+
+void SqliteDataset::bind_int(int index, int value) {
+  if (!prepared_stmt) throw DbErrors("No prepared statement");
+  check_bind(sqlite3_bind_int(prepared_stmt, index, value));
+}
+
+void SqliteDataset::bind_int64(int index, int64_t value) {
+  if (!prepared_stmt) throw DbErrors("No prepared statement");
+  check_bind(sqlite3_bind_int64(prepared_stmt, index, value));
+}
+
+void SqliteDataset::bind_double(int index, double value) {
+  if (!prepared_stmt) throw DbErrors("No prepared statement");
+  check_bind(sqlite3_bind_double(prepared_stmt, index, value));
+}
+
+void SqliteDataset::bind_string(int index, const string &value) {
+  if (!prepared_stmt) throw DbErrors("No prepared statement");
+  check_bind(sqlite3_bind_text(prepared_stmt, index, value.c_str(), value.size(), SQLITE_TRANSIENT));
+}
+
+int SqliteDataset::exec_prepared() {
+  if (!prepared_stmt) throw DbErrors("No prepared statement");
+
+  sqlite3_stmt *stmt = prepared_stmt;
+  prepared_stmt = NULL;
+
+  int rc;
+  while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {}
+  if (rc == SQLITE_DONE)
+    rc = SQLITE_OK;
+  else
+    rc = sqlite3_reset(stmt);
+  sqlite_db()->release_statement(prepared_sql, stmt);
+
+  if (db->setErr(rc, prepared_sql.c_str()) != SQLITE_OK)
+    throw DbErrors(db->getErrorMsg());
+  return rc;
+}
+
+bool SqliteDataset::query_prepared() {
+  if (!prepared_stmt) throw DbErrors("No prepared statement");
+
+  sqlite3_stmt *stmt = prepared_stmt;
+  prepared_stmt = NULL;
+
+  close();
+
+  cursor_stmt = stmt;
+  cursor_cached = true;
+  cursor_sql = prepared_sql;
+
+  // column headers
+  const unsigned int numColumns = sqlite3_column_count(cursor_stmt);
+  result.record_header.resize(numColumns);
+  for (unsigned int i = 0; i < numColumns; i++)
+    result.record_header[i].name = sqlite3_column_name(cursor_stmt, i);
+
+  active = true;
+  ds_state = dsSelect;
+  cursor = true;
+  cursor_started = false;
+  fbof = true;
+  feof = false;
+  return true;
+}
+
+bool SqliteDataset::column_isnull(int index) {
+  if (!cursor)
+    return Dataset::column_isnull(index);
+  if (!cursor_stmt)
+    throw DbErrors("No current row");
+  return sqlite3_column_type(cursor_stmt, index) == SQLITE_NULL;
+}
+
+int SqliteDataset::column_int(int index) {
+  if (!cursor)
+    return Dataset::column_int(index);
+  if (!cursor_stmt)
+    throw DbErrors("No current row");
+  return sqlite3_column_int(cursor_stmt, index);
+}
+
+int64_t SqliteDataset::column_int64(int index) {
+  if (!cursor)
+    return Dataset::column_int64(index);
+  if (!cursor_stmt)
+    throw DbErrors("No current row");
+  return sqlite3_column_int64(cursor_stmt, index);
+}
+
+double SqliteDataset::column_double(int index) {
+  if (!cursor)
+    return Dataset::column_double(index);
+  if (!cursor_stmt)
+    throw DbErrors("No current row");
+  return sqlite3_column_double(cursor_stmt, index);
+}
+
+string SqliteDataset::column_string(int index) {
+  if (!cursor)
+    return Dataset::column_string(index);
+  if (!cursor_stmt)
+    throw DbErrors("No current row");
+  const char *text = (const char *)sqlite3_column_text(cursor_stmt, index);
+  return text ? text : "";
+}
+
+const sql_record* const SqliteDataset::get_sql_record() {
+  if (!cursor)
+    return Dataset::get_sql_record();
+  if (!cursor_stmt)
+    return NULL;
+
+  // only the current row is kept, and it's only converted when it's asked for
+  if (!cursor_row_valid)
+  {
+    const unsigned int numColumns = result.record_header.size();
+    cursor_row.resize(numColumns);
+    for (unsigned int i = 0; i < numColumns; i++)
+      get_column_value(cursor_stmt, i, cursor_row[i]);
+    cursor_row_valid = true;
+  }
+  return &cursor_row;
+}
+
 void SqliteDataset::open(const string &sql) {
 	set_select_sql(sql);
 	open();
@@ -680,6 +998,14 @@ void SqliteDataset::open() {
 
 
 void SqliteDataset::close() {
+  release_cursor();
+  if (prepared_stmt)
+  {
+    sqlite_db()->release_statement(prepared_sql, prepared_stmt);
+    prepared_stmt = NULL;
+  }
+  cursor_row.clear();
+  cursor_row_valid = false;
   Dataset::close();
   result.clear();
   edit_object->clear();
@@ -30,10 +30,15 @@
 #define _SQLITEDATASET_H
 
 #include <stdio.h>
+#include <list>
+#include <map>
 #include "dataset.h"
 #include <sqlite3.h>
 
 namespace dbiplus {
+
+#define SQLITE_STATEMENT_CACHE_SIZE 32	// compiled statements kept per connection
+
 /***************** Class SqliteDatabase definition ******************
 
        class 'SqliteDatabase' connects with Sqlite-server
@@ -46,6 +51,15 @@ protected:
   bool _in_transaction;
   int last_err;
 
+/* cache of compiled statements, most recently used first */
+  typedef std::list< std::pair<std::string, sqlite3_stmt*> > StatementCache;
+  StatementCache stmt_cache;
+  std::map<std::string, StatementCache::iterator> stmt_index;
+  unsigned int stmt_hits, stmt_misses;
+
+/* runs a savepoint command, throwing on failure */
+  void exec_savepoint(const char *command, const char *name);
+
 public:
 /* default constructor */
   SqliteDatabase();
@@ -88,12 +102,24 @@ public:
   virtual void start_transaction();
   virtual void commit_transaction();
   virtual void rollback_transaction();
+  virtual void start_deferred_transaction();
+
+  virtual void savepoint(const char *name);
+  virtual void release_savepoint(const char *name);
+  virtual void rollback_to_savepoint(const char *name);
 
 /* virtual methods for formatting */
   virtual std::string vprepare(const char *format, va_list args);
 
   bool in_transaction() {return _in_transaction;}; 	
 
+/* prepared statement cache. A statement is taken out of the cache while in use, so
+   two datasets never step the same statement at once */
+  sqlite3_stmt *acquire_statement(const std::string &sql);
+  void release_statement(const std::string &sql, sqlite3_stmt *stmt);
+  void clear_statements();
+  virtual void get_statement_stats(unsigned int &hits, unsigned int &misses);
+
 };
 
 
@@ -108,6 +134,21 @@ class SqliteDataset : public Dataset {
 protected:
   sqlite3* handle();
 
+/* forward-only cursor state */
+  sqlite3_stmt *cursor_stmt;	// statement being stepped by next_row()
+  bool cursor_cached;		// cursor_stmt belongs to the statement cache
+  std::string cursor_sql;	// cache key of cursor_stmt
+  sql_record cursor_row;	// current cursor row, filled on demand by get_sql_record()
+  bool cursor_row_valid;
+
+/* statement set up by prepare_statement(), taken from the statement cache */
+  sqlite3_stmt *prepared_stmt;
+
+  SqliteDatabase *sqlite_db() { return static_cast<SqliteDatabase*>(db); }
+/* finalize the cursor statement, or hand it back to the cache */
+  int release_cursor();
+  void check_bind(int rc);
+
 /* Makes direct queries to database */
   virtual void make_query(StringList &_sql);
 /* Makes direct inserts into database */
@@ -147,6 +188,24 @@ or insert() operations default = false) */
 /* as open, but with our query exept Sql */
   virtual bool query(const char *query);
   virtual bool query(const std::string &query);
+/* forward-only cursor over sqlite3_step() */
+  virtual bool query_cursor(const std::string &sql);
+  virtual bool next_row();
+  virtual bool column_isnull(int index);
+  virtual int column_int(int index);
+  virtual int64_t column_int64(int index);
+  virtual double column_double(int index);
+  virtual std::string column_string(int index);
+  virtual const sql_record* const get_sql_record();
+/* prepared statements, cached per connection */
+  virtual void prepare_statement(const std::string &sql);
+  virtual void bind_null(int index);
+  virtual void bind_int(int index, int value);
+  virtual void bind_int64(int index, int64_t value);
+  virtual void bind_double(int index, double value);
+  virtual void bind_string(int index, const std::string &value);
+  virtual int exec_prepared();
+  virtual bool query_prepared();
 /* func. closes a query */
   virtual void close(void);
 /* Cancel changes, made in insert or edit states of dataset */
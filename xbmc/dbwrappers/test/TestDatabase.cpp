@@ -0,0 +1,131 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "dbwrappers/Database.h"
+#include "dbwrappers/sqlitedataset.h"
+#include "filesystem/SpecialProtocol.h"
+#include "utils/StdString.h"
+#include "utils/URIUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace dbiplus;
+
+/* A backend without savepoints, like the ones that only have the base class' */
+class CNoSavepointDatabase : public SqliteDatabase
+{
+public:
+  virtual void savepoint(const char *name) { Database::savepoint(name); }
+  virtual void release_savepoint(const char *name) { Database::release_savepoint(name); }
+  virtual void rollback_to_savepoint(const char *name) { Database::rollback_to_savepoint(name); }
+};
+
+/* Runs CDatabase over a connection set up by the test */
+class CTestDatabase : public CDatabase
+{
+public:
+  CTestDatabase(Database *db)
+  {
+    m_pDB.reset(db);
+    m_pDS.reset(db->CreateDataset());
+    m_pDS2.reset(db->CreateDataset());
+  }
+
+  int CountPaths(const CStdString &path)
+  {
+    return atoi(GetSingleValue(PrepareSQL("select count(*) from path where strPath='%s'", path.c_str())).c_str());
+  }
+
+protected:
+  virtual int GetMinVersion() const { return 1; }
+  virtual const char *GetBaseDBName() const { return "TestDatabase"; }
+};
+
+class TestDatabase : public testing::Test
+{
+protected:
+  TestDatabase()
+  {
+    m_folder = CSpecialProtocol::TranslatePath("special://temp/");
+    remove(URIUtils::AddFileToFolder(m_folder, "TestDatabase.db").c_str());
+  }
+
+  ~TestDatabase()
+  {
+    remove(URIUtils::AddFileToFolder(m_folder, "TestDatabase.db").c_str());
+  }
+
+  bool Connect(SqliteDatabase *db)
+  {
+    db->setHostName(m_folder.c_str());
+    db->setDatabase("TestDatabase.db");
+    if (db->connect(true) != DB_CONNECTION_OK)
+      return false;
+    std::auto_ptr<Dataset> ds(db->CreateDataset());
+    ds->exec("CREATE TABLE path (idPath integer primary key, strPath text)");
+    return true;
+  }
+
+  CStdString m_folder;
+};
+
+TEST_F(TestDatabase, BatchRollback)
+{
+  SqliteDatabase *db = new SqliteDatabase;
+  CTestDatabase database(db);
+  ASSERT_TRUE(Connect(db));
+
+  database.BeginBatch();
+  ASSERT_TRUE(database.InBatch());
+  database.ExecuteQuery("insert into path (idPath, strPath) values (NULL, '/kept/')");
+  database.BeginTransaction();
+  database.ExecuteQuery("insert into path (idPath, strPath) values (NULL, '/discarded/')");
+  database.RollbackTransaction();
+  database.BeginTransaction();
+  database.ExecuteQuery("insert into path (idPath, strPath) values (NULL, '/committed/')");
+  database.CommitTransaction();
+  EXPECT_TRUE(database.EndBatch());
+
+  EXPECT_EQ(1, database.CountPaths("/kept/"));
+  EXPECT_EQ(0, database.CountPaths("/discarded/"));
+  EXPECT_EQ(1, database.CountPaths("/committed/"));
+}
+
+TEST_F(TestDatabase, BatchNeedsSavepoints)
+{
+  CNoSavepointDatabase *db = new CNoSavepointDatabase;
+  CTestDatabase database(db);
+  ASSERT_TRUE(Connect(db));
+
+  // the batch couldn't roll back a transaction within it, so writes go unbatched
+  database.BeginBatch();
+  EXPECT_FALSE(database.InBatch());
+  EXPECT_FALSE(database.InTransaction());
+
+  database.BeginTransaction();
+  database.ExecuteQuery("insert into path (idPath, strPath) values (NULL, '/discarded/')");
+  database.RollbackTransaction();
+  EXPECT_TRUE(database.EndBatch());
+
+  EXPECT_EQ(0, database.CountPaths("/discarded/"));
+}
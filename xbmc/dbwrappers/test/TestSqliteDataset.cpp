@@ -0,0 +1,288 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "dbwrappers/sqlitedataset.h"
+#include "filesystem/SpecialProtocol.h"
+#include "threads/SystemClock.h"
+#include "utils/StdString.h"
+#include "utils/URIUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <iostream>
+#include <memory>
+#include <stdio.h>
+
+using namespace dbiplus;
+
+class TestSqliteDataset : public testing::Test
+{
+protected:
+  TestSqliteDataset()
+  {
+    m_folder = CSpecialProtocol::TranslatePath("special://temp/");
+    remove(URIUtils::AddFileToFolder(m_folder, "TestSqliteDataset.db").c_str());
+    m_db.setHostName(m_folder.c_str());
+    m_db.setDatabase("TestSqliteDataset.db");
+    m_connected = m_db.connect(true) == DB_CONNECTION_OK;
+    if (m_connected)
+    {
+      m_ds.reset(m_db.CreateDataset());
+      // the tables and indices the video library looks up while scanning
+      m_ds->exec("CREATE TABLE path (idPath integer primary key, strPath text)");
+      m_ds->exec("CREATE UNIQUE INDEX ix_path ON path (strPath)");
+      m_ds->exec("CREATE TABLE files (idFile integer primary key, idPath integer, strFileName text)");
+      m_ds->exec("CREATE UNIQUE INDEX ix_files ON files (idPath, strFileName)");
+    }
+  }
+
+  ~TestSqliteDataset()
+  {
+    m_ds.reset();
+    m_db.disconnect();
+    remove(URIUtils::AddFileToFolder(m_folder, "TestSqliteDataset.db").c_str());
+  }
+
+  /* AddPath/AddFile as they used to be: every statement formatted and compiled anew */
+  int AddFileText(const CStdString &path, const CStdString &file)
+  {
+    int idPath = -1;
+    m_ds->query(m_db.prepare("select idPath from path where strPath='%s'", path.c_str()).c_str());
+    if (m_ds->num_rows() > 0)
+      idPath = m_ds->fv(0).get_asInt();
+    m_ds->close();
+    if (idPath < 0)
+    {
+      m_ds->exec(m_db.prepare("insert into path (idPath, strPath) values (NULL,'%s')", path.c_str()));
+      idPath = (int)m_ds->lastinsertid();
+    }
+
+    int idFile = -1;
+    m_ds->query(m_db.prepare("select idFile from files where strFileName='%s' and idPath=%i", file.c_str(), idPath).c_str());
+    if (m_ds->num_rows() > 0)
+      idFile = m_ds->fv(0).get_asInt();
+    m_ds->close();
+    if (idFile < 0)
+    {
+      m_ds->exec(m_db.prepare("insert into files (idFile, idPath, strFileName) values(NULL, %i, '%s')", idPath, file.c_str()));
+      idFile = (int)m_ds->lastinsertid();
+    }
+    return idFile;
+  }
+
+  /* AddPath/AddFile through the prepared statement cache */
+  int AddFilePrepared(const CStdString &path, const CStdString &file)
+  {
+    int idPath = -1;
+    m_ds->prepare_statement("select idPath from path where strPath=?");
+    m_ds->bind_string(1, path);
+    m_ds->query_prepared();
+    if (m_ds->next_row())
+      idPath = m_ds->column_int(0);
+    m_ds->close();
+    if (idPath < 0)
+    {
+      m_ds->prepare_statement("insert into path (idPath, strPath) values (NULL,?)");
+      m_ds->bind_string(1, path);
+      m_ds->exec_prepared();
+      idPath = (int)m_ds->lastinsertid();
+    }
+
+    int idFile = -1;
+    m_ds->prepare_statement("select idFile from files where strFileName=? and idPath=?");
+    m_ds->bind_string(1, file);
+    m_ds->bind_int(2, idPath);
+    m_ds->query_prepared();
+    if (m_ds->next_row())
+      idFile = m_ds->column_int(0);
+    m_ds->close();
+    if (idFile < 0)
+    {
+      m_ds->prepare_statement("insert into files (idFile, idPath, strFileName) values(NULL, ?, ?)");
+      m_ds->bind_int(1, idPath);
+      m_ds->bind_string(2, file);
+      m_ds->exec_prepared();
+      idFile = (int)m_ds->lastinsertid();
+    }
+    return idFile;
+  }
+
+  CStdString m_folder;
+  SqliteDatabase m_db;
+  std::auto_ptr<Dataset> m_ds;
+  bool m_connected;
+};
+
+TEST_F(TestSqliteDataset, BindValues)
+{
+  ASSERT_TRUE(m_connected);
+
+  m_ds->prepare_statement("insert into path (idPath, strPath) values (?,?)");
+  m_ds->bind_int(1, 7);
+  m_ds->bind_string(2, "smb://server/it's a \"path\"/");
+  m_ds->exec_prepared();
+  m_ds->prepare_statement("insert into path (idPath, strPath) values (?,?)");
+  m_ds->bind_int64(1, 8);
+  m_ds->bind_null(2);
+  m_ds->exec_prepared();
+
+  m_ds->query("select strPath from path where idPath=7");
+  ASSERT_EQ(1, m_ds->num_rows());
+  EXPECT_STREQ("smb://server/it's a \"path\"/", m_ds->fv(0).get_asString().c_str());
+  m_ds->close();
+
+  m_ds->prepare_statement("select idPath from path where strPath is ?");
+  m_ds->bind_null(1);
+  ASSERT_TRUE(m_ds->query_prepared());
+  ASSERT_TRUE(m_ds->next_row());
+  EXPECT_EQ(8, m_ds->column_int(0));
+  EXPECT_FALSE(m_ds->next_row());
+  m_ds->close();
+}
+
+TEST_F(TestSqliteDataset, StatementCache)
+{
+  ASSERT_TRUE(m_connected);
+
+  unsigned int hits, misses;
+  m_db.get_statement_stats(hits, misses);
+  for (int i = 0; i < 10; i++)
+    EXPECT_EQ(1, AddFilePrepared("/media/", "file.mkv"));
+
+  unsigned int hitsAfter, missesAfter;
+  m_db.get_statement_stats(hitsAfter, missesAfter);
+  // one compile per distinct statement, every later use is taken from the cache
+  EXPECT_EQ(misses + 4, missesAfter);
+  EXPECT_EQ(hits + 9 * 2, hitsAfter);
+}
+
+/* Scan benchmark: the path and file lookups and inserts of a video library scan, formatted
+   as text as before and through the prepared statement cache, reported as ms per run. */
+TEST_F(TestSqliteDataset, ScanBenchmark)
+{
+  ASSERT_TRUE(m_connected);
+  static const int folders = 200;
+  static const int filesPerFolder = 25;
+
+  unsigned int elapsed[2];
+  for (int run = 0; run < 2; run++)
+  {
+    m_ds->exec("delete from files");
+    m_ds->exec("delete from path");
+
+    unsigned int start = XbmcThreads::SystemClockMillis();
+    m_db.start_transaction();
+    // every file is added twice, once as new and once as a rescan would find it
+    for (int pass = 0; pass < 2; pass++)
+    {
+      int expected = 1;
+      for (int folder = 0; folder < folders; folder++)
+      {
+        CStdString path;
+        path.Format("smb://server/movies/folder %i/", folder);
+        for (int file = 0; file < filesPerFolder; file++, expected++)
+        {
+          CStdString name;
+          name.Format("movie %i.mkv", file);
+          int idFile = run == 0 ? AddFileText(path, name) : AddFilePrepared(path, name);
+          ASSERT_EQ(expected, idFile);
+        }
+      }
+    }
+    m_db.commit_transaction();
+    elapsed[run] = XbmcThreads::SystemClockMillis() - start;
+
+    m_ds->query("select count(*) from files");
+    EXPECT_EQ(folders * filesPerFolder, m_ds->fv(0).get_asInt());
+    m_ds->close();
+  }
+
+  std::cout << folders * filesPerFolder << " files added and rescanned: "
+            << elapsed[0] << " ms with text statements, "
+            << elapsed[1] << " ms with prepared statements" << std::endl;
+}
+
+TEST_F(TestSqliteDataset, Savepoints)
+{
+  ASSERT_TRUE(m_connected);
+
+  m_db.start_deferred_transaction();
+  AddFilePrepared("/media/1/", "kept.mkv");
+  m_db.savepoint("batch1");
+  AddFilePrepared("/media/2/", "kept.mkv");
+  m_db.savepoint("batch2");
+  AddFilePrepared("/media/3/", "discarded.mkv");
+  m_db.rollback_to_savepoint("batch2");
+  m_db.release_savepoint("batch2");
+  m_db.release_savepoint("batch1");
+  EXPECT_THROW(m_db.release_savepoint("batch1"), DbErrors);
+  m_db.commit_transaction();
+
+  m_ds->query("select count(*) from files where strFileName='kept.mkv'");
+  EXPECT_EQ(2, m_ds->fv(0).get_asInt());
+  m_ds->close();
+  m_ds->query("select count(*) from path");
+  EXPECT_EQ(2, m_ds->fv(0).get_asInt());
+  m_ds->close();
+}
+
+TEST_F(TestSqliteDataset, DeferredTransaction)
+{
+  ASSERT_TRUE(m_connected);
+
+  SqliteDatabase other;
+  other.setHostName(m_folder.c_str());
+  other.setDatabase("TestSqliteDataset.db");
+  ASSERT_EQ(DB_CONNECTION_OK, other.connect(false));
+  std::auto_ptr<Dataset> ds(other.CreateDataset());
+
+  // nothing written yet, so the other connection isn't locked out
+  m_db.start_deferred_transaction();
+  EXPECT_NO_THROW(ds->exec("insert into path (idPath, strPath) values (NULL, '/other/')"));
+  m_db.commit_transaction();
+
+  m_ds->query("select count(*) from path");
+  EXPECT_EQ(1, m_ds->fv(0).get_asInt());
+  m_ds->close();
+
+  ds.reset();
+  other.disconnect();
+}
+
+TEST_F(TestSqliteDataset, FailedPostKeepsTransaction)
+{
+  ASSERT_TRUE(m_connected);
+
+  m_db.start_transaction();
+  AddFilePrepared("/media/", "kept.mkv");
+
+  // a queued insert failing must not roll back the transaction it was posted in
+  std::auto_ptr<Dataset> queue(m_db.CreateDataset());
+  queue->insert();
+  queue->add_insert_sql("insert into path (idPath, strPath) values (1, '/duplicate/')");
+  queue->set_autocommit(false);
+  EXPECT_THROW(queue->post(), DbErrors);
+  EXPECT_TRUE(m_db.in_transaction());
+  m_db.commit_transaction();
+
+  m_ds->query("select count(*) from files");
+  EXPECT_EQ(1, m_ds->fv(0).get_asInt());
+  m_ds->close();
+}
@@ -0,0 +1,469 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "threads/SystemClock.h"
+#include "system.h"
+#include "BlockCache.h"
+#ifdef TARGET_POSIX
+#include "PlatformInclude.h"
+#endif
+#include "Util.h"
+#include "SpecialProtocol.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+#include "utils/TimeUtils.h"
+
+using namespace XFILE;
+
+CBlockCache::CBlockCache(size_t memory, size_t disk)
+ : CCacheStrategy()
+ , m_memory(memory)
+ , m_disk(disk)
+ , m_end(0)
+ , m_cur(0)
+ , m_useCounter(0)
+ , m_usedSlots(0)
+ , m_hSpillWrite(NULL)
+ , m_hSpillRead(NULL)
+{
+  // we need room for the forward buffer plus the blocks at both of its ends
+  m_maxBuffers = std::max<unsigned int>(memory / BlockSize, 4);
+  m_maxSlots = disk / BlockSize;
+}
+
+CBlockCache::~CBlockCache()
+{
+  Close();
+}
+
+int CBlockCache::Open()
+{
+  Close();
+
+  CSingleLock lock(m_sync);
+  m_end = 0;
+  m_cur = 0;
+
+  if (m_maxSlots == 0)
+    return CACHE_RC_OK;
+
+  CStdString fileName = CSpecialProtocol::TranslatePath(CUtil::GetNextFilename("special://temp/filecache%03d.cache", 999));
+  if (fileName.empty())
+  {
+    CLog::Log(LOGWARNING, "%s - unable to generate a spill filename, caching in memory only", __FUNCTION__);
+    m_maxSlots = 0;
+    return CACHE_RC_OK;
+  }
+
+  m_hSpillWrite = CreateFile(fileName.c_str()
+            , GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_DELETE
+            , NULL
+            , CREATE_ALWAYS
+            , FILE_ATTRIBUTE_NORMAL
+            , NULL);
+  if (m_hSpillWrite != INVALID_HANDLE_VALUE)
+    m_hSpillRead = CreateFile(fileName.c_str()
+            , GENERIC_READ, FILE_SHARE_WRITE
+            , NULL
+            , OPEN_EXISTING
+            , FILE_ATTRIBUTE_NORMAL | FILE_FLAG_DELETE_ON_CLOSE
+            , NULL);
+
+  if (m_hSpillWrite == INVALID_HANDLE_VALUE || m_hSpillRead == INVALID_HANDLE_VALUE)
+  {
+    CLog::Log(LOGWARNING, "%s - failed to create spill file %s with error code %d, caching in memory only", __FUNCTION__, fileName.c_str(), GetLastError());
+    if (m_hSpillWrite != INVALID_HANDLE_VALUE)
+      CloseHandle(m_hSpillWrite);
+    m_hSpillWrite = NULL;
+    m_hSpillRead = NULL;
+    m_maxSlots = 0;
+  }
+  return CACHE_RC_OK;
+}
+
+void CBlockCache::Close()
+{
+  CSingleLock lock(m_sync);
+  Clear();
+
+  for (std::vector<uint8_t*>::iterator i = m_buffers.begin(); i != m_buffers.end(); ++i)
+    delete[] *i;
+  m_buffers.clear();
+  m_freeBuffers.clear();
+
+  if (m_hSpillWrite)
+    CloseHandle(m_hSpillWrite);
+  m_hSpillWrite = NULL;
+
+  if (m_hSpillRead)
+    CloseHandle(m_hSpillRead);
+  m_hSpillRead = NULL;
+}
+
+void CBlockCache::Clear()
+{
+  m_blocks.clear();
+  m_freeBuffers = m_buffers;
+  m_freeSlots.clear();
+  m_usedSlots = 0;
+}
+
+bool CBlockCache::IsProtected(int64_t index) const
+{
+  // blocks holding the forward buffer may never be dropped
+  return index >= m_cur / BlockSize && index <= m_end / BlockSize;
+}
+
+int64_t CBlockCache::ContiguousEnd(int64_t pos) const
+{
+  int64_t end = pos;
+  BlockMap::const_iterator i = m_blocks.find(pos / BlockSize);
+  while (i != m_blocks.end())
+  {
+    int64_t base = i->first * BlockSize;
+    if (end < base + i->second.beg || end > base + i->second.end)
+      break;
+    end = base + i->second.end;
+    if (i->second.end < BlockSize)
+      break;
+
+    BlockMap::const_iterator next = i;
+    ++next;
+    if (next == m_blocks.end() || next->first != i->first + 1)
+      break;
+    i = next;
+  }
+  return end;
+}
+
+bool CBlockCache::ReadSlot(int slot, unsigned int offset, uint8_t *buf, size_t len)
+{
+  LARGE_INTEGER pos;
+  pos.QuadPart = (int64_t)slot * BlockSize + offset;
+  DWORD read = 0;
+  if (!SetFilePointerEx(m_hSpillRead, pos, NULL, FILE_BEGIN) ||
+      !ReadFile(m_hSpillRead, buf, len, &read, NULL) || read != len)
+  {
+    CLog::Log(LOGERROR, "%s - failed to read spilled block. err: %u", __FUNCTION__, GetLastError());
+    return false;
+  }
+  return true;
+}
+
+bool CBlockCache::WriteSlot(int slot, const uint8_t *buf, size_t len)
+{
+  LARGE_INTEGER pos;
+  pos.QuadPart = (int64_t)slot * BlockSize;
+  DWORD written = 0;
+  if (!SetFilePointerEx(m_hSpillWrite, pos, NULL, FILE_BEGIN) ||
+      !WriteFile(m_hSpillWrite, buf, len, &written, NULL) || written != len)
+  {
+    CLog::Log(LOGERROR, "%s - failed to spill block. err: %u", __FUNCTION__, GetLastError());
+    return false;
+  }
+  return true;
+}
+
+void CBlockCache::DropBlock(BlockMap::iterator block)
+{
+  if (block->second.data)
+    m_freeBuffers.push_back(block->second.data);
+  if (block->second.slot >= 0)
+    m_freeSlots.push_back(block->second.slot);
+  m_blocks.erase(block);
+}
+
+bool CBlockCache::SpillBlock(BlockMap::iterator block)
+{
+  if (m_maxSlots == 0)
+    return false;
+
+  int slot;
+  if (!m_freeSlots.empty())
+  {
+    slot = m_freeSlots.back();
+    m_freeSlots.pop_back();
+  }
+  else if ((unsigned int)m_usedSlots < m_maxSlots)
+    slot = m_usedSlots++;
+  else
+  { // spill file is full, drop the least recently used block on disk
+    BlockMap::iterator oldest = m_blocks.end();
+    for (BlockMap::iterator i = m_blocks.begin(); i != m_blocks.end(); ++i)
+    {
+      if (i->second.slot >= 0 && !i->second.data && !IsProtected(i->first) &&
+          (oldest == m_blocks.end() || i->second.lastUse < oldest->second.lastUse))
+        oldest = i;
+    }
+    if (oldest == m_blocks.end())
+      return false;
+    slot = oldest->second.slot;
+    oldest->second.slot = -1;
+    DropBlock(oldest);
+  }
+
+  if (!WriteSlot(slot, block->second.data, block->second.end))
+  {
+    m_freeSlots.push_back(slot);
+    return false;
+  }
+  block->second.slot = slot;
+  return true;
+}
+
+uint8_t *CBlockCache::AllocBuffer()
+{
+  if (!m_freeBuffers.empty())
+  {
+    uint8_t *buf = m_freeBuffers.back();
+    m_freeBuffers.pop_back();
+    return buf;
+  }
+
+  if (m_buffers.size() < m_maxBuffers)
+  {
+    uint8_t *buf = new uint8_t[BlockSize];
+    m_buffers.push_back(buf);
+    return buf;
+  }
+
+  // move the least recently used block out of memory, preferring those outside the
+  // forward buffer. Blocks in the forward buffer may be spilled but not dropped.
+  int64_t writing = m_end / BlockSize;
+  BlockMap::iterator oldest = m_blocks.end();
+  for (BlockMap::iterator i = m_blocks.begin(); i != m_blocks.end(); ++i)
+  {
+    if (!i->second.data || i->first == writing)
+      continue;
+    if (oldest == m_blocks.end() ||
+        IsProtected(oldest->first) > IsProtected(i->first) ||
+        (IsProtected(oldest->first) == IsProtected(i->first) && i->second.lastUse < oldest->second.lastUse))
+      oldest = i;
+  }
+  if (oldest == m_blocks.end())
+    return NULL;
+
+  uint8_t *buf = oldest->second.data;
+  if (SpillBlock(oldest))
+    oldest->second.data = NULL;
+  else if (!IsProtected(oldest->first))
+  {
+    oldest->second.data = NULL;
+    DropBlock(oldest);
+  }
+  else
+    return NULL;
+  return buf;
+}
+
+/**
+ * Writes at the write position into the block holding it. Only
+ * writes up to the end of that block, so multiple calls may be
+ * needed to store the whole buffer.
+ *
+ * Returns 0 if the forward buffer is full.
+ */
+int CBlockCache::WriteToCache(const char *buf, size_t len)
+{
+  CSingleLock lock(m_sync);
+
+  // limit the forward buffer so it always fits in memory
+  size_t forward = (size_t)(m_end - m_cur);
+  size_t limit = (m_maxBuffers - 2) * BlockSize;
+  if (forward >= limit)
+    return 0;
+  len = std::min(len, limit - forward);
+
+  int64_t index = m_end / BlockSize;
+  unsigned int offset = (unsigned int)(m_end % BlockSize);
+  len = std::min(len, (size_t)(BlockSize - offset));
+
+  BlockMap::iterator i = m_blocks.find(index);
+  if (i == m_blocks.end())
+  {
+    CBlock block;
+    block.data = AllocBuffer();
+    if (!block.data)
+      return 0;
+    block.slot = -1;
+    block.beg = block.end = offset;
+    i = m_blocks.insert(std::make_pair(index, block)).first;
+  }
+  else if (!i->second.data)
+  { // bring the block back from disk before extending it
+    uint8_t *data = AllocBuffer();
+    if (!data)
+      return 0;
+    // allocating may have dropped blocks, but never a protected one like ours
+    if (!ReadSlot(i->second.slot, 0, data, i->second.end))
+    {
+      m_freeBuffers.push_back(data);
+      DropBlock(i);
+      return 0;
+    }
+    i->second.data = data;
+  }
+
+  CBlock &block = i->second;
+  if (block.slot >= 0)
+  { // the spilled copy is about to be stale
+    m_freeSlots.push_back(block.slot);
+    block.slot = -1;
+  }
+  if (offset < block.beg || offset > block.end)
+    block.beg = block.end = offset; // not contiguous with what we have, start over
+
+  memcpy(block.data + offset, buf, len);
+  block.end = std::max(block.end, (unsigned int)(offset + len));
+  block.lastUse = m_useCounter++;
+  m_end += len;
+
+  m_written.Set();
+
+  return len;
+}
+
+/**
+ * Reads from the block at the read position. Will only read up
+ * till the end of that block, so multiple calls may be needed.
+ */
+int CBlockCache::ReadFromCache(char *buf, size_t len)
+{
+  CSingleLock lock(m_sync);
+
+  size_t front = (size_t)(m_end - m_cur);
+  if (front == 0)
+  {
+    if (IsEndOfInput())
+      return 0;
+    else
+      return CACHE_RC_WOULD_BLOCK;
+  }
+
+  BlockMap::iterator i = m_blocks.find(m_cur / BlockSize);
+  if (i == m_blocks.end())
+    return CACHE_RC_ERROR;
+
+  unsigned int offset = (unsigned int)(m_cur % BlockSize);
+  if (offset < i->second.beg || offset >= i->second.end)
+    return CACHE_RC_ERROR;
+  len = std::min(len, front);
+  len = std::min(len, (size_t)(i->second.end - offset));
+
+  if (i->second.data)
+    memcpy(buf, i->second.data + offset, len);
+  else if (!ReadSlot(i->second.slot, offset, (uint8_t *)buf, len))
+    return CACHE_RC_ERROR;
+
+  i->second.lastUse = m_useCounter++;
+  m_cur += len;
+
+  m_space.Set();
+
+  return len;
+}
+
+int64_t CBlockCache::WaitForData(unsigned int minimum, unsigned int millis)
+{
+  CSingleLock lock(m_sync);
+  int64_t avail = m_end - m_cur;
+
+  if (millis == 0 || IsEndOfInput())
+    return avail;
+
+  unsigned int limit = (m_maxBuffers - 2) * BlockSize;
+  if (minimum > limit)
+    minimum = limit;
+
+  XbmcThreads::EndTime endtime(millis);
+  while (!IsEndOfInput() && avail < minimum && !endtime.IsTimePast())
+  {
+    lock.Leave();
+    m_written.WaitMSec(50); // may miss the deadline. shouldn't be a problem.
+    lock.Enter();
+    avail = m_end - m_cur;
+  }
+
+  return avail;
+}
+
+int64_t CBlockCache::Seek(int64_t pos)
+{
+  CSingleLock lock(m_sync);
+
+  // if seek is a bit over what we have, try to wait a few seconds for the data to be available.
+  // we try to avoid a (heavy) seek on the source
+  if (pos >= m_end && pos < m_end + 100000)
+  {
+    lock.Leave();
+    WaitForData((size_t)(pos - m_cur), 5000);
+    lock.Enter();
+  }
+
+  // we can only move the read position if the data from there on runs into the write position
+  if (pos <= m_end && ContiguousEnd(pos) >= m_end)
+  {
+    m_cur = pos;
+    m_space.Set();
+    return pos;
+  }
+
+  return CACHE_RC_ERROR;
+}
+
+void CBlockCache::Reset(int64_t pos, bool clearAnyway)
+{
+  CSingleLock lock(m_sync);
+  if (clearAnyway)
+  {
+    Clear();
+    m_cur = pos;
+    m_end = pos;
+    return;
+  }
+
+  // keep everything, the source continues from the end of the cached data
+  m_cur = pos;
+  m_end = ContiguousEnd(pos);
+  m_space.Set();
+}
+
+int64_t CBlockCache::CachedDataEndPosIfSeekTo(int64_t iFilePosition)
+{
+  CSingleLock lock(m_sync);
+  return ContiguousEnd(iFilePosition);
+}
+
+int64_t CBlockCache::CachedDataEndPos()
+{
+  CSingleLock lock(m_sync);
+  return m_end;
+}
+
+bool CBlockCache::IsCachedPosition(int64_t iFilePosition)
+{
+  CSingleLock lock(m_sync);
+  return iFilePosition == m_end || ContiguousEnd(iFilePosition) > iFilePosition;
+}
+
+CCacheStrategy *CBlockCache::CreateNew()
+{
+  return new CBlockCache(m_memory, m_disk);
+}
@@ -0,0 +1,113 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef CACHEBLOCK_H
+#define CACHEBLOCK_H
+
+#include "CacheStrategy.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+
+#include <map>
+#include <vector>
+
+namespace XFILE {
+
+/*!
+ \brief Cache strategy keeping several regions of a file cached at once.
+
+ The file is split into fixed size blocks which are stored in a sparse map, so data
+ around earlier read positions (such as the header or an index at the end of the file)
+ stays cached when seeking around. Recently used blocks live in memory, older ones are
+ spilled to a temporary file and dropped least recently used first once that is full.
+
+ The forward buffer (data from the read position up to the write position) is always
+ contiguous. Its blocks may be spilled to disk, but are never dropped.
+ */
+class CBlockCache : public CCacheStrategy
+{
+public:
+  /*!
+   \param memory size of the in-memory block pool, this also bounds the forward buffer.
+   \param disk size of the on-disk spill file, 0 to keep blocks in memory only.
+   */
+  CBlockCache(size_t memory, size_t disk);
+  virtual ~CBlockCache();
+
+  virtual int Open();
+  virtual void Close();
+
+  virtual int WriteToCache(const char *buf, size_t len);
+  virtual int ReadFromCache(char *buf, size_t len);
+  virtual int64_t WaitForData(unsigned int minimum, unsigned int iMillis);
+
+  virtual int64_t Seek(int64_t pos);
+  virtual void Reset(int64_t pos, bool clearAnyway=true);
+
+  virtual int64_t CachedDataEndPosIfSeekTo(int64_t iFilePosition);
+  virtual int64_t CachedDataEndPos();
+  virtual bool IsCachedPosition(int64_t iFilePosition);
+
+  virtual CCacheStrategy *CreateNew();
+
+  static const unsigned int BlockSize = 256 * 1024;
+
+protected:
+  struct CBlock
+  {
+    uint8_t     *data;     ///< block contents if held in memory, NULL otherwise
+    int          slot;     ///< slot in the spill file if on disk, -1 otherwise
+    unsigned int beg;      ///< start of valid data within the block
+    unsigned int end;      ///< end of valid data within the block
+    unsigned int lastUse;
+  };
+  typedef std::map<int64_t, CBlock> BlockMap;
+
+  /*! \brief End of the data cached contiguously from pos, pos if it isn't cached
+   */
+  int64_t ContiguousEnd(int64_t pos) const;
+  bool IsProtected(int64_t index) const;
+  uint8_t *AllocBuffer();
+  bool SpillBlock(BlockMap::iterator block);
+  bool ReadSlot(int slot, unsigned int offset, uint8_t *buf, size_t len);
+  bool WriteSlot(int slot, const uint8_t *buf, size_t len);
+  void DropBlock(BlockMap::iterator block);
+  void Clear();
+
+  size_t            m_memory;
+  size_t            m_disk;
+  unsigned int      m_maxBuffers;   ///< number of in-memory blocks we may allocate
+  unsigned int      m_maxSlots;     ///< number of blocks the spill file may hold
+  int64_t           m_end;          ///< write position
+  int64_t           m_cur;          ///< read position
+  unsigned int      m_useCounter;
+  BlockMap          m_blocks;
+  std::vector<uint8_t*> m_buffers;  ///< all allocated block buffers
+  std::vector<uint8_t*> m_freeBuffers;
+  std::vector<int>  m_freeSlots;
+  int               m_usedSlots;
+  HANDLE            m_hSpillWrite;
+  HANDLE            m_hSpillRead;
+  CCriticalSection  m_sync;
+  CEvent            m_written;
+};
+
+} // namespace XFILE
+#endif
@@ -247,6 +247,7 @@ CCurlFile::CReadState::CReadState()
   m_cancelled = false;
   m_bFirstLoop = true;
   m_sendRange = true;
+  m_pending = false;
   m_headerdone = false;
   m_readBuffer = 0;
   m_isPaused = false;
@@ -259,7 +260,7 @@ CCurlFile::CReadState::~CReadState()
   Disconnect();
 
   if(m_easyHandle)
-    g_curlInterface.easy_release(&m_easyHandle, &m_multiHandle);
+    g_curlInterface.easy_release(&m_easyHandle, &m_multiHandle, GetKeepAlive());
 }
 
 bool CCurlFile::CReadState::Seek(int64_t pos)
@@ -273,29 +274,13 @@ bool CCurlFile::CReadState::Seek(int64_t pos)
     return true;
   }
 
-  if(pos > m_filePos && pos < m_filePos + m_bufferSize)
+  // reading up to the position is quicker than a new request, as long as it fits in the buffer
+  if(pos > m_filePos && pos - m_filePos <= m_buffer.getSize())
   {
-    int len = m_buffer.getMaxReadSize();
-    m_filePos += len;
-    m_buffer.SkipBytes(len);
-    if(!FillBuffer(m_bufferSize))
-    {
-      if(!m_buffer.SkipBytes(-len))
-        CLog::Log(LOGERROR, "%s - Failed to restore position after failed fill", __FUNCTION__);
-      else
-        m_filePos -= len;
+    unsigned int len = (unsigned int)(pos - m_filePos);
+    if(!FillBuffer(len) || !m_buffer.SkipBytes(len))
       return false;
-    }
 
-    if(!FITS_INT(pos - m_filePos) || !m_buffer.SkipBytes((int)(pos - m_filePos)))
-    {
-      CLog::Log(LOGERROR, "%s - Failed to skip to position after having filled buffer", __FUNCTION__);
-      if(!m_buffer.SkipBytes(-len))
-        CLog::Log(LOGERROR, "%s - Failed to restore position after failed seek", __FUNCTION__);
-      else
-        m_filePos -= len;
-      return false;
-    }
     m_filePos = pos;
     return true;
   }
@@ -325,6 +310,13 @@ long CCurlFile::CReadState::Connect(unsigned int size)
   if (m_filePos != 0)
     CLog::Log(LOGDEBUG,"CurlFile::CReadState::Connect - Resume from position %"PRId64, m_filePos);
 
+  Start(size);
+  return Finish();
+}
+
+/* send the request without waiting for the response, which is picked up by Finish() */
+void CCurlFile::CReadState::Start(unsigned int size)
+{
   SetResume();
   g_curlInterface.multi_add_handle(m_multiHandle, m_easyHandle);
 
@@ -333,9 +325,17 @@ long CCurlFile::CReadState::Connect(unsigned int size)
   m_buffer.Create(size * 3);
   m_headerdone = false;
 
+  m_stillRunning = 1;
+  m_pending = true;
+  Pump();
+}
+
+long CCurlFile::CReadState::Finish()
+{
+  m_pending = false;
+
   // read some data in to try and obtain the length
   // maybe there's a better way to get this info??
-  m_stillRunning = 1;
   if (!FillBuffer(1))
   {
     CLog::Log(LOGERROR, "CCurlFile::CReadState::Connect, didn't get any data from stream.");
@@ -357,6 +357,27 @@ long CCurlFile::CReadState::Connect(unsigned int size)
   return -1;
 }
 
+/* progress the transfer as far as possible without waiting */
+void CCurlFile::CReadState::Pump()
+{
+  if (m_stillRunning)
+    g_curlInterface.multi_perform(m_multiHandle, &m_stillRunning);
+}
+
+/* how long the server keeps the connection open for the next request */
+int CCurlFile::CReadState::GetKeepAlive() const
+{
+  if (m_httpheader.GetValue("Connection").Equals("close"))
+    return 0;
+
+  CStdString keepAlive = m_httpheader.GetValue("Keep-Alive");
+  int timeout = keepAlive.Find("timeout=");
+  if (timeout >= 0)
+    return atoi(keepAlive.c_str() + timeout + 8) * 1000;
+
+  return -1;
+}
+
 void CCurlFile::CReadState::Disconnect()
 {
   if(m_multiHandle && m_easyHandle)
@@ -370,6 +391,7 @@ void CCurlFile::CReadState::Disconnect()
   m_fileSize = 0;
   m_bufferSize = 0;
   m_readBuffer = 0;
+  m_pending = false;
 
   /* cleanup */
   if( m_curlHeaderList )
@@ -416,6 +438,9 @@ CCurlFile::CCurlFile()
   m_oldState = NULL;
   m_skipshout = false;
   m_httpresponse = -1;
+  m_connects = 0;
+  m_seeks = 0;
+  m_seeksBuffered = 0;
 }
 
 //Has to be called before Open()
@@ -429,6 +454,13 @@ void CCurlFile::Close()
   if (m_opened && m_forWrite && !m_inError)
       Write(NULL, 0);
 
+  if (m_connects > 1 || m_seeks > 0)
+    CLog::Log(LOGDEBUG, "CurlFile::Close(%p) %s - %u requests, %u seeks of which %u were buffered",
+              (void*)this, m_url.c_str(), m_connects, m_seeks, m_seeksBuffered);
+  m_connects = 0;
+  m_seeks = 0;
+  m_seeksBuffered = 0;
+
   m_state->Disconnect();
   delete m_oldState;
   m_oldState = NULL;
@@ -911,6 +943,7 @@ bool CCurlFile::Open(const CURL& url)
   m_state->m_sendRange = m_seekable;
 
   m_httpresponse = m_state->Connect(m_bufferSize);
+  m_connects++;
   if( m_httpresponse < 0 || m_httpresponse >= 400)
     return false;
 
@@ -963,9 +996,43 @@ bool CCurlFile::Open(const CURL& url)
   if (CURLE_OK == g_curlInterface.easy_getinfo(m_state->m_easyHandle, CURLINFO_EFFECTIVE_URL,&efurl) && efurl)
     m_url = efurl;
 
+  // containers such as MP4 and AVI often keep their index at the end of the file, which the
+  // demuxer reads right after the start, so fetch it on a second connection in the meantime
+  int64_t prefetch = (int64_t)g_advancedSettings.m_curlTailPrefetch * 1024;
+  if (m_multisession && m_seekable && prefetch > 0 && m_state->m_fileSize >= prefetch * 32)
+    StartPrefetch(m_state->m_fileSize - prefetch);
+
   return true;
 }
 
+void CCurlFile::StartPrefetch(int64_t pos)
+{
+  CURL url(m_url);
+
+  delete m_oldState;
+  m_oldState = new CReadState();
+  g_curlInterface.easy_aquire(url.GetProtocol(), url.GetHostName(), &m_oldState->m_easyHandle, &m_oldState->m_multiHandle);
+
+  SetCommonOptions(m_oldState);
+  SetRequestHeaders(m_oldState);
+  m_oldState->m_fileSize = m_state->m_fileSize;
+  m_oldState->m_filePos = pos;
+  m_oldState->m_sendRange = true;
+
+  // buffer it all, so the whole region can be seeked in
+  m_oldState->Start((unsigned int)(m_state->m_fileSize - pos) / 2);
+  m_connects++;
+}
+
+unsigned int CCurlFile::Read(void* lpBuf, int64_t uiBufSize)
+{
+  // keep the prefetch going while the rest is read
+  if (m_oldState && m_oldState->m_pending)
+    m_oldState->Pump();
+
+  return m_state->Read(lpBuf, uiBufSize);
+}
+
 bool CCurlFile::OpenForWrite(const CURL& url, bool bOverWrite)
 {
   if(m_opened)
@@ -1150,14 +1217,32 @@ int64_t CCurlFile::Seek(int64_t iFilePosition, int iWhence)
   // We can't seek beyond EOF
   if (m_state->m_fileSize && nextPos > m_state->m_fileSize) return -1;
 
+  bool moved = nextPos != m_state->m_filePos;
+  if (moved)
+    m_seeks++;
+
   if(m_state->Seek(nextPos))
+  {
+    if (moved)
+      m_seeksBuffered++;
     return nextPos;
+  }
+
+  // a prefetch is only of use if the server sent the range asked for
+  if (m_oldState && m_oldState->m_pending && nextPos >= m_oldState->m_filePos &&
+      m_oldState->Finish() != 206)
+  {
+    CLog::Log(LOGDEBUG, "CCurlFile::Seek - Prefetch of %s at %"PRId64" failed", m_url.c_str(), m_oldState->m_filePos);
+    delete m_oldState;
+    m_oldState = NULL;
+  }
 
-  if (m_oldState && m_oldState->Seek(nextPos))
+  if (m_oldState && !m_oldState->m_pending && m_oldState->Seek(nextPos))
   {
     CReadState *tmp = m_state;
     m_state = m_oldState;
     m_oldState = tmp;
+    m_seeksBuffered++;
     return nextPos;
   }
 
@@ -1189,6 +1274,7 @@ int64_t CCurlFile::Seek(int64_t iFilePosition, int iWhence)
   m_state->m_sendRange = true;
 
   long response = m_state->Connect(m_bufferSize);
+  m_connects++;
   if(response < 0 && (m_state->m_fileSize == 0 || m_state->m_fileSize != m_state->m_filePos))
   {
     m_seekable = false;
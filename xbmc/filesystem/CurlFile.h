@@ -58,7 +58,7 @@ namespace XFILE
       virtual int  Stat(const CURL& url, struct __stat64* buffer);
       virtual void Close();
       virtual bool ReadString(char *szLine, int iLineLength)     { return m_state->ReadString(szLine, iLineLength); }
-      virtual unsigned int Read(void* lpBuf, int64_t uiBufSize)  { return m_state->Read(lpBuf, uiBufSize); }
+      virtual unsigned int Read(void* lpBuf, int64_t uiBufSize);
       virtual int Write(const void* lpBuf, int64_t uiBufSize);
       virtual CStdString GetMimeType()                           { return m_state->m_httpheader.GetMimeType(); }
       virtual int IoControl(EIoControl request, void* param);
@@ -115,6 +115,7 @@ namespace XFILE
           bool            m_bFirstLoop;
           bool            m_isPaused;
           bool            m_sendRange;
+          bool            m_pending;          // started without waiting for the response, see Start()
 
           char*           m_readBuffer;
 
@@ -137,7 +138,11 @@ namespace XFILE
 
           void         SetResume(void);
           long         Connect(unsigned int size);
+          void         Start(unsigned int size);
+          long         Finish();
+          void         Pump();
           void         Disconnect();
+          int          GetKeepAlive() const;
       };
 
     protected:
@@ -146,10 +151,11 @@ namespace XFILE
       void SetRequestHeaders(CReadState* state);
       void SetCorrectHeaders(CReadState* state);
       bool Service(const CStdString& strURL, CStdString& strHTML);
+      void StartPrefetch(int64_t pos);
 
     protected:
       CReadState*     m_state;
-      CReadState*     m_oldState;
+      CReadState*     m_oldState;         // the state of the previous position, or of the prefetched end of the file
       unsigned int    m_bufferSize;
       int64_t         m_writeOffset;
 
@@ -191,5 +197,9 @@ namespace XFILE
       MAPHTTPHEADERS m_requestheaders;
 
       long            m_httpresponse;
+
+      unsigned int    m_connects;         // requests made since the file was opened
+      unsigned int    m_seeks;            // seeks to another position since the file was opened
+      unsigned int    m_seeksBuffered;    // of which were served without a new request
   };
 }
@@ -21,17 +21,27 @@
 #include "DirectoryCache.h"
 #include "FileItem.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
 #include "utils/log.h"
 #include "utils/URIUtils.h"
+#include "music/tags/MusicInfoTag.h"
+#include "video/VideoInfoTag.h"
+#include "pictures/PictureInfoTag.h"
 #include "climits"
 
 using namespace std;
 using namespace XFILE;
 
+// approximate memory we allow cached folders (other than DIR_CACHE_ALWAYS ones) to use
+static const size_t max_cache_size = 8 * 1024 * 1024;
+// listings of remote folders are considered stale after this time (ms)
+static const unsigned int remote_ttl = 5 * 60 * 1000;
+
 CDirectoryCache::CDir::CDir(DIR_CACHE_TYPE cacheType)
 {
   m_cacheType = cacheType;
-  m_lastAccess = 0;
+  m_size = 0;
+  m_expires = 0;
   m_Items = new CFileItemList;
   m_Items->SetFastLookup(true);
 }
@@ -41,22 +51,50 @@ CDirectoryCache::CDir::~CDir()
   delete m_Items;
 }
 
-void CDirectoryCache::CDir::SetLastAccess(unsigned int &accessCounter)
-{
-  m_lastAccess = accessCounter++;
-}
-
 CDirectoryCache::CDirectoryCache(void)
 {
-  m_accessCounter = 0;
-#ifdef _DEBUG
+  m_size = 0;
   m_cacheHits = 0;
   m_cacheMisses = 0;
-#endif
+  m_evictions = 0;
 }
 
 CDirectoryCache::~CDirectoryCache(void)
 {
+  Clear();
+}
+
+size_t CDirectoryCache::GetItemSize(const CFileItem &item)
+{
+  size_t size = sizeof(CFileItem) + sizeof(CFileItemPtr) + item.GetPath().size() +
+                item.GetLabel().size() + item.GetLabel2().size();
+  // the fast lookup map keeps a copy of the path as well
+  size += item.GetPath().size() + sizeof(CFileItemPtr) + 32;
+  if (item.HasMusicInfoTag())
+    size += sizeof(MUSIC_INFO::CMusicInfoTag);
+  if (item.HasVideoInfoTag())
+    size += sizeof(CVideoInfoTag);
+  if (item.HasPictureInfoTag())
+    size += sizeof(CPictureInfoTag);
+  return size;
+}
+
+CDirectoryCache::iCache CDirectoryCache::Find(const std::string &path)
+{
+  iCache i = m_cache.find(path);
+  if (i != m_cache.end() && i->second->m_expires &&
+      XbmcThreads::SystemClockMillis() - i->second->m_expires < UINT_MAX / 2)
+  { // remote listing has gone stale
+    Delete(i);
+    m_evictions++;
+    return m_cache.end();
+  }
+  return i;
+}
+
+void CDirectoryCache::Touch(CDir *dir)
+{
+  m_lru.splice(m_lru.begin(), m_lru, dir->m_lruPos);
 }
 
 bool CDirectoryCache::GetDirectory(const CStdString& strPath, CFileItemList &items, bool retrieveAll)
@@ -66,7 +104,7 @@ bool CDirectoryCache::GetDirectory(const CStdString& strPath, CFileItemList &ite
   CStdString storedPath = strPath;
   URIUtils::RemoveSlashAtEnd(storedPath);
 
-  ciCache i = m_cache.find(storedPath);
+  iCache i = Find(storedPath);
   if (i != m_cache.end())
   {
     CDir* dir = i->second;
@@ -74,13 +112,12 @@ bool CDirectoryCache::GetDirectory(const CStdString& strPath, CFileItemList &ite
        (dir->m_cacheType == XFILE::DIR_CACHE_ONCE && retrieveAll))
     {
       items.Copy(*dir->m_Items);
-      dir->SetLastAccess(m_accessCounter);
-#ifdef _DEBUG
-      m_cacheHits+=items.Size();
-#endif
+      Touch(dir);
+      m_cacheHits++;
       return true;
     }
   }
+  m_cacheMisses++;
   return false;
 }
 
@@ -107,12 +144,21 @@ void CDirectoryCache::SetDirectory(const CStdString& strPath, const CFileItemLis
 
   ClearDirectory(storedPath);
 
-  CheckIfFull();
+  size_t size = sizeof(CDir) + sizeof(CFileItemList) + storedPath.size() * 2;
+  for (int i = 0; i < items.Size(); i++)
+    size += GetItemSize(*items[i]);
+
+  if (cacheType != DIR_CACHE_ALWAYS)
+    CheckIfFull(size);
 
   CDir* dir = new CDir(cacheType);
   dir->m_Items->Copy(items);
-  dir->SetLastAccess(m_accessCounter);
-  m_cache.insert(pair<CStdString, CDir*>(storedPath, dir));
+  dir->m_size = size;
+  if (URIUtils::IsRemote(storedPath))
+    dir->m_expires = XbmcThreads::SystemClockMillis() + remote_ttl;
+  dir->m_lruPos = m_lru.insert(m_lru.begin(), storedPath);
+  m_cache.insert(make_pair(storedPath, dir));
+  m_size += size;
 }
 
 void CDirectoryCache::ClearFile(const CStdString& strFile)
@@ -142,8 +188,7 @@ void CDirectoryCache::ClearSubPaths(const CStdString& strPath)
   iCache i = m_cache.begin();
   while (i != m_cache.end())
   {
-    CStdString path = i->first;
-    if (strncmp(path.c_str(), storedPath.c_str(), storedPath.GetLength()) == 0)
+    if (strncmp(i->first.c_str(), storedPath.c_str(), storedPath.GetLength()) == 0)
       Delete(i++);
     else
       i++;
@@ -157,13 +202,16 @@ void CDirectoryCache::AddFile(const CStdString& strFile)
   CStdString strPath = URIUtils::GetDirectory(strFile);
   URIUtils::RemoveSlashAtEnd(strPath);
 
-  ciCache i = m_cache.find(strPath);
+  iCache i = Find(strPath);
   if (i != m_cache.end())
   {
     CDir *dir = i->second;
     CFileItemPtr item(new CFileItem(strFile, false));
     dir->m_Items->Add(item);
-    dir->SetLastAccess(m_accessCounter);
+    size_t size = GetItemSize(*item);
+    dir->m_size += size;
+    m_size += size;
+    Touch(dir);
   }
 }
 
@@ -177,20 +225,16 @@ bool CDirectoryCache::FileExists(const CStdString& strFile, bool& bInCache)
   CStdString storedPath = URIUtils::GetDirectory(strPath);
   URIUtils::RemoveSlashAtEnd(storedPath);
 
-  ciCache i = m_cache.find(storedPath);
+  iCache i = Find(storedPath);
   if (i != m_cache.end())
   {
     bInCache = true;
     CDir *dir = i->second;
-    dir->SetLastAccess(m_accessCounter);
-#ifdef _DEBUG
+    Touch(dir);
     m_cacheHits++;
-#endif
     return (strPath.Equals(storedPath) || dir->m_Items->Contains(strFile));
   }
-#ifdef _DEBUG
   m_cacheMisses++;
-#endif
   return false;
 }
 
@@ -228,51 +272,52 @@ void CDirectoryCache::ClearCache(set<CStdString>& dirs)
   }
 }
 
-void CDirectoryCache::CheckIfFull()
+void CDirectoryCache::CheckIfFull(size_t size)
 {
   CSingleLock lock (m_cs);
-  static const unsigned int max_cached_dirs = 10;
 
-  // find the last accessed folder, and remove if the number of cached folders is too many
-  iCache lastAccessed = m_cache.end();
-  unsigned int numCached = 0;
-  for (iCache i = m_cache.begin(); i != m_cache.end(); i++)
+  // drop the least recently used folders until the new one fits in our budget
+  // ensuring dirs that are always cached aren't cleared
+  LRUList::iterator i = m_lru.end();
+  while (m_size + size > max_cache_size && i != m_lru.begin())
   {
-    // ensure dirs that are always cached aren't cleared
-    if (i->second->m_cacheType != DIR_CACHE_ALWAYS)
-    {
-      if (lastAccessed == m_cache.end() || i->second->GetLastAccess() < lastAccessed->second->GetLastAccess())
-        lastAccessed = i;
-      numCached++;
-    }
+    --i;
+    iCache it = m_cache.find(*i);
+    if (it == m_cache.end() || it->second->m_cacheType == DIR_CACHE_ALWAYS)
+      continue;
+
+    LRUList::iterator next = i;
+    ++next;
+    Delete(it);
+    m_evictions++;
+    i = next;
   }
-  if (lastAccessed != m_cache.end() && numCached >= max_cached_dirs)
-    Delete(lastAccessed);
 }
 
 void CDirectoryCache::Delete(iCache it)
 {
   CDir* dir = it->second;
+  m_lru.erase(dir->m_lruPos);
+  m_size -= dir->m_size;
   delete dir;
   m_cache.erase(it);
 }
 
-#ifdef _DEBUG
+void CDirectoryCache::GetStats(unsigned int &hits, unsigned int &misses, unsigned int &evictions, size_t &size) const
+{
+  CSingleLock lock (m_cs);
+  hits = m_cacheHits;
+  misses = m_cacheMisses;
+  evictions = m_evictions;
+  size = m_size;
+}
+
 void CDirectoryCache::PrintStats() const
 {
   CSingleLock lock (m_cs);
-  CLog::Log(LOGDEBUG, "%s - total of %u cache hits, and %u cache misses", __FUNCTION__, m_cacheHits, m_cacheMisses);
-  // run through and find the oldest and the number of items cached
-  unsigned int oldest = UINT_MAX;
   unsigned int numItems = 0;
-  unsigned int numDirs = 0;
   for (ciCache i = m_cache.begin(); i != m_cache.end(); i++)
-  {
-    CDir *dir = i->second;
-    oldest = min(oldest, dir->GetLastAccess());
-    numItems += dir->m_Items->Size();
-    numDirs++;
-  }
-  CLog::Log(LOGDEBUG, "%s - %u folders cached, with %u items total.  Oldest is %u, current is %u", __FUNCTION__, numDirs, numItems, oldest, m_accessCounter);
+    numItems += i->second->m_Items->Size();
+  CLog::Log(LOGDEBUG, "%s - %u cache hits, %u cache misses, %u evictions. %u folders cached, with %u items using approximately %u kB",
+            __FUNCTION__, m_cacheHits, m_cacheMisses, m_evictions, (unsigned int)m_cache.size(), numItems, (unsigned int)(m_size / 1024));
 }
-#endif
@@ -23,8 +23,9 @@
 #include "Directory.h"
 #include "threads/CriticalSection.h"
 
-#include <map>
+#include <list>
 #include <set>
+#include <boost/unordered_map.hpp>
 
 class CFileItem;
 
@@ -32,19 +33,19 @@ namespace XFILE
 {
   class CDirectoryCache
   {
+    typedef std::list<std::string> LRUList;
+
     class CDir
     {
     public:
       CDir(DIR_CACHE_TYPE cacheType);
       virtual ~CDir();
 
-      void SetLastAccess(unsigned int &accessCounter);
-      unsigned int GetLastAccess() const { return m_lastAccess; };
-
       CFileItemList* m_Items;
       DIR_CACHE_TYPE m_cacheType;
-    private:
-      unsigned int m_lastAccess;
+      LRUList::iterator m_lruPos;  ///< position of this folder in the LRU list
+      size_t m_size;               ///< approximate memory footprint in bytes
+      unsigned int m_expires;      ///< time (in ms) after which this folder is stale, 0 if it never is
     };
   public:
     CDirectoryCache(void);
@@ -57,27 +58,43 @@ namespace XFILE
     void Clear();
     void AddFile(const CStdString& strFile);
     bool FileExists(const CStdString& strPath, bool& bInCache);
-#ifdef _DEBUG
+
+    /*! \brief Retrieve the cache statistics
+     \param hits number of lookups that were served from the cache
+     \param misses number of lookups that weren't
+     \param evictions number of folders dropped to stay within the memory budget or as they went stale
+     \param size approximate memory used by the cached folders in bytes
+     */
+    void GetStats(unsigned int &hits, unsigned int &misses, unsigned int &evictions, size_t &size) const;
     void PrintStats() const;
-#endif
+
+    /*! \brief Approximate the memory footprint of a cached item
+     */
+    static size_t GetItemSize(const CFileItem &item);
   protected:
     void InitCache(std::set<CStdString>& dirs);
     void ClearCache(std::set<CStdString>& dirs);
-    void CheckIfFull();
+    void CheckIfFull(size_t size);
 
-    std::map<CStdString, CDir*> m_cache;
-    typedef std::map<CStdString, CDir*>::iterator iCache;
-    typedef std::map<CStdString, CDir*>::const_iterator ciCache;
+    typedef boost::unordered_map<std::string, CDir*> CacheMap;
+    CacheMap m_cache;
+    typedef CacheMap::iterator iCache;
+    typedef CacheMap::const_iterator ciCache;
     void Delete(iCache i);
 
+    /*! \brief Find a folder in the cache, dropping it if it has gone stale
+     */
+    iCache Find(const std::string &path);
+    void Touch(CDir *dir);
+
     CCriticalSection m_cs;
 
-    unsigned int m_accessCounter;
+    LRUList m_lru;          ///< most recently used folders first
+    size_t m_size;
 
-#ifdef _DEBUG
     unsigned int m_cacheHits;
     unsigned int m_cacheMisses;
-#endif
+    unsigned int m_evictions;
   };
 }
 extern XFILE::CDirectoryCache g_directoryCache;
@@ -26,6 +26,7 @@
 #include "utils/TimeUtils.h"
 
 #include <assert.h>
+#include <algorithm>
 
 using namespace XCURL;
 
@@ -96,7 +97,13 @@ void DllLibCurlGlobal::CheckIdle()
   VEC_CURLSESSIONS::iterator it = m_sessions.begin();
   while(it != m_sessions.end())
   {
-    if( !it->m_busy && (XbmcThreads::SystemClockMillis() - it->m_idletimestamp) > idletime )
+    // there's little point keeping a session around much longer than the server keeps its
+    // connection, though the handle itself is still of use for a request following shortly
+    unsigned int timeout = idletime;
+    if (it->m_keepAlive >= 0 && (unsigned int)it->m_keepAlive < timeout)
+      timeout = std::max((unsigned int)it->m_keepAlive, 5000U);
+
+    if( !it->m_busy && (XbmcThreads::SystemClockMillis() - it->m_idletimestamp) > timeout )
     {
       CLog::Log(LOGINFO, "%s - Closing session to %s://%s (easy=%p, multi=%p)\n", __FUNCTION__, it->m_protocol.c_str(), it->m_hostname.c_str(), (void*)it->m_easy, (void*)it->m_multi);
 
@@ -128,39 +135,52 @@ void DllLibCurlGlobal::easy_aquire(const char *protocol, const char *hostname, C
 
   CSingleLock lock(m_critSection);
 
+  /* allow reuse of requester is trying to connect to same host */
+  /* curl will take care of any differences in username/password */
+  /* prefer sessions whose connection the server still keeps open, then the most recently used */
+  unsigned int now = XbmcThreads::SystemClockMillis();
+  VEC_CURLSESSIONS::iterator best = m_sessions.end();
+  bool bestAlive = false;
   VEC_CURLSESSIONS::iterator it;
   for(it = m_sessions.begin(); it != m_sessions.end(); it++)
   {
-    if( !it->m_busy )
+    if( it->m_busy || it->m_protocol.compare(protocol) != 0 || it->m_hostname.compare(hostname) != 0 )
+      continue;
+
+    bool alive = it->m_keepAlive < 0 || now - it->m_idletimestamp < (unsigned int)it->m_keepAlive;
+    if( best == m_sessions.end() || (alive && !bestAlive) ||
+       (alive == bestAlive && it->m_idletimestamp > best->m_idletimestamp) )
     {
-      /* allow reuse of requester is trying to connect to same host */
-      /* curl will take care of any differences in username/password */
-      if( it->m_protocol.compare(protocol) == 0 && it->m_hostname.compare(hostname) == 0)
-      {
-        it->m_busy = true;
-        if(easy_handle)
-        {
-          if(!it->m_easy)
-            it->m_easy = easy_init();
-
-          *easy_handle = it->m_easy;
-        }
-
-        if(multi_handle)
-        {
-          if(!it->m_multi)
-            it->m_multi = multi_init();
-
-          *multi_handle = it->m_multi;
-        }
-
-        return;
-      }
+      best = it;
+      bestAlive = alive;
     }
   }
 
+  if( best != m_sessions.end() )
+  {
+    best->m_busy = true;
+    if(easy_handle)
+    {
+      if(!best->m_easy)
+        best->m_easy = easy_init();
+
+      *easy_handle = best->m_easy;
+    }
+
+    if(multi_handle)
+    {
+      if(!best->m_multi)
+        best->m_multi = multi_init();
+
+      *multi_handle = best->m_multi;
+    }
+
+    return;
+  }
+
   SSession session = {};
   session.m_busy = true;
+  session.m_keepAlive = -1;
   session.m_protocol = protocol;
   session.m_hostname = hostname;
 
@@ -188,7 +208,7 @@ void DllLibCurlGlobal::easy_aquire(const char *protocol, const char *hostname, C
 
 }
 
-void DllLibCurlGlobal::easy_release(CURL_HANDLE** easy_handle, CURLM** multi_handle)
+void DllLibCurlGlobal::easy_release(CURL_HANDLE** easy_handle, CURLM** multi_handle, int keepAlive)
 {
   CSingleLock lock(m_critSection);
 
@@ -217,6 +237,7 @@ void DllLibCurlGlobal::easy_release(CURL_HANDLE** easy_handle, CURLM** multi_han
       easy_reset(easy);
       it->m_busy = false;
       it->m_idletimestamp = XbmcThreads::SystemClockMillis();
+      it->m_keepAlive = keepAlive;
       return;
     }
   }
@@ -110,7 +110,10 @@ namespace XCURL
   public:
     /* extend interface with buffered functions */
     void easy_aquire(const char *protocol, const char *hostname, CURL_HANDLE** easy_handle, CURLM** multi_handle);
-    void easy_release(CURL_HANDLE** easy_handle, CURLM** multi_handle);
+    /*! \brief Hand a session back for reuse
+     \param keepAlive milliseconds the server keeps the connection open while idle, 0 if it closed it, -1 if unknown
+     */
+    void easy_release(CURL_HANDLE** easy_handle, CURLM** multi_handle, int keepAlive = -1);
     void easy_duplicate(CURL_HANDLE* easy, CURLM* multi, CURL_HANDLE** easy_out, CURLM** multi_out);
     CURL_HANDLE* easy_duphandle(CURL_HANDLE* easy_handle);
     void CheckIdle();
@@ -123,6 +126,7 @@ namespace XCURL
     typedef struct SSession
     {
       unsigned int  m_idletimestamp;  // timestamp of when this object when idle
+      int           m_keepAlive;      // ms the server keeps the idle connection open, 0 if closed, -1 if unknown
       CStdString    m_protocol;
       CStdString    m_hostname;
       bool          m_busy;
@@ -23,6 +23,7 @@
 #include "File.h"
 #include "IFile.h"
 #include "FileFactory.h"
+#include "FileReadAhead.h"
 #include "Application.h"
 #include "DirectoryCache.h"
 #include "Directory.h"
@@ -32,6 +33,11 @@
 #include "utils/BitstreamStats.h"
 #include "Util.h"
 #include "URL.h"
+#if defined(TARGET_LINUX)
+#include "SpecialProtocol.h"
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#endif
 
 #include "commons/Exception.h"
 
@@ -67,14 +73,88 @@ CFile::~CFile()
 
 //*********************************************************************************************
 
-class CAutoBuffer
+// copies are read ahead into a ring of buffers while the previous ones are written
+#define COPY_BUFFER_SIZE  (512 * 1024)
+#define COPY_BUFFERS      4
+
+// report progress (and give the user the chance to cancel) twice a second
+static bool CopyProgress(XFILE::IFileCallback* pCallback, void* pContext, CStopWatch &timer, float &start, uint64_t llPos, uint64_t llFileSize)
+{
+  g_application.ResetScreenSaver();
+
+  float end = timer.GetElapsedSeconds();
+  if (pCallback && end - start > 0.5 && end)
+  {
+    start = end;
+
+    float averageSpeed = llPos / end;
+    int ipercent = 0;
+    if(llFileSize)
+      ipercent = 100 * llPos / llFileSize;
+
+    if(!pCallback->OnFileCallback(pContext, ipercent, averageSpeed))
+    {
+      CLog::Log(LOGERROR, "%s - User aborted copy", __FUNCTION__);
+      return false;
+    }
+  }
+  return true;
+}
+
+#if defined(TARGET_LINUX)
+/*! \brief Copy between two local files inside the kernel, without going through user space
+ \return the bytes copied, or -1 if the files can't be copied this way and should be copied normally
+ */
+static int64_t CopyLocal(const CStdString& strFileName, const CStdString& strDest, uint64_t llFileSize, XFILE::IFileCallback* pCallback, void* pContext, bool &bError)
 {
-  char* p;
-public:
-  explicit CAutoBuffer(size_t s) { p = (char*)malloc(s); }
-  ~CAutoBuffer() { free(p); }
-  char* get() { return p; }
-};
+  bError = false;
+  int in = open(CSpecialProtocol::TranslatePath(strFileName).c_str(), O_RDONLY);
+  if (in < 0)
+    return -1;
+  int out = open(CSpecialProtocol::TranslatePath(strDest).c_str(), O_WRONLY | O_TRUNC);
+  if (out < 0)
+  {
+    close(in);
+    return -1;
+  }
+#if defined(HAVE_POSIX_FADVISE)
+  posix_fadvise(in, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+  CStopWatch timer;
+  timer.StartZero();
+  float start = 0.0f;
+  int64_t llPos = 0;
+  while (true)
+  {
+    ssize_t copied = sendfile(out, in, NULL, 8 * 1024 * 1024);
+    if (copied == 0)
+      break;
+    if (copied < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      if (llPos == 0 && (errno == EINVAL || errno == ENOSYS))
+        llPos = -1; // not supported between these files
+      else
+      {
+        CLog::Log(LOGERROR, "%s - Failed to copy %s to %s (%s)", __FUNCTION__, strFileName.c_str(), strDest.c_str(), strerror(errno));
+        bError = true;
+      }
+      break;
+    }
+    llPos += copied;
+    if (!CopyProgress(pCallback, pContext, timer, start, llPos, llFileSize))
+    {
+      bError = true;
+      break;
+    }
+  }
+  close(out);
+  close(in);
+  return llPos;
+}
+#endif
 
 // This *looks* like a copy function, therefor the name "Cache" is misleading
 bool CFile::Cache(const CStdString& strFileName, const CStdString& strDest, XFILE::IFileCallback* pCallback, void* pContext)
@@ -130,64 +210,67 @@ bool CFile::Cache(const CStdString& strFileName, const CStdString& strDest, XFIL
       return false;
     }
 
-    int iBufferSize = 128 * 1024;
-
-    CAutoBuffer buffer(iBufferSize);
-    int iRead, iWrite;
-
     UINT64 llFileSize = file.GetLength();
     UINT64 llPos = 0;
+    bool bCopied = false;
 
-    CStopWatch timer;
-    timer.StartZero();
-    float start = 0.0f;
-    while (true)
+#if defined(TARGET_LINUX)
+    if (URIUtils::IsHD(strFileName) && URIUtils::IsHD(strDest))
     {
-      g_application.ResetScreenSaver();
-
-      iRead = file.Read(buffer.get(), iBufferSize);
-      if (iRead == 0) break;
-      else if (iRead < 0)
-      {
-        CLog::Log(LOGERROR, "%s - Failed read from file %s", __FUNCTION__, strFileName.c_str());
+      bool bError;
+      int64_t copied = CopyLocal(strFileName, strDest, llFileSize, pCallback, pContext, bError);
+      if (bError)
         llFileSize = (uint64_t)-1;
-        break;
-      }
-
-      /* write data and make sure we managed to write it all */
-      iWrite = 0;
-      while(iWrite < iRead)
+      if (copied >= 0)
       {
-        int iWrite2 = newFile.Write(buffer.get()+iWrite, iRead-iWrite);
-        if(iWrite2 <=0)
-          break;
-        iWrite+=iWrite2;
+        llPos = copied;
+        bCopied = true;
       }
+    }
+#endif
 
-      if (iWrite != iRead)
+    if (!bCopied)
+    {
+      // files that fit in a single buffer aren't worth a read ahead thread
+      CFileReadAhead reader(file, COPY_BUFFER_SIZE, llFileSize > COPY_BUFFER_SIZE ? COPY_BUFFERS : 1);
+      const char *buffer;
+      int iRead, iWrite;
+
+      CStopWatch timer;
+      timer.StartZero();
+      float start = 0.0f;
+      while (true)
       {
-        CLog::Log(LOGERROR, "%s - Failed write to file %s", __FUNCTION__, strDest.c_str());
-        llFileSize = (uint64_t)-1;
-        break;
-      }
-
-      llPos += iRead;
+        iRead = reader.Next(buffer);
+        if (iRead == 0) break;
+        else if (iRead < 0)
+        {
+          CLog::Log(LOGERROR, "%s - Failed read from file %s", __FUNCTION__, strFileName.c_str());
+          llFileSize = (uint64_t)-1;
+          break;
+        }
 
-      // calculate the current and average speeds
-      float end = timer.GetElapsedSeconds();
+        /* write data and make sure we managed to write it all */
+        iWrite = 0;
+        while(iWrite < iRead)
+        {
+          int iWrite2 = newFile.Write(buffer+iWrite, iRead-iWrite);
+          if(iWrite2 <=0)
+            break;
+          iWrite+=iWrite2;
+        }
 
-      if (pCallback && end - start > 0.5 && end)
-      {
-        start = end;
+        if (iWrite != iRead)
+        {
+          CLog::Log(LOGERROR, "%s - Failed write to file %s", __FUNCTION__, strDest.c_str());
+          llFileSize = (uint64_t)-1;
+          break;
+        }
 
-        float averageSpeed = llPos / end;
-        int ipercent = 0;
-        if(llFileSize)
-          ipercent = 100 * llPos / llFileSize;
+        llPos += iRead;
 
-        if(!pCallback->OnFileCallback(pContext, ipercent, averageSpeed))
+        if (!CopyProgress(pCallback, pContext, timer, start, llPos, llFileSize))
         {
-          CLog::Log(LOGERROR, "%s - User aborted copy", __FUNCTION__);
           llFileSize = (uint64_t)-1;
           break;
         }
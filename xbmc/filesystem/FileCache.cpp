@@ -26,6 +26,7 @@
 #include "URL.h"
 
 #include "CircularCache.h"
+#include "BlockCache.h"
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 #include "utils/TimeUtils.h"
@@ -35,6 +36,8 @@ using namespace AUTOPTR;
 using namespace XFILE;
 
 #define READ_CACHE_CHUNK_SIZE (64*1024)
+// size of the block cache spill file relative to the memory buffer
+#define BLOCK_CACHE_SPILL_FACTOR 4
 
 class CWriteRate
 {
@@ -87,6 +90,12 @@ CFileCache::CFileCache(bool useDoubleCache) : CThread("FileCache")
    m_writePos = 0;
    if (g_advancedSettings.m_cacheMemBufferSize == 0)
      m_pCache = new CSimpleFileCache();
+   else if (g_advancedSettings.m_cacheBlocks)
+   {
+     // keeps any number of regions cached by itself, so no need for a double cache
+     m_pCache = new CBlockCache(g_advancedSettings.m_cacheMemBufferSize, (size_t)g_advancedSettings.m_cacheMemBufferSize * BLOCK_CACHE_SPILL_FACTOR);
+     useDoubleCache = false;
+   }
    else
    {
      size_t front = g_advancedSettings.m_cacheMemBufferSize;
@@ -0,0 +1,101 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "FileReadAhead.h"
+#include "File.h"
+#include "threads/SingleLock.h"
+
+using namespace XFILE;
+
+CFileReadAhead::CFileReadAhead(CFile &file, unsigned int bufferSize, unsigned int buffers)
+  : CThread("FileReadAhead"), m_file(file), m_bufferSize(bufferSize)
+{
+  if (buffers < 1)
+    buffers = 1;
+  m_data.resize(bufferSize * buffers);
+  m_sizes.resize(buffers, 0);
+  m_readCount = 0;
+  m_nextCount = 0;
+  m_threaded = buffers > 1;
+  if (m_threaded)
+    Create();
+}
+
+CFileReadAhead::~CFileReadAhead()
+{
+  if (m_threaded)
+    StopThread(true);
+}
+
+int CFileReadAhead::Next(const char *&data)
+{
+  if (!m_threaded)
+  {
+    data = &m_data[0];
+    return m_file.Read(&m_data[0], m_bufferSize);
+  }
+
+  CSingleLock lock(m_section);
+  if (m_nextCount > 0 && m_sizes[(m_nextCount - 1) % m_sizes.size()] <= 0)
+    return m_sizes[(m_nextCount - 1) % m_sizes.size()]; // already at the end
+
+  // the previous chunk is free to be read into again
+  m_released.Set();
+  while (m_readCount == m_nextCount)
+  {
+    lock.Leave();
+    m_read.Wait();
+    lock.Enter();
+  }
+
+  int size = m_sizes[m_nextCount % m_sizes.size()];
+  data = Buffer(m_nextCount);
+  m_nextCount++;
+  return size;
+}
+
+void CFileReadAhead::Process()
+{
+  while (!m_bStop)
+  {
+    CSingleLock lock(m_section);
+    // chunks read but not yet handed out, plus the one last handed out, which is still in use
+    unsigned int used = m_readCount - m_nextCount + (m_nextCount > 0 ? 1 : 0);
+    if (used >= m_sizes.size())
+    {
+      lock.Leave();
+      AbortableWait(m_released);
+      continue;
+    }
+    unsigned int chunk = m_readCount;
+    lock.Leave();
+
+    int size = m_file.Read(Buffer(chunk), m_bufferSize);
+
+    lock.Enter();
+    m_sizes[chunk % m_sizes.size()] = size < 0 ? -1 : size;
+    m_readCount++;
+    lock.Leave();
+    m_read.Set();
+
+    if (size <= 0)
+      break;
+  }
+}
@@ -0,0 +1,74 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/Thread.h"
+
+#include <vector>
+
+namespace XFILE
+{
+  class CFile;
+
+  /*!
+   \brief Reads a file sequentially on its own thread into a ring of buffers
+
+   Lets the consumer of the data (such as the writer of a copy) work while the next chunks
+   are being read, so neither side waits on the other as long as the ring doesn't run full
+   or empty. With a single buffer the file is read on the consumer's thread instead.
+   */
+  class CFileReadAhead : protected CThread
+  {
+  public:
+    /*!
+     \param file the opened file to read from its current position
+     \param bufferSize size of each buffer
+     \param buffers number of buffers in the ring
+     */
+    CFileReadAhead(CFile &file, unsigned int bufferSize, unsigned int buffers);
+    virtual ~CFileReadAhead();
+
+    /*! \brief Get the next chunk of the file, waiting for it to be read if needed
+     The previous chunk is handed back to be read into.
+     \param data [out] the chunk, valid until the next call
+     \return the size of the chunk, 0 at the end of the file, -1 on error
+     */
+    int Next(const char *&data);
+
+  protected:
+    virtual void Process();
+
+  private:
+    char *Buffer(unsigned int chunk) { return &m_data[(chunk % m_sizes.size()) * m_bufferSize]; }
+
+    CFile               &m_file;
+    unsigned int         m_bufferSize;
+    std::vector<char>    m_data;
+    std::vector<int>     m_sizes;      ///< bytes read into each buffer
+    CCriticalSection     m_section;
+    CEvent               m_read;       ///< set when a chunk has been read
+    CEvent               m_released;   ///< set when a chunk has been handed back
+    unsigned int         m_readCount;  ///< chunks read so far
+    unsigned int         m_nextCount;  ///< chunks handed out by Next() so far
+    bool                 m_threaded;
+  };
+}
@@ -31,13 +31,18 @@
 #include "utils/URIUtils.h"
 #include "network/DNSNameCache.h"
 #include "threads/SystemClock.h"
+#include "settings/AdvancedSettings.h"
 
 #include <nfsc/libnfs-raw-mount.h>
 
 #ifdef TARGET_WINDOWS
 #include <fcntl.h>
 #include <sys\stat.h>
+#else
+#include <poll.h>
 #endif
+#include <algorithm>
+#include <limits.h>
 
 //KEEP_ALIVE_TIMEOUT is decremented every half a second
 //360 * 0.5s == 180s == 3mins
@@ -53,6 +58,9 @@
 #define CONTEXT_NEW      1    //new context created
 #define CONTEXT_CACHED   2    //context cached and therefore already mounted (no new mount needed)
 
+//give up on a read ahead reply after 30s, as the sync calls of libnfs do
+#define READAHEAD_TIMEOUT 30000
+
 using namespace XFILE;
 
 CNfsConnection::CNfsConnection()
@@ -460,10 +468,212 @@ void CNfsConnection::AddIdleConnection()
 
 CNfsConnection gNfsConnection;
 
+CNFSReadAhead::CNFSReadAhead(DllLibNfsInterface *lib, struct nfs_context *context, struct nfsfh *fileHandle, uint64_t fileSize, unsigned int chunkSize, unsigned int depth)
+: m_lib(lib)
+, m_context(context)
+, m_fileHandle(fileHandle)
+, m_fileSize(fileSize)
+, m_chunkSize(chunkSize)
+, m_depth(depth)
+, m_nextOffset(0)
+{
+}
+
+CNFSReadAhead::~CNFSReadAhead()
+{
+  Clear();
+
+  // the replies still to come refer to the file handle, so must arrive before it's closed
+  XbmcThreads::EndTime timeout(READAHEAD_TIMEOUT);
+  while (!m_dropped.empty())
+  {
+    Request *request = m_dropped.front();
+    m_dropped.pop_front();
+    if (timeout.IsTimePast() || !Wait(request))
+    {
+      CLog::Log(LOGERROR, "NFS: Gave up waiting for read ahead replies");
+      request->owner = NULL;
+      for (std::list<Request *>::iterator i = m_dropped.begin(); i != m_dropped.end(); ++i)
+        (*i)->owner = NULL;
+      m_dropped.clear();
+      break;
+    }
+    delete request;
+  }
+
+  for (std::vector<Request *>::iterator i = m_spare.begin(); i != m_spare.end(); ++i)
+    delete *i;
+}
+
+void CNFSReadAhead::ReadCallback(int err, struct nfs_context *nfs, void *data, void *private_data)
+{
+  Request *request = (Request *)private_data;
+  if (request->owner == NULL)
+  {
+    delete request;
+    return;
+  }
+
+  request->result = err;
+  if (err > 0)
+  {
+    if ((unsigned int)err > request->size)
+      request->result = request->size;
+    memcpy(&request->data[0], data, request->result);
+  }
+  request->done = true;
+}
+
+void CNFSReadAhead::Fill()
+{
+  // reuse the dropped requests that have completed since
+  for (std::list<Request *>::iterator i = m_dropped.begin(); i != m_dropped.end();)
+  {
+    if ((*i)->done)
+    {
+      m_spare.push_back(*i);
+      i = m_dropped.erase(i);
+    }
+    else
+      ++i;
+  }
+
+  // read past the end of the file only one chunk at a time, in case it has grown
+  while (m_requests.size() < m_depth && (m_nextOffset < m_fileSize || m_requests.empty()))
+  {
+    Request *request;
+    if (m_spare.empty())
+    {
+      request = new Request;
+      request->data.resize(m_chunkSize);
+    }
+    else
+    {
+      request = m_spare.back();
+      m_spare.pop_back();
+    }
+    request->owner = this;
+    request->offset = m_nextOffset;
+    request->size = m_chunkSize;
+    request->result = 0;
+    request->done = false;
+
+    if (m_lib->nfs_pread_async(m_context, m_fileHandle, request->offset, request->size, ReadCallback, request) != 0)
+    {
+      CLog::Log(LOGERROR, "NFS: Failed to start read ahead at %"PRIu64" (%s)", request->offset, m_lib->nfs_get_error(m_context));
+      m_spare.push_back(request);
+      break;
+    }
+    m_requests.push_back(request);
+    m_nextOffset += request->size;
+  }
+}
+
+void CNFSReadAhead::Drop(Request *request)
+{
+  if (request->done)
+    m_spare.push_back(request);
+  else
+    m_dropped.push_back(request);
+}
+
+void CNFSReadAhead::Clear()
+{
+  while (!m_requests.empty())
+  {
+    Drop(m_requests.front());
+    m_requests.pop_front();
+  }
+}
+
+bool CNFSReadAhead::Wait(Request *request)
+{
+#ifdef TARGET_POSIX
+  XbmcThreads::EndTime timeout(READAHEAD_TIMEOUT);
+  while (!request->done)
+  {
+    struct pollfd pfd;
+    pfd.fd = m_lib->nfs_get_fd(m_context);
+    pfd.events = m_lib->nfs_which_events(m_context);
+    pfd.revents = 0;
+
+    if (poll(&pfd, 1, 100) < 0 && errno != EINTR)
+      return false;
+    // also called without events, so libnfs can time out requests
+    if (m_lib->nfs_service(m_context, pfd.revents) < 0)
+      return false;
+    if (!request->done && timeout.IsTimePast())
+      return false;
+  }
+  return true;
+#else
+  return request->done;
+#endif
+}
+
+int CNFSReadAhead::Read(uint64_t position, char *buffer, unsigned int size)
+{
+  // drop what was read ahead of an earlier position
+  while (!m_requests.empty() && position >= m_requests.front()->offset + m_requests.front()->size)
+  {
+    Drop(m_requests.front());
+    m_requests.pop_front();
+  }
+  // or start over after a seek backwards
+  if (!m_requests.empty() && position < m_requests.front()->offset)
+    Clear();
+  if (m_requests.empty())
+    m_nextOffset = position;
+
+  Fill();
+  if (m_requests.empty())
+    return -1;
+
+  if (!Wait(m_requests.front()))
+  {
+    CLog::Log(LOGERROR, "NFS: Failed waiting for read at %"PRIu64" (%s)", position, m_lib->nfs_get_error(m_context));
+    Clear();
+    return -1;
+  }
+  if (m_requests.front()->result < 0)
+  {
+    CLog::Log(LOGERROR, "NFS: Failed to read at %"PRIu64" (%s)", position, m_lib->nfs_get_error(m_context));
+    Clear();
+    return -1;
+  }
+
+  // hand back as much as has arrived in order, without waiting for more
+  unsigned int copied = 0;
+  while (copied < size && !m_requests.empty() && m_requests.front()->done && m_requests.front()->result >= 0)
+  {
+    Request *request = m_requests.front();
+    unsigned int skip = (unsigned int)(position + copied - request->offset);
+    unsigned int count = std::min(size - copied, request->result > (int)skip ? request->result - skip : 0);
+    memcpy(buffer + copied, &request->data[skip], count);
+    copied += count;
+
+    if (skip + count == request->size)
+    {
+      m_requests.pop_front();
+      m_spare.push_back(request);
+      Fill();
+    }
+    else if (skip + count >= (unsigned int)request->result)
+    {
+      // a short read is the end of the file, or the file has changed, so anything read
+      // ahead of it is of no use. Start over from here on the next read.
+      Clear();
+      break;
+    }
+  }
+  return copied;
+}
+
 CNFSFile::CNFSFile()
 : m_fileSize(0)
 , m_pFileHandle(NULL)
 , m_pNfsContext(NULL)
+, m_pReadAhead(NULL)
 {
   gNfsConnection.AddActiveConnection();
 }
@@ -542,6 +752,12 @@ bool CNFSFile::Open(const CURL& url)
   }
   
   m_fileSize = tmpBuffer.st_size;//cache the size of this file
+
+#ifdef TARGET_POSIX
+  if (g_advancedSettings.m_nfsReadAhead > 1)
+    m_pReadAhead = new CNFSReadAhead(gNfsConnection.GetImpl(), m_pNfsContext, m_pFileHandle, m_fileSize,
+                                     (unsigned int)gNfsConnection.GetMaxReadChunkSize(), g_advancedSettings.m_nfsReadAhead);
+#endif
   // We've successfully opened the file!
   return true;
 }
@@ -606,7 +822,18 @@ unsigned int CNFSFile::Read(void *lpBuf, int64_t uiBufSize)
   
   if (m_pFileHandle == NULL || m_pNfsContext == NULL ) return 0;
 
-  numberOfBytesRead = gNfsConnection.GetImpl()->nfs_read(m_pNfsContext, m_pFileHandle, uiBufSize, (char *)lpBuf);  
+  if (m_pReadAhead)
+  {
+    //the reads ahead don't move the position of the file handle, so move it along here
+    uint64_t offset = 0;
+    numberOfBytesRead = gNfsConnection.GetImpl()->nfs_lseek(m_pNfsContext, m_pFileHandle, 0, SEEK_CUR, &offset);
+    if (numberOfBytesRead >= 0)
+      numberOfBytesRead = m_pReadAhead->Read(offset, (char *)lpBuf, (unsigned int)std::min(uiBufSize, (int64_t)INT_MAX));
+    if (numberOfBytesRead > 0)
+      gNfsConnection.GetImpl()->nfs_lseek(m_pNfsContext, m_pFileHandle, offset + numberOfBytesRead, SEEK_SET, &offset);
+  }
+  else
+    numberOfBytesRead = gNfsConnection.GetImpl()->nfs_read(m_pNfsContext, m_pFileHandle, uiBufSize, (char *)lpBuf);  
 
   lock.Leave();//no need to keep the connection lock after that
   
@@ -667,6 +894,8 @@ void CNFSFile::Close()
     // remove it from keep alive list before closing
     // so keep alive code doens't process it anymore
     gNfsConnection.removeFromKeepAliveList(m_pFileHandle);
+    delete m_pReadAhead;
+    m_pReadAhead = NULL;
     ret = gNfsConnection.GetImpl()->nfs_close(m_pNfsContext, m_pFileHandle);
         
 	  if (ret < 0) 
@@ -28,6 +28,8 @@
 #include <list>
 #include "SectionLoader.h"
 #include <map>
+#include <deque>
+#include <vector>
 
 #ifdef TARGET_WINDOWS
 #define S_IRGRP 0
@@ -46,6 +48,7 @@
 #endif
 
 class DllLibNfs;
+class DllLibNfsInterface;
 
 class CNfsConnection : public CCriticalSection
 {     
@@ -125,6 +128,72 @@ extern CNfsConnection gNfsConnection;
 
 namespace XFILE
 {
+  /*!
+   \brief Keeps several asynchronous reads of a file in flight and hands their data back in order
+
+   A single synchronous read is bounded by the round trip to the server, which on high latency
+   links is too slow for high bitrate files. Instead up to depth reads of a chunk each are kept
+   outstanding ahead of the read position, so the server streams replies back to back. Replies
+   may arrive in any order; they are only handed back in the order of the file.
+
+   Reads that were issued but aren't needed anymore (after a seek) are left to complete and
+   then dropped. The caller must hold the connection lock for all calls, as the context is
+   serviced while waiting.
+   */
+  class CNFSReadAhead
+  {
+  public:
+    /*!
+     \param lib the library, or a stand-in implementing its interface
+     \param context the context the file was opened on
+     \param fileHandle the file to read
+     \param fileSize size of the file when it was opened. Reads past it are still tried one at a time, as the file may grow
+     \param chunkSize size of each read, at most the maximum read size of the server
+     \param depth number of reads kept in flight
+     */
+    CNFSReadAhead(DllLibNfsInterface *lib, struct nfs_context *context, struct nfsfh *fileHandle, uint64_t fileSize, unsigned int chunkSize, unsigned int depth);
+
+    /*! \brief Waits for the outstanding reads, which refer to the file handle, so it can be closed afterwards
+     */
+    ~CNFSReadAhead();
+
+    /*! \brief Read from the file, starting further reads ahead of it
+     \param position the position to read from
+     \param buffer buffer to read into
+     \param size maximum number of bytes to read
+     \return the number of bytes read, 0 at the end of the file, -1 on error
+     */
+    int Read(uint64_t position, char *buffer, unsigned int size);
+
+  private:
+    struct Request
+    {
+      CNFSReadAhead    *owner;   ///< NULL if the request deletes itself once completed
+      uint64_t          offset;
+      unsigned int      size;
+      int               result;  ///< bytes read, or a negative error
+      bool              done;
+      std::vector<char> data;
+    };
+
+    static void ReadCallback(int err, struct nfs_context *nfs, void *data, void *private_data);
+    void Fill();
+    void Drop(Request *request);
+    void Clear();
+    bool Wait(Request *request);
+
+    DllLibNfsInterface    *m_lib;
+    struct nfs_context    *m_context;
+    struct nfsfh          *m_fileHandle;
+    uint64_t               m_fileSize;
+    unsigned int           m_chunkSize;
+    unsigned int           m_depth;
+    uint64_t               m_nextOffset;  ///< offset of the next read to issue
+    std::deque<Request *>  m_requests;    ///< in the order of the file
+    std::list<Request *>   m_dropped;     ///< no longer needed but not completed yet
+    std::vector<Request *> m_spare;       ///< completed requests to reuse, with their buffers
+  };
+
   class CNFSFile : public IFile
   {
   public:
@@ -157,6 +226,7 @@ namespace XFILE
     struct nfsfh  *m_pFileHandle;
     struct nfs_context *m_pNfsContext;//current nfs context
     std::string m_exportPath;
+    CNFSReadAhead *m_pReadAhead;//NULL if reads are synchronous
   };
 }
 #endif // FILENFS_H_
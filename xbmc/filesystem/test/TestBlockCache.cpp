@@ -0,0 +1,180 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/BlockCache.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace XFILE;
+
+static const int64_t BlockSize = CBlockCache::BlockSize;
+
+static char Pattern(int64_t pos)
+{
+  return (char)(pos * 7 + pos / 1000);
+}
+
+/* feeds the cache from its write position as CFileCache would, reading
+   back and checking everything from the read position up to end */
+static bool Stream(CBlockCache &cache, int64_t pos, int64_t end)
+{
+  std::vector<char> buf(100000);
+  int64_t written = cache.CachedDataEndPos();
+  while (pos < end)
+  {
+    size_t len = (size_t)std::min<int64_t>(buf.size(), end - written);
+    for (size_t i = 0; i < len; i++)
+      buf[i] = Pattern(written + i);
+    if (len)
+    {
+      int rc = cache.WriteToCache(&buf[0], len);
+      if (rc < 0)
+        return false;
+      written += rc;
+    }
+
+    int rc = cache.ReadFromCache(&buf[0], (size_t)std::min<int64_t>(buf.size(), end - pos));
+    if (rc == CACHE_RC_WOULD_BLOCK)
+      continue;
+    if (rc <= 0)
+      return false;
+    for (int i = 0; i < rc; i++, pos++)
+    {
+      if (buf[i] != Pattern(pos))
+        return false;
+    }
+  }
+  return true;
+}
+
+/* reads what is already cached from pos up to end and checks it */
+static bool Verify(CBlockCache &cache, int64_t pos, int64_t end)
+{
+  std::vector<char> buf(100000);
+  while (pos < end)
+  {
+    int rc = cache.ReadFromCache(&buf[0], (size_t)std::min<int64_t>(buf.size(), end - pos));
+    if (rc <= 0)
+      return false;
+    for (int i = 0; i < rc; i++, pos++)
+    {
+      if (buf[i] != Pattern(pos))
+        return false;
+    }
+  }
+  return true;
+}
+
+TEST(TestBlockCache, SeekHeadTailMiddle)
+{
+  CBlockCache cache(4 * BlockSize, 16 * BlockSize);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+
+  // the header
+  ASSERT_TRUE(Stream(cache, 0, 2 * BlockSize));
+
+  // an index at the tail, the source restarts there as nothing is cached
+  int64_t tail = 10 * BlockSize + 123;
+  EXPECT_FALSE(cache.IsCachedPosition(tail));
+  EXPECT_EQ(tail, cache.CachedDataEndPosIfSeekTo(tail));
+  cache.Reset(tail, false);
+  EXPECT_EQ(tail, cache.CachedDataEndPos());
+  ASSERT_TRUE(Stream(cache, tail, tail + 2 * BlockSize));
+
+  // back to the header, now partly spilled, the source continues after it
+  EXPECT_TRUE(cache.IsCachedPosition(0));
+  EXPECT_EQ(2 * BlockSize, cache.CachedDataEndPosIfSeekTo(0));
+  cache.Reset(0, false);
+  EXPECT_EQ(2 * BlockSize, cache.CachedDataEndPos());
+  EXPECT_TRUE(Verify(cache, 0, 1000));
+  EXPECT_EQ(BlockSize + 10, cache.Seek(BlockSize + 10));
+  EXPECT_TRUE(Verify(cache, BlockSize + 10, 2 * BlockSize));
+  EXPECT_EQ(5, cache.Seek(5));
+  EXPECT_TRUE(Stream(cache, 5, 3 * BlockSize));
+
+  // the middle was never read
+  int64_t middle = 5 * BlockSize + 1234;
+  EXPECT_FALSE(cache.IsCachedPosition(middle));
+  EXPECT_EQ(middle, cache.CachedDataEndPosIfSeekTo(middle));
+  cache.Reset(middle, false);
+  ASSERT_TRUE(Stream(cache, middle, middle + BlockSize));
+
+  // and the tail is still there
+  EXPECT_EQ(tail + 2 * BlockSize, cache.CachedDataEndPosIfSeekTo(tail));
+  cache.Reset(tail, false);
+  EXPECT_TRUE(Verify(cache, tail, tail + 2 * BlockSize));
+
+  cache.Close();
+}
+
+TEST(TestBlockCache, SpillAndDrop)
+{
+  // four blocks in memory and four on disk, the rest has to go
+  CBlockCache cache(4 * BlockSize, 4 * BlockSize);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+  ASSERT_TRUE(Stream(cache, 0, 12 * BlockSize));
+
+  // the oldest blocks were dropped once the spill file was full
+  EXPECT_FALSE(cache.IsCachedPosition(0));
+  EXPECT_FALSE(cache.IsCachedPosition(3 * BlockSize + 100));
+  EXPECT_EQ(100, cache.CachedDataEndPosIfSeekTo(100));
+  EXPECT_EQ(CACHE_RC_ERROR, cache.Seek(100));
+
+  // the spilled ones read back from disk followed by those still in memory
+  EXPECT_TRUE(cache.IsCachedPosition(4 * BlockSize));
+  EXPECT_EQ(12 * BlockSize, cache.CachedDataEndPosIfSeekTo(4 * BlockSize));
+  EXPECT_EQ(4 * BlockSize, cache.Seek(4 * BlockSize));
+  EXPECT_TRUE(Verify(cache, 4 * BlockSize, 12 * BlockSize));
+
+  cache.Close();
+}
+
+TEST(TestBlockCache, CachedDataEndPosAcrossGap)
+{
+  CBlockCache cache(4 * BlockSize, 16 * BlockSize);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+  ASSERT_TRUE(Stream(cache, 0, BlockSize + 500));
+
+  // second region starting mid block, leaving a gap behind the first one
+  int64_t second = 3 * BlockSize + 100;
+  cache.Reset(second, false);
+  ASSERT_TRUE(Stream(cache, second, second + 1000));
+
+  EXPECT_EQ(BlockSize + 500, cache.CachedDataEndPosIfSeekTo(0));
+  EXPECT_EQ(BlockSize + 500, cache.CachedDataEndPosIfSeekTo(BlockSize + 10));
+  EXPECT_EQ(2 * BlockSize, cache.CachedDataEndPosIfSeekTo(2 * BlockSize));
+  EXPECT_EQ(3 * BlockSize + 50, cache.CachedDataEndPosIfSeekTo(3 * BlockSize + 50));
+  EXPECT_EQ(second + 1000, cache.CachedDataEndPosIfSeekTo(second));
+  EXPECT_EQ(second + 1000, cache.CachedDataEndPosIfSeekTo(second + 999));
+
+  EXPECT_TRUE(cache.IsCachedPosition(BlockSize));
+  EXPECT_FALSE(cache.IsCachedPosition(2 * BlockSize));
+  EXPECT_FALSE(cache.IsCachedPosition(3 * BlockSize + 50));
+  EXPECT_TRUE(cache.IsCachedPosition(second + 500));
+
+  // the read position can't cross the gap without the source
+  EXPECT_EQ(CACHE_RC_ERROR, cache.Seek(100));
+  EXPECT_EQ(second + 1000, cache.CachedDataEndPos());
+
+  cache.Close();
+}
@@ -0,0 +1,98 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/DirectoryCache.h"
+#include "FileItem.h"
+#include "utils/StringUtils.h"
+
+#include "gtest/gtest.h"
+
+static void FillFolder(const CStdString &path, int count, CFileItemList &items)
+{
+  items.Clear();
+  for (int i = 0; i < count; i++)
+  {
+    CFileItemPtr item(new CFileItem(path + StringUtils::Format("file%05i.mp3", i), false));
+    items.Add(item);
+  }
+}
+
+TEST(TestDirectoryCache, FileExists)
+{
+  XFILE::CDirectoryCache cache;
+  CFileItemList items;
+  FillFolder("/cache/test/", 10, items);
+  cache.SetDirectory("/cache/test/", items, XFILE::DIR_CACHE_ONCE);
+
+  bool inCache;
+  EXPECT_TRUE(cache.FileExists("/cache/test/file00003.mp3", inCache));
+  EXPECT_TRUE(inCache);
+  EXPECT_FALSE(cache.FileExists("/cache/test/missing.mp3", inCache));
+  EXPECT_TRUE(inCache);
+  EXPECT_FALSE(cache.FileExists("/cache/other/file00003.mp3", inCache));
+  EXPECT_FALSE(inCache);
+
+  cache.AddFile("/cache/test/added.mp3");
+  EXPECT_TRUE(cache.FileExists("/cache/test/added.mp3", inCache));
+
+  unsigned int hits, misses, evictions;
+  size_t size;
+  cache.GetStats(hits, misses, evictions, size);
+  EXPECT_EQ(3U, hits);
+  EXPECT_EQ(1U, misses);
+  EXPECT_EQ(0U, evictions);
+  EXPECT_LT(11 * XFILE::CDirectoryCache::GetItemSize(*items[0]), size);
+
+  cache.ClearDirectory("/cache/test");
+  cache.GetStats(hits, misses, evictions, size);
+  EXPECT_EQ(0U, size);
+}
+
+TEST(TestDirectoryCache, EvictLeastRecentlyUsed)
+{
+  XFILE::CDirectoryCache cache;
+  CFileItemList items;
+  FillFolder("/cache/a/", 1, items);
+  // make each folder use about 3MB so that only two fit in the cache
+  int count = 3 * 1024 * 1024 / XFILE::CDirectoryCache::GetItemSize(*items[0]);
+
+  FillFolder("/cache/a/", count, items);
+  cache.SetDirectory("/cache/a/", items, XFILE::DIR_CACHE_ONCE);
+  FillFolder("/cache/b/", count, items);
+  cache.SetDirectory("/cache/b/", items, XFILE::DIR_CACHE_ONCE);
+
+  // touch a so that b is the least recently used
+  CFileItemList result;
+  EXPECT_TRUE(cache.GetDirectory("/cache/a/", result, true));
+  EXPECT_EQ(count, result.Size());
+
+  FillFolder("/cache/c/", count, items);
+  cache.SetDirectory("/cache/c/", items, XFILE::DIR_CACHE_ONCE);
+
+  EXPECT_TRUE(cache.GetDirectory("/cache/a/", result, true));
+  EXPECT_FALSE(cache.GetDirectory("/cache/b/", result, true));
+  EXPECT_TRUE(cache.GetDirectory("/cache/c/", result, true));
+
+  unsigned int hits, misses, evictions;
+  size_t size;
+  cache.GetStats(hits, misses, evictions, size);
+  EXPECT_EQ(1U, evictions);
+  EXPECT_EQ(1U, misses);
+}
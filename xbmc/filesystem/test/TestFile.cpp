@@ -22,6 +22,7 @@
 #include "test/TestUtils.h"
 
 #include <errno.h>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -202,6 +203,31 @@ TEST(TestFile, Cache)
   EXPECT_TRUE(XFILE::CFile::Delete(path2));
 }
 
+TEST(TestFile, CacheLarge)
+{
+  XFILE::CFile *file;
+  CStdString path1, path2;
+  std::vector<char> data(3 * 1024 * 1024 + 1234), copy(data.size());
+  for (unsigned int i = 0; i < data.size(); i++)
+    data[i] = (char)(i * 7 + i / 4096);
+
+  ASSERT_TRUE((file = XBMC_CREATETEMPFILE("")) != NULL);
+  EXPECT_EQ((int)data.size(), file->Write(&data[0], data.size()));
+  file->Close();
+  path1 = XBMC_TEMPFILEPATH(file);
+  path2 = path1 + ".copy";
+  EXPECT_TRUE(XFILE::CFile::Cache(path1, path2));
+
+  XFILE::CFile copied;
+  ASSERT_TRUE(copied.Open(path2));
+  EXPECT_EQ((int64_t)data.size(), copied.GetLength());
+  EXPECT_EQ((unsigned int)data.size(), copied.Read(&copy[0], copy.size()));
+  copied.Close();
+  EXPECT_TRUE(data == copy);
+  EXPECT_TRUE(XFILE::CFile::Delete(path2));
+  EXPECT_TRUE(XBMC_DELETETEMPFILE(file));
+}
+
 TEST(TestFile, SetHidden)
 {
   XFILE::CFile *file;
@@ -0,0 +1,115 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/File.h"
+#include "filesystem/FileReadAhead.h"
+#include "threads/Thread.h"
+#include "test/TestUtils.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+static const unsigned int BufferSize = 4096;
+
+static unsigned char Pattern(int64_t pos)
+{
+  return (unsigned char)(pos * 7 + pos / 1000);
+}
+
+/* creates a temp file holding size bytes of the pattern */
+static XFILE::CFile *CreatePatternFile(unsigned int size)
+{
+  XFILE::CFile *file = XBMC_CREATETEMPFILE("");
+  if (!file)
+    return NULL;
+  std::vector<unsigned char> buf(size);
+  for (unsigned int i = 0; i < size; i++)
+    buf[i] = Pattern(i);
+  if (size && file->Write(&buf[0], size) != (int)size)
+  {
+    XBMC_DELETETEMPFILE(file);
+    return NULL;
+  }
+  file->Close();
+  return file;
+}
+
+/* reads the file through a read ahead ring and checks all of it arrives in order.
+   With delay set, each chunk is held while the reader has time to fill the rest of
+   the ring, and checked again before it is handed back. */
+static void ReadAll(unsigned int size, unsigned int buffers, bool delay)
+{
+  XFILE::CFile *tmpfile = CreatePatternFile(size);
+  ASSERT_TRUE(tmpfile != NULL);
+
+  {
+    XFILE::CFile file;
+    ASSERT_TRUE(file.Open(XBMC_TEMPFILEPATH(tmpfile)));
+    XFILE::CFileReadAhead reader(file, BufferSize, buffers);
+
+    int64_t pos = 0;
+    const char *data = NULL;
+    int chunk;
+    bool match = true;
+    while (match && (chunk = reader.Next(data)) > 0)
+    {
+      EXPECT_GE(BufferSize, (unsigned int)chunk);
+      if (delay)
+        XbmcThreads::ThreadSleep(5);
+      for (int i = 0; i < chunk; i++)
+        match &= (unsigned char)data[i] == Pattern(pos + i);
+      pos += chunk;
+    }
+    EXPECT_TRUE(match);
+    EXPECT_EQ((int64_t)size, pos);
+
+    // the end of the file sticks
+    EXPECT_EQ(0, reader.Next(data));
+    EXPECT_EQ(0, reader.Next(data));
+  }
+
+  EXPECT_TRUE(XBMC_DELETETEMPFILE(tmpfile));
+}
+
+TEST(TestFileReadAhead, SingleBuffer)
+{
+  ReadAll(10 * BufferSize + 123, 1, false);
+}
+
+TEST(TestFileReadAhead, Ring)
+{
+  ReadAll(10 * BufferSize + 123, 4, false);
+}
+
+TEST(TestFileReadAhead, RingHandBack)
+{
+  ReadAll(10 * BufferSize + 123, 4, true);
+}
+
+TEST(TestFileReadAhead, EndOfFile)
+{
+  // ending on a buffer boundary needs an extra empty read to notice
+  ReadAll(8 * BufferSize, 1, false);
+  ReadAll(8 * BufferSize, 4, false);
+  ReadAll(100, 4, false);
+  ReadAll(0, 1, false);
+  ReadAll(0, 4, false);
+}
@@ -0,0 +1,225 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#if defined(HAS_FILESYSTEM_NFS) && defined(TARGET_POSIX)
+#include "filesystem/DllLibNfs.h"
+#include "filesystem/NFSFile.h"
+
+#include <algorithm>
+#include <poll.h>
+#include <unistd.h>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#define CHUNK_SIZE (64 * 1024)
+
+// Stands in for libnfs, serving a generated file. Replies to asynchronous reads are
+// held back until the context is serviced, and then delivered in reverse order.
+class CNfsStandIn : public DllLibNfsInterface
+{
+public:
+  CNfsStandIn(uint64_t size) : m_size(size), m_failAt((uint64_t)-1), m_maxPending(0)
+  {
+    // a pipe that is always readable, to poll on
+    pipe(m_pipe);
+    write(m_pipe[1], "x", 1);
+  }
+  virtual ~CNfsStandIn()
+  {
+    close(m_pipe[0]);
+    close(m_pipe[1]);
+  }
+
+  static char Byte(uint64_t offset) { return (char)(offset * 13 + offset / 251); }
+
+  virtual int nfs_pread_async(struct nfs_context *nfs, struct nfsfh *nfsfh, uint64_t offset, uint64_t count, nfs_cb cb, void *private_data)
+  {
+    Pending pending = { offset, count, cb, private_data };
+    m_pending.push_back(pending);
+    m_maxPending = std::max(m_maxPending, (unsigned int)m_pending.size());
+    return 0;
+  }
+  virtual int nfs_get_fd(struct nfs_context *nfs) { return m_pipe[0]; }
+  virtual int nfs_which_events(struct nfs_context *nfs) { return POLLIN; }
+  virtual int nfs_service(struct nfs_context *nfs, int revents)
+  {
+    std::vector<Pending> pending;
+    pending.swap(m_pending);
+    for (std::vector<Pending>::reverse_iterator i = pending.rbegin(); i != pending.rend(); ++i)
+    {
+      if (i->offset <= m_failAt && m_failAt < i->offset + i->count)
+      {
+        i->cb(-5, nfs, NULL, i->private_data);
+        continue;
+      }
+      std::vector<char> data;
+      for (uint64_t offset = i->offset; offset < std::min(i->offset + i->count, m_size); offset++)
+        data.push_back(Byte(offset));
+      i->cb(data.size(), nfs, data.empty() ? NULL : &data[0], i->private_data);
+    }
+    return 0;
+  }
+  virtual char *nfs_get_error(struct nfs_context *nfs) { return (char *)"stand in error"; }
+
+  // the rest isn't used by the read ahead
+  virtual void mount_free_export_list(struct exportnode *exports) {}
+  virtual struct exportnode *mount_getexports(const char *server) { return NULL; }
+  virtual struct nfs_server_list *nfs_find_local_servers(void) { return NULL; }
+  virtual void free_nfs_srvr_list(struct nfs_server_list *srv) {}
+  virtual struct nfs_context *nfs_init_context(void) { return NULL; }
+  virtual void nfs_destroy_context(struct nfs_context *nfs) {}
+  virtual uint64_t nfs_get_readmax(struct nfs_context *nfs) { return CHUNK_SIZE; }
+  virtual uint64_t nfs_get_writemax(struct nfs_context *nfs) { return CHUNK_SIZE; }
+  virtual int nfs_close(struct nfs_context *nfs, struct nfsfh *nfsfh) { return -1; }
+  virtual int nfs_fsync(struct nfs_context *nfs, struct nfsfh *nfsfh) { return -1; }
+  virtual int nfs_mkdir(struct nfs_context *nfs, const char *path) { return -1; }
+  virtual int nfs_rmdir(struct nfs_context *nfs, const char *path) { return -1; }
+  virtual int nfs_unlink(struct nfs_context *nfs, const char *path) { return -1; }
+  virtual void nfs_closedir(struct nfs_context *nfs, struct nfsdir *nfsdir) {}
+  virtual struct nfsdirent *nfs_readdir(struct nfs_context *nfs, struct nfsdir *nfsdir) { return NULL; }
+  virtual int nfs_mount(struct nfs_context *nfs, const char *server, const char *exportname) { return -1; }
+  virtual int nfs_stat(struct nfs_context *nfs, const char *path, struct stat *st) { return -1; }
+  virtual int nfs_fstat(struct nfs_context *nfs, struct nfsfh *nfsfh, struct stat *st) { return -1; }
+  virtual int nfs_truncate(struct nfs_context *nfs, const char *path, uint64_t length) { return -1; }
+  virtual int nfs_ftruncate(struct nfs_context *nfs, struct nfsfh *nfsfh, uint64_t length) { return -1; }
+  virtual int nfs_opendir(struct nfs_context *nfs, const char *path, struct nfsdir **nfsdir) { return -1; }
+  virtual int nfs_statvfs(struct nfs_context *nfs, const char *path, struct statvfs *svfs) { return -1; }
+  virtual int nfs_chmod(struct nfs_context *nfs, const char *path, int mode) { return -1; }
+  virtual int nfs_fchmod(struct nfs_context *nfs, struct nfsfh *nfsfh, int mode) { return -1; }
+  virtual int nfs_access(struct nfs_context *nfs, const char *path, int mode) { return -1; }
+  virtual int nfs_utimes(struct nfs_context *nfs, const char *path, struct timeval *times) { return -1; }
+  virtual int nfs_utime(struct nfs_context *nfs, const char *path, struct utimbuf *times) { return -1; }
+  virtual int nfs_symlink(struct nfs_context *nfs, const char *oldpath, const char *newpath) { return -1; }
+  virtual int nfs_rename(struct nfs_context *nfs, const char *oldpath, const char *newpath) { return -1; }
+  virtual int nfs_link(struct nfs_context *nfs, const char *oldpath, const char *newpath) { return -1; }
+  virtual int nfs_readlink(struct nfs_context *nfs, const char *path, char *buf, int bufsize) { return -1; }
+  virtual int nfs_chown(struct nfs_context *nfs, const char *path, int uid, int gid) { return -1; }
+  virtual int nfs_fchown(struct nfs_context *nfs, struct nfsfh *nfsfh, int uid, int gid) { return -1; }
+  virtual int nfs_open(struct nfs_context *nfs, const char *path, int mode, struct nfsfh **nfsfh) { return -1; }
+  virtual int nfs_read(struct nfs_context *nfs, struct nfsfh *nfsfh, uint64_t count, char *buf) { return -1; }
+  virtual int nfs_write(struct nfs_context *nfs, struct nfsfh *nfsfh, uint64_t count, char *buf) { return -1; }
+  virtual int nfs_creat(struct nfs_context *nfs, const char *path, int mode, struct nfsfh **nfsfh) { return -1; }
+  virtual int nfs_pread(struct nfs_context *nfs, struct nfsfh *nfsfh, uint64_t offset, uint64_t count, char *buf) { return -1; }
+  virtual int nfs_pwrite(struct nfs_context *nfs, struct nfsfh *nfsfh, uint64_t offset, uint64_t count, char *buf) { return -1; }
+  virtual int nfs_lseek(struct nfs_context *nfs, struct nfsfh *nfsfh, uint64_t offset, int whence, uint64_t *current_offset) { return -1; }
+
+  struct Pending
+  {
+    uint64_t offset;
+    uint64_t count;
+    nfs_cb   cb;
+    void    *private_data;
+  };
+
+  uint64_t             m_size;
+  uint64_t             m_failAt;     ///< reads covering this offset fail
+  unsigned int         m_maxPending; ///< most reads that were in flight at once
+  std::vector<Pending> m_pending;
+  int                  m_pipe[2];
+};
+
+// read from position to the end in pieces of the given size, checking the data
+static uint64_t ReadToEnd(XFILE::CNFSReadAhead &readAhead, uint64_t position, unsigned int size)
+{
+  std::vector<char> buffer(size);
+  int read;
+  while ((read = readAhead.Read(position, &buffer[0], size)) > 0)
+  {
+    for (int i = 0; i < read; i++)
+    {
+      if (buffer[i] != CNfsStandIn::Byte(position + i))
+      {
+        ADD_FAILURE() << "wrong data at " << position + i;
+        return position;
+      }
+    }
+    position += read;
+  }
+  EXPECT_EQ(0, read);
+  return position;
+}
+
+TEST(TestNFSFile, ReadAheadInOrder)
+{
+  const uint64_t size = 20 * CHUNK_SIZE + 1234;
+  CNfsStandIn lib(size);
+  {
+    XFILE::CNFSReadAhead readAhead(&lib, NULL, NULL, size, CHUNK_SIZE, 4);
+    EXPECT_EQ(size, ReadToEnd(readAhead, 0, 10000));
+    EXPECT_EQ(4U, lib.m_maxPending);
+  }
+  EXPECT_TRUE(lib.m_pending.empty());
+}
+
+TEST(TestNFSFile, ReadAheadLargeReads)
+{
+  // reads spanning several chunks are served from all of them that have arrived
+  const uint64_t size = 9 * CHUNK_SIZE;
+  CNfsStandIn lib(size);
+  XFILE::CNFSReadAhead readAhead(&lib, NULL, NULL, size, CHUNK_SIZE, 3);
+  EXPECT_EQ(size, ReadToEnd(readAhead, 0, 3 * CHUNK_SIZE + 17));
+}
+
+TEST(TestNFSFile, ReadAheadSeek)
+{
+  const uint64_t size = 16 * CHUNK_SIZE;
+  CNfsStandIn lib(size);
+  {
+    XFILE::CNFSReadAhead readAhead(&lib, NULL, NULL, size, CHUNK_SIZE, 4);
+    char buffer[100];
+    const uint64_t positions[] = { 0, 5 * CHUNK_SIZE + 3, 2 * CHUNK_SIZE - 50, 2 * CHUNK_SIZE + 50, 15 * CHUNK_SIZE };
+    for (unsigned int i = 0; i < sizeof(positions) / sizeof(positions[0]); i++)
+    {
+      ASSERT_EQ((int)sizeof(buffer), readAhead.Read(positions[i], buffer, sizeof(buffer)));
+      for (unsigned int j = 0; j < sizeof(buffer); j++)
+        ASSERT_EQ(CNfsStandIn::Byte(positions[i] + j), buffer[j]);
+    }
+    // consuming a whole chunk leaves the one read ahead in its place in flight
+    std::vector<char> chunk(CHUNK_SIZE);
+    ASSERT_EQ(CHUNK_SIZE, readAhead.Read(10 * CHUNK_SIZE, &chunk[0], CHUNK_SIZE));
+    EXPECT_FALSE(lib.m_pending.empty());
+  }
+  // which is waited for before the file may be closed
+  EXPECT_TRUE(lib.m_pending.empty());
+}
+
+TEST(TestNFSFile, ReadAheadError)
+{
+  const uint64_t size = 8 * CHUNK_SIZE;
+  CNfsStandIn lib(size);
+  lib.m_failAt = 5 * CHUNK_SIZE + 10;
+  XFILE::CNFSReadAhead readAhead(&lib, NULL, NULL, size, CHUNK_SIZE, 4);
+  std::vector<char> buffer(CHUNK_SIZE);
+  for (uint64_t position = 0; position < 5 * CHUNK_SIZE; position += CHUNK_SIZE)
+    EXPECT_EQ(CHUNK_SIZE, readAhead.Read(position, &buffer[0], CHUNK_SIZE));
+  EXPECT_EQ(-1, readAhead.Read(5 * CHUNK_SIZE, &buffer[0], CHUNK_SIZE));
+}
+
+TEST(TestNFSFile, ReadAheadGrowingFile)
+{
+  // the file has grown since it was opened
+  const uint64_t size = 6 * CHUNK_SIZE + 99;
+  CNfsStandIn lib(size);
+  XFILE::CNFSReadAhead readAhead(&lib, NULL, NULL, 2 * CHUNK_SIZE, CHUNK_SIZE, 4);
+  EXPECT_EQ(size, ReadToEnd(readAhead, 0, 5000));
+}
+#endif
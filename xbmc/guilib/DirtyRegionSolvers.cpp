@@ -22,6 +22,11 @@
 #include "GraphicContext.h"
 #include <stdio.h>
 
+// weight of the previous samples when a new pass is measured, about the last 100 passes count
+#define COST_DECAY       0.99
+// passes needed before the measured costs replace the defaults
+#define COST_MIN_SAMPLES 20.0
+
 void CUnionDirtyRegionSolver::Solve(const CDirtyRegionList &input, CDirtyRegionList &output)
 {
   CDirtyRegion unifiedRegion;
@@ -81,3 +86,84 @@ void CGreedyDirtyRegionSolver::Solve(const CDirtyRegionList &input, CDirtyRegion
       output.push_back(currentRegion);
   }
 }
+
+CCostDirtyRegionSolver::CCostDirtyRegionSolver()
+{
+  // the same ratio as the greedy solver until we have measured something
+  m_costPerPass  = 0.5f;
+  m_costPerPixel = 0.0005f;
+
+  m_samples     = 0;
+  m_sumArea     = 0;
+  m_sumTime     = 0;
+  m_sumAreaArea = 0;
+  m_sumAreaTime = 0;
+}
+
+void CCostDirtyRegionSolver::Solve(const CDirtyRegionList &input, CDirtyRegionList &output)
+{
+  for (unsigned int i = 0; i < input.size(); i++)
+  {
+    if (!input[i].IsEmpty())
+      output.push_back(input[i]);
+  }
+
+  // merge the pair with the largest saving until no merge saves anything. Overlapping parts
+  // count twice while the regions are separate, as they are drawn twice.
+  while (output.size() > 1)
+  {
+    int   bestFirst = -1, bestSecond = -1;
+    float bestSaving = 0.0f;
+    CDirtyRegion bestUnion;
+
+    for (unsigned int i = 0; i < output.size(); i++)
+    {
+      float area = output[i].Area();
+      for (unsigned int j = i + 1; j < output.size(); j++)
+      {
+        CDirtyRegion temporaryUnion = output[i];
+        temporaryUnion.Union(output[j]);
+        float saving = m_costPerPass + m_costPerPixel * (area + output[j].Area() - temporaryUnion.Area());
+        if (saving > bestSaving)
+        {
+          bestFirst  = i;
+          bestSecond = j;
+          bestSaving = saving;
+          bestUnion  = temporaryUnion;
+        }
+      }
+    }
+
+    if (bestFirst < 0)
+      break;
+
+    output[bestFirst] = bestUnion;
+    output.erase(output.begin() + bestSecond);
+  }
+}
+
+void CCostDirtyRegionSolver::RenderedPass(const CDirtyRegion &region, float milliseconds)
+{
+  double area = region.Area();
+  m_samples     = m_samples     * COST_DECAY + 1.0;
+  m_sumArea     = m_sumArea     * COST_DECAY + area;
+  m_sumTime     = m_sumTime     * COST_DECAY + milliseconds;
+  m_sumAreaArea = m_sumAreaArea * COST_DECAY + area * area;
+  m_sumAreaTime = m_sumAreaTime * COST_DECAY + area * milliseconds;
+
+  if (m_samples < COST_MIN_SAMPLES)
+    return;
+
+  // if all recent passes were about the same size the two costs can't be told apart
+  double variance = m_samples * m_sumAreaArea - m_sumArea * m_sumArea;
+  if (variance <= 0.0001 * m_samples * m_sumAreaArea)
+    return;
+
+  double perPixel = (m_samples * m_sumAreaTime - m_sumArea * m_sumTime) / variance;
+  double perPass  = (m_sumTime - perPixel * m_sumArea) / m_samples;
+  if (perPixel > 0 && perPass > 0)
+  {
+    m_costPerPixel = (float)perPixel;
+    m_costPerPass  = (float)perPass;
+  }
+}
@@ -48,3 +48,31 @@ private:
   float m_costNewRegion;
   float m_costPerArea;
 };
+
+/*!
+ \brief Merges regions whenever that is estimated to be cheaper than rendering them separately
+
+ The cost of a rendering pass is modelled as a fixed cost per pass plus a cost per pixel. Both
+ are estimated at runtime by a least squares fit over the time taken by recent passes, so the
+ solver adapts to whether the GPU is fill rate or draw call bound.
+ */
+class CCostDirtyRegionSolver : public IDirtyRegionSolver
+{
+public:
+  CCostDirtyRegionSolver();
+  virtual void Solve(const CDirtyRegionList &input, CDirtyRegionList &output);
+  virtual void RenderedPass(const CDirtyRegion &region, float milliseconds);
+
+  float GetCostPerPass() const { return m_costPerPass; }
+  float GetCostPerPixel() const { return m_costPerPixel; }
+private:
+  float  m_costPerPass;   ///< estimated time of a pass, excluding the pixels drawn, in ms
+  float  m_costPerPixel;  ///< estimated time per pixel drawn, in ms
+
+  // exponentially decaying sums for the fit of time = pass + pixel * area
+  double m_samples;
+  double m_sumArea;
+  double m_sumTime;
+  double m_sumAreaArea;
+  double m_sumAreaTime;
+};
@@ -19,27 +19,50 @@
  */
 
 #include "DirtyRegionTracker.h"
+#include "filesystem/File.h"
 #include "settings/AdvancedSettings.h"
 #include "utils/log.h"
 #include <stdio.h>
+#include <stdlib.h>
 
 CDirtyRegionTracker::CDirtyRegionTracker(int buffering)
 {
   m_buffering = buffering;
   m_solver = NULL;
+  m_trace = NULL;
 }
 
 CDirtyRegionTracker::~CDirtyRegionTracker()
 {
   delete m_solver;
+  delete m_trace;
 }
 
 void CDirtyRegionTracker::SelectAlgorithm()
 {
   delete m_solver;
 
+  delete m_trace;
+  m_trace = NULL;
+  if (!g_advancedSettings.m_guiDirtyRegionTrace.IsEmpty())
+  {
+    m_trace = new XFILE::CFile;
+    if (m_trace->OpenForWrite(g_advancedSettings.m_guiDirtyRegionTrace, true))
+      CLog::Log(LOGDEBUG, "guilib: Recording dirty regions to %s", g_advancedSettings.m_guiDirtyRegionTrace.c_str());
+    else
+    {
+      CLog::Log(LOGERROR, "guilib: Unable to record dirty regions to %s", g_advancedSettings.m_guiDirtyRegionTrace.c_str());
+      delete m_trace;
+      m_trace = NULL;
+    }
+  }
+
   switch (g_advancedSettings.m_guiAlgorithmDirtyRegions)
   {
+    case DIRTYREGION_SOLVER_COST_MODEL:
+      CLog::Log(LOGDEBUG, "guilib: Measured cost model as algorithm for solving rendering passes");
+      m_solver = new CCostDirtyRegionSolver();
+      break;
     case DIRTYREGION_SOLVER_FILL_VIEWPORT_ON_CHANGE:
       CLog::Log(LOGDEBUG, "guilib: Fill viewport on change for solving rendering passes");
       m_solver = new CFillViewportOnChangeRegionSolver();
@@ -75,6 +98,9 @@ CDirtyRegionList CDirtyRegionTracker::GetDirtyRegions()
 {
   CDirtyRegionList output;
 
+  if (m_trace)
+    WriteTrace();
+
   if (m_solver)
     m_solver->Solve(m_markedRegions, output);
 
@@ -93,3 +119,79 @@ void CDirtyRegionTracker::CleanMarkedRegions()
     i--;
   }
 }
+
+void CDirtyRegionTracker::RenderedPass(const CDirtyRegion &region, float milliseconds)
+{
+  if (m_solver)
+    m_solver->RenderedPass(region, milliseconds);
+}
+
+void CDirtyRegionTracker::WriteTrace()
+{
+  std::string line = FormatTraceFrame(m_markedRegions);
+  line += '\n';
+  if (m_trace->Write(line.c_str(), line.size()) != (int)line.size())
+  {
+    CLog::Log(LOGERROR, "guilib: Unable to write dirty region trace, stopping recording");
+    delete m_trace;
+    m_trace = NULL;
+  }
+}
+
+std::string CDirtyRegionTracker::FormatTraceFrame(const CDirtyRegionList &regions)
+{
+  std::string line;
+  for (CDirtyRegionList::const_iterator i = regions.begin(); i != regions.end(); ++i)
+  {
+    char region[128];
+    snprintf(region, sizeof(region), "%s%g %g %g %g", line.empty() ? "" : ";", i->x1, i->y1, i->x2, i->y2);
+    line += region;
+  }
+  return line;
+}
+
+bool CDirtyRegionTracker::ParseTraceFrame(const std::string &line, CDirtyRegionList &regions)
+{
+  const char *pos = line.c_str();
+  while (*pos && *pos != '\r' && *pos != '\n')
+  {
+    float coords[4];
+    for (int i = 0; i < 4; i++)
+    {
+      char *end;
+      coords[i] = (float)strtod(pos, &end);
+      if (end == pos)
+        return false;
+      pos = end;
+    }
+    regions.push_back(CDirtyRegion(coords[0], coords[1], coords[2], coords[3]));
+
+    while (*pos == ' ')
+      pos++;
+    if (*pos == ';')
+      pos++;
+    else if (*pos && *pos != '\r' && *pos != '\n')
+      return false;
+  }
+  return true;
+}
+
+bool CDirtyRegionTracker::ReadTrace(const CStdString &path, std::vector<CDirtyRegionList> &frames)
+{
+  XFILE::CFile file;
+  if (!file.Open(path))
+    return false;
+
+  char line[16384];
+  while (file.ReadString(line, sizeof(line)))
+  {
+    CDirtyRegionList regions;
+    if (!ParseTraceFrame(line, regions))
+    {
+      CLog::Log(LOGERROR, "%s: invalid line %u in %s", __FUNCTION__, (unsigned int)frames.size() + 1, path.c_str());
+      return false;
+    }
+    frames.push_back(regions);
+  }
+  return true;
+}
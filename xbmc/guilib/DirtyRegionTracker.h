@@ -21,6 +21,9 @@
 
 #include "IDirtyRegionSolver.h"
 #include "DirtyRegionSolvers.h"
+#include "utils/StdString.h"
+
+#include <string>
 
 #if defined(TARGET_DARWIN_IOS)
 #define DEFAULT_BUFFERING 4
@@ -28,6 +31,11 @@
 #define DEFAULT_BUFFERING 3
 #endif
 
+namespace XFILE
+{
+  class CFile;
+}
+
 class CDirtyRegionTracker
 {
 public:
@@ -40,8 +48,34 @@ public:
   CDirtyRegionList GetDirtyRegions();
   void CleanMarkedRegions();
 
+  /*! \brief Report the time a rendering pass took to the solver
+   \param region the region rendered
+   \param milliseconds time taken to render it
+   */
+  void RenderedPass(const CDirtyRegion &region, float milliseconds);
+
+  /*! \brief Format the marked regions of a frame as a line of a trace file
+   Each region is written as "x1 y1 x2 y2", regions are separated by ';'.
+   */
+  static std::string FormatTraceFrame(const CDirtyRegionList &regions);
+
+  /*! \brief Parse a line of a trace file
+   \sa FormatTraceFrame
+   */
+  static bool ParseTraceFrame(const std::string &line, CDirtyRegionList &regions);
+
+  /*! \brief Read a trace file as written with <gui><dirtyregiontrace> in advancedsettings.xml
+   \param path the trace file
+   \param frames [out] the marked regions of each frame
+   \return true if the file was read, false otherwise
+   */
+  static bool ReadTrace(const CStdString &path, std::vector<CDirtyRegionList> &frames);
+
 private:
+  void WriteTrace();
+
   CDirtyRegionList m_markedRegions;
   int m_buffering;
   IDirtyRegionSolver *m_solver;
+  XFILE::CFile *m_trace;
 };
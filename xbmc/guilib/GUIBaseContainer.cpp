@@ -23,6 +23,7 @@
 #include "GUIWindowManager.h"
 #include "utils/CharsetConverter.h"
 #include "GUIInfoManager.h"
+#include "GUILargeTextureManager.h"
 #include "utils/TimeUtils.h"
 #include "utils/log.h"
 #include "utils/SortUtils.h"
@@ -58,12 +59,16 @@ CGUIBaseContainer::CGUIBaseContainer(int parentID, int controlID, float posX, fl
   m_layout = NULL;
   m_focusedLayout = NULL;
   m_cacheItems = preloadItems;
+  m_prefetchOffset = 0;
+  m_prefetchDirection = 0;
+  m_prefetchItems = -1;
   m_scrollItemsPerFrame = 0.0f;
   m_type = VIEW_TYPE_NONE;
 }
 
 CGUIBaseContainer::~CGUIBaseContainer(void)
 {
+  g_largeTextureManager.CancelPrefetch(this);
 }
 
 void CGUIBaseContainer::DoProcess(unsigned int currentTime, CDirtyRegionList &dirtyregions)
@@ -95,6 +100,8 @@ void CGUIBaseContainer::Process(unsigned int currentTime, CDirtyRegionList &dirt
   if ((int)m_items.size() > m_itemsPerPage + cacheBefore + cacheAfter)
     FreeMemory(CorrectOffset(offset - cacheBefore, 0), CorrectOffset(offset + m_itemsPerPage + 1 + cacheAfter, 0));
 
+  PrefetchItems(offset, cacheBefore, cacheAfter);
+
   CPoint origin = CPoint(m_posX, m_posY) + m_renderOffset;
   float pos = (m_orientation == VERTICAL) ? origin.y : origin.x;
   float end = (m_orientation == VERTICAL) ? m_posY + m_height : m_posX + m_width;
@@ -796,6 +803,8 @@ void CGUIBaseContainer::AllocResources()
 void CGUIBaseContainer::FreeResources(bool immediately)
 {
   CGUIControl::FreeResources(immediately);
+  g_largeTextureManager.CancelPrefetch(this);
+  m_prefetchItems = -1;
   if (m_staticContent)
   { // free any static content
     Reset();
@@ -1012,6 +1021,8 @@ void CGUIBaseContainer::Reset()
   m_wasReset = true;
   m_items.clear();
   m_lastItem.reset();
+  g_largeTextureManager.CancelPrefetch(this);
+  m_prefetchItems = -1;
 }
 
 void CGUIBaseContainer::LoadLayout(TiXmlElement *layout)
@@ -1085,6 +1096,41 @@ void CGUIBaseContainer::FreeMemory(int keepStart, int keepEnd)
   }
 }
 
+void CGUIBaseContainer::PrefetchItems(int offset, int cacheBefore, int cacheAfter)
+{
+  if (!m_layout || m_itemsPerPage <= 0)
+    return;
+
+  int direction = m_scroller.IsScrollingDown() ? 1 : (m_scroller.IsScrollingUp() ? -1 : 0);
+  if (offset == m_prefetchOffset && direction == m_prefetchDirection && (int)m_items.size() == m_prefetchItems && !m_bInvalidated)
+    return;
+  m_prefetchOffset = offset;
+  m_prefetchDirection = direction;
+  m_prefetchItems = m_items.size();
+
+  // a page ahead when scrolling, half a page either side otherwise
+  std::vector< std::pair<int, int> > rows;
+  int before = direction < 0 ? m_itemsPerPage : (direction > 0 ? 0 : (m_itemsPerPage + 1) / 2);
+  int after  = direction > 0 ? m_itemsPerPage : (direction < 0 ? 0 : (m_itemsPerPage + 1) / 2);
+  if (after)
+    rows.push_back(std::make_pair(offset + m_itemsPerPage + 2 + cacheAfter, after));
+  if (before)
+    rows.push_back(std::make_pair(offset - cacheBefore - before, before));
+
+  std::vector<CStdString> images;
+  for (std::vector< std::pair<int, int> >::const_iterator it = rows.begin(); it != rows.end(); ++it)
+  {
+    for (int row = it->first; row < it->first + it->second; ++row)
+    {
+      int first = CorrectOffset(row, 0);
+      int last = std::max(first + 1, CorrectOffset(row + 1, 0));
+      for (int i = std::max(first, 0); i < last && i < (int)m_items.size(); ++i)
+        m_layout->GetLargeImages(m_items[i].get(), images);
+    }
+  }
+  g_largeTextureManager.Prefetch(this, images);
+}
+
 bool CGUIBaseContainer::InsideLayout(const CGUIListItemLayout *layout, const CPoint &point) const
 {
   if (!layout) return false;
@@ -121,6 +121,13 @@ protected:
   inline float Size() const;
   void MoveToRow(int row);
   void FreeMemory(int keepStart, int keepEnd);
+  /*! \brief Prefetch the art of the items beyond those we have cached, in the direction we're scrolling
+   \param offset first row on screen
+   \param cacheBefore number of rows cached before offset
+   \param cacheAfter number of rows cached after the last row on screen
+   \sa CGUILargeTextureManager::Prefetch
+   */
+  void PrefetchItems(int offset, int cacheBefore, int cacheAfter);
   void GetCurrentLayouts();
   CGUIListItemLayout *GetFocusedLayout() const;
 
@@ -198,6 +205,9 @@ private:
   int m_cursor;
   int m_offset;
   int m_cacheItems;
+  int m_prefetchOffset;     ///< offset, direction and item count the prefetched images were chosen for
+  int m_prefetchDirection;
+  int m_prefetchItems;
   CStopWatch m_scrollTimer;
   CStopWatch m_lastScrollStartTimer;
   CStopWatch m_pageChangeTimer;
@@ -25,6 +25,7 @@
 #include "LocalizeStrings.h"
 #include "GUIWindowManager.h"
 #include "GUIControlProfiler.h"
+#include "GUIFrameProfiler.h"
 #include "input/MouseStat.h"
 #include "Key.h"
 
@@ -127,6 +128,7 @@ void CGUIControl::DynamicResourceAlloc(bool bOnOff)
 // 3. reset the animation transform
 void CGUIControl::DoProcess(unsigned int currentTime, CDirtyRegionList &dirtyregions)
 {
+  CGUIFrameProfilerScope profile(CGUIFrameProfiler::CATEGORY_CONTROL, "Process", GetID(), GetControlType());
   CRect dirtyRegion = m_renderRegion;
 
   bool changed = m_bInvalidated && IsVisible();
@@ -183,7 +185,10 @@ void CGUIControl::DoRender()
       g_graphicsContext.SetCameraPosition(m_camera);
 
     GUIPROFILER_RENDER_BEGIN(this);
-    Render();
+    {
+      CGUIFrameProfilerScope profile(CGUIFrameProfiler::CATEGORY_CONTROL, "Render", GetID(), GetControlType());
+      Render();
+    }
     GUIPROFILER_RENDER_END(this);
 
     if (m_hasCamera)
@@ -19,13 +19,15 @@
  */
 
 #include "GUIControlProfiler.h"
+#include "GUIRenderBatch.h"
 #include "utils/XBMCTinyXML.h"
 #include "utils/TimeUtils.h"
 
 bool CGUIControlProfiler::m_bIsRunning = false;
 
 CGUIControlProfilerItem::CGUIControlProfilerItem(CGUIControlProfiler *pProfiler, CGUIControlProfilerItem *pParent, CGUIControl *pControl)
-: m_pProfiler(pProfiler), m_pParent(pParent), m_pControl(pControl), m_visTime(0), m_renderTime(0), m_i64VisStart(0), m_i64RenderStart(0)
+: m_pProfiler(pProfiler), m_pParent(pParent), m_pControl(pControl), m_visTime(0), m_renderTime(0), m_drawCalls(0), m_quads(0),
+  m_i64VisStart(0), m_i64RenderStart(0), m_drawCallsStart(0), m_quadsStart(0)
 {
   if (m_pControl)
   {
@@ -53,6 +55,8 @@ void CGUIControlProfilerItem::Reset(CGUIControlProfiler *pProfiler)
 
   m_visTime = 0;
   m_renderTime = 0;
+  m_drawCalls = 0;
+  m_quads = 0;
   const unsigned int dwSize = m_vecChildren.size();
   for (unsigned int i=0; i<dwSize; ++i)
     delete m_vecChildren[i];
@@ -74,11 +78,16 @@ void CGUIControlProfilerItem::EndVisibility(void)
 void CGUIControlProfilerItem::BeginRender(void)
 {
   m_i64RenderStart = CurrentHostCounter();
+  m_drawCallsStart = CGUIRenderBatch::Get().GetDrawCalls();
+  m_quadsStart = CGUIRenderBatch::Get().GetQuads();
 }
 
 void CGUIControlProfilerItem::EndRender(void)
 {
   m_renderTime += (unsigned int)(m_pProfiler->m_fPerfScale * (CurrentHostCounter() - m_i64RenderStart));
+  // batches are drawn when the next one starts, so this counts the batches the control ended
+  m_drawCalls += CGUIRenderBatch::Get().GetDrawCalls() - m_drawCallsStart;
+  m_quads += CGUIRenderBatch::Get().GetQuads() - m_quadsStart;
 }
 
 void CGUIControlProfilerItem::SaveToXML(TiXmlElement *parent)
@@ -203,6 +212,22 @@ void CGUIControlProfilerItem::SaveToXML(TiXmlElement *parent)
     elem->LinkEndChild(text);
   }
 
+  if (m_drawCalls)
+  {
+    CStdString val;
+    TiXmlElement *elem = new TiXmlElement("drawcalls");
+    xmlControl->LinkEndChild(elem);
+    val.Format("%u", m_drawCalls);
+    TiXmlText *text = new TiXmlText(val.c_str());
+    elem->LinkEndChild(text);
+
+    elem = new TiXmlElement("quads");
+    xmlControl->LinkEndChild(elem);
+    val.Format("%u", m_quads);
+    text = new TiXmlText(val.c_str());
+    elem->LinkEndChild(text);
+  }
+
   if (m_vecChildren.size())
   {
     TiXmlElement *xmlChilds = new TiXmlElement("children");
@@ -238,7 +263,8 @@ CGUIControlProfilerItem *CGUIControlProfilerItem::FindOrAddControl(CGUIControl *
 }
 
 CGUIControlProfiler::CGUIControlProfiler(void)
-: m_ItemHead(NULL, NULL, NULL), m_pLastItem(NULL), m_iMaxFrameCount(200), m_iFrameCount(0)
+: m_ItemHead(NULL, NULL, NULL), m_pLastItem(NULL), m_iMaxFrameCount(200), m_iFrameCount(0),
+  m_drawCallsStart(0), m_quadsStart(0)
 // m_bIsRunning(false), no isRunning because it is static
 {
   m_fPerfScale = 100000.0f / CurrentHostFrequency();
@@ -261,6 +287,8 @@ void CGUIControlProfiler::Start(void)
   m_bIsRunning = true;
   m_pLastItem = NULL;
   m_ItemHead.Reset(this);
+  m_drawCallsStart = CGUIRenderBatch::Get().GetDrawCalls();
+  m_quadsStart = CGUIRenderBatch::Get().GetQuads();
 }
 
 void CGUIControlProfiler::BeginVisibility(CGUIControl *pControl)
@@ -327,6 +355,10 @@ void CGUIControlProfiler::EndFrame(void)
       m_ItemHead.m_visTime += p->m_visTime;
       m_ItemHead.m_renderTime += p->m_renderTime;
     }
+    // the totals include the batches drawn outside of any control (e.g. at the end of the frame)
+    CGUIRenderBatch::Get().Flush();
+    m_ItemHead.m_drawCalls = CGUIRenderBatch::Get().GetDrawCalls() - m_drawCallsStart;
+    m_ItemHead.m_quads = CGUIRenderBatch::Get().GetQuads() - m_quadsStart;
 
     m_bIsRunning = false;
     if (SaveResults())
@@ -348,6 +380,13 @@ bool CGUIControlProfiler::SaveResults(void)
   str.Format("%d", m_iFrameCount);
   root->SetAttribute("framecount", str.c_str());
   root->SetAttribute("timeunit", "ms");
+  if (m_ItemHead.m_drawCalls)
+  {
+    str.Format("%.1f", (float)m_ItemHead.m_drawCalls / m_iFrameCount);
+    root->SetAttribute("drawcallsperframe", str.c_str());
+    str.Format("%.1f", (float)m_ItemHead.m_quads / m_ItemHead.m_drawCalls);
+    root->SetAttribute("quadsperdrawcall", str.c_str());
+  }
   doc.LinkEndChild(root);
 
   m_ItemHead.SaveToXML(root);
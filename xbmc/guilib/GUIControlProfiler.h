@@ -39,8 +39,12 @@ public:
   CGUIControl::GUICONTROLTYPES m_ControlType;
   unsigned int m_visTime;
   unsigned int m_renderTime;
+  unsigned int m_drawCalls;   ///< draw calls issued while rendering the control and its children
+  unsigned int m_quads;       ///< quads batched while rendering the control and its children
   int64_t m_i64VisStart;
   int64_t m_i64RenderStart;
+  unsigned int m_drawCallsStart;
+  unsigned int m_quadsStart;
 
   CGUIControlProfilerItem(CGUIControlProfiler *pProfiler, CGUIControlProfilerItem *pParent, CGUIControl *pControl);
   ~CGUIControlProfilerItem(void);
@@ -91,6 +95,8 @@ private:
   CStdString m_strOutputFile;
   int m_iMaxFrameCount;
   int m_iFrameCount;
+  unsigned int m_drawCallsStart;
+  unsigned int m_quadsStart;
 };
 
 #define GUIPROFILER_VISIBILITY_BEGIN(x) { if (CGUIControlProfiler::IsRunning()) CGUIControlProfiler::Instance().BeginVisibility(x); }
@@ -24,6 +24,10 @@
 #include "Texture.h"
 #include "GraphicContext.h"
 #include "filesystem/SpecialProtocol.h"
+#include "filesystem/File.h"
+#include "filesystem/Directory.h"
+#include "settings/AdvancedSettings.h"
+#include "utils/Crc32.h"
 #include "utils/MathUtils.h"
 #include "utils/log.h"
 #include "windowing/WindowingFactory.h"
@@ -47,7 +51,10 @@ using namespace std;
 
 
 #define CHARS_PER_TEXTURE_LINE 20 // number of characters to cache per texture line
-#define CHAR_CHUNK    64      // 64 chars allocated at a time (1024 bytes)
+
+#define GLYPHCACHE_PATH    "special://temp/fontcache/"
+#define GLYPHCACHE_MAGIC   "XBFC"
+#define GLYPHCACHE_VERSION 1
 
 int CGUIFontTTFBase::justification_word_weight = 6;   // weight of word spacing over letter spacing when justifying.
                                                   // A larger number means more of the "dead space" is placed between
@@ -134,8 +141,6 @@ XBMC_GLOBAL_REF(CFreeTypeLibrary, g_freeTypeLibrary); // our freetype library
 CGUIFontTTFBase::CGUIFontTTFBase(const CStdString& strFileName)
 {
   m_texture = NULL;
-  m_char = NULL;
-  m_maxChars = 0;
   m_nestedBeginCount = 0;
 
   m_bTextureLoaded = false;
@@ -149,8 +154,8 @@ CGUIFontTTFBase::CGUIFontTTFBase(const CStdString& strFileName)
   m_referenceCount = 0;
   m_originX = m_originY = 0.0f;
   m_cellBaseLine = m_cellHeight = 0;
-  m_numChars = 0;
-  m_posX = m_posY = 0;
+  m_shelfEnd = 0;
+  m_glyphCacheDirty = false;
   m_textureHeight = m_textureWidth = 0;
   m_textureScaleX = m_textureScaleY = 0.0;
   m_ellipsesWidth = m_height = 0.0f;
@@ -181,33 +186,37 @@ void CGUIFontTTFBase::RemoveReference()
 void CGUIFontTTFBase::ClearCharacterCache()
 {
   delete(m_texture);
+  for (vector<Page>::iterator it = m_pages.begin(); it != m_pages.end(); ++it)
+    delete it->texture;
+  m_pages.clear();
 
   DeleteHardwareTexture();
 
   m_texture = NULL;
-  delete[] m_char;
-  m_char = new Character[CHAR_CHUNK];
+  m_chars.clear();
   memset(m_charquick, 0, sizeof(m_charquick));
-  m_numChars = 0;
-  m_maxChars = CHAR_CHUNK;
-  // set the posX and posY so that our texture will be created on first character write.
-  m_posX = m_textureWidth;
-  m_posY = -(int)GetTextureLineHeight();
+  // the texture will be created on first character write.
+  m_shelves.clear();
+  m_shelfEnd = 0;
   m_textureHeight = 0;
 }
 
 void CGUIFontTTFBase::Clear()
 {
+  SaveGlyphCache();
+
   delete(m_texture);
   m_texture = NULL;
-  delete[] m_char;
+  for (vector<Page>::iterator it = m_pages.begin(); it != m_pages.end(); ++it)
+    delete it->texture;
+  m_pages.clear();
+  m_chars.clear();
   memset(m_charquick, 0, sizeof(m_charquick));
-  m_char = NULL;
-  m_maxChars = 0;
-  m_numChars = 0;
-  m_posX = 0;
-  m_posY = 0;
+  m_shelves.clear();
+  m_shelfEnd = 0;
   m_nestedBeginCount = 0;
+  m_glyphCacheKey.clear();
+  m_glyphCacheDirty = false;
 
   if (m_face)
     g_freeTypeLibrary.ReleaseFont(m_face);
@@ -219,6 +228,7 @@ void CGUIFontTTFBase::Clear()
   free(m_vertex);
   m_vertex = NULL;
   m_vertex_count = 0;
+  m_vertexPages.clear();
 }
 
 bool CGUIFontTTFBase::Load(const CStdString& strFilename, float height, float aspect, float lineSpacing, bool border)
@@ -281,11 +291,8 @@ bool CGUIFontTTFBase::Load(const CStdString& strFilename, float height, float as
 
   delete(m_texture);
   m_texture = NULL;
-  delete[] m_char;
-  m_char = NULL;
-
-  m_maxChars = 0;
-  m_numChars = 0;
+  m_chars.clear();
+  memset(m_charquick, 0, sizeof(m_charquick));
 
   m_strFilename = strFilename;
 
@@ -298,9 +305,20 @@ bool CGUIFontTTFBase::Load(const CStdString& strFilename, float height, float as
     m_textureWidth = g_Windowing.GetMaxTextureSize();
   m_textureScaleX = 1.0f / m_textureWidth;
 
-  // set the posX and posY so that our texture will be created on first character write.
-  m_posX = m_textureWidth;
-  m_posY = -(int)GetTextureLineHeight();
+  // the texture will be created on first character write.
+  m_shelves.clear();
+  m_shelfEnd = 0;
+
+  if (g_advancedSettings.m_guiFontCache && CanCacheGlyphs())
+  {
+    struct __stat64 st;
+    if (XFILE::CFile::Stat(strFilename, &st) == 0)
+    {
+      m_glyphCacheKey.Format("%s|%"PRId64"|%"PRId64"|%f|%f|%d|%u|%u", strFilename.c_str(), (int64_t)st.st_size, (int64_t)st.st_mtime,
+                             height, aspect, border ? 1 : 0, m_textureWidth, (unsigned int)sizeof(Character));
+      LoadGlyphCache();
+    }
+  }
 
   // cache the ellipses width
   Character *ellipse = GetCharacter(L'.');
@@ -484,49 +502,21 @@ CGUIFontTTFBase::Character* CGUIFontTTFBase::GetCharacter(character_t chr)
   // letters are stored based on style and letter
   character_t ch = (style << 16) | letter;
 
-  int low = 0;
-  int high = m_numChars - 1;
-  while (low <= high)
-  {
-    int mid = (low + high) >> 1;
-    if (ch > m_char[mid].letterAndStyle)
-      low = mid + 1;
-    else if (ch < m_char[mid].letterAndStyle)
-      high = mid - 1;
-    else
-      return &m_char[mid];
-  }
-  // if we get to here, then low is where we should insert the new character
+  CharacterMap::iterator it = m_chars.find(ch);
+  if (it != m_chars.end())
+    return &it->second;
 
-  // increase the size of the buffer if we need it
-  if (m_numChars >= m_maxChars)
-  { // need to increase the size of the buffer
-    Character *newTable = new Character[m_maxChars + CHAR_CHUNK];
-    if (m_char)
-    {
-      memcpy(newTable, m_char, low * sizeof(Character));
-      memcpy(newTable + low + 1, m_char + low, (m_numChars - low) * sizeof(Character));
-      delete[] m_char;
-    }
-    m_char = newTable;
-    m_maxChars += CHAR_CHUNK;
-
-  }
-  else
-  { // just move the data along as necessary
-    memmove(m_char + low + 1, m_char + low, (m_numChars - low) * sizeof(Character));
-  }
   // render the character to our texture
   // must End() as we can't render text to our texture during a Begin(), End() block
   unsigned int nestedBeginCount = m_nestedBeginCount;
   m_nestedBeginCount = 1;
   if (nestedBeginCount) End();
-  if (!CacheCharacter(letter, style, m_char + low))
+  Character character;
+  if (!CacheCharacter(letter, style, &character))
   { // unable to cache character - try clearing them all out and starting over
-    CLog::Log(LOGDEBUG, "%s: Unable to cache character.  Clearing character cache of %i characters", __FUNCTION__, m_numChars);
+    CLog::Log(LOGDEBUG, "%s: Unable to cache character.  Clearing character cache of %u characters", __FUNCTION__, (unsigned int)m_chars.size());
     ClearCharacterCache();
-    low = 0;
-    if (!CacheCharacter(letter, style, m_char + low))
+    if (!CacheCharacter(letter, style, &character))
     {
       CLog::Log(LOGERROR, "%s: Unable to cache character (out of memory?)", __FUNCTION__);
       if (nestedBeginCount) Begin();
@@ -537,18 +527,13 @@ CGUIFontTTFBase::Character* CGUIFontTTFBase::GetCharacter(character_t chr)
   if (nestedBeginCount) Begin();
   m_nestedBeginCount = nestedBeginCount;
 
-  // fixup quick access
-  memset(m_charquick, 0, sizeof(m_charquick));
-  for(int i=0;i<m_numChars;i++)
-  {
-    if ((m_char[i].letterAndStyle & 0xffff) < 255)
-    {
-      character_t ch = ((m_char[i].letterAndStyle & 0xffff0000) >> 8) | (m_char[i].letterAndStyle & 0xff);
-      m_charquick[ch] = m_char+i;
-    }
-  }
+  // elements of the map don't move, so we can point straight at them
+  Character *newChar = &(m_chars[ch] = character);
+  if (letter < 255)
+    m_charquick[(style << 8) | letter] = newChar;
+  m_glyphCacheDirty = true;
 
-  return m_char + low;
+  return newChar;
 }
 
 bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *ch)
@@ -585,73 +570,32 @@ bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *
   FT_Bitmap bitmap = bitGlyph->bitmap;
   bool isEmptyGlyph = (bitmap.width == 0 || bitmap.rows == 0);
 
-  if (!isEmptyGlyph)
+  unsigned int posX = 0, posY = 0;
+  if (!isEmptyGlyph && !AllocateGlyph(bitmap.width, bitmap.rows, posX, posY))
   {
-    if (bitGlyph->left < 0)
-      m_posX += -bitGlyph->left;
-
-    // check we have enough room for the character
-    if (m_posX + bitGlyph->left + bitmap.width > (int)m_textureWidth)
-    { // no space - gotta drop to the next line (which means creating a new texture and copying it across)
-      m_posX = 0;
-      m_posY += GetTextureLineHeight();
-      if (bitGlyph->left < 0)
-        m_posX += -bitGlyph->left;
-
-      if(m_posY + GetTextureLineHeight() >= m_textureHeight)
-      {
-        // create the new larger texture
-        unsigned int newHeight = m_posY + GetTextureLineHeight();
-        // check for max height
-        if (newHeight > g_Windowing.GetMaxTextureSize())
-        {
-          CLog::Log(LOGDEBUG, "%s: New cache texture is too large (%u > %u pixels long)", __FUNCTION__, newHeight, g_Windowing.GetMaxTextureSize());
-          FT_Done_Glyph(glyph);
-          return false;
-        }
-
-        CBaseTexture* newTexture = NULL;
-        newTexture = ReallocTexture(newHeight);
-        if(newTexture == NULL)
-        {
-          FT_Done_Glyph(glyph);
-          CLog::Log(LOGDEBUG, "%s: Failed to allocate new texture of height %u", __FUNCTION__, newHeight);
-          return false;
-        }
-        m_texture = newTexture;
-      }
-    }
-
-    if(m_texture == NULL)
-    {
-      FT_Done_Glyph(glyph);
-      CLog::Log(LOGDEBUG, "%s: no texture to cache character to", __FUNCTION__);
-      return false;
-    }
+    FT_Done_Glyph(glyph);
+    return false;
   }
+
   // set the character in our table
   ch->letterAndStyle = (style << 16) | letter;
   ch->offsetX = (short)bitGlyph->left;
   ch->offsetY = (short)m_cellBaseLine - bitGlyph->top;
-  ch->left = isEmptyGlyph ? 0 : ((float)m_posX + ch->offsetX);
-  ch->top = isEmptyGlyph ? 0 : ((float)m_posY + ch->offsetY);
+  ch->left = (float)posX;
+  ch->top = (float)posY;
   ch->right = ch->left + bitmap.width;
   ch->bottom = ch->top + bitmap.rows;
   ch->advance = (float)MathUtils::round_int( (float)m_face->glyph->advance.x / 64 );
+  ch->page = m_pages.size();
 
   // we need only render if we actually have some pixels
   if (!isEmptyGlyph)
   {
     // ensure our rect will stay inside the texture (it *should* but we need to be certain)
-    unsigned int x1 = max(m_posX + ch->offsetX, 0);
-    unsigned int y1 = max(m_posY + ch->offsetY, 0);
-    unsigned int x2 = min(x1 + bitmap.width, m_textureWidth);
-    unsigned int y2 = min(y1 + bitmap.rows, m_textureHeight);
-    CopyCharToTexture(bitGlyph, x1, y1, x2, y2);
-  
-    m_posX += spacing_between_characters_in_texture + (unsigned short)max(ch->right - ch->left + ch->offsetX, ch->advance);
+    unsigned int x2 = min(posX + bitmap.width, m_textureWidth);
+    unsigned int y2 = min(posY + bitmap.rows, m_textureHeight);
+    CopyCharToTexture(bitGlyph, posX, posY, x2, y2);
   }
-  m_numChars++;
 
   // free the glyph
   FT_Done_Glyph(glyph);
@@ -659,6 +603,268 @@ bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *
   return true;
 }
 
+bool CGUIFontTTFBase::AllocateGlyph(unsigned int width, unsigned int height, unsigned int &x, unsigned int &y)
+{
+  // leave a gap between glyphs so that filtering doesn't pick up their neighbours
+  width += spacing_between_characters_in_texture;
+  height += spacing_between_characters_in_texture;
+  if (width > m_textureWidth)
+    return false;
+
+  // round shelf heights up so that glyphs of similar height share a shelf
+  unsigned int step = std::max(4U, GetTextureLineHeight() / 4);
+  unsigned int shelfHeight = ((height + step - 1) / step) * step;
+
+  // use a shelf of the rounded height if there's one with room, else open a new shelf,
+  // falling back to the lowest taller shelf with room if the page is full
+  int best = -1;
+  for (unsigned int i = 0; i < m_shelves.size(); i++)
+  {
+    const Shelf &shelf = m_shelves[i];
+    if (shelf.height < height || shelf.x + width > m_textureWidth)
+      continue;
+    if (shelf.height == shelfHeight)
+    {
+      best = i;
+      break;
+    }
+    if (best < 0 || shelf.height < m_shelves[best].height)
+      best = i;
+  }
+  if (best < 0 || m_shelves[best].height != shelfHeight)
+  {
+    if (AddShelf(shelfHeight))
+      best = m_shelves.size() - 1;
+  }
+  if (best < 0)
+  { // this page is full - start another if the backend can render from it
+    if (!m_texture || m_pages.size() + 1 >= GetMaxPages())
+      return false;
+
+    CLog::Log(LOGDEBUG, "%s: glyph texture for %s, size %f is full, starting page %u", __FUNCTION__, m_strFilename.c_str(), m_height, (unsigned int)m_pages.size() + 2);
+    Page page;
+    page.texture = m_texture;
+    m_pages.push_back(page);
+    m_texture = NULL;
+    m_textureHeight = 0;
+    m_shelves.clear();
+    m_shelfEnd = 0;
+
+    if (!AddShelf(shelfHeight))
+      return false;
+    best = m_shelves.size() - 1;
+  }
+
+  Shelf &shelf = m_shelves[best];
+  x = shelf.x;
+  y = shelf.y;
+  shelf.x += width;
+  return true;
+}
+
+bool CGUIFontTTFBase::AddShelf(unsigned int height)
+{
+  if (m_shelfEnd + height > m_textureHeight || !m_texture)
+  {
+    // create the new larger texture
+    unsigned int newHeight = m_shelfEnd + height;
+    // check for max height
+    if (newHeight > g_Windowing.GetMaxTextureSize())
+      return false;
+
+    CBaseTexture* newTexture = ReallocTexture(newHeight);
+    if (newTexture == NULL)
+    {
+      CLog::Log(LOGDEBUG, "%s: Failed to allocate new texture of height %u", __FUNCTION__, newHeight);
+      return false;
+    }
+    m_texture = newTexture;
+    if (m_shelfEnd + height > m_textureHeight)
+      return false;
+  }
+
+  Shelf shelf = { m_shelfEnd, height, 0 };
+  m_shelves.push_back(shelf);
+  m_shelfEnd += height;
+  return true;
+}
+
+static void WriteUInt32(string &out, uint32_t value)
+{
+  out.append((const char *)&value, sizeof(value));
+}
+
+static bool ReadUInt32(const char *&data, const char *end, uint32_t &value)
+{
+  if (end - data < (ptrdiff_t)sizeof(value))
+    return false;
+  memcpy(&value, data, sizeof(value));
+  data += sizeof(value);
+  return true;
+}
+
+static CStdString GetGlyphCacheFile(const CStdString &key)
+{
+  Crc32 crc;
+  crc.Compute(key);
+  CStdString file;
+  file.Format(GLYPHCACHE_PATH "%08x.bin", (uint32_t)crc);
+  return file;
+}
+
+bool CGUIFontTTFBase::LoadGlyphCache()
+{
+  CStdString cacheFile = GetGlyphCacheFile(m_glyphCacheKey);
+  XFILE::CFile file;
+  if (!file.Open(cacheFile))
+    return false;
+
+  int64_t length = file.GetLength();
+  if (length <= 0 || length > 64 * 1024 * 1024)
+    return false;
+
+  vector<char> buffer((size_t)length);
+  if (file.Read(&buffer[0], length) != length)
+    return false;
+  file.Close();
+
+  const char *data = &buffer[0];
+  const char *end = data + length;
+
+  uint32_t version, keyLength;
+  if (end - data < 4 || memcmp(data, GLYPHCACHE_MAGIC, 4) != 0)
+    return false;
+  data += 4;
+  if (!ReadUInt32(data, end, version) || version != GLYPHCACHE_VERSION ||
+      !ReadUInt32(data, end, keyLength) || (uint32_t)(end - data) < keyLength ||
+      m_glyphCacheKey != CStdString(data, keyLength))
+    return false;
+  data += keyLength;
+
+  bool ok = true;
+  uint32_t pages;
+  ok = ReadUInt32(data, end, pages) && pages > 0 && pages <= GetMaxPages();
+  for (uint32_t i = 0; ok && i < pages; i++)
+  {
+    uint32_t height, pitch;
+    ok = ReadUInt32(data, end, height) && ReadUInt32(data, end, pitch) &&
+         height > 0 && height <= g_Windowing.GetMaxTextureSize();
+    if (!ok)
+      break;
+
+    // each page is a fresh texture, so make sure ReallocTexture() doesn't copy the last one in
+    if (m_texture)
+    {
+      Page page;
+      page.texture = m_texture;
+      m_pages.push_back(page);
+      m_texture = NULL;
+    }
+    m_textureHeight = 0;
+    unsigned int newHeight = height;
+    m_texture = ReallocTexture(newHeight);
+    ok = m_texture && m_textureHeight == height && m_texture->GetPitch() == pitch &&
+         (uint64_t)(end - data) >= (uint64_t)pitch * height;
+    if (ok)
+    {
+      memcpy(m_texture->GetPixels(), data, pitch * height);
+      data += pitch * height;
+    }
+  }
+
+  uint32_t shelves = 0;
+  ok = ok && ReadUInt32(data, end, m_shelfEnd) && m_shelfEnd <= m_textureHeight && ReadUInt32(data, end, shelves);
+  for (uint32_t i = 0; ok && i < shelves; i++)
+  {
+    Shelf shelf;
+    ok = ReadUInt32(data, end, shelf.y) && ReadUInt32(data, end, shelf.height) && ReadUInt32(data, end, shelf.x) &&
+         shelf.y + shelf.height <= m_shelfEnd && shelf.x <= m_textureWidth;
+    if (ok)
+      m_shelves.push_back(shelf);
+  }
+
+  uint32_t glyphs = 0;
+  ok = ok && ReadUInt32(data, end, glyphs) && (uint64_t)(end - data) == (uint64_t)glyphs * sizeof(Character);
+  for (uint32_t i = 0; ok && i < glyphs; i++)
+  {
+    Character ch;
+    memcpy(&ch, data, sizeof(Character));
+    data += sizeof(Character);
+
+    bool isEmptyGlyph = ch.right == ch.left || ch.bottom == ch.top;
+    if (!isEmptyGlyph && ch.page >= pages)
+    {
+      ok = false;
+      break;
+    }
+    Character *newChar = &(m_chars[ch.letterAndStyle] = ch);
+    character_t letter = ch.letterAndStyle & 0xffff;
+    if (letter < 255)
+      m_charquick[((ch.letterAndStyle & 0xffff0000) >> 8) | letter] = newChar;
+  }
+
+  if (!ok)
+  {
+    CLog::Log(LOGWARNING, "%s: invalid glyph cache %s for %s", __FUNCTION__, cacheFile.c_str(), m_strFilename.c_str());
+    ClearCharacterCache();
+    return false;
+  }
+
+  CLog::Log(LOGDEBUG, "%s: loaded %u glyphs on %u pages for %s, size %f", __FUNCTION__, glyphs, pages, m_strFilename.c_str(), m_height);
+  m_glyphCacheDirty = false;
+  return true;
+}
+
+void CGUIFontTTFBase::SaveGlyphCache()
+{
+  if (m_glyphCacheKey.IsEmpty() || !m_glyphCacheDirty || !m_texture)
+    return;
+
+  string out(GLYPHCACHE_MAGIC);
+  WriteUInt32(out, GLYPHCACHE_VERSION);
+  WriteUInt32(out, m_glyphCacheKey.size());
+  out.append(m_glyphCacheKey.c_str(), m_glyphCacheKey.size());
+
+  WriteUInt32(out, m_pages.size() + 1);
+  for (unsigned int i = 0; i <= m_pages.size(); i++)
+  {
+    const CBaseTexture *texture = i < m_pages.size() ? m_pages[i].texture : m_texture;
+    unsigned int height = i < m_pages.size() ? texture->GetHeight() : m_textureHeight;
+    WriteUInt32(out, height);
+    WriteUInt32(out, texture->GetPitch());
+    out.append((const char *)texture->GetPixels(), texture->GetPitch() * height);
+  }
+
+  WriteUInt32(out, m_shelfEnd);
+  WriteUInt32(out, m_shelves.size());
+  for (vector<Shelf>::const_iterator it = m_shelves.begin(); it != m_shelves.end(); ++it)
+  {
+    WriteUInt32(out, it->y);
+    WriteUInt32(out, it->height);
+    WriteUInt32(out, it->x);
+  }
+
+  WriteUInt32(out, m_chars.size());
+  for (CharacterMap::const_iterator it = m_chars.begin(); it != m_chars.end(); ++it)
+    out.append((const char *)&it->second, sizeof(Character));
+
+  if (!XFILE::CDirectory::Exists(GLYPHCACHE_PATH))
+    XFILE::CDirectory::Create(GLYPHCACHE_PATH);
+
+  CStdString cacheFile = GetGlyphCacheFile(m_glyphCacheKey);
+  XFILE::CFile file;
+  if (!file.OpenForWrite(cacheFile, true))
+  {
+    CLog::Log(LOGWARNING, "%s: unable to write %s", __FUNCTION__, cacheFile.c_str());
+    return;
+  }
+  bool ret = file.Write(out.c_str(), out.size()) == (int)out.size();
+  file.Close();
+  if (!ret)
+    XFILE::CFile::Delete(cacheFile);
+  m_glyphCacheDirty = false;
+}
+
 void CGUIFontTTFBase::RenderCharacter(float posX, float posY, const Character *ch, color_t color, bool roundX)
 {
   // actual image width isn't same as the character width as that is
@@ -719,11 +925,15 @@ void CGUIFontTTFBase::RenderCharacter(float posX, float posY, const Character *c
   z[2] = (float)MathUtils::round_int(g_graphicsContext.ScaleFinalZCoord(vertex.x2, vertex.y2));
   z[3] = (float)MathUtils::round_int(g_graphicsContext.ScaleFinalZCoord(vertex.x1, vertex.y2));
 
+  // glyphs on full pages are rendered from a different texture
+  bool currentPage = ch->page >= m_pages.size();
+  float scaleY = currentPage ? m_textureScaleY : 1.0f / m_pages[ch->page].texture->GetHeight();
+
   // tex coords converted to 0..1 range
   float tl = texture.x1 * m_textureScaleX;
   float tr = texture.x2 * m_textureScaleX;
-  float tt = texture.y1 * m_textureScaleY;
-  float tb = texture.y2 * m_textureScaleY;
+  float tt = texture.y1 * scaleY;
+  float tb = texture.y2 * scaleY;
 
   // grow the vertex buffer if required
   if(m_vertex_count >= m_vertex_size)
@@ -738,9 +948,12 @@ void CGUIFontTTFBase::RenderCharacter(float posX, float posY, const Character *c
       return;
     }
   }
+  // the quads of all pages share the buffer, so they're drawn in the order they were rendered
+  SVertex* v = m_vertex + m_vertex_count;
+  m_vertex_count += 4;
+  m_vertexPages.push_back(ch->page);
 
   m_color = color;
-  SVertex* v = m_vertex + m_vertex_count;
 
   unsigned char r = GET_R(color)
               , g = GET_G(color)
@@ -807,8 +1020,6 @@ void CGUIFontTTFBase::RenderCharacter(float posX, float posY, const Character *c
   v[3].y = y[2];
   v[3].z = z[2];
 #endif
-
-  m_vertex_count+=4;
 }
 
 // Oblique code - original taken from freetype2 (ftsynth.c)
@@ -27,6 +27,9 @@
  *
  */
 
+#include <vector>
+#include <boost/unordered_map.hpp>
+
 // forward definition
 class CBaseTexture;
 
@@ -89,6 +92,7 @@ protected:
     float left, top, right, bottom;
     float advance;
     character_t letterAndStyle;
+    unsigned int page;    // atlas page holding the glyph
   };
   void AddReference();
   void RemoveReference();
@@ -112,20 +116,60 @@ protected:
   void RenderCharacter(float posX, float posY, const Character *ch, color_t color, bool roundX);
   void ClearCharacterCache();
 
+  /*! \brief Find room for a glyph in the atlas
+   Glyphs are shelf packed: each shelf is a strip of the page filled left to right with glyphs
+   of about its height. New shelves are added below the last one, growing the texture as needed,
+   and once the page is at the maximum texture size a new page is started.
+   \param width width of the glyph in pixels
+   \param height height of the glyph in pixels
+   \param x [out] left of the glyph in the current page
+   \param y [out] top of the glyph in the current page
+   \return true if the glyph has been given a place, false if the atlas is full
+   */
+  bool AllocateGlyph(unsigned int width, unsigned int height, unsigned int &x, unsigned int &y);
+  bool AddShelf(unsigned int height);
+
   virtual CBaseTexture* ReallocTexture(unsigned int& newHeight) = 0;
   virtual bool CopyCharToTexture(FT_BitmapGlyph bitGlyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2) = 0;
   virtual void DeleteHardwareTexture() = 0;
 
+  /*! \brief Maximum number of texture pages the glyphs may be spread over
+   Backends that can only render from a single texture keep the default of 1, in which case the
+   glyph cache is cleared once its texture is full.
+   */
+  virtual unsigned int GetMaxPages() const { return 1; }
+
+  /*! \brief Whether the glyph pages are held in system memory, so they can be saved to the glyph cache on disk */
+  virtual bool CanCacheGlyphs() const { return false; }
+
+  bool LoadGlyphCache();
+  void SaveGlyphCache();
+
   // modifying glyphs
   void EmboldenGlyph(FT_GlyphSlot slot);
   static void ObliqueGlyph(FT_GlyphSlot slot);
 
-  CBaseTexture* m_texture;        // texture that holds our rendered characters (8bit alpha only)
+  CBaseTexture* m_texture;        // atlas page currently being filled (8bit alpha only)
 
   unsigned int m_textureWidth;       // width of our texture
   unsigned int m_textureHeight;      // heigth of our texture
-  int m_posX;                        // current position in the texture
-  int m_posY;
+
+  /*! \brief A full page of the atlas
+   */
+  struct Page
+  {
+    CBaseTexture*        texture;
+  };
+  std::vector<Page> m_pages;         // full pages, m_texture is the page after these
+
+  struct Shelf
+  {
+    unsigned int y;
+    unsigned int height;
+    unsigned int x;                  // first free column
+  };
+  std::vector<Shelf> m_shelves;      // shelves of the current page
+  unsigned int m_shelfEnd;           // first row below the last shelf
 
   /*! \brief the height of each line in the texture.
    Accounts for spacing between lines to avoid characters overlapping.
@@ -135,10 +179,12 @@ protected:
 
   color_t m_color;
 
-  Character *m_char;                 // our characters
+  typedef boost::unordered_map<character_t, Character> CharacterMap;
+  CharacterMap m_chars;              // our characters, keyed on style and letter
   Character *m_charquick[256*4];     // ascii chars (4 styles) here
-  int m_maxChars;                    // size of character array (can be incremented)
-  int m_numChars;                    // the current number of cached characters
+
+  CStdString m_glyphCacheKey;        // font file, size and style of the glyphs, empty if they aren't cached on disk
+  bool m_glyphCacheDirty;            // glyphs were added since the cache was loaded
 
   float m_ellipsesWidth;               // this is used every character (width of '.')
 
@@ -160,6 +206,7 @@ protected:
   SVertex* m_vertex;
   int      m_vertex_count;
   int      m_vertex_size;
+  std::vector<unsigned int> m_vertexPages;  // atlas page of each quad in m_vertex
 
   float    m_textureScaleX;
   float    m_textureScaleY;
@@ -94,6 +94,7 @@ void CGUIFontTTFDX::Begin()
 
     pD3DDevice->SetFVF(D3DFVF_XYZ | D3DFVF_DIFFUSE | D3DFVF_TEX1);
     m_vertex_count = 0;
+    m_vertexPages.clear();
   }
 
   // Keep track of the nested begin/end calls.
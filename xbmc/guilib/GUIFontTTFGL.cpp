@@ -21,6 +21,8 @@
 #include "system.h"
 #include "GUIFont.h"
 #include "GUIFontTTFGL.h"
+#include "GUIRenderBatch.h"
+#include "GUIFrameProfiler.h"
 #include "GUIFontManager.h"
 #include "Texture.h"
 #include "TextureManager.h"
@@ -44,83 +46,43 @@ using namespace std;
 CGUIFontTTFGL::CGUIFontTTFGL(const CStdString& strFileName)
 : CGUIFontTTFBase(strFileName)
 {
+  m_updateY1 = m_updateY2 = 0;
 }
 
 CGUIFontTTFGL::~CGUIFontTTFGL(void)
 {
+  DeleteHardwareTexture();
 }
 
-void CGUIFontTTFGL::Begin()
+unsigned int CGUIFontTTFGL::CreateHardwareTexture(const CBaseTexture *texture)
 {
-  if (m_nestedBeginCount == 0 && m_texture != NULL)
-  {
-    if (!m_bTextureLoaded)
-    {
-      // Have OpenGL generate a texture object handle for us
-      glGenTextures(1, (GLuint*) &m_nTexture);
-
-      // Bind the texture object
-      glBindTexture(GL_TEXTURE_2D, m_nTexture);
-#ifdef HAS_GL
-      glEnable(GL_TEXTURE_2D);
-#endif
-      // Set the texture's stretching properties
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-      // Set the texture image -- THIS WORKS, so the pixels must be wrong.
-      glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, m_texture->GetWidth(), m_texture->GetHeight(), 0,
-                   GL_ALPHA, GL_UNSIGNED_BYTE, m_texture->GetPixels());
+  GLuint id;
+  // Have OpenGL generate a texture object handle for us
+  glGenTextures(1, &id);
 
-      VerifyGLState();
-      m_bTextureLoaded = true;
-    }
-
-    // Turn Blending On
-    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE_MINUS_DST_ALPHA, GL_ONE);
-    glEnable(GL_BLEND);
+  // Bind the texture object
+  glBindTexture(GL_TEXTURE_2D, id);
 #ifdef HAS_GL
-    glEnable(GL_TEXTURE_2D);
+  glEnable(GL_TEXTURE_2D);
 #endif
-    glBindTexture(GL_TEXTURE_2D, m_nTexture);
+  // Set the texture's stretching properties
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-#ifdef HAS_GL
-    glTexEnvi(GL_TEXTURE_ENV,GL_TEXTURE_ENV_MODE,GL_COMBINE);
-    glTexEnvi(GL_TEXTURE_ENV,GL_COMBINE_RGB,GL_REPLACE);
-    glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_PRIMARY_COLOR);
-    glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND0_RGB, GL_SRC_COLOR);
-    glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_MODULATE);
-    glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_ALPHA, GL_TEXTURE0);
-    glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND0_ALPHA, GL_SRC_ALPHA);
-    glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE1_ALPHA, GL_PRIMARY_COLOR);
-    glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND1_ALPHA, GL_SRC_ALPHA);
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    VerifyGLState();
-
-    if(g_Windowing.UseLimitedColor())
-    {
-      glActiveTexture(GL_TEXTURE1);
-      glBindTexture(GL_TEXTURE_2D, m_nTexture); // dummy bind
-      glEnable(GL_TEXTURE_2D);
-
-      const GLfloat rgba[4] = {16.0f / 255.0f, 16.0f / 255.0f, 16.0f / 255.0f, 0.0f};
-      glTexEnvi (GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE , GL_COMBINE);
-      glTexEnvfv(GL_TEXTURE_ENV, GL_TEXTURE_ENV_COLOR, rgba);
-      glTexEnvi (GL_TEXTURE_ENV, GL_COMBINE_RGB      , GL_ADD);
-      glTexEnvi (GL_TEXTURE_ENV, GL_SOURCE0_RGB      , GL_PREVIOUS);
-      glTexEnvi (GL_TEXTURE_ENV, GL_SOURCE1_RGB      , GL_CONSTANT);
-      glTexEnvi (GL_TEXTURE_ENV, GL_OPERAND0_RGB     , GL_SRC_COLOR);
-      glTexEnvi (GL_TEXTURE_ENV, GL_OPERAND1_RGB     , GL_SRC_COLOR);
-      glTexEnvi (GL_TEXTURE_ENV, GL_COMBINE_ALPHA    , GL_REPLACE);
-      glTexEnvi (GL_TEXTURE_ENV, GL_SOURCE0_ALPHA    , GL_PREVIOUS);
-      VerifyGLState();
-    }
+  // Set the texture image -- THIS WORKS, so the pixels must be wrong.
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, texture->GetWidth(), texture->GetHeight(), 0,
+               GL_ALPHA, GL_UNSIGNED_BYTE, texture->GetPixels());
 
-#else
-    g_Windowing.EnableGUIShader(SM_FONTS);
-#endif
+  VerifyGLState();
+  return id;
+}
 
+void CGUIFontTTFGL::Begin()
+{
+  if (m_nestedBeginCount == 0)
+  {
     m_vertex_count = 0;
+    m_vertexPages.clear();
   }
   // Keep track of the nested begin/end calls.
   m_nestedBeginCount++;
@@ -134,66 +96,94 @@ void CGUIFontTTFGL::End()
   if (--m_nestedBeginCount > 0)
     return;
 
-#ifdef HAS_GL
-  glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
-
-  glColorPointer   (4, GL_UNSIGNED_BYTE, sizeof(SVertex), (char*)m_vertex + offsetof(SVertex, r));
-  glVertexPointer  (3, GL_FLOAT        , sizeof(SVertex), (char*)m_vertex + offsetof(SVertex, x));
-  glTexCoordPointer(2, GL_FLOAT        , sizeof(SVertex), (char*)m_vertex + offsetof(SVertex, u));
-  glEnableClientState(GL_COLOR_ARRAY);
-  glEnableClientState(GL_VERTEX_ARRAY);
-  glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-  glDrawArrays(GL_QUADS, 0, m_vertex_count);
-  glPopClientAttrib();
-
-  glBindTexture(GL_TEXTURE_2D, 0);
-  glActiveTexture(GL_TEXTURE0);
-#else
-  // GLES 2.0 version. Cannot draw quads. Convert to triangles.
-  GLint posLoc  = g_Windowing.GUIShaderGetPos();
-  GLint colLoc  = g_Windowing.GUIShaderGetCol();
-  GLint tex0Loc = g_Windowing.GUIShaderGetCoord0();
-
-  // stack object until VBOs will be used
-  std::vector<SVertex> vecVertices( 6 * (m_vertex_count / 4) );
-  SVertex *vertices = &vecVertices[0];
-
-  for (int i=0; i<m_vertex_count; i+=4)
+  // upload after rendering, so glyphs cached while rendering are drawn straight away
+  if (m_texture)
   {
-    *vertices++ = m_vertex[i];
-    *vertices++ = m_vertex[i+1];
-    *vertices++ = m_vertex[i+2];
-
-    *vertices++ = m_vertex[i+1];
-    *vertices++ = m_vertex[i+3];
-    *vertices++ = m_vertex[i+2];
+    if (!m_bTextureLoaded)
+    {
+      CGUIFrameProfilerScope profile(CGUIFrameProfiler::CATEGORY_TEXTURE, "Glyph upload", m_texture->GetWidth(), m_texture->GetHeight());
+      m_nTexture = CreateHardwareTexture(m_texture);
+      m_bTextureLoaded = true;
+      m_updateY1 = m_updateY2 = 0;
+    }
+    else if (m_updateY2 > m_updateY1)
+    { // upload only the rows that have had glyphs added
+      CGUIFrameProfilerScope profile(CGUIFrameProfiler::CATEGORY_TEXTURE, "Glyph upload", m_texture->GetWidth(), m_updateY2 - m_updateY1);
+      glBindTexture(GL_TEXTURE_2D, m_nTexture);
+      glTexSubImage2D(GL_TEXTURE_2D, 0, 0, m_updateY1, m_texture->GetWidth(), m_updateY2 - m_updateY1,
+                      GL_ALPHA, GL_UNSIGNED_BYTE, m_texture->GetPixels() + m_updateY1 * m_texture->GetPitch());
+      VerifyGLState();
+      m_updateY1 = m_updateY2 = 0;
+    }
   }
 
-  vertices = &vecVertices[0];
-
-  glVertexAttribPointer(posLoc,  3, GL_FLOAT,         GL_FALSE, sizeof(SVertex), (char*)vertices + offsetof(SVertex, x));
-  // Normalize color values. Does not affect Performance at all.
-  glVertexAttribPointer(colLoc,  4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(SVertex), (char*)vertices + offsetof(SVertex, r));
-  glVertexAttribPointer(tex0Loc, 2, GL_FLOAT,         GL_FALSE, sizeof(SVertex), (char*)vertices + offsetof(SVertex, u));
-
-  glEnableVertexAttribArray(posLoc);
-  glEnableVertexAttribArray(colLoc);
-  glEnableVertexAttribArray(tex0Loc);
-
-  glDrawArrays(GL_TRIANGLES, 0, vecVertices.size());
+  // submit the quads in the order they were rendered, switching texture whenever the page changes
+  // so that e.g. shadows stay below their text
+  unsigned int quads = m_vertexPages.size();
+  for (unsigned int start = 0, end; start < quads; start = end)
+  {
+    unsigned int page = m_vertexPages[start];
+    for (end = start + 1; end < quads && m_vertexPages[end] == page; end++)
+      ;
+    SubmitVertices(GetPageTexture(page), m_vertex + start * 4, (end - start) * 4);
+  }
+}
 
-  glDisableVertexAttribArray(posLoc);
-  glDisableVertexAttribArray(colLoc);
-  glDisableVertexAttribArray(tex0Loc);
+unsigned int CGUIFontTTFGL::GetPageTexture(unsigned int page)
+{
+  if (page >= m_pages.size())
+    return m_nTexture;
+
+  if (m_pageTextures.size() <= page)
+    m_pageTextures.resize(page + 1, 0);
+  if (!m_pageTextures[page])
+    m_pageTextures[page] = CreateHardwareTexture(m_pages[page].texture);
+  return m_pageTextures[page];
+}
 
-  g_Windowing.DisableGUIShader();
+void CGUIFontTTFGL::SubmitVertices(unsigned int texture, const SVertex *vertices, int count)
+{
+#ifdef HAS_GL
+  static const int order[4] = { 0, 1, 2, 3 };
+#else
+  // the vertices are in triangle strip order for GLES, the batch takes them clockwise
+  static const int order[4] = { 0, 2, 3, 1 };
 #endif
+
+  for (int i = 0; i + 3 < count; i += 4)
+  {
+    CGUIRenderBatch::Vertex *quad = CGUIRenderBatch::Get().AddQuad(CGUIRenderBatch::MODE_FONT, texture, 0, true, 0);
+    for (int j = 0; j < 4; j++)
+    {
+      const SVertex &vertex = vertices[i + order[j]];
+      quad[j].x = vertex.x;
+      quad[j].y = vertex.y;
+      quad[j].z = vertex.z;
+      quad[j].r = vertex.r;
+      quad[j].g = vertex.g;
+      quad[j].b = vertex.b;
+      quad[j].a = vertex.a;
+      quad[j].u1 = vertex.u;
+      quad[j].v1 = vertex.v;
+      quad[j].u2 = quad[j].v2 = 0;
+    }
+  }
 }
 
 CBaseTexture* CGUIFontTTFGL::ReallocTexture(unsigned int& newHeight)
 {
   newHeight = CBaseTexture::PadPow2(newHeight);
 
+  // the current page is being replaced, so its hardware texture has to be recreated
+  if (m_bTextureLoaded)
+  {
+    g_graphicsContext.BeginPaint();  //FIXME
+    if (glIsTexture(m_nTexture))
+      g_TextureManager.ReleaseHwTexture(m_nTexture);
+    g_graphicsContext.EndPaint();
+    m_bTextureLoaded = false;
+  }
+
   CBaseTexture* newTexture = new CTexture(m_textureWidth, newHeight, XB_FMT_A8);
 
   if (!newTexture || newTexture->GetPixels() == NULL)
@@ -241,14 +231,16 @@ bool CGUIFontTTFGL::CopyCharToTexture(FT_BitmapGlyph bitGlyph, unsigned int x1,
   }
   // THE SOURCE VALUES ARE THE SAME IN BOTH SITUATIONS.
 
-  // Since we have a new texture, we need to delete the old one
-  // the Begin(); End(); stuff is handled by whoever called us
-  if (m_bTextureLoaded)
+  // the changed rows are uploaded on the next End()
+  if (m_updateY2 > m_updateY1)
   {
-    g_graphicsContext.BeginPaint();  //FIXME
-    DeleteHardwareTexture();
-    g_graphicsContext.EndPaint();
-    m_bTextureLoaded = false;
+    m_updateY1 = std::min(m_updateY1, y1);
+    m_updateY2 = std::max(m_updateY2, y2);
+  }
+  else
+  {
+    m_updateY1 = y1;
+    m_updateY2 = y2;
   }
 
   return TRUE;
@@ -263,6 +255,12 @@ void CGUIFontTTFGL::DeleteHardwareTexture()
       g_TextureManager.ReleaseHwTexture(m_nTexture);
     m_bTextureLoaded = false;
   }
+  for (std::vector<unsigned int>::iterator it = m_pageTextures.begin(); it != m_pageTextures.end(); ++it)
+  {
+    if (*it && glIsTexture(*it))
+      g_TextureManager.ReleaseHwTexture(*it);
+  }
+  m_pageTextures.clear();
 }
 
 #endif
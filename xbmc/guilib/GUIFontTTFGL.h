@@ -48,7 +48,18 @@ protected:
   virtual CBaseTexture* ReallocTexture(unsigned int& newHeight);
   virtual bool CopyCharToTexture(FT_BitmapGlyph bitGlyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2);
   virtual void DeleteHardwareTexture();
+  virtual unsigned int GetMaxPages() const { return 4; }
+  virtual bool CanCacheGlyphs() const { return true; }
 
+private:
+  static unsigned int CreateHardwareTexture(const CBaseTexture *texture);
+  void SubmitVertices(unsigned int texture, const SVertex *vertices, int count);
+  /*! \brief The hardware texture of an atlas page, uploading full pages on first use */
+  unsigned int GetPageTexture(unsigned int page);
+
+  std::vector<unsigned int> m_pageTextures; ///< hardware textures of the full pages, 0 until uploaded
+  unsigned int m_updateY1;                  ///< rows of the current page changed since it was uploaded
+  unsigned int m_updateY2;
 };
 
 #endif
@@ -0,0 +1,278 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUIFrameProfiler.h"
+#include "GUIControlFactory.h"
+#include "GUIRenderBatch.h"
+#include "threads/SingleLock.h"
+#include "utils/TimeUtils.h"
+#include "utils/Variant.h"
+#include "utils/log.h"
+
+#include <string.h>
+
+// about 40 bytes each, enough for a few seconds of controls or a minute of windows
+#define PROFILER_MAX_EVENTS 32768
+#define PROFILER_MAX_FRAMES 3600
+
+CGUIFrameProfiler::CGUIFrameProfiler()
+{
+  m_level = LEVEL_OFF;
+  m_thread = CThread::GetCurrentThreadId();
+  m_nextEvent = 0;
+  m_eventsWrapped = false;
+  m_nextFrame = 0;
+  m_framesWrapped = false;
+  memset(&m_current, 0, sizeof(m_current));
+  m_infoDepth = 0;
+  m_infoStart = 0;
+  m_lastDrawCalls = 0;
+  m_lastQuads = 0;
+}
+
+CGUIFrameProfiler &CGUIFrameProfiler::Get()
+{
+  static CGUIFrameProfiler profiler;
+  return profiler;
+}
+
+void CGUIFrameProfiler::SetLevel(int level)
+{
+  CSingleLock lock(m_section);
+  if (level < LEVEL_OFF || level > LEVEL_CONTROLS)
+    level = LEVEL_OFF;
+  if (level == m_level)
+    return;
+
+  CLog::Log(LOGDEBUG, "%s: recording at level %i", __FUNCTION__, level);
+  m_level = level;
+  if (m_level == LEVEL_OFF)
+  { // release the buffers
+    std::vector<Event>().swap(m_events);
+    std::vector<Frame>().swap(m_frames);
+  }
+  else
+  {
+    m_events.resize(PROFILER_MAX_EVENTS);
+    m_frames.resize(PROFILER_MAX_FRAMES);
+  }
+  m_nextEvent = m_nextFrame = 0;
+  m_eventsWrapped = m_framesWrapped = false;
+}
+
+void CGUIFrameProfiler::AddEvent(Category category, const char *name, int id, int extra, int64_t start, unsigned int drawCalls)
+{
+  int64_t end = CurrentHostCounter();
+
+  CSingleLock lock(m_section);
+  if (m_events.empty())
+    return;
+
+  Event &event = m_events[m_nextEvent];
+  event.name = name;
+  event.category = category;
+  event.id = id;
+  event.extra = extra;
+  event.start = start;
+  event.duration = end - start;
+  event.drawCalls = drawCalls;
+
+  if (++m_nextEvent == m_events.size())
+  {
+    m_nextEvent = 0;
+    m_eventsWrapped = true;
+  }
+}
+
+bool CGUIFrameProfiler::BeginInfo()
+{
+  // only the GUI thread gets past here, so no lock is needed for the counters
+  if (!IsRecording(CATEGORY_FRAME))
+    return false;
+  if (m_infoDepth++ == 0)
+    m_infoStart = CurrentHostCounter();
+  return true;
+}
+
+void CGUIFrameProfiler::EndInfo()
+{
+  if (--m_infoDepth == 0)
+    m_current.infoTime += CurrentHostCounter() - m_infoStart;
+  m_current.infoEvaluations++;
+}
+
+void CGUIFrameProfiler::EndFrame()
+{
+  // the GUI may be run by a different thread than the one that created us
+  m_thread = CThread::GetCurrentThreadId();
+
+  unsigned int drawCalls = CGUIRenderBatch::Get().GetDrawCalls();
+  unsigned int quads = CGUIRenderBatch::Get().GetQuads();
+  m_current.time = CurrentHostCounter();
+  m_current.drawCalls = drawCalls - m_lastDrawCalls;
+  m_current.quads = quads - m_lastQuads;
+  m_lastDrawCalls = drawCalls;
+  m_lastQuads = quads;
+
+  if (m_level > LEVEL_OFF)
+  {
+    CSingleLock lock(m_section);
+    if (!m_frames.empty())
+    {
+      m_frames[m_nextFrame] = m_current;
+      if (++m_nextFrame == m_frames.size())
+      {
+        m_nextFrame = 0;
+        m_framesWrapped = true;
+      }
+    }
+  }
+  memset(&m_current, 0, sizeof(m_current));
+}
+
+static double ToMicroSeconds(int64_t ticks, int64_t frequency)
+{
+  return (double)ticks * 1000000.0 / frequency;
+}
+
+static const char *CategoryName(CGUIFrameProfiler::Category category)
+{
+  switch (category)
+  {
+  case CGUIFrameProfiler::CATEGORY_FRAME:
+    return "frame";
+  case CGUIFrameProfiler::CATEGORY_WINDOW:
+    return "window";
+  case CGUIFrameProfiler::CATEGORY_CONTROL:
+    return "control";
+  case CGUIFrameProfiler::CATEGORY_TEXTURE:
+    return "texture";
+  }
+  return "";
+}
+
+static void AddCounter(CVariant &traceEvents, const char *name, double ts, const CVariant &value)
+{
+  CVariant item(CVariant::VariantTypeObject);
+  item["name"] = name;
+  item["cat"] = "frame";
+  item["ph"] = "C";
+  item["ts"] = ts;
+  item["pid"] = 1;
+  item["args"]["value"] = value;
+  traceEvents.push_back(item);
+}
+
+void CGUIFrameProfiler::GetTrace(CVariant &trace, bool clear)
+{
+  std::vector<Event> events;
+  std::vector<Frame> frames;
+  {
+    // copy the buffers in order, oldest first, so the lock isn't held while building the trace
+    CSingleLock lock(m_section);
+    if (m_eventsWrapped)
+      events.insert(events.end(), m_events.begin() + m_nextEvent, m_events.end());
+    events.insert(events.end(), m_events.begin(), m_events.begin() + m_nextEvent);
+    if (m_framesWrapped)
+      frames.insert(frames.end(), m_frames.begin() + m_nextFrame, m_frames.end());
+    frames.insert(frames.end(), m_frames.begin(), m_frames.begin() + m_nextFrame);
+    if (clear)
+    {
+      m_nextEvent = m_nextFrame = 0;
+      m_eventsWrapped = m_framesWrapped = false;
+    }
+  }
+
+  int64_t frequency = CurrentHostFrequency();
+  trace = CVariant(CVariant::VariantTypeObject);
+  trace["displayTimeUnit"] = "ms";
+  trace["traceEvents"] = CVariant(CVariant::VariantTypeArray);
+  CVariant &traceEvents = trace["traceEvents"];
+
+  for (unsigned int i = 0; i < events.size(); i++)
+  {
+    const Event &event = events[i];
+    CVariant item(CVariant::VariantTypeObject);
+    CStdString name(event.name);
+    CVariant args(CVariant::VariantTypeObject);
+    switch (event.category)
+    {
+    case CATEGORY_WINDOW:
+      name.AppendFormat(" window %i", event.id);
+      args["window"] = event.id;
+      break;
+    case CATEGORY_CONTROL:
+      name.AppendFormat(" %s %i", CGUIControlFactory::TranslateControlType((CGUIControl::GUICONTROLTYPES)event.extra).c_str(), event.id);
+      args["control"] = event.id;
+      break;
+    case CATEGORY_TEXTURE:
+      name.AppendFormat(" %ix%i", event.id, event.extra);
+      args["width"] = event.id;
+      args["height"] = event.extra;
+      break;
+    default:
+      break;
+    }
+    if (event.drawCalls)
+      args["drawcalls"] = event.drawCalls;
+
+    item["name"] = name;
+    item["cat"] = CategoryName(event.category);
+    item["ph"] = "X";
+    item["ts"] = ToMicroSeconds(event.start, frequency);
+    item["dur"] = ToMicroSeconds(event.duration, frequency);
+    item["pid"] = 1;
+    item["tid"] = 1;
+    item["args"] = args;
+    traceEvents.push_back(item);
+  }
+
+  // counters are drawn as separate tracks, so each gets its own name
+  for (unsigned int i = 0; i < frames.size(); i++)
+  {
+    const Frame &frame = frames[i];
+    double ts = ToMicroSeconds(frame.time, frequency);
+    AddCounter(traceEvents, "info time (ms)", ts, ToMicroSeconds(frame.infoTime, frequency) / 1000.0);
+    AddCounter(traceEvents, "info evaluations", ts, frame.infoEvaluations);
+    AddCounter(traceEvents, "draw calls", ts, frame.drawCalls);
+    AddCounter(traceEvents, "quads", ts, frame.quads);
+  }
+}
+
+CGUIFrameProfilerScope::CGUIFrameProfilerScope(CGUIFrameProfiler::Category category, const char *name, int id, int extra)
+{
+  m_category = category;
+  m_name = name;
+  m_id = id;
+  m_extra = extra;
+  m_start = 0;
+  m_drawCalls = 0;
+  if (CGUIFrameProfiler::Get().IsRecording(category))
+  {
+    m_drawCalls = CGUIRenderBatch::Get().GetDrawCalls();
+    m_start = CurrentHostCounter();
+  }
+}
+
+CGUIFrameProfilerScope::~CGUIFrameProfilerScope()
+{
+  if (m_start)
+    CGUIFrameProfiler::Get().AddEvent(m_category, m_name, m_id, m_extra, m_start, CGUIRenderBatch::Get().GetDrawCalls() - m_drawCalls);
+}
@@ -0,0 +1,178 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "threads/CriticalSection.h"
+#include "threads/Thread.h"
+
+#include <stdint.h>
+#include <vector>
+
+class CVariant;
+
+/*!
+ \ingroup guilib
+ \brief Records the time spent on each frame of the GUI into a ring buffer
+
+ Timed events are kept for the processing and rendering of each frame, window and (at the
+ highest level) control, as well as for texture uploads. Once per frame the time spent
+ evaluating info booleans and labels and the draw calls and quads issued are sampled.
+ Only the thread running the GUI is recorded, and the oldest events are overwritten once
+ the buffer is full, so the profiler can be left running.
+
+ The recorded frames can be exported in the Chrome trace event format (chrome://tracing)
+ with GetTrace(), which JSON-RPC makes available as GUI.GetFrameProfile.
+
+ The level is set with <gui><frameprofiler> in advancedsettings.xml.
+ */
+class CGUIFrameProfiler
+{
+public:
+  enum Level
+  {
+    LEVEL_OFF = 0,  ///< nothing is recorded
+    LEVEL_WINDOWS,  ///< frames, windows, texture uploads and the per frame counters
+    LEVEL_CONTROLS  ///< as LEVEL_WINDOWS plus every control
+  };
+
+  enum Category
+  {
+    CATEGORY_FRAME = 0, ///< window manager process, render and render passes
+    CATEGORY_WINDOW,    ///< id is the window id
+    CATEGORY_CONTROL,   ///< id is the control id, extra the control type
+    CATEGORY_TEXTURE    ///< id is the width, extra the height
+  };
+
+  static CGUIFrameProfiler &Get();
+
+  void SetLevel(int level);
+  int GetLevel() const { return m_level; }
+
+  /*! \brief Whether events of the given category are recorded for the calling thread
+   */
+  bool IsRecording(Category category) const
+  {
+    return m_level > LEVEL_OFF && (category != CATEGORY_CONTROL || m_level >= LEVEL_CONTROLS) &&
+           CThread::IsCurrentThread(m_thread);
+  }
+
+  /*! \brief Record a timed event
+   \param category the category of the event
+   \param name name of the event, must be a static string
+   \param id window id, control id or texture width depending on the category
+   \param extra control type or texture height depending on the category
+   \param start host counter at the start of the event
+   \param drawCalls draw calls issued during the event
+   \sa CGUIFrameProfilerScope
+   */
+  void AddEvent(Category category, const char *name, int id, int extra, int64_t start, unsigned int drawCalls);
+
+  /*! \brief Start timing the evaluation of an info boolean or label
+   Evaluations made while another is being timed count towards the outer one.
+   \return true if the evaluation is timed, in which case EndInfo() must be called
+   \sa CGUIFrameProfilerInfoScope
+   */
+  bool BeginInfo();
+  void EndInfo();
+
+  /*! \brief Take the per frame counters. Called once per frame by the window manager on the GUI thread.
+   */
+  void EndFrame();
+
+  /*! \brief Export the recorded events in the Chrome trace event format
+   \param trace [out] object with the events in "traceEvents"
+   \param clear whether to drop the recorded events afterwards
+   */
+  void GetTrace(CVariant &trace, bool clear);
+
+private:
+  CGUIFrameProfiler();
+  CGUIFrameProfiler(const CGUIFrameProfiler&);
+  CGUIFrameProfiler const& operator=(CGUIFrameProfiler const&);
+
+  struct Event
+  {
+    const char  *name;
+    Category     category;
+    int          id;
+    int          extra;
+    int64_t      start;
+    int64_t      duration;
+    unsigned int drawCalls;
+  };
+
+  struct Frame
+  {
+    int64_t      time;
+    int64_t      infoTime;
+    unsigned int infoEvaluations;
+    unsigned int drawCalls;
+    unsigned int quads;
+  };
+
+  CCriticalSection   m_section;
+  int                m_level;
+  ThreadIdentifier   m_thread;        ///< thread the events are recorded for
+  std::vector<Event> m_events;
+  unsigned int       m_nextEvent;     ///< position in m_events the next event is written to
+  bool               m_eventsWrapped; ///< true once m_events has been filled
+  std::vector<Frame> m_frames;
+  unsigned int       m_nextFrame;
+  bool               m_framesWrapped;
+  Frame              m_current;       ///< counters of the frame being recorded
+  unsigned int       m_infoDepth;     ///< info evaluations being timed
+  int64_t            m_infoStart;     ///< start of the outermost info evaluation
+  unsigned int       m_lastDrawCalls;
+  unsigned int       m_lastQuads;
+};
+
+/*!
+ \ingroup guilib
+ \brief Records the time from its construction to its destruction as a frame profiler event
+ */
+class CGUIFrameProfilerScope
+{
+public:
+  CGUIFrameProfilerScope(CGUIFrameProfiler::Category category, const char *name, int id = 0, int extra = 0);
+  ~CGUIFrameProfilerScope();
+
+private:
+  CGUIFrameProfiler::Category m_category;
+  const char  *m_name;
+  int          m_id;
+  int          m_extra;
+  int64_t      m_start;       ///< 0 if the event isn't recorded
+  unsigned int m_drawCalls;
+};
+
+/*!
+ \ingroup guilib
+ \brief Adds the time from its construction to its destruction to the info evaluation time of the frame
+ */
+class CGUIFrameProfilerInfoScope
+{
+public:
+  CGUIFrameProfilerInfoScope() { m_timed = CGUIFrameProfiler::Get().BeginInfo(); }
+  ~CGUIFrameProfilerInfoScope() { if (m_timed) CGUIFrameProfiler::Get().EndInfo(); }
+
+private:
+  bool m_timed;
+};
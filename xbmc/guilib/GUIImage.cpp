@@ -20,6 +20,7 @@
 
 #include "GUIImage.h"
 #include "TextureManager.h"
+#include "URL.h"
 #include "utils/log.h"
 #include "utils/TimeUtils.h"
 
@@ -298,6 +299,19 @@ const CStdString &CGUIImage::GetFileName() const
   return m_texture.GetFileName();
 }
 
+CStdString CGUIImage::GetLargeFileName(const CGUIListItem *item) const
+{
+  if (m_info.IsConstant())
+    return ""; // skin images aren't item specific
+
+  // same rules as CGUITexture::AllocResources, skin media comes from the bundle
+  CStdString fileName = m_info.GetItemLabel(item, true);
+  if (fileName.IsEmpty() || !CURL::IsFullPath(fileName) ||
+      (!m_texture.IsLazyLoaded() && g_TextureManager.CanLoad(fileName)))
+    return "";
+  return fileName;
+}
+
 void CGUIImage::SetAspectRatio(const CAspectRatio &aspect)
 {
   m_texture.SetAspectRatio(aspect);
@@ -93,6 +93,14 @@ public:
   void SetCrossFade(unsigned int time);
 
   const CStdString& GetFileName() const;
+
+  /*! \brief Get the image this control would load in the background for a list item
+   Used to prefetch the art of list items before they are shown.
+   \param item the list item to evaluate the image for
+   \return the path of the image if it would be loaded by the large texture manager, empty otherwise
+   \sa CGUILargeTextureManager::Prefetch
+   */
+  CStdString GetLargeFileName(const CGUIListItem *item) const;
   float GetTextureWidth() const;
   float GetTextureHeight() const;
 
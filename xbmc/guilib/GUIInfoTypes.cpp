@@ -20,6 +20,7 @@
 
 #include "GUIInfoTypes.h"
 #include "GUIInfoManager.h"
+#include "GUIFrameProfiler.h"
 #include "addons/AddonManager.h"
 #include "utils/log.h"
 #include "LocalizeStrings.h"
@@ -145,6 +146,7 @@ CStdString CGUIInfoLabel::GetLabel(int contextWindow, bool preferImage, CStdStri
     const CInfoPortion &portion = m_info[i];
     if (portion.m_info)
     {
+      CGUIFrameProfilerInfoScope profile;
       CStdString infoLabel;
       if (preferImage)
         infoLabel = g_infoManager.GetImage(portion.m_info, contextWindow, fallback);
@@ -172,6 +174,7 @@ CStdString CGUIInfoLabel::GetItemLabel(const CGUIListItem *item, bool preferImag
     const CInfoPortion &portion = m_info[i];
     if (portion.m_info)
     {
+      CGUIFrameProfilerInfoScope profile;
       CStdString infoLabel;
       if (preferImages)
         infoLabel = g_infoManager.GetItemImage((const CFileItem *)item, portion.m_info, fallback);
@@ -22,6 +22,7 @@
 #include "GUIListLabel.h"
 #include "GUIMultiSelectText.h"
 #include "GUIBorderedImage.h"
+#include "GUIInfoManager.h"
 #include "GUIControlProfiler.h"
 #include "utils/log.h"
 
@@ -117,6 +118,26 @@ void CGUIListGroup::UpdateInfo(const CGUIListItem *item)
   }
 }
 
+void CGUIListGroup::GetLargeImages(const CGUIListItem *item, std::vector<CStdString> &images) const
+{
+  for (ciControls it = m_children.begin(); it != m_children.end(); ++it)
+  {
+    const CGUIControl *control = *it;
+    if (control->GetVisibleCondition() && !g_infoManager.GetBoolValue(control->GetVisibleCondition(), item))
+      continue;
+
+    if (control->GetControlType() == CGUIControl::GUICONTROL_IMAGE ||
+        control->GetControlType() == CGUIControl::GUICONTROL_BORDEREDIMAGE)
+    {
+      CStdString image = ((const CGUIImage *)control)->GetLargeFileName(item);
+      if (!image.IsEmpty())
+        images.push_back(image);
+    }
+    else if (control->GetControlType() == CGUIControl::GUICONTROL_LISTGROUP)
+      ((const CGUIListGroup *)control)->GetLargeImages(item, images);
+  }
+}
+
 void CGUIListGroup::EnlargeWidth(float difference)
 {
   // Alters the width of the controls that have an ID of 1
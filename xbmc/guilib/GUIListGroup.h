@@ -56,6 +56,13 @@ public:
   void SetState(bool selected, bool focused);
   void SelectItemFromPoint(const CPoint &point);
 
+  /*! \brief Collect the images our visible image controls would load in the background for an item
+   \param item the list item to evaluate the images for
+   \param images [out] vector to append the image paths to
+   \sa CGUIImage::GetLargeFileName
+   */
+  void GetLargeImages(const CGUIListItem *item, std::vector<CStdString> &images) const;
+
 protected:
   const CGUIListItem *m_item;
 };
@@ -226,6 +226,11 @@ void CGUIListItemLayout::FreeResources(bool immediately)
   m_group.FreeResources(immediately);
 }
 
+void CGUIListItemLayout::GetLargeImages(const CGUIListItem *item, std::vector<CStdString> &images) const
+{
+  m_group.GetLargeImages(item, images);
+}
+
 #ifdef _DEBUG
 void CGUIListItemLayout::DumpTextureUse()
 {
@@ -0,0 +1,330 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#include "GUIRenderBatch.h"
+#if defined(HAS_GL) || defined(HAS_GLES)
+#include "system_gl.h"
+#include "utils/GLUtils.h"
+#include "windowing/WindowingFactory.h"
+#endif
+
+#include <stddef.h>
+
+// indices are 16 bit, so this is the most a single draw call can take
+#define MAX_BATCH_QUADS (65536 / 4)
+
+CGUIRenderBatch::CGUIRenderBatch()
+{
+  m_state.mode = MODE_TEXTURE;
+  m_state.texture = 0;
+  m_state.diffuse = 0;
+  m_state.blend = false;
+  m_state.color = 0;
+  m_flushing = false;
+  m_drawCalls = 0;
+  m_quads = 0;
+}
+
+CGUIRenderBatch &CGUIRenderBatch::Get()
+{
+  static CGUIRenderBatch batch;
+  return batch;
+}
+
+CGUIRenderBatch::Vertex *CGUIRenderBatch::AddQuad(Mode mode, unsigned int texture, unsigned int diffuse, bool blend, color_t color)
+{
+  State state;
+  state.mode = mode;
+  state.texture = texture;
+  state.diffuse = diffuse;
+  state.blend = blend;
+#if defined(HAS_GLES)
+  // the texture shaders take their colour from a uniform
+  state.color = mode == MODE_TEXTURE ? color : 0;
+#else
+  state.color = 0;
+#endif
+
+  if (!m_vertices.empty() && (!(state == m_state) || m_vertices.size() >= MAX_BATCH_QUADS * 4))
+    Flush();
+  m_state = state;
+
+  m_vertices.resize(m_vertices.size() + 4);
+  return &m_vertices[m_vertices.size() - 4];
+}
+
+void CGUIRenderBatch::Flush()
+{
+  // the render system calls back in here when the batch changes its state
+  if (m_vertices.empty() || m_flushing)
+    return;
+
+  m_flushing = true;
+  ApplyState();
+  Draw();
+  ResetState();
+  m_flushing = false;
+
+  m_drawCalls++;
+  m_quads += m_vertices.size() / 4;
+  m_vertices.clear();
+}
+
+#if defined(HAS_GL)
+
+void CGUIRenderBatch::ApplyState()
+{
+  int unit = 0;
+  glActiveTexture(GL_TEXTURE0 + unit++);
+  glBindTexture(GL_TEXTURE_2D, m_state.texture);
+  glEnable(GL_TEXTURE_2D);
+  glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+  if (m_state.mode == MODE_FONT)
+  {
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE_MINUS_DST_ALPHA, GL_ONE);
+    glEnable(GL_BLEND);
+
+    glTexEnvi(GL_TEXTURE_ENV,GL_TEXTURE_ENV_MODE,GL_COMBINE);
+    glTexEnvi(GL_TEXTURE_ENV,GL_COMBINE_RGB,GL_REPLACE);
+    glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_PRIMARY_COLOR);
+    glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND0_RGB, GL_SRC_COLOR);
+    glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_MODULATE);
+    glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_ALPHA, GL_TEXTURE0);
+    glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND0_ALPHA, GL_SRC_ALPHA);
+    glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE1_ALPHA, GL_PRIMARY_COLOR);
+    glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND1_ALPHA, GL_SRC_ALPHA);
+    VerifyGLState();
+  }
+  else
+  {
+    glBlendFunc(GL_SRC_ALPHA,GL_ONE_MINUS_SRC_ALPHA);
+    glEnable(GL_BLEND);          // Turn Blending On
+
+    // diffuse coloring
+    glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
+    glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
+    glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_TEXTURE);
+    glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND0_RGB, GL_SRC_COLOR);
+    glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE1_RGB, GL_PRIMARY_COLOR);
+    glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND1_RGB, GL_SRC_COLOR);
+
+    glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_MODULATE);
+    glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE0_ALPHA, GL_TEXTURE);
+    glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE1_ALPHA, GL_PRIMARY_COLOR);
+    glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND0_ALPHA, GL_SRC_ALPHA);
+    glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND1_ALPHA, GL_SRC_ALPHA);
+    VerifyGLState();
+
+    if (m_state.diffuse)
+    {
+      glActiveTexture(GL_TEXTURE0 + unit++);
+      glBindTexture(GL_TEXTURE_2D, m_state.diffuse);
+      glEnable(GL_TEXTURE_2D);
+      glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
+      glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
+      glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_TEXTURE);
+      glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND0_RGB, GL_SRC_COLOR);
+      glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE1_RGB, GL_PREVIOUS);
+      glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND1_RGB, GL_SRC_COLOR);
+
+      glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_MODULATE);
+      glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE0_ALPHA, GL_TEXTURE);
+      glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE1_ALPHA, GL_PREVIOUS);
+      glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND0_ALPHA, GL_SRC_ALPHA);
+      glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND1_ALPHA, GL_SRC_ALPHA);
+      VerifyGLState();
+    }
+  }
+
+  if (g_Windowing.UseLimitedColor())
+  {
+    glActiveTexture(GL_TEXTURE0 + unit++);
+    glBindTexture(GL_TEXTURE_2D, m_state.texture); // dummy bind
+    glEnable(GL_TEXTURE_2D);
+
+    const GLfloat rgba[4] = {16.0f / 255.0f, 16.0f / 255.0f, 16.0f / 255.0f, 0.0f};
+    glTexEnvi (GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE , GL_COMBINE);
+    glTexEnvfv(GL_TEXTURE_ENV, GL_TEXTURE_ENV_COLOR, rgba);
+    glTexEnvi (GL_TEXTURE_ENV, GL_COMBINE_RGB      , GL_ADD);
+    glTexEnvi (GL_TEXTURE_ENV, GL_SOURCE0_RGB      , GL_PREVIOUS);
+    glTexEnvi (GL_TEXTURE_ENV, GL_SOURCE1_RGB      , GL_CONSTANT);
+    glTexEnvi (GL_TEXTURE_ENV, GL_OPERAND0_RGB     , GL_SRC_COLOR);
+    glTexEnvi (GL_TEXTURE_ENV, GL_OPERAND1_RGB     , GL_SRC_COLOR);
+    glTexEnvi (GL_TEXTURE_ENV, GL_COMBINE_ALPHA    , GL_REPLACE);
+    glTexEnvi (GL_TEXTURE_ENV, GL_SOURCE0_ALPHA    , GL_PREVIOUS);
+    VerifyGLState();
+  }
+}
+
+void CGUIRenderBatch::Draw()
+{
+  const char *vertices = (const char *)&m_vertices[0];
+
+  glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+
+  glColorPointer (4, GL_UNSIGNED_BYTE, sizeof(Vertex), vertices + offsetof(Vertex, r));
+  glVertexPointer(3, GL_FLOAT        , sizeof(Vertex), vertices + offsetof(Vertex, x));
+  glEnableClientState(GL_COLOR_ARRAY);
+  glEnableClientState(GL_VERTEX_ARRAY);
+
+  glClientActiveTexture(GL_TEXTURE0);
+  glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), vertices + offsetof(Vertex, u1));
+  glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+  if (m_state.diffuse)
+  {
+    glClientActiveTexture(GL_TEXTURE1);
+    glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), vertices + offsetof(Vertex, u2));
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+  }
+
+  glDrawArrays(GL_QUADS, 0, m_vertices.size());
+
+  if (m_state.diffuse)
+  {
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glClientActiveTexture(GL_TEXTURE0);
+  }
+  glPopClientAttrib();
+}
+
+void CGUIRenderBatch::ResetState()
+{
+  int units = 1;
+  if (m_state.diffuse)
+    units++;
+  if (g_Windowing.UseLimitedColor())
+    units++;
+
+  while (units--)
+  {
+    glActiveTexture(GL_TEXTURE0 + units);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glDisable(GL_TEXTURE_2D);
+  }
+  VerifyGLState();
+}
+
+#elif defined(HAS_GLES)
+
+void CGUIRenderBatch::ApplyState()
+{
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, m_state.texture);
+
+  if (m_state.mode == MODE_FONT)
+    g_Windowing.EnableGUIShader(SM_FONTS);
+  else
+  {
+    bool white = m_state.color == 0xffffffff;
+    if (m_state.diffuse)
+    {
+      glActiveTexture(GL_TEXTURE1);
+      glBindTexture(GL_TEXTURE_2D, m_state.diffuse);
+      g_Windowing.EnableGUIShader(white ? SM_MULTI : SM_MULTI_BLENDCOLOR);
+    }
+    else
+      g_Windowing.EnableGUIShader(white ? SM_TEXTURE_NOBLEND : SM_TEXTURE);
+
+    GLint uniColLoc = g_Windowing.GUIShaderGetUniCol();
+    if (uniColLoc >= 0)
+      glUniform4f(uniColLoc, GET_R(m_state.color) / 255.0f, GET_G(m_state.color) / 255.0f,
+                             GET_B(m_state.color) / 255.0f, GET_A(m_state.color) / 255.0f);
+  }
+
+  if (m_state.blend)
+  {
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE_MINUS_DST_ALPHA, GL_ONE);
+    glEnable(GL_BLEND);
+  }
+  else
+    glDisable(GL_BLEND);
+}
+
+void CGUIRenderBatch::Draw()
+{
+  // GLES can't draw quads, so index them as pairs of triangles
+  size_t quads = m_vertices.size() / 4;
+  for (size_t i = m_indices.size() / 6; i < quads; i++)
+  {
+    m_indices.push_back(i*4+0);
+    m_indices.push_back(i*4+1);
+    m_indices.push_back(i*4+2);
+    m_indices.push_back(i*4+2);
+    m_indices.push_back(i*4+3);
+    m_indices.push_back(i*4+0);
+  }
+
+  const char *vertices = (const char *)&m_vertices[0];
+  GLint posLoc  = g_Windowing.GUIShaderGetPos();
+  GLint colLoc  = g_Windowing.GUIShaderGetCol();
+  GLint tex0Loc = g_Windowing.GUIShaderGetCoord0();
+  GLint tex1Loc = g_Windowing.GUIShaderGetCoord1();
+
+  glVertexAttribPointer(posLoc, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), vertices + offsetof(Vertex, x));
+  glEnableVertexAttribArray(posLoc);
+  glVertexAttribPointer(tex0Loc, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), vertices + offsetof(Vertex, u1));
+  glEnableVertexAttribArray(tex0Loc);
+  if (m_state.mode == MODE_FONT)
+  {
+    // Normalize color values. Does not affect Performance at all.
+    glVertexAttribPointer(colLoc, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), vertices + offsetof(Vertex, r));
+    glEnableVertexAttribArray(colLoc);
+  }
+  else if (m_state.diffuse)
+  {
+    glVertexAttribPointer(tex1Loc, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), vertices + offsetof(Vertex, u2));
+    glEnableVertexAttribArray(tex1Loc);
+  }
+
+  glDrawElements(GL_TRIANGLES, quads * 6, GL_UNSIGNED_SHORT, &m_indices[0]);
+
+  if (m_state.mode == MODE_FONT)
+    glDisableVertexAttribArray(colLoc);
+  else if (m_state.diffuse)
+    glDisableVertexAttribArray(tex1Loc);
+  glDisableVertexAttribArray(posLoc);
+  glDisableVertexAttribArray(tex0Loc);
+}
+
+void CGUIRenderBatch::ResetState()
+{
+  if (m_state.diffuse)
+    glActiveTexture(GL_TEXTURE0);
+  glEnable(GL_BLEND);
+  g_Windowing.DisableGUIShader();
+}
+
+#else
+
+void CGUIRenderBatch::ApplyState()
+{
+}
+
+void CGUIRenderBatch::Draw()
+{
+}
+
+void CGUIRenderBatch::ResetState()
+{
+}
+
+#endif
@@ -0,0 +1,114 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <vector>
+
+typedef uint32_t color_t;
+
+/*!
+ \ingroup guilib
+ \brief Collects the quads of textures and text into as few draw calls as possible
+
+ Consecutive quads drawn with the same textures, blending and shader are kept in a buffer
+ and submitted with a single draw call once a quad with different state comes along, or when
+ anything else is about to touch the GL state. As only consecutive quads are merged, the
+ drawing order is the same as without batching.
+
+ Anything rendering directly with GL rather than through CGUITexture or CGUIFont must call
+ Flush() first. The render system does this on viewport, scissor, transform and state block
+ changes, and at the end of the frame.
+
+ Only used by the GL and GLES backends, on other platforms the counters stay at zero.
+ */
+class CGUIRenderBatch
+{
+public:
+  enum Mode
+  {
+    MODE_TEXTURE = 0, ///< texture (and optional diffuse texture) modulated by the colour
+    MODE_FONT         ///< alpha only glyph texture, coloured per vertex
+  };
+
+  struct Vertex
+  {
+    float x, y, z;
+    unsigned char r, g, b, a;
+    float u1, v1;
+    float u2, v2;
+  };
+
+  static CGUIRenderBatch &Get();
+
+  /*! \brief Add a quad to the batch, flushing the current batch first if its state differs
+   \param mode how the textures are combined
+   \param texture texture object bound to the first unit
+   \param diffuse texture object bound to the second unit, 0 for none
+   \param blend whether alpha blending is needed
+   \param color the colour the quad is drawn in. Only used to compare state where the backend can't
+                colour per vertex, the vertices still need their colour set.
+   \return the 4 vertices of the quad (top left, top right, bottom right, bottom left) to be filled in
+   */
+  Vertex *AddQuad(Mode mode, unsigned int texture, unsigned int diffuse, bool blend, color_t color);
+
+  /*! \brief Submit the quads collected so far
+   */
+  void Flush();
+
+  /*! \brief Number of draw calls issued since startup
+   */
+  unsigned int GetDrawCalls() const { return m_drawCalls; }
+
+  /*! \brief Number of quads drawn since startup
+   */
+  unsigned int GetQuads() const { return m_quads; }
+
+private:
+  CGUIRenderBatch();
+  CGUIRenderBatch(const CGUIRenderBatch&);
+  CGUIRenderBatch const& operator=(CGUIRenderBatch const&);
+
+  struct State
+  {
+    Mode         mode;
+    unsigned int texture;
+    unsigned int diffuse;
+    bool         blend;
+    color_t      color;
+    bool operator==(const State &right) const
+    {
+      return mode == right.mode && texture == right.texture && diffuse == right.diffuse &&
+             blend == right.blend && color == right.color;
+    }
+  };
+
+  void ApplyState();
+  void ResetState();
+  void Draw();
+
+  State                       m_state;
+  std::vector<Vertex>         m_vertices;
+  std::vector<unsigned short> m_indices;   ///< triangle indices for backends that can't draw quads
+  bool                        m_flushing;
+  unsigned int                m_drawCalls;
+  unsigned int                m_quads;
+};
@@ -0,0 +1,311 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUISkinCache.h"
+#include "Resolution.h"
+#include "GUIInfoManager.h"
+#include "addons/Skin.h"
+#include "filesystem/File.h"
+#include "filesystem/Directory.h"
+#include "utils/Crc32.h"
+#include "utils/log.h"
+#include "utils/XBMCTinyXML.h"
+
+#include <string.h>
+#include <vector>
+
+using namespace std;
+
+#define SKINCACHE_PATH    "special://temp/skincache/"
+#define SKINCACHE_MAGIC   "XBSC"
+#define SKINCACHE_VERSION 1
+#define SKINCACHE_MAXSIZE (16 * 1024 * 1024)
+
+// node types in the binary form
+#define NODE_ELEMENT 'E'
+#define NODE_TEXT    'T'
+#define NODE_CDATA   'C'
+
+static void WriteUInt32(string &out, uint32_t value)
+{
+  out.append((const char *)&value, sizeof(value));
+}
+
+static void WriteString(string &out, const char *value)
+{
+  uint32_t length = strlen(value);
+  WriteUInt32(out, length);
+  out.append(value, length);
+}
+
+static bool ReadUInt32(const char *&data, const char *end, uint32_t &value)
+{
+  if (end - data < (ptrdiff_t)sizeof(value))
+    return false;
+  memcpy(&value, data, sizeof(value));
+  data += sizeof(value);
+  return true;
+}
+
+static bool ReadString(const char *&data, const char *end, string &value)
+{
+  uint32_t length;
+  if (!ReadUInt32(data, end, length) || (uint32_t)(end - data) < length)
+    return false;
+  value.assign(data, length);
+  data += length;
+  return true;
+}
+
+static bool IsStored(const TiXmlNode *node)
+{
+  return node->Type() == TiXmlNode::TINYXML_ELEMENT || node->Type() == TiXmlNode::TINYXML_TEXT;
+}
+
+void CGUISkinCache::Serialize(const TiXmlNode *node, string &out)
+{
+  const TiXmlText *text = node->ToText();
+  if (text)
+  {
+    out.push_back(text->CDATA() ? NODE_CDATA : NODE_TEXT);
+    WriteString(out, text->Value());
+    return;
+  }
+
+  const TiXmlElement *element = node->ToElement();
+  if (!element)
+    return;
+
+  out.push_back(NODE_ELEMENT);
+  WriteString(out, element->Value());
+
+  uint32_t count = 0;
+  for (const TiXmlAttribute *attribute = element->FirstAttribute(); attribute; attribute = attribute->Next())
+    count++;
+  WriteUInt32(out, count);
+  for (const TiXmlAttribute *attribute = element->FirstAttribute(); attribute; attribute = attribute->Next())
+  {
+    WriteString(out, attribute->Name());
+    WriteString(out, attribute->Value());
+  }
+
+  count = 0;
+  for (const TiXmlNode *child = element->FirstChild(); child; child = child->NextSibling())
+  {
+    if (IsStored(child))
+      count++;
+  }
+  WriteUInt32(out, count);
+  for (const TiXmlNode *child = element->FirstChild(); child; child = child->NextSibling())
+  {
+    if (IsStored(child))
+      Serialize(child, out);
+  }
+}
+
+TiXmlNode *CGUISkinCache::Deserialize(const char *&data, const char *end)
+{
+  if (data >= end)
+    return NULL;
+
+  char type = *data++;
+  string value;
+  if (!ReadString(data, end, value))
+    return NULL;
+
+  if (type == NODE_TEXT || type == NODE_CDATA)
+  {
+    TiXmlText *text = new TiXmlText(value.c_str());
+    text->SetCDATA(type == NODE_CDATA);
+    return text;
+  }
+  else if (type != NODE_ELEMENT)
+    return NULL;
+
+  TiXmlElement *element = new TiXmlElement(value.c_str());
+  uint32_t count;
+  if (!ReadUInt32(data, end, count))
+  {
+    delete element;
+    return NULL;
+  }
+  for (uint32_t i = 0; i < count; i++)
+  {
+    string name;
+    if (!ReadString(data, end, name) || !ReadString(data, end, value))
+    {
+      delete element;
+      return NULL;
+    }
+    element->SetAttribute(name.c_str(), value.c_str());
+  }
+
+  if (!ReadUInt32(data, end, count))
+  {
+    delete element;
+    return NULL;
+  }
+  for (uint32_t i = 0; i < count; i++)
+  {
+    TiXmlNode *child = Deserialize(data, end);
+    if (!child)
+    {
+      delete element;
+      return NULL;
+    }
+    element->LinkEndChild(child);
+  }
+  return element;
+}
+
+bool CGUISkinCache::GetKey(const CStdString &path, const RESOLUTION_INFO &res, CStdString &key, CStdString &cacheFile)
+{
+  // skinners want to see their changes straight away
+  if (!g_SkinInfo || g_SkinInfo->IsDebugging())
+    return false;
+
+  struct __stat64 window;
+  if (XFILE::CFile::Stat(path, &window) != 0)
+    return false;
+
+  key.Format("%s|%s|%s|%"PRId64"|%"PRId64,
+             g_SkinInfo->ID().c_str(), g_SkinInfo->Version().c_str(),
+             path.c_str(), (int64_t)window.st_size, (int64_t)window.st_mtime);
+
+  // any of the include files may change what the window resolves to
+  const vector<CStdString> &includeFiles = g_SkinInfo->GetIncludeFiles();
+  for (vector<CStdString>::const_iterator it = includeFiles.begin(); it != includeFiles.end(); ++it)
+  {
+    struct __stat64 includes;
+    if (XFILE::CFile::Stat(*it, &includes) != 0)
+      memset(&includes, 0, sizeof(includes));
+    key.AppendFormat("|%s|%"PRId64"|%"PRId64, it->c_str(), (int64_t)includes.st_size, (int64_t)includes.st_mtime);
+  }
+  key.AppendFormat("|%dx%d", res.iWidth, res.iHeight);
+
+  // one entry per window and resolution, the full key is checked on load
+  CStdString name;
+  name.Format("%s|%dx%d", path.c_str(), res.iWidth, res.iHeight);
+  Crc32 crc;
+  crc.ComputeFromLowerCase(name);
+  cacheFile.Format(SKINCACHE_PATH "%08x.bin", (uint32_t)crc);
+  return true;
+}
+
+TiXmlElement *CGUISkinCache::Load(const CStdString &path, const RESOLUTION_INFO &res, map<int, bool> &includeConditions)
+{
+  CStdString key, cacheFile;
+  if (!GetKey(path, res, key, cacheFile))
+    return NULL;
+
+  XFILE::CFile file;
+  if (!file.Open(cacheFile))
+    return NULL;
+
+  int64_t length = file.GetLength();
+  if (length <= 0 || length > SKINCACHE_MAXSIZE)
+    return NULL;
+
+  vector<char> buffer((size_t)length);
+  if (file.Read(&buffer[0], length) != length)
+    return NULL;
+  file.Close();
+
+  const char *data = &buffer[0];
+  const char *end = data + length;
+
+  uint32_t version;
+  string storedKey;
+  if (end - data < 4 || memcmp(data, SKINCACHE_MAGIC, 4) != 0)
+    return NULL;
+  data += 4;
+  if (!ReadUInt32(data, end, version) || version != SKINCACHE_VERSION ||
+      !ReadString(data, end, storedKey) || key != storedKey.c_str())
+    return NULL;
+
+  // the includes resolved depend on these, so they must still have the same values
+  uint32_t count;
+  if (!ReadUInt32(data, end, count))
+    return NULL;
+  map<int, bool> conditions;
+  for (uint32_t i = 0; i < count; i++)
+  {
+    string expression;
+    if (!ReadString(data, end, expression) || data >= end)
+      return NULL;
+    bool value = *data++ != 0;
+
+    int condition = g_infoManager.Register(expression);
+    if (!condition || g_infoManager.GetBoolValue(condition) != value)
+    {
+      CLog::Log(LOGDEBUG, "%s: include condition %s changed for %s", __FUNCTION__, expression.c_str(), path.c_str());
+      return NULL;
+    }
+    conditions[condition] = value;
+  }
+
+  TiXmlNode *root = Deserialize(data, end);
+  if (!root || !root->ToElement() || data != end)
+  {
+    CLog::Log(LOGWARNING, "%s: invalid cache file %s for %s", __FUNCTION__, cacheFile.c_str(), path.c_str());
+    delete root;
+    return NULL;
+  }
+
+  for (map<int, bool>::const_iterator it = conditions.begin(); it != conditions.end(); ++it)
+    includeConditions[it->first] = it->second;
+  return root->ToElement();
+}
+
+bool CGUISkinCache::Save(const CStdString &path, const RESOLUTION_INFO &res, const TiXmlElement *root, const map<int, bool> &includeConditions)
+{
+  CStdString key, cacheFile;
+  if (!root || !GetKey(path, res, key, cacheFile))
+    return false;
+
+  string out(SKINCACHE_MAGIC);
+  WriteUInt32(out, SKINCACHE_VERSION);
+  WriteString(out, key.c_str());
+  WriteUInt32(out, includeConditions.size());
+  for (map<int, bool>::const_iterator it = includeConditions.begin(); it != includeConditions.end(); ++it)
+  {
+    CStdString expression = g_infoManager.GetBoolExpression(it->first);
+    if (expression.IsEmpty())
+      return false;
+    WriteString(out, expression.c_str());
+    out.push_back(it->second ? 1 : 0);
+  }
+  Serialize(root, out);
+
+  if (!XFILE::CDirectory::Exists(SKINCACHE_PATH))
+    XFILE::CDirectory::Create(SKINCACHE_PATH);
+
+  XFILE::CFile file;
+  if (!file.OpenForWrite(cacheFile, true))
+  {
+    CLog::Log(LOGWARNING, "%s: unable to write %s", __FUNCTION__, cacheFile.c_str());
+    return false;
+  }
+  bool ret = file.Write(out.c_str(), out.size()) == (int)out.size();
+  file.Close();
+  if (!ret)
+    XFILE::CFile::Delete(cacheFile);
+  return ret;
+}
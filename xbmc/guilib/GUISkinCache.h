@@ -0,0 +1,80 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/StdString.h"
+
+#include <map>
+#include <string>
+
+class TiXmlNode;
+class TiXmlElement;
+struct RESOLUTION_INFO;
+
+/*!
+ \ingroup guilib
+ \brief On-disk cache of compiled skin window files
+
+ A compiled window is the window's XML tree after includes, defaults and constants have been
+ resolved, stored in a compact binary form in special://temp/skincache/. Loading it skips both
+ the XML parse and the include resolution.
+
+ Entries are keyed on the skin, its version, the window file and every include file loaded
+ (path, size and modification time) and the resolution the window is loaded in. The conditions used to
+ resolve conditional includes are stored with their values at compile time, and an entry is
+ only used while all of them still evaluate to the same values.
+ */
+class CGUISkinCache
+{
+public:
+  /*! \brief Load the compiled form of a window
+   \param path path of the window XML file
+   \param res resolution the window is loaded in
+   \param includeConditions [out] conditions used to resolve the includes, with their values
+   \return the resolved root element, to be deleted by the caller. NULL if there is no valid entry.
+   */
+  static TiXmlElement *Load(const CStdString &path, const RESOLUTION_INFO &res, std::map<int, bool> &includeConditions);
+
+  /*! \brief Store the compiled form of a window
+   \param path path of the window XML file
+   \param res resolution the window is loaded in
+   \param root the root element with includes resolved
+   \param includeConditions conditions used to resolve the includes, with their values
+   \return true if the window was stored, false otherwise
+   */
+  static bool Save(const CStdString &path, const RESOLUTION_INFO &res, const TiXmlElement *root, const std::map<int, bool> &includeConditions);
+
+  /*! \brief Append the binary form of an XML element or text node (and its children) to a buffer
+   Comments and other node types are dropped.
+   */
+  static void Serialize(const TiXmlNode *node, std::string &out);
+
+  /*! \brief Create an XML node from its binary form
+   \param data [in/out] start of the binary form, moved past the node on return
+   \param end end of the buffer
+   \return the node, NULL if the data is invalid
+   \sa Serialize
+   */
+  static TiXmlNode *Deserialize(const char *&data, const char *end);
+
+private:
+  static bool GetKey(const CStdString &path, const RESOLUTION_INFO &res, CStdString &key, CStdString &cacheFile);
+};
@@ -19,9 +19,11 @@
  */
 
 #include "GUITextLayout.h"
+#include "GUITextLayoutCache.h"
 #include "GUIFont.h"
 #include "GUIControl.h"
 #include "GUIColorManager.h"
+#include "GraphicContext.h"
 #include "utils/CharsetConverter.h"
 #include "utils/StringUtils.h"
 
@@ -230,13 +232,20 @@ bool CGUITextLayout::UpdateW(const CStdStringW &text, float maxWidth /*= 0*/, bo
   if (text.Equals(m_lastText) && !forceUpdate)
     return false;
 
-  // parse the text for style information
-  vecText parsedText;
-  vecColors colors;
-  ParseText(text, m_font ? m_font->GetStyle() : 0, m_textColor, colors, parsedText);
-
-  // and update
-  UpdateStyled(parsedText, colors, maxWidth, forceLTRReadingOrder);
+  // the width only matters if we wrap. The font's metrics depend on the window's GUI scale.
+  CGUITextLayoutCache::Key key(text, m_font, m_textColor, m_wrap && maxWidth > 0 ? maxWidth : 0, m_maxHeight, forceLTRReadingOrder,
+                               g_graphicsContext.GetGUIScaleX(), g_graphicsContext.GetGUIScaleY());
+  if (!CGUITextLayoutCache::Get().Lookup(key, m_lines, m_colors, m_textWidth, m_textHeight))
+  {
+    // parse the text for style information
+    vecText parsedText;
+    vecColors colors;
+    ParseText(text, m_font ? m_font->GetStyle() : 0, m_textColor, colors, parsedText);
+
+    // and update
+    UpdateStyled(parsedText, colors, maxWidth, forceLTRReadingOrder);
+    CGUITextLayoutCache::Get().Add(key, m_lines, m_colors, m_textWidth, m_textHeight);
+  }
   m_lastText = text;
   return true;
 }
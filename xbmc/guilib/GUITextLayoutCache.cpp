@@ -0,0 +1,144 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUITextLayoutCache.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+
+#include <boost/functional/hash.hpp>
+
+using namespace std;
+
+// characters are 4 bytes once parsed, so this is a few MB
+#define TEXTLAYOUT_CACHE_MAX_CHARACTERS (512 * 1024)
+// larger layouts would push too much else out of the cache
+#define TEXTLAYOUT_CACHE_MAX_ENTRY      (TEXTLAYOUT_CACHE_MAX_CHARACTERS / 16)
+
+CGUITextLayoutCache::Key::Key(const CStdStringW &text, const CGUIFont *font, color_t color, float maxWidth, float maxHeight, bool forceLTRReadingOrder, float scaleX, float scaleY)
+  : text(text), font(font), color(color), maxWidth(maxWidth), maxHeight(maxHeight), forceLTRReadingOrder(forceLTRReadingOrder),
+    scaleX(scaleX), scaleY(scaleY)
+{
+}
+
+bool CGUITextLayoutCache::Key::operator==(const Key &right) const
+{
+  return font == right.font && color == right.color && maxWidth == right.maxWidth && maxHeight == right.maxHeight &&
+         forceLTRReadingOrder == right.forceLTRReadingOrder && scaleX == right.scaleX && scaleY == right.scaleY &&
+         text == right.text;
+}
+
+size_t CGUITextLayoutCache::KeyHash::operator()(const Key &key) const
+{
+  size_t seed = boost::hash_range(key.text.begin(), key.text.end());
+  boost::hash_combine(seed, key.font);
+  boost::hash_combine(seed, key.color);
+  boost::hash_combine(seed, key.maxWidth);
+  boost::hash_combine(seed, key.maxHeight);
+  boost::hash_combine(seed, key.forceLTRReadingOrder);
+  boost::hash_combine(seed, key.scaleX);
+  boost::hash_combine(seed, key.scaleY);
+  return seed;
+}
+
+CGUITextLayoutCache::CGUITextLayoutCache()
+{
+  m_characters = 0;
+  m_hits = 0;
+  m_misses = 0;
+}
+
+CGUITextLayoutCache &CGUITextLayoutCache::Get()
+{
+  static CGUITextLayoutCache cache;
+  return cache;
+}
+
+bool CGUITextLayoutCache::Lookup(const Key &key, vector<CGUIString> &lines, vecColors &colors, float &width, float &height)
+{
+  CSingleLock lock(m_section);
+  EntryIndex::iterator i = m_index.find(key);
+  if (i == m_index.end())
+  {
+    m_misses++;
+    return false;
+  }
+
+  // move to the front, as it's now the most recently used
+  m_entries.splice(m_entries.begin(), m_entries, i->second);
+
+  const Entry &entry = *i->second;
+  lines = entry.lines;
+  colors = entry.colors;
+  width = entry.width;
+  height = entry.height;
+  m_hits++;
+  return true;
+}
+
+void CGUITextLayoutCache::Add(const Key &key, const vector<CGUIString> &lines, const vecColors &colors, float width, float height)
+{
+  unsigned int characters = key.text.size() + colors.size();
+  for (vector<CGUIString>::const_iterator i = lines.begin(); i != lines.end(); ++i)
+    characters += i->m_text.size();
+  if (characters > TEXTLAYOUT_CACHE_MAX_ENTRY)
+    return;
+
+  CSingleLock lock(m_section);
+  if (m_index.find(key) != m_index.end())
+    return;
+
+  while (!m_entries.empty() && m_characters + characters > TEXTLAYOUT_CACHE_MAX_CHARACTERS)
+  {
+    m_characters -= m_entries.back().characters;
+    m_index.erase(m_entries.back().key);
+    m_entries.pop_back();
+  }
+
+  m_entries.push_front(Entry(key));
+  Entry &entry = m_entries.front();
+  entry.lines = lines;
+  entry.colors = colors;
+  entry.width = width;
+  entry.height = height;
+  entry.characters = characters;
+  m_index.insert(make_pair(key, m_entries.begin()));
+  m_characters += characters;
+}
+
+void CGUITextLayoutCache::Clear()
+{
+  CSingleLock lock(m_section);
+  if (m_hits + m_misses > 0)
+    CLog::Log(LOGDEBUG, "%s: %u hits, %u misses, dropping %u entries", __FUNCTION__, m_hits, m_misses, (unsigned int)m_index.size());
+  m_index.clear();
+  m_entries.clear();
+  m_characters = 0;
+}
+
+CGUITextLayoutCache::Stats CGUITextLayoutCache::GetStats()
+{
+  CSingleLock lock(m_section);
+  Stats stats;
+  stats.hits = m_hits;
+  stats.misses = m_misses;
+  stats.entries = m_index.size();
+  stats.characters = m_characters;
+  return stats;
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUITextLayout.h"
+#include "threads/CriticalSection.h"
+
+#include <list>
+#include <boost/unordered_map.hpp>
+
+/*!
+ \ingroup guilib
+ \brief Least recently used cache of laid out text, shared by all CGUITextLayouts
+
+ Holds the result of parsing, wrapping and measuring a string, so labels, list items and
+ text boxes showing text that was laid out before (such as items scrolling back into view)
+ skip the work. Entries are keyed on everything the layout depends on: the text, the font
+ and default colour, the width wrapped to, the maximum height, the reading order and the
+ GUI scale, which differs between windows with different coordinate resolutions.
+
+ Fonts are only identified by their address, so the cache must be cleared whenever fonts
+ are unloaded or resized, which the font manager does.
+ */
+class CGUITextLayoutCache
+{
+public:
+  struct Key
+  {
+    Key(const CStdStringW &text, const CGUIFont *font, color_t color, float maxWidth, float maxHeight, bool forceLTRReadingOrder, float scaleX, float scaleY);
+    bool operator==(const Key &right) const;
+
+    CStdStringW     text;
+    const CGUIFont *font;
+    color_t         color;
+    float           maxWidth;  ///< width the text is wrapped to, 0 if it isn't wrapped
+    float           maxHeight;
+    bool            forceLTRReadingOrder;
+    float           scaleX;    ///< GUI scale of the window, which the font's metrics are scaled by
+    float           scaleY;
+  };
+
+  struct Stats
+  {
+    Stats() : hits(0), misses(0), entries(0), characters(0) {}
+    unsigned int hits;
+    unsigned int misses;
+    unsigned int entries;
+    unsigned int characters; ///< characters held by the entries, an estimate of their size
+  };
+
+  static CGUITextLayoutCache &Get();
+
+  /*! \brief Retrieve a cached layout
+   \param key the text and layout parameters
+   \param lines [out] the laid out lines
+   \param colors [out] the colors used by the lines
+   \param width [out] the width of the widest line
+   \param height [out] the height of the lines
+   \return true if the layout was cached, false otherwise
+   */
+  bool Lookup(const Key &key, std::vector<CGUIString> &lines, vecColors &colors, float &width, float &height);
+
+  /*! \brief Add a layout to the cache, dropping the least recently used ones if the cache is full
+   \sa Lookup
+   */
+  void Add(const Key &key, const std::vector<CGUIString> &lines, const vecColors &colors, float width, float height);
+
+  /*! \brief Drop all cached layouts
+   */
+  void Clear();
+
+  Stats GetStats();
+
+private:
+  CGUITextLayoutCache();
+  CGUITextLayoutCache(const CGUITextLayoutCache&);
+  CGUITextLayoutCache const& operator=(CGUITextLayoutCache const&);
+
+  struct Entry
+  {
+    Key                     key;
+    std::vector<CGUIString> lines;
+    vecColors               colors;
+    float                   width;
+    float                   height;
+    unsigned int            characters;
+
+    Entry(const Key &k) : key(k), width(0), height(0), characters(0) {}
+  };
+
+  struct KeyHash
+  {
+    size_t operator()(const Key &key) const;
+  };
+
+  typedef std::list<Entry> EntryList;
+  typedef boost::unordered_map<Key, EntryList::iterator, KeyHash> EntryIndex;
+
+  CCriticalSection m_section;
+  EntryList        m_entries;   ///< most recently used first
+  EntryIndex       m_index;
+  unsigned int     m_characters;
+  unsigned int     m_hits;
+  unsigned int     m_misses;
+};
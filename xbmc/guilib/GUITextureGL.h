@@ -43,6 +43,8 @@ protected:
   void End();
 private:
   GLubyte m_col[4];
+  GLuint  m_textureObject;
+  GLuint  m_diffuseObject;
 };
 
 #endif
@@ -23,6 +23,7 @@
 #include "GUITextureGLES.h"
 #endif
 #include "Texture.h"
+#include "GUIRenderBatch.h"
 #include "utils/log.h"
 #include "utils/GLUtils.h"
 #include "utils/MathUtils.h"
@@ -35,105 +36,39 @@
 CGUITextureGLES::CGUITextureGLES(float posX, float posY, float width, float height, const CTextureInfo &texture)
 : CGUITextureBase(posX, posY, width, height, texture)
 {
+  m_textureObject = 0;
+  m_diffuseObject = 0;
+  m_color = 0;
+  m_hasAlpha = false;
 }
 
 void CGUITextureGLES::Begin(color_t color)
 {
-  CBaseTexture* texture = m_texture.m_textures[m_currentFrame];
+  CTexture* texture = (CTexture*)m_texture.m_textures[m_currentFrame];
   texture->LoadToGPU();
-  if (m_diffuse.size())
-    m_diffuse.m_textures[0]->LoadToGPU();
-
-  texture->BindToUnit(0);
-
-  // Setup Colors
-  m_col[0] = (GLubyte)GET_R(color);
-  m_col[1] = (GLubyte)GET_G(color);
-  m_col[2] = (GLubyte)GET_B(color);
-  m_col[3] = (GLubyte)GET_A(color);
+  m_textureObject = texture->GetTextureObject();
+  m_diffuseObject = 0;
 
-  bool hasAlpha = m_texture.m_textures[m_currentFrame]->HasAlpha() || m_col[3] < 255;
+  m_color = color;
+  m_hasAlpha = texture->HasAlpha() || GET_A(color) < 255;
 
   if (m_diffuse.size())
   {
-    if (m_col[0] == 255 && m_col[1] == 255 && m_col[2] == 255 && m_col[3] == 255 )
-    {
-      g_Windowing.EnableGUIShader(SM_MULTI);
-    }
-    else
-    {
-      g_Windowing.EnableGUIShader(SM_MULTI_BLENDCOLOR);
-    }
-
-    hasAlpha |= m_diffuse.m_textures[0]->HasAlpha();
-
-    m_diffuse.m_textures[0]->BindToUnit(1);
-
-  }
-  else
-  {
-    if (m_col[0] == 255 && m_col[1] == 255 && m_col[2] == 255 && m_col[3] == 255)
-    {
-      g_Windowing.EnableGUIShader(SM_TEXTURE_NOBLEND);
-    }
-    else
-    {
-      g_Windowing.EnableGUIShader(SM_TEXTURE);
-    }
-  }
-
-  if ( hasAlpha )
-  {
-    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE_MINUS_DST_ALPHA, GL_ONE);
-    glEnable( GL_BLEND );
+    CTexture* diffuse = (CTexture*)m_diffuse.m_textures[0];
+    diffuse->LoadToGPU();
+    m_diffuseObject = diffuse->GetTextureObject();
+    m_hasAlpha |= diffuse->HasAlpha();
   }
-  else
-  {
-    glDisable(GL_BLEND);
-  }
-  m_packedVertices.clear();
 }
 
 void CGUITextureGLES::End()
 {
-  GLint posLoc  = g_Windowing.GUIShaderGetPos();
-  GLint tex0Loc = g_Windowing.GUIShaderGetCoord0();
-  GLint tex1Loc = g_Windowing.GUIShaderGetCoord1();
-  GLint uniColLoc = g_Windowing.GUIShaderGetUniCol();
-
-  if(uniColLoc >= 0)
-  {
-    glUniform4f(uniColLoc,(m_col[0] / 255.0f), (m_col[1] / 255.0f), (m_col[2] / 255.0f), (m_col[3] / 255.0f));
-  }
-
-  if(m_diffuse.size())
-  {
-    glVertexAttribPointer(tex1Loc, 2, GL_FLOAT, 0, sizeof(PackedVertex), (char*)&m_packedVertices[0] + offsetof(PackedVertex, u2));
-    glEnableVertexAttribArray(tex1Loc);
-  }
-  glVertexAttribPointer(posLoc, 3, GL_FLOAT, 0, sizeof(PackedVertex), (char*)&m_packedVertices[0] + offsetof(PackedVertex, x));
-  glEnableVertexAttribArray(posLoc);
-  glVertexAttribPointer(tex0Loc, 2, GL_FLOAT, 0, sizeof(PackedVertex), (char*)&m_packedVertices[0] + offsetof(PackedVertex, u1));
-  glEnableVertexAttribArray(tex0Loc);
-
-  glDrawElements(GL_TRIANGLES, m_packedVertices.size()*6 / 4, GL_UNSIGNED_SHORT, m_idx.data());
-
-  if (m_diffuse.size())
-  {
-    glDisableVertexAttribArray(tex1Loc);
-    glActiveTexture(GL_TEXTURE0);
-  }
-
-  glDisableVertexAttribArray(posLoc);
-  glDisableVertexAttribArray(tex0Loc);
-
-  glEnable(GL_BLEND);
-  g_Windowing.DisableGUIShader();
+  // the quads are drawn when the batch is flushed
 }
 
 void CGUITextureGLES::Draw(float *x, float *y, float *z, const CRect &texture, const CRect &diffuse, int orientation)
 {
-  PackedVertex vertices[4];
+  CGUIRenderBatch::Vertex *vertices = CGUIRenderBatch::Get().AddQuad(CGUIRenderBatch::MODE_TEXTURE, m_textureObject, m_diffuseObject, m_hasAlpha, m_color);
 
   // Setup texture coordinates
   //TopLeft
@@ -202,23 +137,13 @@ void CGUITextureGLES::Draw(float *x, float *y, float *z, const CRect &texture, c
     vertices[i].x = x[i];
     vertices[i].y = y[i];
     vertices[i].z = z[i];
-    m_packedVertices.push_back(vertices[i]);
-  }
-
-  if ((m_packedVertices.size() / 4) > (m_idx.size() / 6))
-  {
-    size_t i = m_packedVertices.size() - 4;
-    m_idx.push_back(i+0);
-    m_idx.push_back(i+1);
-    m_idx.push_back(i+2);
-    m_idx.push_back(i+2);
-    m_idx.push_back(i+3);
-    m_idx.push_back(i+0);
   }
 }
 
 void CGUITextureGLES::DrawQuad(const CRect &rect, color_t color, CBaseTexture *texture, const CRect *texCoords)
 {
+  CGUIRenderBatch::Get().Flush();
+
   if (texture)
   {
     texture->LoadToGPU();
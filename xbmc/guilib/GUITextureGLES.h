@@ -31,15 +31,6 @@
 #include "GUITexture.h"
 
 #include "system_gl.h"
-#include <vector>
-
-struct PackedVertex
-{
-  float x, y, z;
-  float u1, v1;
-  float u2, v2;
-};
-typedef std::vector<PackedVertex> PackedVertices;
 
 class CGUITextureGLES : public CGUITextureBase
 {
@@ -51,10 +42,10 @@ protected:
   void Draw(float *x, float *y, float *z, const CRect &texture, const CRect &diffuse, int orientation);
   void End();
 
-  GLubyte m_col[4];
-
-  PackedVertices m_packedVertices;
-  std::vector<GLushort> m_idx;
+  GLuint  m_textureObject;
+  GLuint  m_diffuseObject;
+  color_t m_color;
+  bool    m_hasAlpha;
 };
 
 #endif
@@ -21,6 +21,7 @@
 #include "system.h"
 #include "GUIVideoControl.h"
 #include "GUIWindowManager.h"
+#include "GUIRenderBatch.h"
 #include "Application.h"
 #include "Key.h"
 #include "WindowIDs.h"
@@ -64,6 +65,8 @@ void CGUIVideoControl::Render()
     if (!g_application.m_pPlayer->IsPausedPlayback())
       g_application.ResetScreenSaver();
 
+    // the video renderer draws directly, so anything batched so far has to go first
+    CGUIRenderBatch::Get().Flush();
     g_graphicsContext.SetViewWindow(m_posX, m_posY, m_posX + m_width, m_posY + m_height);
 
 #ifdef HAS_VIDEO_PLAYBACK
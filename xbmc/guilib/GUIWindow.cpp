@@ -26,6 +26,8 @@
 #include "GUIControlFactory.h"
 #include "GUIControlGroup.h"
 #include "GUIControlProfiler.h"
+#include "GUIFrameProfiler.h"
+#include "GUISkinCache.h"
 #ifdef PRE_SKIN_VERSION_9_10_COMPATIBILITY
 #include "GUIEditControl.h"
 #endif
@@ -84,10 +86,8 @@ bool CGUIWindow::Load(const CStdString& strFileName, bool bContainsPath)
   if (m_windowLoaded || g_SkinInfo == NULL)
     return true;      // no point loading if it's already there
 
-#ifdef _DEBUG
   int64_t start;
   start = CurrentHostCounter();
-#endif
   const char* strLoadType;
   switch (m_loadType)
   {
@@ -118,17 +118,23 @@ bool CGUIWindow::Load(const CStdString& strFileName, bool bContainsPath)
 
   bool ret = LoadXML(strPath.c_str(), strLowerPath.c_str());
 
-#ifdef _DEBUG
   int64_t end, freq;
   end = CurrentHostCounter();
   freq = CurrentHostFrequency();
   CLog::Log(LOGDEBUG,"Load %s: %.2fms", GetProperty("xmlfile").c_str(), 1000.f * (end - start) / freq);
-#endif
   return ret;
 }
 
 bool CGUIWindow::LoadXML(const CStdString &strPath, const CStdString &strLowerPath)
 {
+  // the compiled window has includes and constants resolved already
+  TiXmlElement *pRootElement = CGUISkinCache::Load(strPath, m_coordsRes, m_xmlIncludeConditions);
+  if (pRootElement)
+  {
+    CLog::Log(LOGDEBUG, "Using compiled skin file for %s", strPath.c_str());
+    return LoadResolved(pRootElement);
+  }
+
   // load window xml if we don't have it stored yet
   if (!m_windowXMLRootElement)
   {
@@ -144,30 +150,50 @@ bool CGUIWindow::LoadXML(const CStdString &strPath, const CStdString &strLowerPa
   else
     CLog::Log(LOGDEBUG, "Using already stored xml root node for %s", strPath.c_str());
 
-  return Load(m_windowXMLRootElement);
+  pRootElement = ResolveXML(m_windowXMLRootElement);
+  if (!pRootElement)
+    return false;
+
+  CGUISkinCache::Save(strPath, m_coordsRes, pRootElement, m_xmlIncludeConditions);
+  return LoadResolved(pRootElement);
 }
 
 bool CGUIWindow::Load(TiXmlElement* pRootElement)
+{
+  return LoadResolved(ResolveXML(pRootElement));
+}
+
+TiXmlElement *CGUIWindow::ResolveXML(const TiXmlElement *pRootElement)
 {
   if (!pRootElement)
-    return false;
+    return NULL;
   
   if (strcmpi(pRootElement->Value(), "window"))
   {
     CLog::Log(LOGERROR, "file : XML file doesnt contain <window>");
-    return false;
+    return NULL;
   }
 
   // we must create copy of root element as we will manipulate it when resolving includes
   // and we don't want original root element to change
-  pRootElement = (TiXmlElement*)pRootElement->Clone();
+  TiXmlElement *pResolved = (TiXmlElement*)pRootElement->Clone();
 
   // set the scaling resolution so that any control creation or initialisation can
   // be done with respect to the correct aspect ratio
   g_graphicsContext.SetScalingResolution(m_coordsRes, m_needsScaling);
 
   // Resolve any includes that may be present and save conditions used to do it
-  g_SkinInfo->ResolveIncludes(pRootElement, &m_xmlIncludeConditions);
+  g_SkinInfo->ResolveIncludes(pResolved, &m_xmlIncludeConditions);
+  return pResolved;
+}
+
+bool CGUIWindow::LoadResolved(TiXmlElement* pRootElement)
+{
+  if (!pRootElement)
+    return false;
+
+  g_graphicsContext.SetScalingResolution(m_coordsRes, m_needsScaling);
+
   // now load in the skin file
   SetDefaults();
 
@@ -325,6 +351,7 @@ void CGUIWindow::CenterWindow()
 
 void CGUIWindow::DoProcess(unsigned int currentTime, CDirtyRegionList &dirtyregions)
 {
+  CGUIFrameProfilerScope profile(CGUIFrameProfiler::CATEGORY_WINDOW, "Process", GetID());
   g_graphicsContext.SetRenderingResolution(m_coordsRes, m_needsScaling);
   g_graphicsContext.AddGUITransform();
   CGUIControlGroup::DoProcess(currentTime, dirtyregions);
@@ -345,6 +372,7 @@ void CGUIWindow::DoRender()
   // to occur.
   if (!m_bAllocated) return;
 
+  CGUIFrameProfilerScope profile(CGUIFrameProfiler::CATEGORY_WINDOW, "Render", GetID());
   g_graphicsContext.SetRenderingResolution(m_coordsRes, m_needsScaling);
 
   g_graphicsContext.AddGUITransform();
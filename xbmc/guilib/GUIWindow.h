@@ -198,6 +198,8 @@ protected:
   virtual EVENT_RESULT OnMouseEvent(const CPoint &point, const CMouseEvent &event);
   virtual bool LoadXML(const CStdString& strPath, const CStdString &strLowerPath);  ///< Loads from the given file
   bool Load(TiXmlElement *pRootElement);                 ///< Loads from the given XML root element
+  TiXmlElement *ResolveXML(const TiXmlElement *pRootElement); ///< Returns a copy of the given XML root element with includes resolved
+  bool LoadResolved(TiXmlElement *pRootElement);         ///< Loads from (and takes ownership of) an XML root element with includes resolved
   /*! \brief Check if XML file needs (re)loading
    XML file has to be (re)loaded when window is not loaded or include conditions values were changed
    */
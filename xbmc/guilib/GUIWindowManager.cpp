@@ -31,7 +31,10 @@
 #include "settings/Settings.h"
 #include "addons/Skin.h"
 #include "GUITexture.h"
+#include "GUIRenderBatch.h"
+#include "GUIFrameProfiler.h"
 #include "windowing/WindowingFactory.h"
+#include "utils/TimeUtils.h"
 #include "utils/Variant.h"
 #include "Key.h"
 
@@ -52,6 +55,7 @@ CGUIWindowManager::~CGUIWindowManager(void)
 void CGUIWindowManager::Initialize()
 {
   m_tracker.SelectAlgorithm();
+  CGUIFrameProfiler::Get().SetLevel(g_advancedSettings.m_guiFrameProfiler);
   m_initialized = true;
 
   LoadNotOnDemandWindows();
@@ -496,6 +500,7 @@ void CGUIWindowManager::Process(unsigned int currentTime)
 {
   assert(g_application.IsCurrentThread());
   CSingleLock lock(g_graphicsContext);
+  CGUIFrameProfilerScope profile(CGUIFrameProfiler::CATEGORY_FRAME, "Process");
 
   CDirtyRegionList dirtyregions;
 
@@ -527,6 +532,7 @@ void CGUIWindowManager::MarkDirty(const CRect& rect)
 
 void CGUIWindowManager::RenderPass() const
 {
+  CGUIFrameProfilerScope profile(CGUIFrameProfiler::CATEGORY_FRAME, "RenderPass");
   CGUIWindow* pWindow = GetWindow(GetActiveWindow());
   if (pWindow)
   {
@@ -549,6 +555,7 @@ bool CGUIWindowManager::Render()
 {
   assert(g_application.IsCurrentThread());
   CSingleLock lock(g_graphicsContext);
+  CGUIFrameProfilerScope profile(CGUIFrameProfiler::CATEGORY_FRAME, "Render");
 
   CDirtyRegionList dirtyRegions = m_tracker.GetDirtyRegions();
 
@@ -574,8 +581,12 @@ bool CGUIWindowManager::Render()
       if (i->IsEmpty())
         continue;
 
+      int64_t start = CurrentHostCounter();
       g_graphicsContext.SetScissors(*i);
       RenderPass();
+      // draw what is left of the pass now, so its time isn't counted towards the next one
+      CGUIRenderBatch::Get().Flush();
+      m_tracker.RenderedPass(*i, 1000.0f * (CurrentHostCounter() - start) / CurrentHostFrequency());
       hasRendered = true;
     }
     g_graphicsContext.ResetScissors();
@@ -597,6 +608,7 @@ bool CGUIWindowManager::Render()
 void CGUIWindowManager::AfterRender()
 {
   m_tracker.CleanMarkedRegions();
+  CGUIFrameProfiler::Get().EndFrame();
 
   CGUIWindow* pWindow = GetWindow(GetActiveWindow());
   if (pWindow)
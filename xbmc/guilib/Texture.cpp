@@ -371,7 +371,7 @@ bool CBaseTexture::LoadIImage(IImage *pImage, unsigned char* buffer, unsigned in
   return false;
 }
 
-bool CBaseTexture::LoadFromMemory(unsigned int width, unsigned int height, unsigned int pitch, unsigned int format, bool hasAlpha, unsigned char* pixels)
+bool CBaseTexture::LoadFromMemory(unsigned int width, unsigned int height, unsigned int pitch, unsigned int format, bool hasAlpha, const unsigned char* pixels)
 {
   m_imageWidth = m_originalWidth = width;
   m_imageHeight = m_originalHeight = height;
@@ -381,6 +381,19 @@ bool CBaseTexture::LoadFromMemory(unsigned int width, unsigned int height, unsig
   return true;
 }
 
+unsigned char* CBaseTexture::AllocateInPlace(unsigned int width, unsigned int height, unsigned int format, bool hasAlpha)
+{
+  if (format & XB_FMT_DXT_MASK && !g_Windowing.SupportsDXT())
+    return NULL; // needs decompressing, see Update()
+
+  Allocate(width, height, format);
+  m_hasAlpha = hasAlpha;
+
+  if (GetPitch(width) != GetPitch() || GetRows(height) > GetRows())
+    return NULL;
+  return m_pixels;
+}
+
 bool CBaseTexture::LoadPaletted(unsigned int width, unsigned int height, unsigned int pitch, unsigned int format, const unsigned char *pixels, const COLOR *palette)
 {
   if (pixels == NULL || palette == NULL)
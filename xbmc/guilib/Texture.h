@@ -71,7 +71,19 @@ public:
   static CBaseTexture *LoadFromFileInMemory(unsigned char* buffer, size_t bufferSize, const std::string& mimeType,
                                             unsigned int idealWidth = 0, unsigned int idealHeight = 0);
 
-  bool LoadFromMemory(unsigned int width, unsigned int height, unsigned int pitch, unsigned int format, bool hasAlpha, unsigned char* pixels);
+  bool LoadFromMemory(unsigned int width, unsigned int height, unsigned int pitch, unsigned int format, bool hasAlpha, const unsigned char* pixels);
+
+  /*! \brief Allocate the texture and return its pixel buffer to be filled in place
+   Saves the copy LoadFromMemory() does when the image data is produced by the caller (e.g. decompressed).
+   The data must be in the texture's own layout, so this fails if the format needs converting or the rows
+   are padded. Call ClampToEdge() once the pixels have been written.
+   \param width width of the image.
+   \param height height of the image.
+   \param format XB_FMT_* format of the image.
+   \param hasAlpha whether the image has an alpha channel.
+   \return the pixel buffer, GetPitch() * GetRows() bytes in size. NULL if the image can't be written in place.
+   */
+  unsigned char* AllocateInPlace(unsigned int width, unsigned int height, unsigned int format, bool hasAlpha);
   bool LoadPaletted(unsigned int width, unsigned int height, unsigned int pitch, unsigned int format, const unsigned char *pixels, const COLOR *palette);
 
   bool HasAlpha() const;
@@ -29,6 +29,7 @@
 #include "filesystem/SpecialProtocol.h"
 #include "utils/EndianSwap.h"
 #include "utils/URIUtils.h"
+#include "threads/SystemClock.h"
 #include "XBTF.h"
 #include <lzo/lzo1x.h>
 
@@ -78,12 +79,14 @@ bool CTextureBundleXBT::OpenBundle()
   strPath = CSpecialProtocol::TranslatePathConvertCase(strPath);
 
   // Load the texture file
+  unsigned int start = XbmcThreads::SystemClockMillis();
   if (!m_XBTFReader.Open(strPath))
   {
     return false;
   }
 
-  CLog::Log(LOGDEBUG, "%s - Opened bundle %s", __FUNCTION__, strPath.c_str());
+  CLog::Log(LOGDEBUG, "%s - Opened bundle %s (%u files in %u ms)", __FUNCTION__, strPath.c_str(),
+            (unsigned int)m_XBTFReader.GetFiles().size(), XbmcThreads::SystemClockMillis() - start);
 
   m_TimeStamp = m_XBTFReader.GetLastModificationTimestamp();
 
@@ -193,50 +196,73 @@ int CTextureBundleXBT::LoadAnim(const CStdString& Filename, CBaseTexture*** ppTe
 
 bool CTextureBundleXBT::ConvertFrameToTexture(const CStdString& name, CXBTFFrame& frame, CBaseTexture** ppTexture)
 {
-  // found texture - allocate the necessary buffers
-  squish::u8 *buffer = new squish::u8[(size_t)frame.GetPackedSize()];
-  if (buffer == NULL)
+  // use the packed data straight from the mapped bundle if we can, else read it in
+  squish::u8 *buffer = NULL;
+  const squish::u8 *packed = m_XBTFReader.GetData(frame);
+  if (!packed)
   {
-    CLog::Log(LOGERROR, "Out of memory loading texture: %s (need %"PRIu64" bytes)", name.c_str(), frame.GetPackedSize());
-    return false;
-  }
+    buffer = new squish::u8[(size_t)frame.GetPackedSize()];
+    if (buffer == NULL)
+    {
+      CLog::Log(LOGERROR, "Out of memory loading texture: %s (need %"PRIu64" bytes)", name.c_str(), frame.GetPackedSize());
+      return false;
+    }
 
-  // load the compressed texture
-  if (!m_XBTFReader.Load(frame, buffer))
-  {
-    CLog::Log(LOGERROR, "Error loading texture: %s", name.c_str());
-    delete[] buffer;
-    return false;
+    // load the compressed texture
+    if (!m_XBTFReader.Load(frame, buffer))
+    {
+      CLog::Log(LOGERROR, "Error loading texture: %s", name.c_str());
+      delete[] buffer;
+      return false;
+    }
+    packed = buffer;
   }
 
+  CTexture *texture = new CTexture();
+
   // check if it's packed with lzo
   if (frame.IsPacked())
-  { // unpack
-    squish::u8 *unpacked = new squish::u8[(size_t)frame.GetUnpackedSize()];
-    if (unpacked == NULL)
+  { // unpack, straight into the texture if its layout matches
+    squish::u8 *unpacked = texture->AllocateInPlace(frame.GetWidth(), frame.GetHeight(), frame.GetFormat(), frame.HasAlpha());
+    lzo_uint size = unpacked ? (lzo_uint)texture->GetPitch() * texture->GetRows() : 0;
+    if (size < frame.GetUnpackedSize())
     {
-      CLog::Log(LOGERROR, "Out of memory unpacking texture: %s (need %"PRIu64" bytes)", name.c_str(), frame.GetUnpackedSize());
-      delete[] buffer;
-      return false;
+      unpacked = new squish::u8[(size_t)frame.GetUnpackedSize()];
+      if (unpacked == NULL)
+      {
+        CLog::Log(LOGERROR, "Out of memory unpacking texture: %s (need %"PRIu64" bytes)", name.c_str(), frame.GetUnpackedSize());
+        delete[] buffer;
+        delete texture;
+        return false;
+      }
+      size = (lzo_uint)frame.GetUnpackedSize();
     }
-    lzo_uint s = (lzo_uint)frame.GetUnpackedSize();
-    if (lzo1x_decompress_safe(buffer, (lzo_uint)frame.GetPackedSize(), unpacked, &s, NULL) != LZO_E_OK ||
-        s != frame.GetUnpackedSize())
+    lzo_uint s = size;
+    bool unpackedOK = lzo1x_decompress_safe(packed, (lzo_uint)frame.GetPackedSize(), unpacked, &s, NULL) == LZO_E_OK &&
+                      s == frame.GetUnpackedSize();
+    delete[] buffer;
+    buffer = NULL;
+    if (unpacked != texture->GetPixels())
     {
-      CLog::Log(LOGERROR, "Error loading texture: %s: Decompression error", name.c_str());
-      delete[] buffer;
+      if (unpackedOK)
+        texture->LoadFromMemory(frame.GetWidth(), frame.GetHeight(), 0, frame.GetFormat(), frame.HasAlpha(), unpacked);
       delete[] unpacked;
+    }
+    else if (unpackedOK)
+      texture->ClampToEdge();
+
+    if (!unpackedOK)
+    {
+      CLog::Log(LOGERROR, "Error loading texture: %s: Decompression error", name.c_str());
+      delete texture;
       return false;
     }
-    delete[] buffer;
-    buffer = unpacked;
   }
-
-  // create an xbmc texture
-  *ppTexture = new CTexture();
-  (*ppTexture)->LoadFromMemory(frame.GetWidth(), frame.GetHeight(), 0, frame.GetFormat(), frame.HasAlpha(), buffer);
+  else
+    texture->LoadFromMemory(frame.GetWidth(), frame.GetHeight(), 0, frame.GetFormat(), frame.HasAlpha(), packed);
 
   delete[] buffer;
+  *ppTexture = texture;
 
   return true;
 }
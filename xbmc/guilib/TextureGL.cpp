@@ -24,6 +24,7 @@
 #include "utils/log.h"
 #include "utils/GLUtils.h"
 #include "guilib/TextureManager.h"
+#include "guilib/GUIFrameProfiler.h"
 
 #if defined(HAS_GL) || defined(HAS_GLES)
 
@@ -61,6 +62,8 @@ void CGLTexture::LoadToGPU()
     // nothing to load - probably same image (no change)
     return;
   }
+  CGUIFrameProfilerScope profile(CGUIFrameProfiler::CATEGORY_TEXTURE, "Upload", m_textureWidth, m_textureHeight);
+
   if (m_texture == 0)
   {
     // Have OpenGL generate a texture object handle for us
@@ -26,6 +26,7 @@
 #include "utils/log.h"
 #include "utils/URIUtils.h"
 #include "addons/Skin.h"
+#include "settings/AdvancedSettings.h"
 #ifdef _DEBUG
 #include "utils/TimeUtils.h"
 #endif
@@ -127,14 +128,16 @@ CTextureMap::CTextureMap()
   m_textureName = "";
   m_referenceCount = 0;
   m_memUsage = 0;
+  m_bundle = -1;
 }
 
-CTextureMap::CTextureMap(const CStdString& textureName, int width, int height, int loops)
+CTextureMap::CTextureMap(const CStdString& textureName, int width, int height, int loops, int bundle)
 : m_texture(width, height, loops)
 {
   m_textureName = textureName;
   m_referenceCount = 0;
   m_memUsage = 0;
+  m_bundle = bundle;
 }
 
 CTextureMap::~CTextureMap()
@@ -215,6 +218,8 @@ CGUITextureManager::CGUITextureManager(void)
 {
   // we set the theme bundle to be the first bundle (thus prioritizing it)
   m_TexBundle[0].SetThemeBundle(true);
+  m_memUsage = 0;
+  m_unusedMemUsage = 0;
 }
 
 CGUITextureManager::~CGUITextureManager(void)
@@ -249,14 +254,10 @@ bool CGUITextureManager::HasTexture(const CStdString &textureName, CStdString *p
 
   // Check our loaded and bundled textures - we store in bundles using \\.
   CStdString bundledName = CTextureBundle::Normalize(textureName);
-  for (int i = 0; i < (int)m_vecTextures.size(); ++i)
+  if (m_textures.find(textureName) != m_textures.end())
   {
-    CTextureMap *pMap = m_vecTextures[i];
-    if (pMap->GetName() == textureName)
-    {
-      if (size) *size = 1;
-      return true;
-    }
+    if (size) *size = 1;
+    return true;
   }
 
   for (int i = 0; i < 2; i++)
@@ -286,28 +287,25 @@ const CTextureArray& CGUITextureManager::Load(const CStdString& strTextureName,
 
   if (size) // we found the texture
   {
-    for (int i = 0; i < (int)m_vecTextures.size(); ++i)
+    iTextures i = m_textures.find(strTextureName);
+    if (i != m_textures.end())
     {
-      CTextureMap *pMap = m_vecTextures[i];
-      if (pMap->GetName() == strTextureName)
-      {
-        //CLog::Log(LOGDEBUG, "Total memusage %u", GetMemoryUsage());
-        return pMap->GetTexture();
-      }
+      //CLog::Log(LOGDEBUG, "Total memusage %u", GetMemoryUsage());
+      return i->second->GetTexture();
     }
     // Whoops, not there.
     return emptyTexture;
   }
 
-  for (ilistUnused i = m_unusedTextures.begin(); i != m_unusedTextures.end(); ++i)
+  UnusedIndex::iterator unused = m_unusedIndex.find(strTextureName);
+  if (unused != m_unusedIndex.end())
   {
-    CTextureMap* pMap = i->first;
-    if (pMap->GetName() == strTextureName)
-    {
-      m_vecTextures.push_back(pMap);
-      m_unusedTextures.erase(i);
-      return pMap->GetTexture();
-    }
+    CTextureMap* pMap = unused->second->first;
+    m_unusedTextures.erase(unused->second);
+    m_unusedIndex.erase(unused);
+    m_unusedMemUsage -= pMap->GetMemoryUsage();
+    AddTexture(pMap);
+    return pMap->GetTexture();
   }
 
   if (checkBundleOnly && bundle == -1)
@@ -339,7 +337,7 @@ const CTextureArray& CGUITextureManager::Load(const CStdString& strTextureName,
         return emptyTexture;
       }
 
-      pMap = new CTextureMap(strTextureName, width, height, nLoops);
+      pMap = new CTextureMap(strTextureName, width, height, nLoops, bundle);
       for (int iImage = 0; iImage < nImages; ++iImage)
       {
         pMap->Add(pTextures[iImage], Delay[iImage]);
@@ -394,7 +392,7 @@ const CTextureArray& CGUITextureManager::Load(const CStdString& strTextureName,
     OutputDebugString(temp);
 #endif
 
-    m_vecTextures.push_back(pMap);
+    AddTexture(pMap);
     return pMap->GetTexture();
   } // of if (strPath.Right(4).ToLower()==".gif")
 
@@ -419,9 +417,9 @@ const CTextureArray& CGUITextureManager::Load(const CStdString& strTextureName,
 
   if (!pTexture) return emptyTexture;
 
-  CTextureMap* pMap = new CTextureMap(strTextureName, width, height, 0);
+  CTextureMap* pMap = new CTextureMap(strTextureName, width, height, 0, bundle);
   pMap->Add(pTexture, 100);
-  m_vecTextures.push_back(pMap);
+  AddTexture(pMap);
 
 #ifdef _DEBUG_TEXTURES
   int64_t end, freq;
@@ -436,27 +434,30 @@ const CTextureArray& CGUITextureManager::Load(const CStdString& strTextureName,
 }
 
 
+void CGUITextureManager::AddTexture(CTextureMap *pMap)
+{
+  m_textures[pMap->GetName()] = pMap;
+  m_memUsage += pMap->GetMemoryUsage();
+}
+
 void CGUITextureManager::ReleaseTexture(const CStdString& strTextureName)
 {
   CSingleLock lock(g_graphicsContext);
 
-  ivecTextures i;
-  i = m_vecTextures.begin();
-  while (i != m_vecTextures.end())
+  iTextures i = m_textures.find(strTextureName);
+  if (i != m_textures.end())
   {
-    CTextureMap* pMap = *i;
-    if (pMap->GetName() == strTextureName)
+    CTextureMap* pMap = i->second;
+    if (pMap->Release())
     {
-      if (pMap->Release())
-      {
-        //CLog::Log(LOGINFO, "  cleanup:%s", strTextureName.c_str());
-        // add to our textures to free
-        m_unusedTextures.push_back(make_pair(pMap, XbmcThreads::SystemClockMillis()));
-        i = m_vecTextures.erase(i);
-      }
-      return;
+      //CLog::Log(LOGINFO, "  cleanup:%s", strTextureName.c_str());
+      // add to our textures to free
+      m_textures.erase(i);
+      m_memUsage -= pMap->GetMemoryUsage();
+      m_unusedIndex[pMap->GetName()] = m_unusedTextures.insert(m_unusedTextures.end(), make_pair(pMap, XbmcThreads::SystemClockMillis()));
+      m_unusedMemUsage += pMap->GetMemoryUsage();
     }
-    ++i;
+    return;
   }
   CLog::Log(LOGWARNING, "%s: Unable to release texture %s", __FUNCTION__, strTextureName.c_str());
 }
@@ -464,17 +465,26 @@ void CGUITextureManager::ReleaseTexture(const CStdString& strTextureName)
 void CGUITextureManager::FreeUnusedTextures(unsigned int timeDelay)
 {
   unsigned int currFrameTime = XbmcThreads::SystemClockMillis();
+  uint32_t budget = g_advancedSettings.m_guiTextureMemory * 1024 * 1024;
+  uint32_t evicted = 0;
   CSingleLock lock(g_graphicsContext);
+  // textures are released in order, so the first ones are the least recently used
   for (ilistUnused i = m_unusedTextures.begin(); i != m_unusedTextures.end();)
   {
-    if (currFrameTime - i->second >= timeDelay)
-    {
-      delete i->first;
-      i = m_unusedTextures.erase(i);
-    }
-    else
-      ++i;
+    bool overBudget = budget && m_memUsage + m_unusedMemUsage > budget;
+    if (!overBudget && currFrameTime - i->second < timeDelay)
+      break;
+
+    if (overBudget && currFrameTime - i->second < timeDelay)
+      evicted += i->first->GetMemoryUsage();
+    m_unusedMemUsage -= i->first->GetMemoryUsage();
+    m_unusedIndex.erase(i->first->GetName());
+    delete i->first;
+    i = m_unusedTextures.erase(i);
   }
+  if (evicted)
+    CLog::Log(LOGDEBUG, "%s: freed %u bytes of textures to stay within %u bytes, resident theme: %u skin: %u files: %u", __FUNCTION__,
+              evicted, budget, GetResidentMemory(0), GetResidentMemory(1), GetResidentMemory(-1));
 
 #if defined(HAS_GL) || defined(HAS_GLES)
   for (unsigned int i = 0; i < m_unusedHwTextures.size(); ++i)
@@ -495,15 +505,14 @@ void CGUITextureManager::Cleanup()
 {
   CSingleLock lock(g_graphicsContext);
 
-  ivecTextures i;
-  i = m_vecTextures.begin();
-  while (i != m_vecTextures.end())
+  for (iTextures i = m_textures.begin(); i != m_textures.end(); ++i)
   {
-    CTextureMap* pMap = *i;
+    CTextureMap* pMap = i->second;
     CLog::Log(LOGWARNING, "%s: Having to cleanup texture %s", __FUNCTION__, pMap->GetName().c_str());
     delete pMap;
-    i = m_vecTextures.erase(i);
   }
+  m_textures.clear();
+  m_memUsage = 0;
   for (int i = 0; i < 2; i++)
     m_TexBundle[i].Cleanup();
   FreeUnusedTextures();
@@ -512,12 +521,14 @@ void CGUITextureManager::Cleanup()
 void CGUITextureManager::Dump() const
 {
   CStdString strLog;
-  strLog.Format("total texturemaps size:%i\n", m_vecTextures.size());
+  strLog.Format("total texturemaps size:%i\n", m_textures.size());
+  OutputDebugString(strLog.c_str());
+  strLog.Format("resident texture memory theme:%u skin:%u files:%u\n", GetResidentMemory(0), GetResidentMemory(1), GetResidentMemory(-1));
   OutputDebugString(strLog.c_str());
 
-  for (int i = 0; i < (int)m_vecTextures.size(); ++i)
+  for (TextureIndex::const_iterator i = m_textures.begin(); i != m_textures.end(); ++i)
   {
-    const CTextureMap* pMap = m_vecTextures[i];
+    const CTextureMap* pMap = i->second;
     if (!pMap->IsEmpty())
       pMap->Dump();
   }
@@ -527,16 +538,16 @@ void CGUITextureManager::Flush()
 {
   CSingleLock lock(g_graphicsContext);
 
-  ivecTextures i;
-  i = m_vecTextures.begin();
-  while (i != m_vecTextures.end())
+  iTextures i = m_textures.begin();
+  while (i != m_textures.end())
   {
-    CTextureMap* pMap = *i;
+    CTextureMap* pMap = i->second;
     pMap->Flush();
     if (pMap->IsEmpty() )
     {
+      m_memUsage -= pMap->GetMemoryUsage();
       delete pMap;
-      i = m_vecTextures.erase(i);
+      i = m_textures.erase(i);
     }
     else
     {
@@ -547,10 +558,21 @@ void CGUITextureManager::Flush()
 
 unsigned int CGUITextureManager::GetMemoryUsage() const
 {
-  unsigned int memUsage = 0;
-  for (int i = 0; i < (int)m_vecTextures.size(); ++i)
+  return m_memUsage;
+}
+
+uint32_t CGUITextureManager::GetResidentMemory(int bundle) const
+{
+  uint32_t memUsage = 0;
+  for (TextureIndex::const_iterator i = m_textures.begin(); i != m_textures.end(); ++i)
+  {
+    if (i->second->GetBundle() == bundle)
+      memUsage += i->second->GetMemoryUsage();
+  }
+  for (std::list<std::pair<CTextureMap*, unsigned int> >::const_iterator i = m_unusedTextures.begin(); i != m_unusedTextures.end(); ++i)
   {
-    memUsage += m_vecTextures[i]->GetMemoryUsage();
+    if (i->first->GetBundle() == bundle)
+      memUsage += i->first->GetMemoryUsage();
   }
   return memUsage;
 }
@@ -28,6 +28,7 @@
 
 #include <vector>
 #include <list>
+#include <boost/unordered_map.hpp>
 #include "TextureBundle.h"
 #include "threads/CriticalSection.h"
 
@@ -73,7 +74,7 @@ class CTextureMap
 {
 public:
   CTextureMap();
-  CTextureMap(const CStdString& textureName, int width, int height, int loops);
+  CTextureMap(const CStdString& textureName, int width, int height, int loops, int bundle = -1);
   virtual ~CTextureMap();
 
   void Add(CBaseTexture* texture, int delay);
@@ -83,6 +84,7 @@ public:
   const CTextureArray& GetTexture();
   void Dump() const;
   uint32_t GetMemoryUsage() const;
+  int GetBundle() const { return m_bundle; };
   void Flush();
   bool IsEmpty() const;
 protected:
@@ -92,6 +94,7 @@ protected:
   CTextureArray m_texture;
   unsigned int m_referenceCount;
   uint32_t m_memUsage;
+  int m_bundle;              ///< bundle the texture was loaded from, -1 if loaded from a file
 };
 
 /*!
@@ -114,6 +117,11 @@ public:
   void Cleanup();
   void Dump() const;
   uint32_t GetMemoryUsage() const;
+
+  /*! \brief Get the memory held by textures from a bundle, whether in use or released and not yet freed
+   \param bundle the bundle the textures were loaded from (0 for the theme, 1 for the skin), -1 for textures loaded from files
+   */
+  uint32_t GetResidentMemory(int bundle) const;
   void Flush();
   CStdString GetTexturePath(const CStdString& textureName, bool directory = false);
   void GetBundledTexturesFromPath(const CStdString& texturePath, std::vector<CStdString> &items);
@@ -122,14 +130,26 @@ public:
   void SetTexturePath(const CStdString &texturePath);    ///< Set a single path as the path to check when loading media (clear then add)
   void RemoveTexturePath(const CStdString &texturePath); ///< Remove a path from the paths to check when loading media
 
-  void FreeUnusedTextures(unsigned int timeDelay = 0); ///< Free textures (called from app thread only)
+  /*! \brief Free textures (called from app thread only)
+   Released textures are freed once they have been unused for timeDelay ms, or earlier (least
+   recently used first) while the texture memory exceeds the budget set in advancedsettings.
+   */
+  void FreeUnusedTextures(unsigned int timeDelay = 0);
   void ReleaseHwTexture(unsigned int texture);
 protected:
-  std::vector<CTextureMap*> m_vecTextures;
-  std::list<std::pair<CTextureMap*, unsigned int> > m_unusedTextures;
-  std::vector<unsigned int> m_unusedHwTextures;
-  typedef std::vector<CTextureMap*>::iterator ivecTextures;
+  void AddTexture(CTextureMap *pMap);
+
+  typedef boost::unordered_map<std::string, CTextureMap*> TextureIndex;
   typedef std::list<std::pair<CTextureMap*, unsigned int> >::iterator ilistUnused;
+  typedef boost::unordered_map<std::string, ilistUnused> UnusedIndex;
+  typedef TextureIndex::iterator iTextures;
+
+  TextureIndex m_textures;                                            ///< textures in use, by name
+  std::list<std::pair<CTextureMap*, unsigned int> > m_unusedTextures; ///< released textures, least recently released first
+  UnusedIndex m_unusedIndex;                                          ///< released textures, by name
+  uint32_t m_memUsage;                                                ///< memory used by textures in use
+  uint32_t m_unusedMemUsage;                                          ///< memory used by released textures
+  std::vector<unsigned int> m_unusedHwTextures;
   // we have 2 texture bundles (one for the base textures, one for the theme)
   CTextureBundle m_TexBundle[2];
 
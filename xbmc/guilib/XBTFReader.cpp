@@ -25,6 +25,9 @@
 #ifdef TARGET_WINDOWS
 #include "FileSystem/SpecialProtocol.h"
 #endif
+#ifdef TARGET_POSIX
+#include <sys/mman.h>
+#endif
 
 #include <string.h>
 #include "PlatformDefs.h"
@@ -46,6 +49,8 @@
 CXBTFReader::CXBTFReader()
 {
   m_file = NULL;
+  m_map = NULL;
+  m_mapSize = 0;
 }
 
 bool CXBTFReader::IsOpen() const
@@ -87,6 +92,8 @@ bool CXBTFReader::Open(const CStdString& fileName)
 
   unsigned int nofFiles;
   READ_U32(nofFiles, m_file);
+  m_xbtf.GetFiles().reserve(nofFiles);
+  m_fileIndex.rehash(nofFiles);
   for (unsigned int i = 0; i < nofFiles; i++)
   {
     CXBTFFile file;
@@ -122,9 +129,8 @@ bool CXBTFReader::Open(const CStdString& fileName)
       file.GetFrames().push_back(frame);
     }
 
+    m_fileIndex[file.GetPath()] = m_xbtf.GetFiles().size();
     m_xbtf.GetFiles().push_back(file);
-
-    m_filesMap[file.GetPath()] = file;
   }
 
   // Sanity check
@@ -135,11 +141,34 @@ bool CXBTFReader::Open(const CStdString& fileName)
     return false;
   }
 
+#ifdef TARGET_POSIX
+  // map the frame data so textures can be loaded without copying it out first.
+  // failing to map isn't fatal, Load() falls back to reading from the file.
+  struct stat fileStat;
+  if (fstat(fileno(m_file), &fileStat) == 0 && fileStat.st_size > 0 &&
+      (uint64_t)fileStat.st_size == (uint64_t)(size_t)fileStat.st_size)
+  {
+    void *map = mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_SHARED, fileno(m_file), 0);
+    if (map != MAP_FAILED)
+    {
+      m_map = (unsigned char *)map;
+      m_mapSize = fileStat.st_size;
+    }
+  }
+#endif
+
   return true;
 }
 
 void CXBTFReader::Close()
 {
+#ifdef TARGET_POSIX
+  if (m_map)
+    munmap(m_map, (size_t)m_mapSize);
+#endif
+  m_map = NULL;
+  m_mapSize = 0;
+
   if (m_file)
   {
     fclose(m_file);
@@ -147,7 +176,7 @@ void CXBTFReader::Close()
   }
 
   m_xbtf.GetFiles().clear();
-  m_filesMap.clear();
+  m_fileIndex.clear();
 }
 
 time_t CXBTFReader::GetLastModificationTimestamp()
@@ -173,13 +202,23 @@ bool CXBTFReader::Exists(const CStdString& name)
 
 CXBTFFile* CXBTFReader::Find(const CStdString& name)
 {
-  std::map<CStdString, CXBTFFile>::iterator iter = m_filesMap.find(name);
-  if (iter == m_filesMap.end())
+  FileIndex::const_iterator iter = m_fileIndex.find(name);
+  if (iter == m_fileIndex.end())
   {
     return NULL;
   }
 
-  return &(iter->second);
+  return &m_xbtf.GetFiles()[iter->second];
+}
+
+const unsigned char* CXBTFReader::GetData(const CXBTFFrame& frame) const
+{
+  if (!m_map || frame.GetOffset() > m_mapSize || frame.GetPackedSize() > m_mapSize - frame.GetOffset())
+  {
+    return NULL;
+  }
+
+  return m_map + frame.GetOffset();
 }
 
 bool CXBTFReader::Load(const CXBTFFrame& frame, unsigned char* buffer)
@@ -188,6 +227,13 @@ bool CXBTFReader::Load(const CXBTFFrame& frame, unsigned char* buffer)
   {
     return false;
   }
+
+  const unsigned char* data = GetData(frame);
+  if (data)
+  {
+    memcpy(buffer, data, (size_t)frame.GetPackedSize());
+    return true;
+  }
 #if defined(TARGET_DARWIN) || defined(TARGET_FREEBSD) || defined(TARGET_ANDROID)
     if (fseeko(m_file, (off_t)frame.GetOffset(), SEEK_SET) == -1)
 #else
@@ -22,7 +22,8 @@
 #define XBTFREADER_H_
 
 #include <vector>
-#include <map>
+#include <string>
+#include <boost/unordered_map.hpp>
 #include "utils/StdString.h"
 #include "XBTF.h"
 
@@ -37,13 +38,26 @@ public:
   bool Exists(const CStdString& name);
   CXBTFFile* Find(const CStdString& name);
   bool Load(const CXBTFFrame& frame, unsigned char* buffer);
+
+  /*! \brief Get the packed data of a frame without copying it
+   Where the platform supports it the bundle is memory mapped, and the returned pointer
+   points into the mapping. It stays valid until the reader is closed.
+   \param frame the frame to get the data of
+   \return the frame's packed data, NULL if the bundle isn't mapped (use Load() instead)
+   */
+  const unsigned char* GetData(const CXBTFFrame& frame) const;
+
   std::vector<CXBTFFile>&  GetFiles();
 
 private:
+  typedef boost::unordered_map<std::string, size_t> FileIndex;
+
   CXBTF      m_xbtf;
   CStdString m_fileName;
   FILE*      m_file;
-  std::map<CStdString, CXBTFFile> m_filesMap;
+  FileIndex  m_fileIndex;   ///< path -> position in m_xbtf.GetFiles()
+  unsigned char* m_map;
+  uint64_t   m_mapSize;
 };
 
 #endif
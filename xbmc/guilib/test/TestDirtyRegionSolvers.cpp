@@ -0,0 +1,257 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "guilib/DirtyRegionSolvers.h"
+#include "guilib/DirtyRegionTracker.h"
+#include "utils/TimeUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <stdlib.h>
+#include <iostream>
+#include <vector>
+
+/* frames of a 1280x720 home screen: a spinner, a clock, a scrolling list and an info bar */
+static void MakeTrace(std::vector<CDirtyRegionList> &frames)
+{
+  const int buffering = 3;
+  CDirtyRegionList marked;
+  std::vector<int> ages;
+
+  srand(1234);
+  for (int frame = 0; frame < 2000; frame++)
+  {
+    CDirtyRegionList added;
+    added.push_back(CDirtyRegion(600, 320, 680, 400));
+    if (frame % 30 == 0)
+      added.push_back(CDirtyRegion(1100, 20, 1260, 60));
+    if ((frame / 100) % 2 == 0)
+    {
+      float y = 100.0f + (frame % 100) * 5.0f;
+      added.push_back(CDirtyRegion(100, y, 500, y + 60));
+      if (frame % 10 == 0)
+        added.push_back(CDirtyRegion(520, 100, 1200, 600)); // fanart of the focused item
+    }
+    if (rand() % 50 == 0)
+      added.push_back(CDirtyRegion(0, 620, 1280, 720));
+
+    for (unsigned int i = 0; i < added.size(); i++)
+    {
+      marked.push_back(added[i]);
+      ages.push_back(0);
+    }
+    frames.push_back(marked);
+
+    for (int i = marked.size() - 1; i >= 0; i--)
+    {
+      if (++ages[i] >= buffering)
+      {
+        marked.erase(marked.begin() + i);
+        ages.erase(ages.begin() + i);
+      }
+    }
+  }
+}
+
+static bool Equal(const CRect &a, const CRect &b)
+{
+  return !(a != b);
+}
+
+static float Area(const CDirtyRegionList &regions)
+{
+  float area = 0;
+  for (unsigned int i = 0; i < regions.size(); i++)
+    area += regions[i].Area();
+  return area;
+}
+
+TEST(TestDirtyRegionSolvers, CostModelMergesOverlapping)
+{
+  CCostDirtyRegionSolver solver;
+  CDirtyRegionList input, output;
+  input.push_back(CDirtyRegion(0, 0, 100, 100));
+  input.push_back(CDirtyRegion(30, 30, 120, 120));
+  input.push_back(CDirtyRegion(60, 60, 70, 70));
+  solver.Solve(input, output);
+
+  ASSERT_EQ(1U, output.size());
+  EXPECT_TRUE(Equal(CRect(0, 0, 120, 120), output[0]));
+}
+
+TEST(TestDirtyRegionSolvers, CostModelKeepsDistantRegions)
+{
+  CCostDirtyRegionSolver solver;
+  CDirtyRegionList input, output;
+  input.push_back(CDirtyRegion(0, 0, 50, 50));
+  input.push_back(CDirtyRegion(1000, 600, 1050, 650));
+  input.push_back(CDirtyRegion(CRect()));
+  solver.Solve(input, output);
+
+  ASSERT_EQ(2U, output.size());
+  EXPECT_TRUE(Equal(input[0], output[0]));
+  EXPECT_TRUE(Equal(input[1], output[1]));
+}
+
+TEST(TestDirtyRegionSolvers, CostModelLearnsCosts)
+{
+  CCostDirtyRegionSolver solver;
+
+  // draw call bound: a pass costs as much as 100000 pixels
+  for (int i = 0; i < 200; i++)
+  {
+    float size = 10.0f + (i % 20) * 30.0f;
+    CDirtyRegion region(0, 0, size, size);
+    solver.RenderedPass(region, 2.0f + 0.00002f * region.Area());
+  }
+  EXPECT_NEAR(2.0f, solver.GetCostPerPass(), 0.01f);
+  EXPECT_NEAR(0.00002f, solver.GetCostPerPixel(), 0.000001f);
+
+  // which makes merging the distant regions worthwhile
+  CDirtyRegionList input, output;
+  input.push_back(CDirtyRegion(0, 0, 50, 50));
+  input.push_back(CDirtyRegion(200, 200, 250, 250));
+  solver.Solve(input, output);
+  ASSERT_EQ(1U, output.size());
+  EXPECT_TRUE(Equal(CRect(0, 0, 250, 250), output[0]));
+}
+
+TEST(TestDirtyRegionSolvers, CostModelIgnoresConstantSizes)
+{
+  CCostDirtyRegionSolver solver;
+  float pass = solver.GetCostPerPass();
+  float pixel = solver.GetCostPerPixel();
+
+  for (int i = 0; i < 200; i++)
+    solver.RenderedPass(CDirtyRegion(0, 0, 100, 100), 5.0f);
+  EXPECT_EQ(pass, solver.GetCostPerPass());
+  EXPECT_EQ(pixel, solver.GetCostPerPixel());
+}
+
+TEST(TestDirtyRegionSolvers, TraceFrame)
+{
+  CDirtyRegionList regions, parsed;
+  regions.push_back(CDirtyRegion(0, 0, 1280, 720));
+  regions.push_back(CDirtyRegion(10.5f, 20.25f, 30, 40));
+
+  std::string line = CDirtyRegionTracker::FormatTraceFrame(regions);
+  EXPECT_EQ("0 0 1280 720;10.5 20.25 30 40", line);
+  EXPECT_TRUE(CDirtyRegionTracker::ParseTraceFrame(line + "\r\n", parsed));
+  ASSERT_EQ(2U, parsed.size());
+  EXPECT_TRUE(Equal(regions[0], parsed[0]));
+  EXPECT_TRUE(Equal(regions[1], parsed[1]));
+
+  parsed.clear();
+  EXPECT_TRUE(CDirtyRegionTracker::ParseTraceFrame("", parsed));
+  EXPECT_TRUE(parsed.empty());
+  EXPECT_FALSE(CDirtyRegionTracker::ParseTraceFrame("1 2 3", parsed));
+  EXPECT_FALSE(CDirtyRegionTracker::ParseTraceFrame("1 2 3 4 5", parsed));
+}
+
+/* replays a trace through each solver, reporting the pixels and passes rendered, the render time
+   on a simulated GPU and the time taken by the solver. The passes are reported back to the solvers
+   with the simulated time, so the cost model solver can adapt to it.
+
+   A trace recorded with <gui><dirtyregiontrace> can be given in the XBMC_DIRTYREGION_TRACE
+   environment variable, a synthetic one is used otherwise. */
+TEST(TestDirtyRegionSolvers, Benchmark)
+{
+  std::vector<CDirtyRegionList> frames;
+  const char *path = getenv("XBMC_DIRTYREGION_TRACE");
+  if (path)
+    ASSERT_TRUE(CDirtyRegionTracker::ReadTrace(path, frames));
+  else
+    MakeTrace(frames);
+  ASSERT_FALSE(frames.empty());
+
+  const struct
+  {
+    const char *name;
+    float costPerPass;
+    float costPerPixel;
+  } gpus[] =
+  {
+    { "fill rate bound", 0.05f, 0.00002f },
+    { "draw call bound", 2.0f,  0.000002f },
+  };
+
+  for (unsigned int g = 0; g < sizeof(gpus) / sizeof(gpus[0]); g++)
+  {
+    CUnionDirtyRegionSolver unionSolver;
+    CGreedyDirtyRegionSolver greedySolver;
+    CCostDirtyRegionSolver costSolver;
+    struct
+    {
+      const char *name;
+      IDirtyRegionSolver *solver;
+    } solvers[] =
+    {
+      { "union ", &unionSolver },
+      { "greedy", &greedySolver },
+      { "cost  ", &costSolver },
+    };
+
+    std::cout << gpus[g].name << ":" << std::endl;
+    for (unsigned int s = 0; s < sizeof(solvers) / sizeof(solvers[0]); s++)
+    {
+      double pixels = 0, renderTime = 0;
+      unsigned int passes = 0;
+      int64_t time = 0;
+      for (unsigned int f = 0; f < frames.size(); f++)
+      {
+        CDirtyRegionList output;
+        int64_t start = CurrentHostCounter();
+        solvers[s].solver->Solve(frames[f], output);
+        time += CurrentHostCounter() - start;
+
+        // every input region must still be redrawn
+        float covered = 0;
+        for (unsigned int i = 0; i < frames[f].size(); i++)
+        {
+          for (unsigned int j = 0; j < output.size(); j++)
+          {
+            CRect intersection(frames[f][i]);
+            intersection.Intersect(output[j]);
+            if (Equal(intersection, frames[f][i]))
+            {
+              covered += intersection.Area();
+              break;
+            }
+          }
+        }
+        EXPECT_EQ(Area(frames[f]), covered) << solvers[s].name << " frame " << f;
+
+        for (unsigned int i = 0; i < output.size(); i++)
+        {
+          float passTime = gpus[g].costPerPass + gpus[g].costPerPixel * output[i].Area();
+          solvers[s].solver->RenderedPass(output[i], passTime);
+          renderTime += passTime;
+        }
+        pixels += Area(output);
+        passes += output.size();
+      }
+
+      std::cout << "  " << solvers[s].name << ": " << (uint64_t)(pixels / frames.size()) << " pixels/frame, "
+                << (float)passes / frames.size() << " passes/frame, "
+                << renderTime / frames.size() << " ms/frame rendering, "
+                << 1000000.0 * time / CurrentHostFrequency() / frames.size() << " us/frame solving" << std::endl;
+    }
+  }
+}
@@ -0,0 +1,249 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "guilib/GUIFont.h"
+#include "guilib/GUIFontTTF.h"
+#include "guilib/Texture.h"
+#include "filesystem/File.h"
+#include "utils/Crc32.h"
+#include "windowing/WindowingFactory.h"
+
+#include "gtest/gtest.h"
+
+#include <string.h>
+
+/* A font that packs glyphs into system memory only, so the atlas can be tested without a
+   font file or a rendering context. */
+class CTestFont : public CGUIFontTTFBase
+{
+public:
+  typedef CGUIFontTTFBase::Character Character;
+
+  CTestFont(const CStdString &key = "") : CGUIFontTTFBase("test")
+  {
+    m_textureWidth = 256;
+    m_textureScaleX = 1.0f / m_textureWidth;
+    m_cellHeight = 15;
+    m_glyphCacheKey = key;
+  }
+
+  virtual void Begin() {}
+  virtual void End() {}
+
+  bool Allocate(unsigned int width, unsigned int height, unsigned int &x, unsigned int &y)
+  {
+    bool ret = AllocateGlyph(width, height, x, y);
+    if (ret)
+      m_glyphCacheDirty = true;
+    return ret;
+  }
+
+  /*! \brief Add a glyph to the map and fill its pixels with a pattern, as CacheCharacter() would */
+  bool AddGlyph(character_t letter, unsigned int width, unsigned int height)
+  {
+    unsigned int x, y;
+    if (!Allocate(width, height, x, y))
+      return false;
+
+    Character ch;
+    memset(&ch, 0, sizeof(ch));
+    ch.letterAndStyle = letter;
+    ch.left = (float)x;
+    ch.top = (float)y;
+    ch.right = ch.left + width;
+    ch.bottom = ch.top + height;
+    ch.advance = (float)width;
+    ch.page = m_pages.size();
+    m_chars[letter] = ch;
+
+    for (unsigned int row = y; row < y + height; row++)
+      memset(m_texture->GetPixels() + row * m_texture->GetPitch() + x, (unsigned char)letter, width);
+    return true;
+  }
+
+  const Character *Find(character_t letter) const
+  {
+    CharacterMap::const_iterator it = m_chars.find(letter);
+    return it == m_chars.end() ? NULL : &it->second;
+  }
+
+  unsigned char Pixel(unsigned int page, unsigned int x, unsigned int y) const
+  {
+    const CBaseTexture *texture = page < m_pages.size() ? m_pages[page].texture : m_texture;
+    return texture->GetPixels()[y * texture->GetPitch() + x];
+  }
+
+  unsigned int Pages() const { return m_pages.size() + (m_texture ? 1 : 0); }
+  unsigned int Shelves() const { return m_shelves.size(); }
+  unsigned int Glyphs() const { return m_chars.size(); }
+
+  bool Load() { return LoadGlyphCache(); }
+  void Save() { SaveGlyphCache(); }
+  bool Dirty() const { return m_glyphCacheDirty; }
+
+  CStdString CacheFile() const
+  {
+    Crc32 crc;
+    crc.Compute(m_glyphCacheKey);
+    CStdString file;
+    file.Format("special://temp/fontcache/%08x.bin", (uint32_t)crc);
+    return file;
+  }
+
+protected:
+  virtual CBaseTexture* ReallocTexture(unsigned int& newHeight)
+  {
+    CBaseTexture *texture = new CTexture(m_textureWidth, newHeight, XB_FMT_A8);
+    memset(texture->GetPixels(), 0, texture->GetHeight() * texture->GetPitch());
+    if (m_texture)
+    {
+      for (unsigned int y = 0; y < m_texture->GetHeight(); y++)
+        memcpy(texture->GetPixels() + y * texture->GetPitch(), m_texture->GetPixels() + y * m_texture->GetPitch(), m_texture->GetPitch());
+      delete m_texture;
+    }
+    m_textureHeight = texture->GetHeight();
+    m_textureScaleY = 1.0f / m_textureHeight;
+    return texture;
+  }
+  virtual bool CopyCharToTexture(FT_BitmapGlyph bitGlyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2) { return true; }
+  virtual void DeleteHardwareTexture() {}
+  virtual unsigned int GetMaxPages() const { return 4; }
+  virtual bool CanCacheGlyphs() const { return true; }
+};
+
+TEST(TestGUIFontTTF, ShelfSameHeight)
+{
+  CTestFont font;
+  unsigned int x1, y1, x2, y2;
+  ASSERT_TRUE(font.Allocate(10, 14, x1, y1));
+  ASSERT_TRUE(font.Allocate(12, 13, x2, y2));
+
+  // glyphs of about the same height share a shelf, with a gap between them
+  EXPECT_EQ(1U, font.Shelves());
+  EXPECT_EQ(y1, y2);
+  EXPECT_EQ(x1 + 10 + 1, x2);
+}
+
+TEST(TestGUIFontTTF, ShelfPerHeight)
+{
+  CTestFont font;
+  unsigned int x1, y1, x2, y2, x3, y3;
+  ASSERT_TRUE(font.Allocate(10, 14, x1, y1));
+  ASSERT_TRUE(font.Allocate(10, 4, x2, y2));
+  ASSERT_TRUE(font.Allocate(10, 14, x3, y3));
+
+  // a small glyph gets a shelf of its own below, rather than wasting the tall one
+  EXPECT_EQ(2U, font.Shelves());
+  EXPECT_GT(y2, y1);
+  EXPECT_EQ(0U, x2);
+  EXPECT_EQ(y1, y3);
+  EXPECT_GT(x3, x1);
+}
+
+TEST(TestGUIFontTTF, ShelfFull)
+{
+  CTestFont font;
+  unsigned int x, y;
+  // a shelf fills up to the width of the texture
+  for (unsigned int i = 0; i < 256 / 16; i++)
+  {
+    ASSERT_TRUE(font.Allocate(15, 14, x, y));
+    EXPECT_EQ(i * 16, x);
+    EXPECT_EQ(0U, y);
+  }
+  ASSERT_TRUE(font.Allocate(15, 14, x, y));
+  EXPECT_EQ(0U, x);
+  EXPECT_GT(y, 0U);
+  EXPECT_EQ(2U, font.Shelves());
+
+  EXPECT_FALSE(font.Allocate(256, 14, x, y));
+}
+
+TEST(TestGUIFontTTF, Pages)
+{
+  CTestFont font;
+  unsigned int maxSize = g_Windowing.GetMaxTextureSize();
+  unsigned int glyphsPerPage = (256 / 16) * (maxSize / 16);
+
+  unsigned int x, y;
+  for (unsigned int i = 0; i < glyphsPerPage; i++)
+    ASSERT_TRUE(font.Allocate(15, 15, x, y));
+  EXPECT_EQ(1U, font.Pages());
+
+  // once a page is at the maximum texture size the next glyph starts another
+  ASSERT_TRUE(font.Allocate(15, 15, x, y));
+  EXPECT_EQ(2U, font.Pages());
+  EXPECT_EQ(0U, x);
+  EXPECT_EQ(0U, y);
+
+  // and the atlas is full once the backend's page limit is reached
+  for (unsigned int i = 1; i < glyphsPerPage * 3; i++)
+    ASSERT_TRUE(font.Allocate(15, 15, x, y));
+  EXPECT_EQ(4U, font.Pages());
+  EXPECT_FALSE(font.Allocate(15, 15, x, y));
+}
+
+TEST(TestGUIFontTTF, GlyphCache)
+{
+  CStdString key = "TestGUIFontTTF|GlyphCache";
+  {
+    CTestFont font(key);
+    XFILE::CFile::Delete(font.CacheFile());
+    EXPECT_FALSE(font.Load());
+    for (character_t letter = 'A'; letter <= 'Z'; letter++)
+      ASSERT_TRUE(font.AddGlyph(letter, 8 + letter % 5, 10 + letter % 3));
+    EXPECT_TRUE(font.Dirty());
+    font.Save();
+    EXPECT_FALSE(font.Dirty());
+  }
+
+  CStdString cacheFile;
+  {
+    CTestFont font(key);
+    cacheFile = font.CacheFile();
+    ASSERT_TRUE(font.Load());
+    EXPECT_EQ(26U, font.Glyphs());
+    EXPECT_EQ(1U, font.Pages());
+    for (character_t letter = 'A'; letter <= 'Z'; letter++)
+    {
+      const CTestFont::Character *ch = NULL;
+      ASSERT_TRUE((ch = font.Find(letter)) != NULL);
+      EXPECT_EQ(8 + letter % 5, ch->right - ch->left);
+      EXPECT_EQ(10 + letter % 3, ch->bottom - ch->top);
+      EXPECT_EQ((unsigned char)letter, font.Pixel(ch->page, (unsigned int)ch->left, (unsigned int)ch->top));
+      EXPECT_EQ((unsigned char)letter, font.Pixel(ch->page, (unsigned int)ch->right - 1, (unsigned int)ch->bottom - 1));
+    }
+
+    // glyphs added after loading go next to the cached ones
+    ASSERT_TRUE(font.AddGlyph('a', 8, 10));
+    const CTestFont::Character *a = font.Find('a');
+    for (character_t letter = 'A'; letter <= 'Z'; letter++)
+    {
+      const CTestFont::Character *ch = font.Find(letter);
+      EXPECT_FALSE(a->left < ch->right && ch->left < a->right && a->top < ch->bottom && ch->top < a->bottom);
+    }
+  }
+  // the new glyph is saved again as the font is destroyed
+  XFILE::CFile::Delete(cacheFile);
+
+  // a cache made for another font isn't used
+  CTestFont other("TestGUIFontTTF|Other");
+  EXPECT_FALSE(other.Load());
+}
@@ -0,0 +1,92 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "guilib/GUISkinCache.h"
+#include "utils/XBMCTinyXML.h"
+
+#include "gtest/gtest.h"
+
+static const char *window =
+  "<window id=\"1100\">"
+    "<defaultcontrol always=\"true\">50</defaultcontrol>"
+    "<!-- dropped from the cache -->"
+    "<controls>"
+      "<control type=\"label\" id=\"2\">"
+        "<posx>10</posx>"
+        "<label><![CDATA[<b>bold</b>]]></label>"
+        "<visible>!Skin.HasSetting(foo) + Control.IsVisible(50)</visible>"
+      "</control>"
+      "<control type=\"group\"/>"
+    "</controls>"
+  "</window>";
+
+static std::string Print(const TiXmlNode *node)
+{
+  TiXmlPrinter printer;
+  node->Accept(&printer);
+  return printer.CStr();
+}
+
+TEST(TestGUISkinCache, RoundTrip)
+{
+  CXBMCTinyXML doc;
+  doc.Parse(window);
+  ASSERT_TRUE(doc.RootElement() != NULL);
+
+  std::string data;
+  CGUISkinCache::Serialize(doc.RootElement(), data);
+
+  const char *start = data.c_str();
+  const char *end = start + data.size();
+  TiXmlNode *root = CGUISkinCache::Deserialize(start, end);
+  ASSERT_TRUE(root != NULL);
+  EXPECT_EQ(end, start);
+  ASSERT_TRUE(root->ToElement() != NULL);
+
+  // the comment is the only thing lost
+  TiXmlComment *comment = doc.RootElement()->FirstChild("defaultcontrol")->NextSibling()->ToComment();
+  ASSERT_TRUE(comment != NULL);
+  doc.RootElement()->RemoveChild(comment);
+  EXPECT_EQ(Print(doc.RootElement()), Print(root));
+
+  const TiXmlElement *label = root->FirstChildElement("controls")->FirstChildElement("control")->FirstChildElement("label");
+  ASSERT_TRUE(label != NULL && label->FirstChild() != NULL && label->FirstChild()->ToText() != NULL);
+  EXPECT_TRUE(label->FirstChild()->ToText()->CDATA());
+  EXPECT_STREQ("<b>bold</b>", label->FirstChild()->Value());
+  delete root;
+}
+
+TEST(TestGUISkinCache, Truncated)
+{
+  CXBMCTinyXML doc;
+  doc.Parse(window);
+  ASSERT_TRUE(doc.RootElement() != NULL);
+
+  std::string data;
+  CGUISkinCache::Serialize(doc.RootElement(), data);
+
+  for (size_t length = 0; length < data.size(); length++)
+  {
+    const char *start = data.c_str();
+    TiXmlNode *root = CGUISkinCache::Deserialize(start, data.c_str() + length);
+    EXPECT_TRUE(root == NULL) << "accepted " << length << " of " << data.size() << " bytes";
+    delete root;
+  }
+}
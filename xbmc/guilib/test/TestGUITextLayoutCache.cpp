@@ -0,0 +1,119 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "guilib/GUITextLayoutCache.h"
+
+#include "gtest/gtest.h"
+
+// the cache only compares fonts, they are never dereferenced
+static const CGUIFont *font1 = (const CGUIFont *)0x1000;
+static const CGUIFont *font2 = (const CGUIFont *)0x2000;
+
+static std::vector<CGUIString> MakeLines(const CStdStringW &text)
+{
+  vecText utf32(text.begin(), text.end());
+  std::vector<CGUIString> lines;
+  lines.push_back(CGUIString(utf32.begin(), utf32.end(), true));
+  return lines;
+}
+
+class TestGUITextLayoutCache : public testing::Test
+{
+protected:
+  TestGUITextLayoutCache() { CGUITextLayoutCache::Get().Clear(); }
+  ~TestGUITextLayoutCache() { CGUITextLayoutCache::Get().Clear(); }
+};
+
+TEST_F(TestGUITextLayoutCache, LookupAfterAdd)
+{
+  CGUITextLayoutCache &cache = CGUITextLayoutCache::Get();
+  CGUITextLayoutCache::Key key(L"some text", font1, 0, 100, 0, false, 1, 1);
+  std::vector<CGUIString> lines;
+  vecColors colors;
+  float width = 0, height = 0;
+
+  unsigned int misses = cache.GetStats().misses;
+  EXPECT_FALSE(cache.Lookup(key, lines, colors, width, height));
+  EXPECT_EQ(misses + 1, cache.GetStats().misses);
+
+  colors.push_back(0xffffffff);
+  cache.Add(key, MakeLines(L"some text"), colors, 80, 20);
+  colors.clear();
+
+  unsigned int hits = cache.GetStats().hits;
+  ASSERT_TRUE(cache.Lookup(key, lines, colors, width, height));
+  EXPECT_EQ(hits + 1, cache.GetStats().hits);
+  ASSERT_EQ(1U, lines.size());
+  EXPECT_EQ(9U, lines[0].m_text.size());
+  ASSERT_EQ(1U, colors.size());
+  EXPECT_EQ(80, width);
+  EXPECT_EQ(20, height);
+}
+
+TEST_F(TestGUITextLayoutCache, KeyParameters)
+{
+  CGUITextLayoutCache &cache = CGUITextLayoutCache::Get();
+  vecColors colors;
+  cache.Add(CGUITextLayoutCache::Key(L"text", font1, 0, 100, 0, false, 1, 1), MakeLines(L"text"), colors, 40, 20);
+
+  std::vector<CGUIString> lines;
+  float width, height;
+  EXPECT_TRUE(cache.Lookup(CGUITextLayoutCache::Key(L"text", font1, 0, 100, 0, false, 1, 1), lines, colors, width, height));
+  EXPECT_FALSE(cache.Lookup(CGUITextLayoutCache::Key(L"Text", font1, 0, 100, 0, false, 1, 1), lines, colors, width, height));
+  EXPECT_FALSE(cache.Lookup(CGUITextLayoutCache::Key(L"text", font2, 0, 100, 0, false, 1, 1), lines, colors, width, height));
+  EXPECT_FALSE(cache.Lookup(CGUITextLayoutCache::Key(L"text", font1, 0xff000000, 100, 0, false, 1, 1), lines, colors, width, height));
+  EXPECT_FALSE(cache.Lookup(CGUITextLayoutCache::Key(L"text", font1, 0, 200, 0, false, 1, 1), lines, colors, width, height));
+  EXPECT_FALSE(cache.Lookup(CGUITextLayoutCache::Key(L"text", font1, 0, 100, 50, false, 1, 1), lines, colors, width, height));
+  EXPECT_FALSE(cache.Lookup(CGUITextLayoutCache::Key(L"text", font1, 0, 100, 0, true, 1, 1), lines, colors, width, height));
+  // the same text in a window with another coordinate resolution
+  EXPECT_FALSE(cache.Lookup(CGUITextLayoutCache::Key(L"text", font1, 0, 100, 0, false, 1.5f, 1), lines, colors, width, height));
+  EXPECT_FALSE(cache.Lookup(CGUITextLayoutCache::Key(L"text", font1, 0, 100, 0, false, 1, 1.5f), lines, colors, width, height));
+}
+
+TEST_F(TestGUITextLayoutCache, EvictsLeastRecentlyUsed)
+{
+  CGUITextLayoutCache &cache = CGUITextLayoutCache::Get();
+  vecColors colors;
+  std::vector<CGUIString> lines;
+  float width, height;
+
+  // entries of 2 * 16K characters, so the 512K character cache takes 16 of them
+  CStdStringW text(16 * 1024 - 1, L'a');
+  for (int i = 0; i < 16; i++)
+    cache.Add(CGUITextLayoutCache::Key(text, font1, 0, (float)i, 0, false, 1, 1), MakeLines(text), colors, 0, 0);
+  EXPECT_EQ(16U, cache.GetStats().entries);
+
+  // use the oldest, so the second oldest is dropped when adding another
+  EXPECT_TRUE(cache.Lookup(CGUITextLayoutCache::Key(text, font1, 0, 0, 0, false, 1, 1), lines, colors, width, height));
+  cache.Add(CGUITextLayoutCache::Key(text, font1, 0, 16, 0, false, 1, 1), MakeLines(text), colors, 0, 0);
+  EXPECT_EQ(16U, cache.GetStats().entries);
+  EXPECT_TRUE(cache.Lookup(CGUITextLayoutCache::Key(text, font1, 0, 0, 0, false, 1, 1), lines, colors, width, height));
+  EXPECT_FALSE(cache.Lookup(CGUITextLayoutCache::Key(text, font1, 0, 1, 0, false, 1, 1), lines, colors, width, height));
+  EXPECT_TRUE(cache.Lookup(CGUITextLayoutCache::Key(text, font1, 0, 16, 0, false, 1, 1), lines, colors, width, height));
+}
+
+TEST_F(TestGUITextLayoutCache, SkipsLargeLayouts)
+{
+  CGUITextLayoutCache &cache = CGUITextLayoutCache::Get();
+  vecColors colors;
+  CStdStringW text(64 * 1024, L'a');
+  cache.Add(CGUITextLayoutCache::Key(text, font1, 0, 0, 0, false, 1, 1), MakeLines(text), colors, 0, 0);
+  EXPECT_EQ(0U, cache.GetStats().entries);
+}
@@ -30,6 +30,7 @@ InfoSingle::InfoSingle(const CStdString &expression, int context)
 : InfoBool(expression, context)
 {
   m_condition = g_infoManager.TranslateSingleString(expression);
+  m_dependencies = g_infoManager.GetDependencies(m_condition);
 }
 
 void InfoSingle::Update(const CGUIListItem *item)
@@ -142,6 +143,10 @@ void InfoExpression::Parse(const CStdString &expression)
     operators.pop();
   }
 
+  m_dependencies = INFO_DEPENDS_NONE;
+  for (vector<unsigned int>::const_iterator it = m_operands.begin(); it != m_operands.end(); ++it)
+    m_dependencies |= g_infoManager.GetBoolDependencies(*it);
+
   // test evaluate
   bool test;
   if (!Evaluate(NULL, test))
@@ -28,6 +28,18 @@ class CGUIListItem;
 
 namespace INFO
 {
+/*! \brief Inputs a boolean condition reads, used to decide when its cached value is stale
+ */
+enum
+{
+  INFO_DEPENDS_NONE     = 0x00, ///< constant, evaluated once
+  INFO_DEPENDS_FRAME    = 0x01, ///< polled state, re-evaluated each frame
+  INFO_DEPENDS_SETTINGS = 0x02, ///< skin settings
+  INFO_DEPENDS_LIBRARY  = 0x04, ///< library content flags
+  INFO_DEPENDS_LISTITEM = 0x08, ///< the list item the condition is evaluated against
+  INFO_DEPENDS_ALL      = 0x0f
+};
+
 /*!
  \ingroup info
  \brief Base class, wrapping boolean conditions and expressions
@@ -38,6 +50,7 @@ public:
   InfoBool(const CStdString &expression, int context)
     : m_value(false),
       m_context(context),
+      m_dependencies(INFO_DEPENDS_FRAME),
       m_expression(expression),
       m_lastUpdate(0)
   {
@@ -47,14 +60,14 @@ public:
 
   /*! \brief Get the value of this info bool
    This is called to update (if necessary) and fetch the value of the info bool
-   \param time current time (used to test if we need to update yet)
+   \param time last change of any of our inputs (used to test if we need to update yet)
    \param item the item used to evaluate the bool
    */
   inline bool Get(unsigned int time, const CGUIListItem *item = NULL)
   {
-    if (item)
+    if (item && (m_dependencies & INFO_DEPENDS_LISTITEM))
       Update(item);
-    else if (time - m_lastUpdate > 0)
+    else if (time != m_lastUpdate)
     {
       Update(NULL);
       m_lastUpdate = time;
@@ -62,6 +75,22 @@ public:
     return m_value;
   }
 
+  /*! \brief Whether a call to Get() with the same parameters will evaluate the bool
+   */
+  inline bool IsDirty(unsigned int time, const CGUIListItem *item = NULL) const
+  {
+    return (item && (m_dependencies & INFO_DEPENDS_LISTITEM)) || time != m_lastUpdate;
+  }
+
+  /*! \brief Get the inputs this info bool reads
+   \return INFO_DEPENDS_* flags
+   */
+  unsigned int GetDependencies() const { return m_dependencies; };
+
+  /*! \brief Get the expression this info bool was registered with
+   */
+  const CStdString &GetExpression() const { return m_expression; };
+
   bool operator==(const InfoBool &right) const
   {
     return (m_context == right.m_context && 
@@ -77,6 +106,7 @@ protected:
 
   bool m_value;                ///< current value
   int m_context;               ///< contextual information to go with the condition
+  unsigned int m_dependencies; ///< inputs this condition reads (INFO_DEPENDS_*)
 
 private:
   CStdString m_expression;     ///< original expression
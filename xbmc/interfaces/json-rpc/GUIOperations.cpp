@@ -23,6 +23,7 @@
 #include "ApplicationMessenger.h"
 #include "GUIInfoManager.h"
 #include "guilib/GUIWindowManager.h"
+#include "guilib/GUIFrameProfiler.h"
 #include "guilib/Key.h"
 #include "interfaces/Builtins.h"
 #include "dialogs/GUIDialogKaiToast.h"
@@ -100,6 +101,15 @@ JSONRPC_STATUS CGUIOperations::SetFullscreen(const CStdString &method, ITranspor
   return GetPropertyValue("fullscreen", result);
 }
 
+JSONRPC_STATUS CGUIOperations::GetFrameProfile(const CStdString &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
+{
+  if (CGUIFrameProfiler::Get().GetLevel() == CGUIFrameProfiler::LEVEL_OFF)
+    return FailedToExecute;
+
+  CGUIFrameProfiler::Get().GetTrace(result, parameterObject["clear"].asBoolean());
+  return OK;
+}
+
 JSONRPC_STATUS CGUIOperations::GetPropertyValue(const CStdString &property, CVariant &result)
 {
   if (property.Equals("currentwindow"))
@@ -154,6 +154,7 @@ JsonRpcMethodMap CJSONServiceDescription::m_methodMaps[] = {
   { "GUI.ActivateWindow",                           CGUIOperations::ActivateWindow },
   { "GUI.ShowNotification",                         CGUIOperations::ShowNotification },
   { "GUI.SetFullscreen",                            CGUIOperations::SetFullscreen },
+  { "GUI.GetFrameProfile",                          CGUIOperations::GetFrameProfile },
 
 // PVR operations
   { "PVR.GetProperties",                            CPVROperations::GetProperties },
@@ -22,7 +22,7 @@
 namespace JSONRPC
 {
   const char* const JSONRPC_SERVICE_ID          = "http://xbmc.org/jsonrpc/ServiceDescription.json";
-  const char* const JSONRPC_SERVICE_VERSION     = "6.6.2";
+  const char* const JSONRPC_SERVICE_VERSION     = "6.7.0";
   const char* const JSONRPC_SERVICE_DESCRIPTION = "JSON-RPC API of XBMC";
 
   const char* const JSONRPC_SERVICE_TYPES[] = {  
@@ -2782,6 +2782,23 @@ namespace JSONRPC
       "],"
       "\"returns\": { \"type\": \"boolean\", \"description\": \"Fullscreen state\" }"
     "}",
+    "\"GUI.GetFrameProfile\": {"
+      "\"type\": \"method\","
+      "\"description\": \"Retrieves the recently rendered GUI frames in the Chrome trace event format\","
+      "\"transport\": \"Response\","
+      "\"permission\": \"ReadData\","
+      "\"params\": ["
+        "{ \"name\": \"clear\", \"type\": \"boolean\", \"default\": false, \"description\": \"Drop the returned frames from the profiler\" }"
+      "],"
+      "\"returns\": {"
+        "\"type\": \"object\","
+        "\"description\": \"Trace to be loaded into chrome://tracing\","
+        "\"properties\": {"
+          "\"displayTimeUnit\": { \"type\": \"string\", \"required\": true },"
+          "\"traceEvents\": { \"type\": \"array\", \"required\": true, \"items\": { \"type\": \"object\" } }"
+        "}"
+      "}"
+    "}",
     "\"Addons.GetAddons\": {"
       "\"type\": \"method\","
       "\"description\": \"Gets all available addons\","
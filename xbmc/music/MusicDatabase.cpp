@@ -688,41 +688,42 @@ int CMusicDatabase::AddArtist(const CStdString& strArtist, const CStdString& str
 
 bool CMusicDatabase::AddSongArtist(int idArtist, int idSong, std::string joinPhrase, bool featured, int iOrder)
 {
-  CStdString strSQL;
-  strSQL=PrepareSQL("replace into song_artist (idArtist, idSong, strJoinPhrase, boolFeatured, iOrder) values(%i,%i,'%s',%i,%i)",
-                    idArtist, idSong, joinPhrase.c_str(), featured == true ? 1 : 0, iOrder);
-  return ExecuteQuery(strSQL);
+  return AddArtistLink("replace into song_artist (idArtist, idSong, strJoinPhrase, boolFeatured, iOrder) values(?,?,?,?,?)",
+                       idArtist, idSong, joinPhrase, featured, iOrder);
 };
 
 bool CMusicDatabase::AddAlbumArtist(int idArtist, int idAlbum, std::string joinPhrase, bool featured, int iOrder)
 {
-  CStdString strSQL;
-  strSQL=PrepareSQL("replace into album_artist (idArtist, idAlbum, strJoinPhrase, boolFeatured, iOrder) values(%i,%i,'%s',%i,%i)",
-                    idArtist, idAlbum, joinPhrase.c_str(), featured == true ? 1 : 0, iOrder);
-  return ExecuteQuery(strSQL);
+  return AddArtistLink("replace into album_artist (idArtist, idAlbum, strJoinPhrase, boolFeatured, iOrder) values(?,?,?,?,?)",
+                       idArtist, idAlbum, joinPhrase, featured, iOrder);
 };
 
+bool CMusicDatabase::AddArtistLink(const char *sql, int idArtist, int idItem, const std::string &joinPhrase, bool featured, int iOrder)
+{
+  return ExecutePreparedQuery(sql, Params().Add(idArtist).Add(idItem).Add(joinPhrase).Add(featured ? 1 : 0).Add(iOrder));
+}
+
 bool CMusicDatabase::AddSongGenre(int idGenre, int idSong, int iOrder)
 {
   if (idGenre == -1 || idSong == -1)
     return true;
 
-  CStdString strSQL;
-  strSQL=PrepareSQL("replace into song_genre (idGenre, idSong, iOrder) values(%i,%i,%i)",
-                    idGenre, idSong, iOrder);
-  return ExecuteQuery(strSQL);};
+  return AddGenreLink("replace into song_genre (idGenre, idSong, iOrder) values(?,?,?)", idGenre, idSong, iOrder);
+};
 
 bool CMusicDatabase::AddAlbumGenre(int idGenre, int idAlbum, int iOrder)
 {
   if (idGenre == -1 || idAlbum == -1)
     return true;
-  
-  CStdString strSQL;
-  strSQL=PrepareSQL("replace into album_genre (idGenre, idAlbum, iOrder) values(%i,%i,%i)",
-                    idGenre, idAlbum, iOrder);
-  return ExecuteQuery(strSQL);
+
+  return AddGenreLink("replace into album_genre (idGenre, idAlbum, iOrder) values(?,?,?)", idGenre, idAlbum, iOrder);
 };
 
+bool CMusicDatabase::AddGenreLink(const char *sql, int idGenre, int idItem, int iOrder)
+{
+  return ExecutePreparedQuery(sql, Params().Add(idGenre).Add(idItem).Add(iOrder));
+}
+
 bool CMusicDatabase::GetAlbumsByArtist(int idArtist, bool includeFeatured, std::vector<int> &albums)
 {
   try 
@@ -3310,36 +3311,46 @@ bool CMusicDatabase::GetSongsByWhere(const CStdString &baseDir, const Filter &fi
     strSQL = PrepareSQL(strSQL, !filter.fields.empty() && filter.fields.compare("*") != 0 ? filter.fields.c_str() : "songview.*") + strSQLExtra;
 
     CLog::Log(LOGDEBUG, "%s query = %s", __FUNCTION__, strSQL.c_str());
-    // run query
-    if (!m_pDS->query(strSQL.c_str()))
-      return false;
 
-    int iRowsFound = m_pDS->num_rows();
-    if (iRowsFound == 0)
+    // without any sorting to do, rows are read straight off a forward-only cursor
+    // rather than having the entire result set copied up front
+    bool streamed = sortDescription.sortBy == SortByNone;
+    int iRowsFound = 0;
+    DatabaseResults results;
+    if (streamed)
     {
-      m_pDS->close();
-      return true;
+      if (!m_pDS->query_cursor(strSQL))
+        return false;
     }
+    else
+    {
+      // run query
+      if (!m_pDS->query(strSQL.c_str()))
+        return false;
 
-    // store the total value of items as a property
-    if (total < iRowsFound)
-      total = iRowsFound;
-    items.SetProperty("total", total);
-    
-    DatabaseResults results;
-    results.reserve(iRowsFound);
-    if (!SortUtils::SortFromDataset(sortDescription, MediaTypeSong, m_pDS, results))
-      return false;
+      iRowsFound = m_pDS->num_rows();
+      if (iRowsFound == 0)
+      {
+        m_pDS->close();
+        return true;
+      }
+
+      results.reserve(iRowsFound);
+      if (!SortUtils::SortFromDataset(sortDescription, MediaTypeSong, m_pDS, results))
+        return false;
+      items.Reserve(results.size());
+    }
 
     // get data from returned rows
-    items.Reserve(results.size());
     const dbiplus::query_data &data = m_pDS->get_result_set().records;
+    DatabaseResults::const_iterator it = results.begin();
     int count = 0;
-    for (DatabaseResults::const_iterator it = results.begin(); it != results.end(); it++)
+    int iRowsRead = 0;
+    while (streamed ? m_pDS->next_row() : it != results.end())
     {
-      unsigned int targetRow = (unsigned int)it->at(FieldRow).asInteger();
-      const dbiplus::sql_record* const record = data.at(targetRow);
-      
+      const dbiplus::sql_record* const record = streamed ? m_pDS->get_sql_record() : data.at((unsigned int)(it++)->at(FieldRow).asInteger());
+      iRowsRead++;
+
       try
       {
         CFileItemPtr item(new CFileItem);
@@ -3356,6 +3367,12 @@ bool CMusicDatabase::GetSongsByWhere(const CStdString &baseDir, const Filter &fi
       }
     }
 
+    // store the total value of items as a property
+    if (!streamed)
+      iRowsRead = iRowsFound;
+    if (iRowsRead > 0)
+      items.SetProperty("total", std::max(total, iRowsRead));
+
     // cleanup
     m_pDS->close();
     CLog::Log(LOGDEBUG, "%s(%s) - took %d ms", __FUNCTION__, filter.where.c_str(), XbmcThreads::SystemClockMillis() - time);
@@ -4427,12 +4444,14 @@ int CMusicDatabase::GetSongIDFromPath(const CStdString &filePath)
 
 bool CMusicDatabase::CommitTransaction()
 {
-  if (CDatabase::CommitTransaction())
-  { // number of items in the db has likely changed, so reset the infomanager cache
+  if (!CDatabase::CommitTransaction())
+    return false;
+
+  // number of items in the db has likely changed, so reset the infomanager cache
+  // (batched writes do this once the batch is ended)
+  if (!InBatch())
     g_infoManager.SetLibraryBool(LIBRARY_HAS_MUSIC, GetSongsCount() > 0);
-    return true;
-  }
-  return false;
+  return true;
 }
 
 bool CMusicDatabase::SetScraperForPath(const CStdString& strPath, const ADDON::ScraperPtr& scraper)
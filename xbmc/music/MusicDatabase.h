@@ -436,6 +436,12 @@ private:
   CArtistCredit GetAlbumArtistCreditFromDataset(const dbiplus::sql_record* const record);
   void GetFileItemFromDataset(CFileItem* item, const CStdString& strMusicDBbasePath);
   void GetFileItemFromDataset(const dbiplus::sql_record* const record, CFileItem* item, const CStdString& strMusicDBbasePath);
+
+  /*! \brief Insert a song/album <-> artist or genre link through a cached prepared statement
+   \param sql the parameterised replace statement
+   */
+  bool AddArtistLink(const char *sql, int idArtist, int idItem, const std::string &joinPhrase, bool featured, int iOrder);
+  bool AddGenreLink(const char *sql, int idGenre, int idItem, int iOrder);
   bool CleanupSongs();
   bool CleanupSongsByIds(const CStdString &strSongIds);
   bool CleanupPaths();
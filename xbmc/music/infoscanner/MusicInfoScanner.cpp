@@ -45,6 +45,7 @@
 #include "utils/StringUtils.h"
 #include "utils/TimeUtils.h"
 #include "utils/log.h"
+#include "utils/JobManager.h"
 #include "utils/URIUtils.h"
 #include "TextureCache.h"
 #include "music/MusicThumbLoader.h"
@@ -117,6 +118,9 @@ void CMusicInfoScanner::Process()
       m_bCanInterrupt = false;
       m_needsCleanup = false;
 
+      // group the writes of several directories into one transaction
+      m_musicDatabase.BeginBatch();
+
       bool commit = false;
       bool cancelled = false;
       for (std::set<std::string>::const_iterator it = m_pathsToScan.begin(); it != m_pathsToScan.end(); it++)
@@ -137,6 +141,8 @@ void CMusicInfoScanner::Process()
         commit = !cancelled;
       }
 
+      m_musicDatabase.EndBatch();
+
       if (commit)
       {
         g_infoManager.ResetLibraryBools();
@@ -414,7 +420,8 @@ bool CMusicInfoScanner::DoScan(const CStdString& strDirectory)
     items.Sort(SortByLabel, SortOrderAscending);
 
     // and then scan in the new information
-    if (RetrieveMusicInfo(strDirectory, items) > 0)
+    int numAdded = RetrieveMusicInfo(strDirectory, items);
+    if (numAdded > 0)
     {
       if (m_handle)
         OnDirectoryScanned(strDirectory);
@@ -422,6 +429,9 @@ bool CMusicInfoScanner::DoScan(const CStdString& strDirectory)
 
     // save information about this folder
     m_musicDatabase.SetPathHash(strDirectory, hash);
+
+    // the folder is complete, so this is a safe point to commit batched writes
+    m_musicDatabase.BatchItemsAdded(std::max(numAdded, 1));
   }
   else
   { // path is the same - no need to rescan
@@ -458,15 +468,48 @@ bool CMusicInfoScanner::DoScan(const CStdString& strDirectory)
   return !m_bStop;
 }
 
+/*! \brief Job reading the tag of a single file for the music scanner
+ */
+class CMusicTagJob : public CJob
+{
+public:
+  CMusicTagJob(const CFileItemPtr &item, volatile bool &stop) : m_item(item), m_stop(stop) {}
+
+  virtual const char *GetType() const { return "musictag"; }
+
+  virtual bool DoWork()
+  {
+    if (m_stop)
+      return false;
+
+    CMusicInfoTag& tag = *m_item->GetMusicInfoTag();
+    auto_ptr<IMusicInfoTagLoader> pLoader (CMusicInfoTagLoaderFactory::CreateLoader(m_item->GetPath()));
+    if (NULL != pLoader.get())
+      pLoader->Load(m_item->GetPath(), tag);
+    return tag.Loaded();
+  }
+
+private:
+  CFileItemPtr m_item;
+  volatile bool &m_stop;
+};
+
+void CMusicInfoScanner::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+{
+  CSingleLock lock(m_tagSection);
+  m_tagJobs.erase(jobID);
+  m_tagJobDone.Set();
+}
+
 INFO_RET CMusicInfoScanner::ScanTags(const CFileItemList& items, CFileItemList& scannedItems)
 {
   CStdStringArray regexps = g_advancedSettings.m_audioExcludeFromScanRegExps;
 
+  // gather the files we want tags for, queueing a reader for those we don't have yet
+  vector<CFileItemPtr> files;
+  vector<CFileItemPtr> toRead;
   for (int i = 0; i < items.Size(); ++i)
   {
-    if (m_bStop)
-      return INFO_CANCELLED;
-
     CFileItemPtr pItem = items[i];
 
     if (CUtil::ExcludeFileOrFolder(pItem->GetPath(), regexps))
@@ -475,25 +518,70 @@ INFO_RET CMusicInfoScanner::ScanTags(const CFileItemList& items, CFileItemList&
     if (pItem->m_bIsFolder || pItem->IsPlayList() || pItem->IsPicture() || pItem->IsLyrics())
       continue;
 
-    m_currentItem++;
+    files.push_back(pItem);
+    if (!pItem->GetMusicInfoTag()->Loaded())
+      toRead.push_back(pItem);
+  }
 
-    CMusicInfoTag& tag = *pItem->GetMusicInfoTag();
-    if (!tag.Loaded())
+  // read with up to tagreaders jobs in flight so that we aren't bound by the latency of a single read
+  unsigned int readers = std::max(g_advancedSettings.m_iMusicLibraryTagReaders, 1);
+  unsigned int next = 0;
+  int firstItem = m_currentItem;
+  m_tagJobDone.Reset();
+  while (true)
+  {
     {
-      auto_ptr<IMusicInfoTagLoader> pLoader (CMusicInfoTagLoaderFactory::CreateLoader(pItem->GetPath()));
-      if (NULL != pLoader.get())
-        pLoader->Load(pItem->GetPath(), tag);
+      CSingleLock lock(m_tagSection);
+      while (!m_bStop && next < toRead.size() && m_tagJobs.size() < readers)
+      {
+        CMusicTagJob *job = new CMusicTagJob(toRead[next++], m_bStop);
+        unsigned int jobID = CJobManager::GetInstance().AddJob(job, this, CJob::PRIORITY_NORMAL);
+        if (jobID == 0)
+        {
+          // the job manager is shutting down
+          delete job;
+          m_bStop = true;
+          break;
+        }
+        m_tagJobs.insert(jobID);
+      }
+
+      // the jobs still in flight are cancelled rather than waited for, the job manager
+      // may have dropped them without completing them when it was shut down
+      if (m_bStop)
+      {
+        for (std::set<unsigned int>::iterator it = m_tagJobs.begin(); it != m_tagJobs.end(); ++it)
+          CJobManager::GetInstance().CancelJob(*it);
+        m_tagJobs.clear();
+        break;
+      }
+      if (m_tagJobs.empty() && next == toRead.size())
+        break;
+
+      m_currentItem = firstItem + (files.size() - toRead.size()) + next - m_tagJobs.size();
     }
 
     if (m_handle && m_itemCount>0)
       m_handle->SetPercentage(m_currentItem/(float)m_itemCount*100);
 
-    if (!tag.Loaded())
+    m_tagJobDone.WaitMSec(100);
+  }
+
+  if (m_bStop)
+    return INFO_CANCELLED;
+
+  m_currentItem = firstItem + files.size();
+  if (m_handle && m_itemCount>0)
+    m_handle->SetPercentage(m_currentItem/(float)m_itemCount*100);
+
+  for (vector<CFileItemPtr>::const_iterator i = files.begin(); i != files.end(); ++i)
+  {
+    if (!(*i)->GetMusicInfoTag()->Loaded())
     {
-      CLog::Log(LOGDEBUG, "%s - No tag found for: %s", __FUNCTION__, pItem->GetPath().c_str());
+      CLog::Log(LOGDEBUG, "%s - No tag found for: %s", __FUNCTION__, (*i)->GetPath().c_str());
       continue;
     }
-    scannedItems.Add(pItem);
+    scannedItems.Add(*i);
   }
   return INFO_ADDED;
 }
@@ -705,6 +793,9 @@ int CMusicInfoScanner::RetrieveMusicInfo(const CStdString& strDirectory, CFileIt
       break;
 
     album->strPath = strDirectory;
+    // don't keep others from writing to the database while the album is looked up online
+    if ((m_flags & SCAN_ONLINE) && albumScraper && m_albumCache.find(*album) == m_albumCache.end())
+      m_musicDatabase.CommitPendingBatch();
     m_musicDatabase.BeginTransaction();
 
     // Check if the album has already been downloaded or failed
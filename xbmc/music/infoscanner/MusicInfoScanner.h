@@ -19,6 +19,9 @@
  *
  */
 #include "threads/Thread.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "utils/Job.h"
 #include "music/MusicDatabase.h"
 #include "MusicAlbumInfo.h"
 #include "MusicInfoScraper.h"
@@ -41,7 +44,7 @@ enum INFO_RET
   INFO_ADDED 
 };
 
-class CMusicInfoScanner : CThread, public IRunnable
+class CMusicInfoScanner : CThread, public IRunnable, public IJobCallback
 {
 public:
   /*! \brief Flags for controlling the scanning process
@@ -162,6 +165,8 @@ public:
    \param artist [in] an artist
    */
   std::map<std::string, std::string> GetArtistArtwork(const CArtist& artist);
+
+  virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
 protected:
   virtual void Process();
 
@@ -178,6 +183,8 @@ protected:
     Given a list of FileItems, scan in the tags for those FileItems
    and populate a new FileItemList with the files that were successfully scanned.
    Any files which couldn't be scanned (no/bad tags) are discarded in the process.
+   Tags are read by up to advancedsettings' musiclibrary/tagreaders jobs at a time,
+   scannedItems retains the order of items.
    \param items [in] list of FileItems to scan
    \param scannedItems [in] list to populate with the scannedItems
    */
@@ -218,5 +225,9 @@ protected:
   std::set<std::string> m_pathsToScan;
   int m_flags;
   CThread m_fileCountReader;
+
+  CCriticalSection m_tagSection;
+  std::set<unsigned int> m_tagJobs; ///< ids of the tag reading jobs in flight
+  CEvent m_tagJobDone;
 };
 }
@@ -19,11 +19,15 @@
  */
 
 #include "TCPServer.h"
+#include <algorithm>
 #include <stdio.h>
 #include <stdlib.h>
 #include <memory.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#ifndef TARGET_WINDOWS
+#include <fcntl.h>
+#endif
 
 #include "settings/AdvancedSettings.h"
 #include "interfaces/json-rpc/JSONRPC.h"
@@ -56,6 +60,26 @@ using namespace ANNOUNCEMENT;
 //using namespace std; On VS2010, bind conflicts with std::bind
 
 #define RECEIVEBUFFER 1024
+#define MAX_EVENTS    64
+#define MAX_OUTPUT    (16 * 1024 * 1024) // of a client that doesn't read what it's sent
+
+#if defined(TARGET_LINUX) || defined(TARGET_ANDROID)
+#define HAS_EPOLL
+#include <sys/epoll.h>
+#endif
+
+#ifdef TARGET_WINDOWS
+#define SOCKET_WOULDBLOCK() (WSAGetLastError() == WSAEWOULDBLOCK)
+#define SOCKET_INTERRUPTED() (WSAGetLastError() == WSAEINTR)
+#else
+#define SOCKET_WOULDBLOCK() (errno == EAGAIN || errno == EWOULDBLOCK)
+#define SOCKET_INTERRUPTED() (errno == EINTR)
+#endif
+
+// writing to a client that has gone away mustn't raise SIGPIPE
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
 
 CTCPServer *CTCPServer::ServerInstance = NULL;
 
@@ -99,19 +123,91 @@ CTCPServer::CTCPServer(int port, bool nonlocal) : CThread("TCPServer")
   m_port = port;
   m_nonlocal = nonlocal;
   m_sdpd = NULL;
+  m_epoll = -1;
 }
 
 void CTCPServer::Process()
 {
-  m_bStop = false;
-
+  // m_bStop isn't reset here, Create() has done that already and the server may have been stopped since
   while (!m_bStop)
   {
-    SOCKET          max_fd = 0;
-    fd_set          rfds;
-    struct timeval  to     = {1, 0};
-    FD_ZERO(&rfds);
+    std::vector<SOCKET> readable, writable;
+    if (!Wait(readable, writable, 1000))
+    {
+      CLog::Log(LOGERROR, "JSONRPC Server: Waiting for sockets failed");
+      Sleep(1000);
+      Initialize();
+      continue;
+    }
+
+    bool failed = false;
+    CSingleLock lock(m_critSection);
+    for (unsigned int i = 0; i < readable.size(); i++)
+    {
+      Connections::iterator it = m_connections.find(readable[i]);
+      if (it == m_connections.end())
+        continue;
+
+      CTCPClient *client = it->second;
+      if (!Receive(client))
+      {
+        CLog::Log(LOGINFO, "JSONRPC Server: Disconnection detected");
+        Close(it);
+      }
+    }
+
+    for (unsigned int i = 0; i < writable.size(); i++)
+    {
+      Connections::iterator it = m_connections.find(writable[i]);
+      if (it != m_connections.end() && !it->second->Flush())
+        Close(it);
+    }
 
+    // accept new connections last, their sockets may be those of connections closed above
+    for (unsigned int i = 0; i < readable.size(); i++)
+    {
+      if (std::find(m_servers.begin(), m_servers.end(), readable[i]) != m_servers.end())
+        failed |= !Accept(readable[i]);
+    }
+
+    DeleteClosed();
+    lock.Leave();
+
+    if (failed)
+    {
+      Sleep(1000);
+      Initialize();
+    }
+  }
+
+  Deinitialize();
+}
+
+bool CTCPServer::Wait(std::vector<SOCKET> &readable, std::vector<SOCKET> &writable, unsigned int timeout)
+{
+#ifdef HAS_EPOLL
+  struct epoll_event events[MAX_EVENTS];
+  int res = epoll_wait(m_epoll, events, MAX_EVENTS, timeout);
+  if (res < 0)
+    return errno == EINTR;
+
+  for (int i = 0; i < res; i++)
+  {
+    if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+      readable.push_back(events[i].data.fd);
+    if (events[i].events & EPOLLOUT)
+      writable.push_back(events[i].data.fd);
+  }
+  return true;
+#else
+  SOCKET          max_fd = 0;
+  fd_set          rfds, wfds;
+  struct timeval  to     = {timeout / 1000, (timeout % 1000) * 1000};
+  FD_ZERO(&rfds);
+  FD_ZERO(&wfds);
+
+  {
+    CSingleLock lock(m_critSection);
     for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); it++)
     {
       FD_SET(*it, &rfds);
@@ -119,98 +215,203 @@ void CTCPServer::Process()
         max_fd = *it;
     }
 
-    for (unsigned int i = 0; i < m_connections.size(); i++)
+    for (Connections::iterator it = m_connections.begin(); it != m_connections.end(); it++)
+    {
+      FD_SET(it->first, &rfds);
+      if (it->second->HasOutput())
+        FD_SET(it->first, &wfds);
+      if ((intptr_t)it->first > (intptr_t)max_fd)
+        max_fd = it->first;
+    }
+  }
+
+  int res = select((intptr_t)max_fd+1, &rfds, &wfds, NULL, &to);
+  if (res < 0)
+    return false;
+
+  for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); it++)
+  {
+    if (FD_ISSET(*it, &rfds))
+      readable.push_back(*it);
+  }
+
+  CSingleLock lock(m_critSection);
+  for (Connections::iterator it = m_connections.begin(); it != m_connections.end(); it++)
+  {
+    if (FD_ISSET(it->first, &rfds))
+      readable.push_back(it->first);
+    if (FD_ISSET(it->first, &wfds))
+      writable.push_back(it->first);
+  }
+  return true;
+#endif
+}
+
+bool CTCPServer::Watch(SOCKET socket)
+{
+#ifdef TARGET_WINDOWS
+  u_long nonblocking = 1;
+  if (ioctlsocket(socket, FIONBIO, &nonblocking) != 0)
+    return false;
+#else
+  int flags = fcntl(socket, F_GETFL, 0);
+  if (flags == -1 || fcntl(socket, F_SETFL, flags | O_NONBLOCK) == -1)
+    return false;
+#endif
+
+#ifdef HAS_EPOLL
+  // edge triggered, so writes only need watching once they've been held up, which the
+  // sockets are read and written until they would block for
+  struct epoll_event event = {};
+  event.events = EPOLLIN | EPOLLOUT | EPOLLET;
+  event.data.fd = socket;
+  if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, socket, &event) != 0)
+    return false;
+#endif
+  return true;
+}
+
+bool CTCPServer::Accept(SOCKET server)
+{
+  while (true)
+  {
+    CTCPClient *newconnection = new CTCPClient();
+    newconnection->m_socket = accept(server, (sockaddr*)&newconnection->m_cliaddr, &newconnection->m_addrlen);
+
+    if (newconnection->m_socket == INVALID_SOCKET)
     {
-      FD_SET(m_connections[i]->m_socket, &rfds);
-      if ((intptr_t)m_connections[i]->m_socket > (intptr_t)max_fd)
-        max_fd = m_connections[i]->m_socket;
+      delete newconnection;
+      if (SOCKET_WOULDBLOCK())
+        return true;
+
+      CLog::Log(LOGERROR, "JSONRPC Server: Accept of new connection failed: %d", errno);
+      return EBADF != errno;
     }
 
-    int res = select((intptr_t)max_fd+1, &rfds, NULL, NULL, &to);
-    if (res < 0)
+    if (!Watch(newconnection->m_socket))
     {
-      CLog::Log(LOGERROR, "JSONRPC Server: Select failed");
-      Sleep(1000);
-      Initialize();
+      CLog::Log(LOGERROR, "JSONRPC Server: Failed to watch new connection");
+      newconnection->Disconnect();
+      delete newconnection;
+      continue;
     }
-    else if (res > 0)
+
+    CLog::Log(LOGINFO, "JSONRPC Server: New connection added");
+    m_connections[newconnection->m_socket] = newconnection;
+  }
+}
+
+bool CTCPServer::Receive(CTCPClient *&client)
+{
+  while (true)
+  {
+    char buffer[RECEIVEBUFFER] = {};
+    int  nread = recv(client->m_socket, (char*)&buffer, RECEIVEBUFFER, 0);
+    if (nread < 0 && SOCKET_INTERRUPTED())
+      continue;
+    if (nread < 0 && SOCKET_WOULDBLOCK())
+      return true;
+    if (nread <= 0)
+      return false;
+
+    std::string response;
+    if (client->IsNew())
     {
-      for (int i = m_connections.size() - 1; i >= 0; i--)
-      {
-        int socket = m_connections[i]->m_socket;
-        if (FD_ISSET(socket, &rfds))
-        {
-          char buffer[RECEIVEBUFFER] = {};
-          int  nread = 0;
-          nread = recv(socket, (char*)&buffer, RECEIVEBUFFER, 0);
-          bool close = false;
-          if (nread > 0)
-          {
-            std::string response;
-            if (m_connections[i]->IsNew())
-            {
-              CWebSocket *websocket = CWebSocketManager::Handle(buffer, nread, response);
-
-              if (response.size() > 0)
-                m_connections[i]->Send(response.c_str(), response.size());
-
-              if (websocket != NULL)
-              {
-                // Replace the CTCPClient with a CWebSocketClient
-                CWebSocketClient *websocketClient = new CWebSocketClient(websocket, *(m_connections[i]));
-                delete m_connections[i];
-                m_connections.erase(m_connections.begin() + i);
-                m_connections.insert(m_connections.begin() + i, websocketClient);
-              }
-            }
-
-            if (response.size() <= 0)
-              m_connections[i]->PushBuffer(this, buffer, nread);
-
-            close = m_connections[i]->Closing();
-          }
-          else
-            close = true;
-
-          if (close)
-          {
-            CLog::Log(LOGINFO, "JSONRPC Server: Disconnection detected");
-            m_connections[i]->Disconnect();
-            delete m_connections[i];
-            m_connections.erase(m_connections.begin() + i);
-          }
-        }
-      }
+      CWebSocket *websocket = CWebSocketManager::Handle(buffer, nread, response);
 
-      for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); it++)
+      if (response.size() > 0)
+        client->Send(response.c_str(), response.size());
+
+      if (websocket != NULL)
       {
-        if (FD_ISSET(*it, &rfds))
-        {
-          CLog::Log(LOGDEBUG, "JSONRPC Server: New connection detected");
-          CTCPClient *newconnection = new CTCPClient();
-          newconnection->m_socket = accept(*it, (sockaddr*)&newconnection->m_cliaddr, &newconnection->m_addrlen);
-
-          if (newconnection->m_socket == INVALID_SOCKET)
-          {
-            CLog::Log(LOGERROR, "JSONRPC Server: Accept of new connection failed: %d", errno);
-            if (EBADF == errno)
-            {
-              Sleep(1000);
-              Initialize();
-              break;
-            }
-          }
-          else
-          {
-            CLog::Log(LOGINFO, "JSONRPC Server: New connection added");
-            m_connections.push_back(newconnection);
-          }
-        }
+        // Replace the CTCPClient with a CWebSocketClient
+        CWebSocketClient *websocketClient = new CWebSocketClient(websocket, *client);
+        m_connections[client->m_socket] = websocketClient;
+        delete client;
+        client = websocketClient;
       }
     }
+
+    if (response.size() <= 0)
+      client->PushBuffer(this, buffer, nread);
+
+    if (client->Closing())
+      return false;
+  }
+}
+
+void CTCPServer::Close(Connections::iterator connection)
+{
+  CTCPClient *client = connection->second;
+  m_connections.erase(connection);
+  client->Disconnect();
+  m_closed.push_back(client);
+}
+
+void CTCPServer::DeleteClosed()
+{
+  for (int i = m_closed.size() - 1; i >= 0; i--)
+  {
+    // a worker executing a request of the client still uses it
+    if (!m_closed[i]->IsBusy())
+    {
+      delete m_closed[i];
+      m_closed.erase(m_closed.begin() + i);
+    }
   }
+}
 
-  Deinitialize();
+void CTCPServer::Schedule(CTCPClient *client)
+{
+  CSingleLock lock(m_readySection);
+  m_ready.push_back(client);
+  m_readyEvent.Set();
+}
+
+CTCPServer::CTCPClient *CTCPServer::NextClient()
+{
+  CSingleLock lock(m_readySection);
+  if (m_ready.empty())
+    return NULL;
+
+  CTCPClient *client = m_ready.front();
+  m_ready.pop_front();
+  // the event only wakes one worker, pass it on if there's more to do
+  if (!m_ready.empty())
+    m_readyEvent.Set();
+  return client;
+}
+
+void CTCPServer::StartWorkers()
+{
+  for (unsigned int i = m_workers.size(); i < g_advancedSettings.m_jsonTcpWorkers; i++)
+  {
+    CRequestWorker *worker = new CRequestWorker(this);
+    worker->Create();
+    m_workers.push_back(worker);
+  }
+}
+
+void CTCPServer::StopWorkers()
+{
+  for (unsigned int i = 0; i < m_workers.size(); i++)
+    m_workers[i]->StopThread(false);
+  for (unsigned int i = 0; i < m_workers.size(); i++)
+  {
+    m_workers[i]->StopThread(true);
+    delete m_workers[i];
+  }
+  m_workers.clear();
+
+  std::deque<CTCPClient*> ready;
+  {
+    CSingleLock lock(m_readySection);
+    ready.swap(m_ready);
+  }
+  // the clients are closed, which makes them drop their requests and become idle
+  std::string request;
+  for (unsigned int i = 0; i < ready.size(); i++)
+    ready[i]->NextRequest(request);
 }
 
 bool CTCPServer::PrepareDownload(const char *path, CVariant &details, std::string &protocol)
@@ -232,15 +433,17 @@ void CTCPServer::Announce(AnnouncementFlag flag, const char *sender, const char
 {
   std::string str = IJSONRPCAnnouncer::AnnouncementToJSONRPC(flag, sender, message, data, g_advancedSettings.m_jsonOutputCompact);
 
-  for (unsigned int i = 0; i < m_connections.size(); i++)
+  CSingleLock lock(m_critSection);
+  for (Connections::iterator it = m_connections.begin(); it != m_connections.end(); it++)
   {
     {
-      CSingleLock lock (m_connections[i]->m_critSection);
-      if ((m_connections[i]->GetAnnouncementFlags() & flag) == 0)
+      CSingleLock lock (it->second->m_critSection);
+      if ((it->second->GetAnnouncementFlags() & flag) == 0)
         continue;
     }
 
-    m_connections[i]->Send(str.c_str(), str.size());
+    // only queued, a client that's slow to read doesn't hold up the others
+    it->second->Send(str.c_str(), str.size());
   }
 }
 
@@ -253,8 +456,26 @@ bool CTCPServer::Initialize()
   started |= InitializeBlue();
   started |= InitializeTCP();
 
+#ifdef HAS_EPOLL
+  if (started && (m_epoll = epoll_create(MAX_EVENTS)) < 0)
+  {
+    CLog::Log(LOGERROR, "JSONRPC Server: Failed to create epoll instance: %d", errno);
+    started = false;
+  }
+#endif
+
+  for (unsigned int i = 0; i < m_servers.size() && started; i++)
+  {
+    if (!Watch(m_servers[i]))
+    {
+      CLog::Log(LOGERROR, "JSONRPC Server: Failed to watch server socket");
+      started = false;
+    }
+  }
+
   if (started)
   {
+    StartWorkers();
     CAnnouncementManager::AddAnnouncer(this);
     CLog::Log(LOGINFO, "JSONRPC Server: Successfully initialized");
     return true;
@@ -449,7 +670,7 @@ bool CTCPServer::InitializeTCP()
 
   Deinitialize();
 
-  if ((fd = CreateTCPServerSocket(m_port, !m_nonlocal, 10, "JSONRPC")) == INVALID_SOCKET)
+  if ((fd = CreateTCPServerSocket(m_port, !m_nonlocal, SOMAXCONN, "JSONRPC")) == INVALID_SOCKET)
     return false;
 
   m_servers.push_back(fd);
@@ -458,19 +679,26 @@ bool CTCPServer::InitializeTCP()
 
 void CTCPServer::Deinitialize()
 {
-  for (unsigned int i = 0; i < m_connections.size(); i++)
   {
-    m_connections[i]->Disconnect();
-    delete m_connections[i];
+    CSingleLock lock(m_critSection);
+    while (!m_connections.empty())
+      Close(m_connections.begin());
   }
-
-  m_connections.clear();
+  // the lock isn't held while waiting, the workers may announce something
+  StopWorkers();
+  DeleteClosed();
 
   for (unsigned int i = 0; i < m_servers.size(); i++)
     closesocket(m_servers[i]);
 
   m_servers.clear();
 
+#ifdef HAS_EPOLL
+  if (m_epoll >= 0)
+    close(m_epoll);
+  m_epoll = -1;
+#endif
+
 #ifdef HAVE_LIBBLUETOOTH
   if (m_sdpd)
     sdp_close((sdp_session_t*)m_sdpd);
@@ -489,6 +717,8 @@ CTCPServer::CTCPClient::CTCPClient()
   m_endBrackets = 0;
   m_beginChar = 0;
   m_endChar = 0;
+  m_outputPosition = 0;
+  m_busy = false;
 
   m_addrlen = sizeof(m_cliaddr);
 }
@@ -522,12 +752,77 @@ bool CTCPServer::CTCPClient::SetAnnouncementFlags(int flags)
 
 void CTCPServer::CTCPClient::Send(const char *data, unsigned int size)
 {
-  unsigned int sent = 0;
-  do
+  CSingleLock lock (m_critSection);
+  if (m_socket == INVALID_SOCKET)
+    return;
+
+  // rather than using up all memory for a client that doesn't read, drop it
+  if (m_output.size() - m_outputPosition + size > MAX_OUTPUT)
   {
-    CSingleLock lock (m_critSection);
-    sent += send(m_socket, data + sent, size - sent, 0);
-  } while (sent < size);
+    CLog::Log(LOGWARNING, "JSONRPC Server: Client isn't reading what it's sent, closing the connection");
+    shutdown(m_socket, SHUT_RDWR);
+    return;
+  }
+
+  m_output.append(data, size);
+  Flush();
+}
+
+bool CTCPServer::CTCPClient::Flush()
+{
+  CSingleLock lock (m_critSection);
+  while (m_outputPosition < m_output.size() && m_socket != INVALID_SOCKET)
+  {
+    int sent = send(m_socket, m_output.c_str() + m_outputPosition, m_output.size() - m_outputPosition, MSG_NOSIGNAL);
+    if (sent < 0 && SOCKET_INTERRUPTED())
+      continue;
+    if (sent < 0 && SOCKET_WOULDBLOCK())
+      break;
+    if (sent < 0)
+      return false;
+
+    m_outputPosition += sent;
+  }
+
+  // drop what's been sent, but don't move a large remainder around for every write
+  if (m_outputPosition == m_output.size())
+  {
+    m_output.clear();
+    m_outputPosition = 0;
+  }
+  else if (m_outputPosition >= m_output.size() / 2)
+  {
+    m_output.erase(0, m_outputPosition);
+    m_outputPosition = 0;
+  }
+  return true;
+}
+
+bool CTCPServer::CTCPClient::HasOutput()
+{
+  CSingleLock lock (m_critSection);
+  return m_outputPosition < m_output.size();
+}
+
+bool CTCPServer::CTCPClient::NextRequest(std::string &request)
+{
+  CSingleLock lock (m_critSection);
+  if (m_requests.empty() || m_socket == INVALID_SOCKET)
+  {
+    m_requests.clear();
+    m_busy = false;
+    return false;
+  }
+
+  request = m_requests.front();
+  m_requests.pop_front();
+  return true;
+}
+
+bool CTCPServer::CTCPClient::IsBusy()
+{
+  CSingleLock lock (m_critSection);
+  return m_busy;
 }
 
 void CTCPServer::CTCPClient::PushBuffer(CTCPServer *host, const char *buffer, int length)
@@ -558,8 +853,14 @@ void CTCPServer::CTCPClient::PushBuffer(CTCPServer *host, const char *buffer, in
         m_endBrackets++;
       if (m_beginBrackets > 0 && m_endBrackets > 0 && m_beginBrackets == m_endBrackets)
       {
-        std::string line = CJSONRPC::MethodCall(m_buffer, host, this);
-        Send(line.c_str(), line.size());
+        // the requests of a client are executed in order, by one job at a time
+        CSingleLock lock (m_critSection);
+        m_requests.push_back(m_buffer);
+        if (!m_busy)
+        {
+          m_busy = true;
+          host->Schedule(this);
+        }
         m_beginChar = m_beginBrackets = m_endBrackets = 0;
         m_buffer.clear();
       }
@@ -590,6 +891,35 @@ void CTCPServer::CTCPClient::Copy(const CTCPClient& client)
   m_beginChar         = client.m_beginChar;
   m_endChar           = client.m_endChar;
   m_buffer            = client.m_buffer;
+  m_output            = client.m_output;
+  m_outputPosition    = client.m_outputPosition;
+  m_requests          = client.m_requests;
+  m_busy              = client.m_busy;
+}
+
+CTCPServer::CRequestWorker::CRequestWorker(CTCPServer *server) : CThread("JSONRPCRequestWorker")
+{
+  m_server = server;
+}
+
+void CTCPServer::CRequestWorker::Process()
+{
+  while (!m_bStop)
+  {
+    CTCPClient *client = m_server->NextClient();
+    if (client == NULL)
+    {
+      AbortableWait(m_server->m_readyEvent);
+      continue;
+    }
+
+    std::string request;
+    while (client->NextRequest(request))
+    {
+      std::string response = CJSONRPC::MethodCall(request, m_server, client);
+      client->Send(response.c_str(), response.size());
+    }
+  }
 }
 
 CTCPServer::CWebSocketClient::CWebSocketClient(CWebSocket *websocket)
@@ -625,6 +955,8 @@ CTCPServer::CWebSocketClient& CTCPServer::CWebSocketClient::operator=(const CWeb
 
 void CTCPServer::CWebSocketClient::Send(const char *data, unsigned int size)
 {
+  // responses are sent from the jobs as well as from the server
+  CSingleLock lock (m_critSection);
   const CWebSocketMessage *msg = m_websocket->Send(WebSocketTextFrame, data, size);
   if (msg == NULL || !msg->IsComplete())
     return;
@@ -636,6 +968,7 @@ void CTCPServer::CWebSocketClient::Send(const char *data, unsigned int size)
 
 void CTCPServer::CWebSocketClient::PushBuffer(CTCPServer *host, const char *buffer, int length)
 {
+  CSingleLock lock (m_critSection);
   bool send;
   const CWebSocketMessage *msg = NULL;
   size_t len = length;
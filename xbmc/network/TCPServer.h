@@ -19,6 +19,8 @@
  *
  */
 
+#include <deque>
+#include <map>
 #include <vector>
 #include <sys/socket.h>
 
@@ -26,6 +28,7 @@
 #include "interfaces/json-rpc/IJSONRPCAnnouncer.h"
 #include "interfaces/json-rpc/ITransportLayer.h"
 #include "threads/CriticalSection.h"
+#include "threads/Event.h"
 #include "threads/Thread.h"
 #include "websocket/WebSocket.h"
 
@@ -52,6 +55,44 @@ namespace JSONRPC
     bool InitializeTCP();
     void Deinitialize();
 
+    class CTCPClient;
+
+    /*! \brief Wait until any of the sockets can be read from or written to
+     \return false if waiting failed
+     */
+    bool Wait(std::vector<SOCKET> &readable, std::vector<SOCKET> &writable, unsigned int timeout);
+    /*! \brief Make a socket non-blocking and report its events to Wait()
+     */
+    bool Watch(SOCKET socket);
+    /*! \brief Accept all pending connections of a server socket
+     \return false if the server socket is broken
+     */
+    bool Accept(SOCKET server);
+    /*! \brief Read everything available from a client, which may be replaced by a websocket client
+     \return false if the connection is to be closed
+     */
+    bool Receive(CTCPClient *&client);
+    typedef std::map<SOCKET, CTCPClient*> Connections;
+
+    /*! \brief Disconnect the client of a connection, which is deleted once it has no request being executed
+     \param connection the connection, not looked up by socket as a websocket client may have closed it already
+     */
+    void Close(Connections::iterator connection);
+    void DeleteClosed();
+
+    /*! \brief Queue a client with new requests for the request workers
+     */
+    void Schedule(CTCPClient *client);
+    /*! \brief Take the next client with requests to execute
+     \return the client, NULL if none is waiting
+     */
+    CTCPClient *NextClient();
+    void StartWorkers();
+    /*! \brief Stop the request workers once they've finished the requests being executed, and
+     drop the requests still waiting. Only to be called once all clients are closed.
+     */
+    void StopWorkers();
+
     class CTCPClient : public IClient
     {
     public:
@@ -66,6 +107,8 @@ namespace JSONRPC
       virtual int  GetAnnouncementFlags();
       virtual bool SetAnnouncementFlags(int flags);
 
+      /*! \brief Queue data to be sent, sending as much of it right away as the socket takes
+       */
       virtual void Send(const char *data, unsigned int size);
       virtual void PushBuffer(CTCPServer *host, const char *buffer, int length);
       virtual void Disconnect();
@@ -73,6 +116,17 @@ namespace JSONRPC
       virtual bool IsNew() const { return m_new; }
       virtual bool Closing() const { return false; }
 
+      /*! \brief Send as much of the queued data as the socket takes without blocking
+       \return false if the connection failed
+       */
+      bool Flush();
+      bool HasOutput();
+
+      /*! \brief Take the next request to execute, or mark the client idle if there's none
+       */
+      bool NextRequest(std::string &request);
+      bool IsBusy();
+
       SOCKET           m_socket;
       sockaddr_storage m_cliaddr;
       socklen_t        m_addrlen;
@@ -86,6 +140,25 @@ namespace JSONRPC
       int m_beginBrackets, m_endBrackets;
       char m_beginChar, m_endChar;
       std::string m_buffer;
+
+      std::string             m_output;         ///< data waiting for the socket to take it
+      size_t                  m_outputPosition; ///< how much of m_output has been sent
+      std::deque<std::string> m_requests;       ///< requests waiting to be executed, in order
+      bool                    m_busy;           ///< whether a job is executing the requests
+    };
+
+    /*! \brief Executes the requests of the clients on a thread of its own, so long running
+     methods don't hold up the other clients and the announcements. The requests of a client
+     are executed by one worker at a time, in order.
+     */
+    class CRequestWorker : public CThread
+    {
+    public:
+      CRequestWorker(CTCPServer *server);
+    protected:
+      void Process();
+    private:
+      CTCPServer *m_server;
     };
 
     class CWebSocketClient : public CTCPClient
@@ -108,11 +181,19 @@ namespace JSONRPC
       CWebSocket *m_websocket;
     };
 
-    std::vector<CTCPClient*> m_connections;
+    Connections m_connections;
+    std::vector<CTCPClient*> m_closed;
     std::vector<SOCKET> m_servers;
     int m_port;
     bool m_nonlocal;
     void* m_sdpd;
+    int m_epoll;
+    CCriticalSection m_critSection;  ///< guards m_connections against announcements from other threads
+
+    std::vector<CRequestWorker*> m_workers;
+    std::deque<CTCPClient*>      m_ready;        ///< clients with requests waiting for a worker
+    CCriticalSection             m_readySection;
+    CEvent                       m_readyEvent;   ///< set when a client is queued in m_ready
 
     static CTCPServer *ServerInstance;
   };
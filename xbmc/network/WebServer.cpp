@@ -24,6 +24,7 @@
 #include "Util.h"
 #include "XBDateTime.h"
 #include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
 #include "settings/Settings.h"
 #include "threads/SingleLock.h"
 #include "utils/Base64.h"
@@ -46,6 +47,12 @@
 
 #define CONTENT_RANGE_FORMAT  "bytes %" PRId64 "-%" PRId64 "/%" PRId64
 
+#if defined(TARGET_POSIX) && (MHD_VERSION >= 0x00092000)
+// local files are handed to libmicrohttpd as a file descriptor, which it sends with sendfile()
+#define WEBSERVER_ZERO_COPY
+#include <fcntl.h>
+#endif
+
 using namespace XFILE;
 using namespace std;
 using namespace JSONRPC;
@@ -400,6 +407,9 @@ int CWebServer::CreateFileDownloadResponse(struct MHD_Connection *connection, co
     if (!GetLastModifiedDateTime(file, lastModified))
       lastModified.Reset();
 
+    // the entity tag changes whenever the file is modified
+    string eTag = GenerateETag(fileLength, lastModified);
+
     // get the MIME type for the Content-Type header
     CStdString ext = URIUtils::GetExtension(strURL);
     ext = ext.ToLower();
@@ -419,20 +429,34 @@ int CWebServer::CreateFileDownloadResponse(struct MHD_Connection *connection, co
 
       if (methodType == GET)
       {
-        // handle If-Modified-Since
-        string ifModifiedSince = GetRequestHeaderValue(connection, MHD_HEADER_KIND, "If-Modified-Since");
-        if (!ifModifiedSince.empty() && lastModified.IsValid())
+        // handle If-None-Match, which takes precedence over If-Modified-Since
+        string ifNoneMatch = GetRequestHeaderValue(connection, MHD_HEADER_KIND, "If-None-Match");
+        if (!ifNoneMatch.empty())
         {
-          CDateTime ifModifiedSinceDate;
-          ifModifiedSinceDate.SetFromRFC1123DateTime(ifModifiedSince);
-
-          if (lastModified.GetAsUTCDateTime() <= ifModifiedSinceDate)
+          if (ifNoneMatch == "*" || (!eTag.empty() && ifNoneMatch.find(eTag) != string::npos))
           {
             getData = false;
             response = MHD_create_response_from_data(0, NULL, MHD_NO, MHD_NO);
             responseCode = MHD_HTTP_NOT_MODIFIED;
           }
         }
+        // handle If-Modified-Since
+        else
+        {
+          string ifModifiedSince = GetRequestHeaderValue(connection, MHD_HEADER_KIND, "If-Modified-Since");
+          if (!ifModifiedSince.empty() && lastModified.IsValid())
+          {
+            CDateTime ifModifiedSinceDate;
+            ifModifiedSinceDate.SetFromRFC1123DateTime(ifModifiedSince);
+
+            if (lastModified.GetAsUTCDateTime() <= ifModifiedSinceDate)
+            {
+              getData = false;
+              response = MHD_create_response_from_data(0, NULL, MHD_NO, MHD_NO);
+              responseCode = MHD_HTTP_NOT_MODIFIED;
+            }
+          }
+        }
 
         if (getData)
         {
@@ -443,7 +467,13 @@ int CWebServer::CreateFileDownloadResponse(struct MHD_Connection *connection, co
           if (!context->ranges.empty())
           {
             string ifRange = GetRequestHeaderValue(connection, MHD_HEADER_KIND, "If-Range");
-            if (!ifRange.empty() && lastModified.IsValid())
+            // If-Range holds either an entity tag or a date
+            if (!ifRange.empty() && ifRange[0] == '"')
+            {
+              if (ifRange != eTag)
+                context->ranges.clear();
+            }
+            else if (!ifRange.empty() && lastModified.IsValid())
             {
               CDateTime ifRangeDate;
               ifRangeDate.SetFromRFC1123DateTime(ifRange);
@@ -514,11 +544,27 @@ int CWebServer::CreateFileDownloadResponse(struct MHD_Connection *connection, co
         // set the initial write position
         context->writePosition = context->ranges.begin()->first;
 
+        // a single range of a local file is sent straight from the file descriptor
+        if (context->rangeCount == 1)
+          response = CreateFileDescriptorResponse(strURL, context->writePosition, totalLength);
+
+        if (response != NULL)
+        {
+          getData = false;
+          delete context;
+          context = NULL;
+        }
         // create the response object
-        response = MHD_create_response_from_callback(totalLength,
-                                                     2048,
-                                                     &CWebServer::ContentReaderCallback, context,
-                                                     &CWebServer::ContentReaderFreeCallback);
+        else
+          response = MHD_create_response_from_callback(totalLength,
+                                                       2048,
+                                                       &CWebServer::ContentReaderCallback, context,
+                                                       &CWebServer::ContentReaderFreeCallback);
+      }
+      else
+      {
+        delete context;
+        context = NULL;
       }
 
       if (response == NULL)
@@ -561,6 +607,10 @@ int CWebServer::CreateFileDownloadResponse(struct MHD_Connection *connection, co
     if (lastModified.IsValid())
       AddHeader(response, "Last-Modified", lastModified.GetAsRFC1123DateTime());
 
+    // set the ETag header
+    if (!eTag.empty())
+      AddHeader(response, "ETag", eTag);
+
     // set the Expires header
     CDateTime expiryTime = CDateTime::GetCurrentDateTime();
     if (StringUtils::EqualsNoCase(mimeType, "text/html") ||
@@ -588,6 +638,32 @@ int CWebServer::CreateFileDownloadResponse(struct MHD_Connection *connection, co
   return MHD_YES;
 }
 
+struct MHD_Response* CWebServer::CreateFileDescriptorResponse(const string &strURL, int64_t position, uint64_t length)
+{
+#ifdef WEBSERVER_ZERO_COPY
+  // only plain files on a local filesystem can be sent without going through CFile
+  string path = CSpecialProtocol::TranslatePath(strURL);
+  if (URIUtils::IsURL(path) || length > (uint64_t)SIZE_MAX)
+    return NULL;
+
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return NULL;
+
+  // libmicrohttpd closes the descriptor when it's done with the response
+  struct MHD_Response *response = MHD_create_response_from_fd_at_offset((size_t)length, fd, position);
+  if (response == NULL)
+    close(fd);
+
+#ifdef WEBSERVER_DEBUG
+  CLog::Log(LOGDEBUG, "webserver [OUT] sending %" PRIu64 " bytes of %s from position %" PRId64 " without copying", length, path.c_str(), position);
+#endif
+  return response;
+#else
+  return NULL;
+#endif
+}
+
 int CWebServer::CreateErrorResponse(struct MHD_Connection *connection, int responseType, HTTPMethod method, struct MHD_Response *&response)
 {
   size_t payloadSize = 0;
@@ -1055,6 +1131,16 @@ std::string CWebServer::GenerateMultipartBoundary()
   return boundary;
 }
 
+string CWebServer::GenerateETag(int64_t length, const CDateTime &lastModified)
+{
+  if (!lastModified.IsValid())
+    return "";
+
+  time_t time;
+  lastModified.GetAsTime(time);
+  return StringUtils::Format("\"%" PRIx64 "-%" PRIx64 "\"", (uint64_t)time, (uint64_t)length);
+}
+
 bool CWebServer::GetLastModifiedDateTime(XFILE::CFile *file, CDateTime &lastModified)
 {
   if (file == NULL)
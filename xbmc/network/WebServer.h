@@ -103,6 +103,10 @@ private:
   static void ContentReaderFreeCallback (void *cls);
   static int CreateRedirect(struct MHD_Connection *connection, const std::string &strURL, struct MHD_Response *&response);
   static int CreateFileDownloadResponse(struct MHD_Connection *connection, const std::string &strURL, HTTPMethod methodType, struct MHD_Response *&response, int &responseCode);
+  /*! \brief Create a response sending the given part of a local file without copying it through a buffer
+   \return the response, or NULL if the file isn't on a local filesystem and has to be read through CFile
+   */
+  static struct MHD_Response* CreateFileDescriptorResponse(const std::string &strURL, int64_t position, uint64_t length);
   static int CreateErrorResponse(struct MHD_Connection *connection, int responseType, HTTPMethod method, struct MHD_Response *&response);
   static int CreateMemoryDownloadResponse(struct MHD_Connection *connection, void *data, size_t size, bool free, bool copy, struct MHD_Response *&response);
 
@@ -117,6 +121,7 @@ private:
   static int AddHeader(struct MHD_Response *response, const std::string &name, const std::string &value);
   static int64_t ParseRangeHeader(const std::string &rangeHeaderValue, int64_t totalLength, HttpRanges &ranges, int64_t &firstPosition, int64_t &lastPosition);
   static std::string GenerateMultipartBoundary();
+  static std::string GenerateETag(int64_t length, const CDateTime &lastModified);
   static bool GetLastModifiedDateTime(XFILE::CFile *file, CDateTime &lastModified);
 
   struct MHD_Daemon *m_daemon_ip6;
@@ -0,0 +1,243 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#ifdef TARGET_POSIX
+#include "network/TCPServer.h"
+#include "interfaces/json-rpc/JSONRPC.h"
+#include "utils/Stopwatch.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#define TCPSERVER_TEST_PORT 39095
+
+static const std::string ping = "{\"jsonrpc\": \"2.0\", \"method\": \"JSONRPC.Ping\", \"id\": 1}";
+
+static int Connect()
+{
+  int sock = socket(AF_INET, SOCK_STREAM, 0);
+  if (sock < 0)
+    return -1;
+
+  struct timeval timeout = { 10, 0 };
+  setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(TCPSERVER_TEST_PORT);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+  {
+    close(sock);
+    return -1;
+  }
+  return sock;
+}
+
+static bool SendAll(int sock, const std::string &data)
+{
+  return send(sock, data.c_str(), data.size(), 0) == (ssize_t)data.size();
+}
+
+static unsigned int Count(const std::string &data, const std::string &what)
+{
+  unsigned int count = 0;
+  for (size_t pos = data.find(what); pos != std::string::npos; pos = data.find(what, pos + what.size()))
+    count++;
+  return count;
+}
+
+// read until the given text has been received as often as expected
+static bool ReceiveCount(int sock, const std::string &what, unsigned int expected, std::string &received)
+{
+  char buffer[4096];
+  while (Count(received, what) < expected)
+  {
+    ssize_t read = recv(sock, buffer, sizeof(buffer), 0);
+    if (read <= 0)
+      return false;
+    received.append(buffer, read);
+  }
+  return true;
+}
+
+// a masked websocket frame with a payload of less than 126 bytes, masked with a zero key
+static std::string WebSocketFrame(unsigned char opcode, const std::string &payload)
+{
+  std::string frame;
+  frame.push_back((char)(0x80 | opcode));
+  frame.push_back((char)(0x80 | payload.size()));
+  frame.append(4, '\0');
+  return frame + payload;
+}
+
+class TestTCPServer : public testing::Test
+{
+protected:
+  TestTCPServer()
+  {
+    JSONRPC::CJSONRPC::Initialize();
+    JSONRPC::CTCPServer::StartServer(TCPSERVER_TEST_PORT, false);
+  }
+
+  ~TestTCPServer()
+  {
+    for (unsigned int i = 0; i < m_clients.size(); i++)
+      close(m_clients[i]);
+    JSONRPC::CTCPServer::StopServer(true);
+  }
+
+  void ConnectClients(unsigned int count)
+  {
+    for (unsigned int i = 0; i < count; i++)
+    {
+      int sock = Connect();
+      ASSERT_LE(0, sock);
+      m_clients.push_back(sock);
+    }
+  }
+
+  std::vector<int> m_clients;
+};
+
+TEST_F(TestTCPServer, ManyClients)
+{
+  const unsigned int clients = 300;
+  const unsigned int requests = 20;
+  ASSERT_TRUE(JSONRPC::CTCPServer::IsRunning());
+  ConnectClients(clients);
+
+  CStopWatch timer;
+  timer.StartZero();
+  // every client sends all its requests at once, split up in a few writes
+  std::string batch;
+  for (unsigned int r = 0; r < requests; r++)
+    batch += ping;
+  for (unsigned int i = 0; i < clients; i++)
+  {
+    ASSERT_TRUE(SendAll(m_clients[i], batch.substr(0, batch.size() / 3)));
+    ASSERT_TRUE(SendAll(m_clients[i], batch.substr(batch.size() / 3)));
+  }
+
+  for (unsigned int i = 0; i < clients; i++)
+  {
+    std::string received;
+    EXPECT_TRUE(ReceiveCount(m_clients[i], "\"pong\"", requests, received)) << "client " << i;
+  }
+  float elapsed = timer.GetElapsedSeconds();
+  std::cout << clients << " clients: " << (unsigned int)(clients * requests / std::max(elapsed, 0.001f)) << " requests/s" << std::endl;
+}
+
+TEST_F(TestTCPServer, StalledClient)
+{
+  // a client that doesn't read its large responses doesn't hold up the others
+  ConnectClients(11);
+  std::string introspect = "{\"jsonrpc\": \"2.0\", \"method\": \"JSONRPC.Introspect\", \"id\": 1}";
+  for (unsigned int i = 0; i < 20; i++)
+    ASSERT_TRUE(SendAll(m_clients[0], introspect));
+
+  for (unsigned int i = 1; i < m_clients.size(); i++)
+  {
+    std::string received;
+    ASSERT_TRUE(SendAll(m_clients[i], ping));
+    EXPECT_TRUE(ReceiveCount(m_clients[i], "\"pong\"", 1, received));
+  }
+
+  // and neither does it hold up notifications
+  std::string notify = "{\"jsonrpc\": \"2.0\", \"method\": \"JSONRPC.NotifyAll\", \"params\": { \"sender\": \"test\", \"message\": \"stalled\" }, \"id\": 1}";
+  ASSERT_TRUE(SendAll(m_clients[1], notify));
+  for (unsigned int i = 1; i < m_clients.size(); i++)
+  {
+    std::string received;
+    EXPECT_TRUE(ReceiveCount(m_clients[i], "Other.stalled", 1, received)) << "client " << i;
+  }
+}
+
+TEST_F(TestTCPServer, Disconnect)
+{
+  // clients that go away with requests still being executed
+  ConnectClients(50);
+  std::string batch;
+  for (unsigned int r = 0; r < 50; r++)
+    batch += ping;
+  for (unsigned int i = 0; i < m_clients.size(); i++)
+  {
+    ASSERT_TRUE(SendAll(m_clients[i], batch));
+    close(m_clients[i]);
+  }
+  m_clients.clear();
+
+  ConnectClients(1);
+  std::string received;
+  ASSERT_TRUE(SendAll(m_clients[0], ping));
+  EXPECT_TRUE(ReceiveCount(m_clients[0], "\"pong\"", 1, received));
+}
+TEST_F(TestTCPServer, WebSocketClose)
+{
+  // a websocket client that closes the connection itself is removed along with it
+  ConnectClients(2);
+  std::string received;
+  ASSERT_TRUE(SendAll(m_clients[0], "GET / HTTP/1.1\r\n"
+                                    "Host: localhost\r\n"
+                                    "Upgrade: websocket\r\n"
+                                    "Connection: Upgrade\r\n"
+                                    "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                                    "Sec-WebSocket-Version: 13\r\n"
+                                    "Sec-WebSocket-Protocol: jsonrpc.xbmc.org\r\n\r\n"));
+  ASSERT_TRUE(ReceiveCount(m_clients[0], "\r\n\r\n", 1, received));
+  EXPECT_EQ(0U, received.find("HTTP/1.1 101"));
+
+  received.clear();
+  ASSERT_TRUE(SendAll(m_clients[0], WebSocketFrame(0x1, ping)));
+  EXPECT_TRUE(ReceiveCount(m_clients[0], "\"pong\"", 1, received));
+
+  // close, and wait for the server to close its side as well
+  ASSERT_TRUE(SendAll(m_clients[0], WebSocketFrame(0x8, "")));
+  char buffer[1024];
+  while (recv(m_clients[0], buffer, sizeof(buffer), 0) > 0);
+
+  // announcements go to the remaining client only
+  std::string notify = "{\"jsonrpc\": \"2.0\", \"method\": \"JSONRPC.NotifyAll\", \"params\": { \"sender\": \"test\", \"message\": \"closed\" }, \"id\": 1}";
+  received.clear();
+  ASSERT_TRUE(SendAll(m_clients[1], notify));
+  EXPECT_TRUE(ReceiveCount(m_clients[1], "Other.closed", 1, received));
+}
+
+TEST_F(TestTCPServer, StopWithRequestsWaiting)
+{
+  // stopping the server (in the destructor) doesn't wait for requests that haven't started
+  ConnectClients(20);
+  std::string batch;
+  for (unsigned int r = 0; r < 200; r++)
+    batch += ping;
+  for (unsigned int i = 0; i < m_clients.size(); i++)
+    ASSERT_TRUE(SendAll(m_clients[i], batch));
+}
+#endif
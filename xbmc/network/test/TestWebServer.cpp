@@ -0,0 +1,239 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#if defined(HAS_WEB_SERVER) && defined(TARGET_POSIX)
+#include "network/WebServer.h"
+#include "filesystem/File.h"
+#include "test/TestUtils.h"
+#include "utils/Stopwatch.h"
+#include "utils/StringUtils.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#define WEBSERVER_TEST_PORT 38085
+
+// serves the file given at /testfile
+class CHTTPTestFileHandler : public IHTTPRequestHandler
+{
+public:
+  CHTTPTestFileHandler(const std::string &path) : m_path(path) { }
+
+  virtual IHTTPRequestHandler* GetInstance() { return new CHTTPTestFileHandler(m_path); }
+  virtual bool CheckHTTPRequest(const HTTPRequest &request) { return request.url == "/testfile"; }
+  virtual int HandleHTTPRequest(const HTTPRequest &request)
+  {
+    m_responseCode = MHD_HTTP_OK;
+    m_responseType = HTTPFileDownload;
+    return MHD_YES;
+  }
+  virtual std::string GetHTTPResponseFile() const { return m_path; }
+
+private:
+  std::string m_path;
+};
+
+struct HTTPTestResponse
+{
+  int status;
+  std::map<std::string, std::string> headers;
+  std::vector<char> body;
+};
+
+// a minimal HTTP/1.0 client, reading the response until the server closes the connection
+static bool Get(const std::string &request, HTTPTestResponse &response)
+{
+  int sock = socket(AF_INET, SOCK_STREAM, 0);
+  if (sock < 0)
+    return false;
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(WEBSERVER_TEST_PORT);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+      send(sock, request.c_str(), request.size(), 0) != (ssize_t)request.size())
+  {
+    close(sock);
+    return false;
+  }
+
+  std::vector<char> data;
+  std::vector<char> buffer(256 * 1024);
+  ssize_t read;
+  while ((read = recv(sock, &buffer[0], buffer.size(), 0)) > 0)
+    data.insert(data.end(), buffer.begin(), buffer.begin() + read);
+  close(sock);
+
+  std::string separator = "\r\n\r\n";
+  std::vector<char>::iterator end = std::search(data.begin(), data.end(), separator.begin(), separator.end());
+  if (end == data.end())
+    return false;
+
+  std::vector<std::string> lines = StringUtils::Split(std::string(data.begin(), end), "\r\n");
+  if (lines.empty() || sscanf(lines[0].c_str(), "HTTP/%*s %d", &response.status) != 1)
+    return false;
+
+  response.headers.clear();
+  for (unsigned int i = 1; i < lines.size(); i++)
+  {
+    size_t colon = lines[i].find(':');
+    if (colon == std::string::npos)
+      continue;
+    std::string name = lines[i].substr(0, colon);
+    std::string value = lines[i].substr(colon + 1);
+    response.headers[StringUtils::Trim(name)] = StringUtils::Trim(value);
+  }
+  response.body.assign(end + separator.size(), data.end());
+  return true;
+}
+
+class TestWebServer : public testing::Test
+{
+protected:
+  TestWebServer()
+  {
+    m_data.resize(32 * 1024 * 1024 + 1234);
+    for (unsigned int i = 0; i < m_data.size(); i++)
+      m_data[i] = (char)(i * 7 + i / 4096);
+
+    m_file = XBMC_CREATETEMPFILE("");
+    m_file->Write(&m_data[0], m_data.size());
+    m_file->Close();
+
+    m_handler = new CHTTPTestFileHandler(XBMC_TEMPFILEPATH(m_file));
+    CWebServer::RegisterRequestHandler(m_handler);
+    m_webserver.Start(WEBSERVER_TEST_PORT, "", "");
+  }
+
+  ~TestWebServer()
+  {
+    m_webserver.Stop();
+    CWebServer::UnregisterRequestHandler(m_handler);
+    delete m_handler;
+    XBMC_DELETETEMPFILE(m_file);
+  }
+
+  static std::string Request(const std::string &headers)
+  {
+    return "GET /testfile HTTP/1.0\r\n" + headers + "\r\n";
+  }
+
+  bool IsPart(const HTTPTestResponse &response, size_t start, size_t length)
+  {
+    return response.body.size() == length && std::equal(response.body.begin(), response.body.end(), m_data.begin() + start);
+  }
+
+  CWebServer m_webserver;
+  IHTTPRequestHandler *m_handler;
+  XFILE::CFile *m_file;
+  std::vector<char> m_data;
+};
+
+TEST_F(TestWebServer, Download)
+{
+  HTTPTestResponse response;
+  ASSERT_TRUE(Get(Request(""), response));
+  EXPECT_EQ(MHD_HTTP_OK, response.status);
+  EXPECT_EQ("bytes", response.headers["Accept-Ranges"]);
+  EXPECT_FALSE(response.headers["ETag"].empty());
+  EXPECT_TRUE(IsPart(response, 0, m_data.size()));
+}
+
+TEST_F(TestWebServer, Range)
+{
+  HTTPTestResponse response;
+  ASSERT_TRUE(Get(Request("Range: bytes=1000000-1999999\r\n"), response));
+  EXPECT_EQ(MHD_HTTP_PARTIAL_CONTENT, response.status);
+  EXPECT_EQ(StringUtils::Format("bytes 1000000-1999999/%u", (unsigned int)m_data.size()), response.headers["Content-Range"]);
+  EXPECT_TRUE(IsPart(response, 1000000, 1000000));
+
+  ASSERT_TRUE(Get(Request("Range: bytes=-100\r\n"), response));
+  EXPECT_EQ(MHD_HTTP_PARTIAL_CONTENT, response.status);
+  EXPECT_TRUE(IsPart(response, m_data.size() - 100, 100));
+}
+
+TEST_F(TestWebServer, Conditional)
+{
+  HTTPTestResponse response;
+  ASSERT_TRUE(Get(Request(""), response));
+  std::string eTag = response.headers["ETag"];
+  std::string lastModified = response.headers["Last-Modified"];
+  ASSERT_FALSE(eTag.empty());
+
+  ASSERT_TRUE(Get(Request("If-None-Match: " + eTag + "\r\n"), response));
+  EXPECT_EQ(MHD_HTTP_NOT_MODIFIED, response.status);
+  EXPECT_TRUE(response.body.empty());
+
+  ASSERT_TRUE(Get(Request("If-None-Match: \"other\"\r\nIf-Modified-Since: " + lastModified + "\r\n"), response));
+  EXPECT_EQ(MHD_HTTP_OK, response.status);
+
+  ASSERT_TRUE(Get(Request("If-Modified-Since: " + lastModified + "\r\n"), response));
+  EXPECT_EQ(MHD_HTTP_NOT_MODIFIED, response.status);
+
+  // the range is only served if the file is still the one the client has
+  ASSERT_TRUE(Get(Request("Range: bytes=0-99\r\nIf-Range: " + eTag + "\r\n"), response));
+  EXPECT_EQ(MHD_HTTP_PARTIAL_CONTENT, response.status);
+  EXPECT_TRUE(IsPart(response, 0, 100));
+  ASSERT_TRUE(Get(Request("Range: bytes=0-99\r\nIf-Range: \"other\"\r\n"), response));
+  EXPECT_EQ(MHD_HTTP_OK, response.status);
+  EXPECT_TRUE(IsPart(response, 0, m_data.size()));
+}
+
+TEST_F(TestWebServer, Throughput)
+{
+  // a single range of a local file is sent from its descriptor while several ranges
+  // are read through CFile, so compare the two for (nearly) the whole file
+  const unsigned int runs = 4;
+  const size_t half = m_data.size() / 2;
+  struct
+  {
+    const char *name;
+    std::string request;
+    size_t length;
+  } requests[] = {
+    { "single range", Request(""), m_data.size() },
+    { "multiple ranges", Request(StringUtils::Format("Range: bytes=0-%u,%u-%u\r\n", (unsigned int)half - 1, (unsigned int)half, (unsigned int)m_data.size() - 2)), m_data.size() - 1 },
+  };
+
+  for (unsigned int r = 0; r < sizeof(requests) / sizeof(requests[0]); r++)
+  {
+    HTTPTestResponse response;
+    CStopWatch timer;
+    timer.StartZero();
+    for (unsigned int i = 0; i < runs; i++)
+    {
+      ASSERT_TRUE(Get(requests[r].request, response));
+      EXPECT_LE(requests[r].length, response.body.size());
+    }
+    float elapsed = timer.GetElapsedSeconds();
+    std::cout << requests[r].name << ": " << (unsigned int)(runs * requests[r].length / (1024 * 1024) / std::max(elapsed, 0.001f)) << " MB/s" << std::endl;
+  }
+}
+#endif
@@ -21,6 +21,7 @@
 #include "SlideShowPicture.h"
 #include "system.h"
 #include "guilib/GraphicContext.h"
+#include "guilib/GUIRenderBatch.h"
 #include "guilib/Texture.h"
 #include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
@@ -743,6 +744,7 @@ void CSlideShowPic::Render()
 
 void CSlideShowPic::Render(float *x, float *y, CBaseTexture* pTexture, color_t color)
 {
+  CGUIRenderBatch::Get().Flush();
 #ifdef HAS_DX
   struct VERTEX
   {
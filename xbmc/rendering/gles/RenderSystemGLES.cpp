@@ -24,6 +24,7 @@
 #if HAS_GLES == 2
 
 #include "guilib/GraphicContext.h"
+#include "guilib/GUIRenderBatch.h"
 #include "settings/AdvancedSettings.h"
 #include "RenderSystemGLES.h"
 #include "guilib/MatrixGLES.h"
@@ -196,6 +197,8 @@ bool CRenderSystemGLES::EndRender()
   if (!m_bRenderCreated)
     return false;
 
+  CGUIRenderBatch::Get().Flush();
+
   return true;
 }
 
@@ -204,6 +207,8 @@ bool CRenderSystemGLES::ClearBuffers(color_t color)
   if (!m_bRenderCreated)
     return false;
 
+  CGUIRenderBatch::Get().Flush();
+
   float r = GET_R(color) / 255.0f;
   float g = GET_G(color) / 255.0f;
   float b = GET_B(color) / 255.0f;
@@ -355,6 +360,8 @@ void CRenderSystemGLES::CaptureStateBlock()
   if (!m_bRenderCreated)
     return;
 
+  CGUIRenderBatch::Get().Flush();
+
   g_matrices.MatrixMode(MM_PROJECTION);
   g_matrices.PushMatrix();
   g_matrices.MatrixMode(MM_TEXTURE);
@@ -388,7 +395,9 @@ void CRenderSystemGLES::SetCameraPosition(const CPoint &camera, int screenWidth,
 { 
   if (!m_bRenderCreated)
     return;
-  
+
+  CGUIRenderBatch::Get().Flush();
+
   g_graphicsContext.BeginPaint();
   
   CPoint offset = camera - CPoint(screenWidth*0.5f, screenHeight*0.5f);
@@ -479,6 +488,8 @@ void CRenderSystemGLES::ApplyHardwareTransform(const TransformMatrix &finalMatri
   if (!m_bRenderCreated)
     return;
 
+  CGUIRenderBatch::Get().Flush();
+
   g_matrices.MatrixMode(MM_MODELVIEW);
   g_matrices.PushMatrix();
   GLfloat matrix[4][4];
@@ -500,6 +511,8 @@ void CRenderSystemGLES::RestoreHardwareTransform()
   if (!m_bRenderCreated)
     return;
 
+  CGUIRenderBatch::Get().Flush();
+
   g_matrices.MatrixMode(MM_MODELVIEW);
   g_matrices.PopMatrix();
 }
@@ -530,6 +543,8 @@ void CRenderSystemGLES::SetViewPort(CRect& viewPort)
   if (!m_bRenderCreated)
     return;
 
+  CGUIRenderBatch::Get().Flush();
+
   glScissor((GLint) viewPort.x1, (GLint) (m_height - viewPort.y1 - viewPort.Height()), (GLsizei) viewPort.Width(), (GLsizei) viewPort.Height());
   glViewport((GLint) viewPort.x1, (GLint) (m_height - viewPort.y1 - viewPort.Height()), (GLsizei) viewPort.Width(), (GLsizei) viewPort.Height());
 }
@@ -538,6 +553,8 @@ void CRenderSystemGLES::SetScissors(const CRect &rect)
 {
   if (!m_bRenderCreated)
     return;
+
+  CGUIRenderBatch::Get().Flush();
   GLint x1 = MathUtils::round_int(rect.x1);
   GLint y1 = MathUtils::round_int(rect.y1);
   GLint x2 = MathUtils::round_int(rect.x2);
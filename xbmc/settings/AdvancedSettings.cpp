@@ -275,6 +275,7 @@ void CAdvancedSettings::Initialize()
   m_bMusicLibraryAlbumsSortByArtistThenYear = false;
   m_bMusicLibraryCleanOnUpdate = false;
   m_iMusicLibraryRecentlyAddedItems = 25;
+  m_iMusicLibraryTagReaders = 4;
   m_strMusicLibraryAlbumFormat = "";
   m_strMusicLibraryAlbumFormatRight = "";
   m_prioritiseAPEv2tags = false;
@@ -328,6 +329,7 @@ void CAdvancedSettings::Initialize()
   m_curlretries = 2;
   m_curlDisableIPV6 = false;      //Certain hardware/OS combinations have trouble
                                   //with ipv6.
+  m_curlTailPrefetch = 1024;
 
   m_fullScreen = m_startFullScreen = false;
   m_showExitButton = true;
@@ -374,14 +376,17 @@ void CAdvancedSettings::Initialize()
   m_measureRefreshrate = false;
 
   m_cacheMemBufferSize = 1024 * 1024 * 20;
+  m_cacheBlocks = false;
   m_alwaysForceBuffer = false;
   // the following setting determines the readRate of a player data
   // as multiply of the default data read rate
   m_readBufferFactor = 1.0f;
+  m_nfsReadAhead = 4;
   m_addonPackageFolderSize = 200;
 
   m_jsonOutputCompact = true;
   m_jsonTcpPort = 9090;
+  m_jsonTcpWorkers = 4;
 
   m_enableMultimediaKeys = false;
 
@@ -389,6 +394,10 @@ void CAdvancedSettings::Initialize()
   m_guiVisualizeDirtyRegions = false;
   m_guiAlgorithmDirtyRegions = 3;
   m_guiDirtyRegionNoFlipTimeout = 0;
+  m_guiDirtyRegionTrace.clear();
+  m_guiTextureMemory = 0;
+  m_guiFontCache = false;
+  m_guiFrameProfiler = 1;
   m_logEnableAirtunes = false;
   m_airTunesPort = 36666;
   m_airPlayPort = 36667;
@@ -754,6 +763,7 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
   {
     XMLUtils::GetBoolean(pElement, "hideallitems", m_bMusicLibraryHideAllItems);
     XMLUtils::GetInt(pElement, "recentlyaddeditems", m_iMusicLibraryRecentlyAddedItems, 1, INT_MAX);
+    XMLUtils::GetInt(pElement, "tagreaders", m_iMusicLibraryTagReaders, 1, 4);
     XMLUtils::GetBoolean(pElement, "prioritiseapetags", m_prioritiseAPEv2tags);
     XMLUtils::GetBoolean(pElement, "allitemsonbottom", m_bMusicLibraryAllItemsOnBottom);
     XMLUtils::GetBoolean(pElement, "albumssortbyartistthenyear", m_bMusicLibraryAlbumsSortByArtistThenYear);
@@ -805,9 +815,12 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetInt(pElement, "curllowspeedtime", m_curllowspeedtime, 1, 1000);
     XMLUtils::GetInt(pElement, "curlretries", m_curlretries, 0, 10);
     XMLUtils::GetBoolean(pElement,"disableipv6", m_curlDisableIPV6);
+    XMLUtils::GetUInt(pElement, "curltailprefetch", m_curlTailPrefetch, 0, 16384);
     XMLUtils::GetUInt(pElement, "cachemembuffersize", m_cacheMemBufferSize);
+    XMLUtils::GetBoolean(pElement, "cacheblocks", m_cacheBlocks);
     XMLUtils::GetBoolean(pElement, "alwaysforcebuffer", m_alwaysForceBuffer);
     XMLUtils::GetFloat(pElement, "readbufferfactor", m_readBufferFactor);
+    XMLUtils::GetUInt(pElement, "nfsreadahead", m_nfsReadAhead, 0, 32);
   }
 
   pElement = pRootElement->FirstChildElement("jsonrpc");
@@ -815,6 +828,7 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
   {
     XMLUtils::GetBoolean(pElement, "compactoutput", m_jsonOutputCompact);
     XMLUtils::GetUInt(pElement, "tcpport", m_jsonTcpPort);
+    XMLUtils::GetUInt(pElement, "tcpworkers", m_jsonTcpWorkers, 1, 32);
   }
 
   pElement = pRootElement->FirstChildElement("samba");
@@ -1164,6 +1178,10 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetBoolean(pElement, "visualizedirtyregions", m_guiVisualizeDirtyRegions);
     XMLUtils::GetInt(pElement, "algorithmdirtyregions",     m_guiAlgorithmDirtyRegions);
     XMLUtils::GetInt(pElement, "nofliptimeout",             m_guiDirtyRegionNoFlipTimeout);
+    XMLUtils::GetPath(pElement, "dirtyregiontrace",         m_guiDirtyRegionTrace);
+    XMLUtils::GetUInt(pElement, "texturememory",            m_guiTextureMemory, 0, 2048);
+    XMLUtils::GetBoolean(pElement, "fontcache",             m_guiFontCache);
+    XMLUtils::GetInt(pElement, "frameprofiler",             m_guiFrameProfiler, 0, 2);
   }
 
   // load in the settings overrides
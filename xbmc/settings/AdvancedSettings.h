@@ -258,6 +258,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
 
     bool m_bMusicLibraryHideAllItems;
     int m_iMusicLibraryRecentlyAddedItems;
+    int m_iMusicLibraryTagReaders; ///< number of files the music scanner reads tags from concurrently, at most the 4 normal priority jobs the job manager runs at once
     bool m_bMusicLibraryAllItemsOnBottom;
     bool m_bMusicLibraryAlbumsSortByArtistThenYear;
     bool m_bMusicLibraryCleanOnUpdate;
@@ -318,6 +319,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int m_curllowspeedtime;
     int m_curlretries;
     bool m_curlDisableIPV6;
+    unsigned int m_curlTailPrefetch; ///< KB at the end of seekable HTTP files fetched on a second connection when they are opened, 0 to disable
 
     bool m_fullScreen;
     bool m_startFullScreen;
@@ -373,14 +375,21 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     bool m_guiVisualizeDirtyRegions;
     int  m_guiAlgorithmDirtyRegions;
     int  m_guiDirtyRegionNoFlipTimeout;
+    CStdString m_guiDirtyRegionTrace; ///< file to record the dirty regions of each frame to, empty for none
+    unsigned int m_guiTextureMemory; ///< MB of texture memory after which unused textures are freed early, 0 for no limit
+    bool m_guiFontCache; ///< keep rendered font glyphs on disk between runs
+    int  m_guiFrameProfiler; ///< level of detail the GUI frame profiler records at, see CGUIFrameProfiler::Level
     unsigned int m_addonPackageFolderSize;
 
     unsigned int m_cacheMemBufferSize;
+    bool m_cacheBlocks; ///< use the block based cache which keeps multiple regions of a file cached
     bool m_alwaysForceBuffer;
     float m_readBufferFactor;
+    unsigned int m_nfsReadAhead; ///< number of NFS reads kept in flight ahead of the read position, 0 or 1 to read synchronously
 
     bool m_jsonOutputCompact;
     unsigned int m_jsonTcpPort;
+    unsigned int m_jsonTcpWorkers; ///< number of JSON-RPC requests of TCP clients executed at once
 
     bool m_enableMultimediaKeys;
     std::vector<CStdString> m_settingsFiles;
@@ -87,6 +87,7 @@ void CSkinSettings::SetString(int setting, const string &label)
   if (it != m_strings.end())
   {
     it->second.value = label;
+    g_infoManager.InvalidateBools(INFO::INFO_DEPENDS_SETTINGS);
     return;
   }
 
@@ -134,6 +135,7 @@ void CSkinSettings::SetBool(int setting, bool set)
   if (it != m_bools.end())
   {
     it->second.value = set;
+    g_infoManager.InvalidateBools(INFO::INFO_DEPENDS_SETTINGS);
     return;
   }
 
@@ -152,6 +154,7 @@ void CSkinSettings::Reset(const string &setting)
     if (StringUtils::EqualsNoCase(settingName, it->second.name))
     {
       it->second.value.clear();
+      g_infoManager.InvalidateBools(INFO::INFO_DEPENDS_SETTINGS);
       return;
     }
   }
@@ -162,6 +165,7 @@ void CSkinSettings::Reset(const string &setting)
     if (StringUtils::EqualsNoCase(settingName, it->second.name))
     {
       it->second.value = false;
+      g_infoManager.InvalidateBools(INFO::INFO_DEPENDS_SETTINGS);
       return;
     }
   }
@@ -185,6 +189,7 @@ void CSkinSettings::Reset()
       it->second.value.clear();
   }
 
+  g_infoManager.InvalidateBools(INFO::INFO_DEPENDS_SETTINGS);
   g_infoManager.ResetCache();
 }
 
@@ -226,6 +231,7 @@ bool CSkinSettings::Load(const TiXmlNode *settings)
     pChild = pChild->NextSiblingElement(XML_SETTING);
   }
 
+  g_infoManager.InvalidateBools(INFO::INFO_DEPENDS_SETTINGS);
   return true;
 }
 
@@ -273,6 +279,7 @@ void CSkinSettings::Clear()
   CSingleLock lock(m_critical);
   m_strings.clear();
   m_bools.clear();
+  g_infoManager.InvalidateBools(INFO::INFO_DEPENDS_SETTINGS);
 }
 
 std::string CSkinSettings::GetCurrentSkin() const
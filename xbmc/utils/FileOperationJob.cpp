@@ -26,6 +26,7 @@
 #include "filesystem/MultiPathDirectory.h"
 #include "filesystem/SpecialProtocol.h"
 #include "log.h"
+#include "threads/SingleLock.h"
 #include "Util.h"
 #include "URIUtils.h"
 #include "URL.h"
@@ -37,13 +38,29 @@
 #include "filesystem/RarManager.h"
 #endif
 
+#include <algorithm>
+
 using namespace std;
 using namespace XFILE;
 
+// most sources and destinations keep up with more than one transfer at once,
+// but more than a couple just has them seeking between the files
+#define FILEOPERATION_MAX_PARALLEL 2
+
+struct CFileOperationJob::DataHolder
+{
+  CFileOperationJob *base;
+  double done; ///< time of the operation done so far
+};
+
 CFileOperationJob::CFileOperationJob()
 {
   m_handle = NULL;
   m_displayProgress = false;
+  m_operations = NULL;
+  m_nextOperation = m_endOperation = 0;
+  m_success = true;
+  m_opWeight = m_done = 0.0;
 }
 
 CFileOperationJob::CFileOperationJob(FileAction action, CFileItemList & items,
@@ -53,6 +70,10 @@ CFileOperationJob::CFileOperationJob(FileAction action, CFileItemList & items,
 {
   m_handle = NULL;
   m_displayProgress = displayProgress;
+  m_operations = NULL;
+  m_nextOperation = m_endOperation = 0;
+  m_success = true;
+  m_opWeight = m_done = 0.0;
   m_heading = heading;
   m_line = line;
   SetFileOperation(action, items, strDestFile);
@@ -82,13 +103,26 @@ bool CFileOperationJob::DoWork()
 
   bool success = DoProcess(m_action, m_items, m_strDestFile, ops, totalTime);
 
-  unsigned int size = ops.size();
+  m_opWeight = 100.0 / totalTime;
+  m_done = 0.0;
+  m_timer.StartZero();
 
-  double opWeight = 100.0 / totalTime;
-  double current = 0.0;
-
-  for (unsigned int i = 0; i < size && success; i++)
-    success &= ops[i].ExecuteOperation(this, current, opWeight);
+  // consecutive operations of the same kind on files are independent of each other, so run
+  // alongside each other. Anything else (creating the folders files are copied into, removing
+  // the ones they were moved out of, copying files just deleted by a replace) waits for them.
+  unsigned int start = 0;
+  while (start < ops.size() && success)
+  {
+    FileAction action = ops[start].GetAction();
+    unsigned int end = start + 1;
+    if (action != ActionCreateFolder && action != ActionDeleteFolder)
+    {
+      while (end < ops.size() && ops[end].GetAction() == action)
+        end++;
+    }
+    success = RunOperations(ops, start, end);
+    start = end;
+  }
 
   if (m_handle)
     m_handle->MarkFinished();
@@ -96,6 +130,60 @@ bool CFileOperationJob::DoWork()
   return success;
 }
 
+bool CFileOperationJob::RunOperations(FileOperationList &fileOperations, unsigned int start, unsigned int end)
+{
+  {
+    CSingleLock lock(m_section);
+    m_operations = &fileOperations;
+    m_nextOperation = start;
+    m_endOperation = end;
+    m_success = true;
+  }
+
+  CRunner runner(this);
+  vector<CThread *> threads;
+  for (unsigned int i = 1; i < min(end - start, (unsigned int)FILEOPERATION_MAX_PARALLEL); i++)
+  {
+    CThread *thread = new CThread(&runner, "FileOperation");
+    thread->Create();
+    threads.push_back(thread);
+  }
+
+  ExecuteOperations();
+
+  for (vector<CThread *>::iterator i = threads.begin(); i != threads.end(); ++i)
+  {
+    (*i)->StopThread(true);
+    delete *i;
+  }
+
+  CSingleLock lock(m_section);
+  m_operations = NULL;
+  return m_success;
+}
+
+void CFileOperationJob::ExecuteOperations()
+{
+  CSingleLock lock(m_section);
+  while (m_success && m_nextOperation < m_endOperation)
+  {
+    CFileOperation &operation = (*m_operations)[m_nextOperation++];
+    lock.Leave();
+    bool result = operation.ExecuteOperation(this);
+    lock.Enter();
+    if (!result)
+      m_success = false;
+  }
+}
+
+double CFileOperationJob::GetDone() const
+{
+  double done = m_done;
+  for (vector<DataHolder *>::const_iterator i = m_running.begin(); i != m_running.end(); ++i)
+    done += (*i)->done;
+  return done;
+}
+
 bool CFileOperationJob::DoProcessFile(FileAction action, const CStdString& strFileA, const CStdString& strFileB, FileOperationList &fileOperations, double &totalTime)
 {
   int64_t time = 1;
@@ -209,13 +297,6 @@ CFileOperationJob::CFileOperation::CFileOperation(FileAction action, const CStdS
 {
 }
 
-struct DataHolder
-{
-  CFileOperationJob *base;
-  double current;
-  double opWeight;
-};
-
 CStdString CFileOperationJob::GetActionString(FileAction action)
 {
   CStdString result;
@@ -242,23 +323,28 @@ CStdString CFileOperationJob::GetActionString(FileAction action)
   return result;
 }
 
-bool CFileOperationJob::CFileOperation::ExecuteOperation(CFileOperationJob *base, double &current, double opWeight)
+bool CFileOperationJob::CFileOperation::ExecuteOperation(CFileOperationJob *base)
 {
   bool bResult = true;
+  DataHolder data = {base, 0.0};
 
-  base->m_currentFile = CURL(m_strFileA).GetFileNameWithoutPath();
-  base->m_currentOperation = GetActionString(m_action);
+  {
+    CSingleLock lock(base->m_section);
+    base->m_currentFile = CURL(m_strFileA).GetFileNameWithoutPath();
+    base->m_currentOperation = GetActionString(m_action);
 
-  if (base->ShouldCancel((unsigned)current, 100))
-    return false;
+    double current = base->GetDone() * base->m_opWeight;
+    if (base->ShouldCancel((unsigned)current, 100))
+      return false;
 
-  if (base->m_handle)
-  {
-    base->m_handle->SetText(base->GetCurrentFile());
-    base->m_handle->SetPercentage((float)current);
-  }
+    if (base->m_handle)
+    {
+      base->m_handle->SetText(base->GetCurrentFile());
+      base->m_handle->SetPercentage((float)current);
+    }
 
-  DataHolder data = {base, current, opWeight};
+    base->m_running.push_back(&data);
+  }
 
   switch (m_action)
   {
@@ -305,7 +391,9 @@ bool CFileOperationJob::CFileOperation::ExecuteOperation(CFileOperationJob *base
     break;
   }
 
-  current += (double)m_time * opWeight;
+  CSingleLock lock(base->m_section);
+  base->m_running.erase(find(base->m_running.begin(), base->m_running.end(), &data));
+  base->m_done += m_time;
 
   return bResult;
 }
@@ -330,23 +418,34 @@ void CFileOperationJob::CFileOperation::Debug()
 bool CFileOperationJob::CFileOperation::OnFileCallback(void* pContext, int ipercent, float avgSpeed)
 {
   DataHolder *data = (DataHolder *)pContext;
-  double current = data->current + ((double)ipercent * data->opWeight * (double)m_time)/ 100.0;
+  CFileOperationJob *base = data->base;
+
+  CSingleLock lock(base->m_section);
+  data->done = ((double)ipercent * (double)m_time) / 100.0;
+  double done = base->GetDone();
+  double current = done * base->m_opWeight;
+
+  // files may be copied alongside each other, so report the speed of the job as a whole
+  // rather than that of this file
+  float elapsed = base->m_timer.GetElapsedSeconds();
+  if (elapsed > 0.0f)
+    avgSpeed = (float)(done / elapsed);
 
   if (avgSpeed > 1000000.0f)
-    data->base->m_avgSpeed.Format("%.1f MB/s", avgSpeed / 1000000.0f);
+    base->m_avgSpeed.Format("%.1f MB/s", avgSpeed / 1000000.0f);
   else
-    data->base->m_avgSpeed.Format("%.1f KB/s", avgSpeed / 1000.0f);
+    base->m_avgSpeed.Format("%.1f KB/s", avgSpeed / 1000.0f);
 
-  if (data->base->m_handle)
+  if (base->m_handle)
   {
     CStdString line;
-    line.Format("%s (%s)", data->base->GetCurrentFile().c_str(),
-                           data->base->GetAverageSpeed().c_str());
-    data->base->m_handle->SetText(line);
-    data->base->m_handle->SetPercentage((float)current);
+    line.Format("%s (%s)", base->GetCurrentFile().c_str(),
+                           base->GetAverageSpeed().c_str());
+    base->m_handle->SetText(line);
+    base->m_handle->SetPercentage((float)current);
   }
 
-  return !data->base->ShouldCancel((unsigned)current, 100);
+  return !base->ShouldCancel((unsigned)current, 100);
 }
 
 bool CFileOperationJob::operator==(const CJob* job) const
@@ -23,6 +23,9 @@
 #include "FileItem.h"
 #include "Job.h"
 #include "filesystem/File.h"
+#include "threads/CriticalSection.h"
+#include "threads/Thread.h"
+#include "utils/Stopwatch.h"
 
 class CGUIDialogProgressBarHandle;
 
@@ -62,13 +65,16 @@ public:
   int GetHeading() const                  { return m_heading; }
   int GetLine() const                     { return m_line; }
 private:
+  struct DataHolder;
+
   class CFileOperation : public XFILE::IFileCallback
   {
   public:
     CFileOperation(FileAction action, const CStdString &strFileA, const CStdString &strFileB, int64_t time);
-    bool ExecuteOperation(CFileOperationJob *base, double &current, double opWeight);
+    bool ExecuteOperation(CFileOperationJob *base);
     void Debug();
     virtual bool OnFileCallback(void* pContext, int ipercent, float avgSpeed);
+    FileAction GetAction() const { return m_action; }
   private:
     FileAction m_action;
     CStdString m_strFileA, m_strFileB;
@@ -76,10 +82,32 @@ private:
   };
   friend class CFileOperation;
   typedef std::vector<CFileOperation> FileOperationList;
+
+  /*! \brief Runs the pending operations on an additional thread alongside the job's own
+   */
+  class CRunner : public IRunnable
+  {
+  public:
+    CRunner(CFileOperationJob *base) : m_base(base) {}
+    virtual void Run() { m_base->ExecuteOperations(); }
+  private:
+    CFileOperationJob *m_base;
+  };
+
   bool DoProcess(FileAction action, CFileItemList & items, const CStdString& strDestFile, FileOperationList &fileOperations, double &totalTime);
   bool DoProcessFolder(FileAction action, const CStdString& strPath, const CStdString& strDestFile, FileOperationList &fileOperations, double &totalTime);
   bool DoProcessFile(FileAction action, const CStdString& strFileA, const CStdString& strFileB, FileOperationList &fileOperations, double &totalTime);
 
+  /*! \brief Run the operations [start, end) alongside each other
+   \return false if any of them failed or the job was cancelled
+   */
+  bool RunOperations(FileOperationList &fileOperations, unsigned int start, unsigned int end);
+  void ExecuteOperations();
+
+  /*! \brief Progress of the job, in the units of the operations' times. m_section must be held.
+   */
+  double GetDone() const;
+
   static inline bool CanBeRenamed(const CStdString &strFileA, const CStdString &strFileB);
 
   FileAction m_action;
@@ -90,4 +118,14 @@ private:
   bool m_displayProgress;
   int m_heading;
   int m_line;
+
+  CCriticalSection          m_section;         ///< guards the progress while operations run in parallel
+  FileOperationList        *m_operations;
+  unsigned int              m_nextOperation;
+  unsigned int              m_endOperation;
+  bool                      m_success;
+  double                    m_opWeight;        ///< percentage of the job each unit of time accounts for
+  double                    m_done;            ///< time of the finished operations
+  std::vector<DataHolder *> m_running;         ///< progress of the operations being run
+  CStopWatch                m_timer;
 };
@@ -20,8 +20,10 @@
 
 #include "JobManager.h"
 #include <algorithm>
+#include "threads/Atomics.h"
 #include "threads/SingleLock.h"
 #include "utils/log.h"
+#include "utils/CPUInfo.h"
 
 #include "system.h"
 
@@ -35,9 +37,10 @@ bool CJob::ShouldCancel(unsigned int progress, unsigned int total) const
   return false;
 }
 
-CJobWorker::CJobWorker(CJobManager *manager) : CThread("JobWorker")
+CJobWorker::CJobWorker(CJobManager *manager, unsigned int queue) : CThread("JobWorker")
 {
   m_jobManager = manager;
+  m_queue = queue;
   Create(true); // start work immediately, and kill ourselves when we're done
 }
 
@@ -70,7 +73,7 @@ void CJobWorker::Process()
     {
       CLog::Log(LOGERROR, "%s error processing job %s", __FUNCTION__, job->GetType());
     }
-    m_jobManager->OnJobComplete(success, job);
+    m_jobManager->OnJobComplete(success, job, this);
   }
 }
 
@@ -174,10 +177,28 @@ CJobManager &CJobManager::GetInstance()
 CJobManager::CJobManager()
 {
   m_jobCounter = 0;
+  m_poolSize = GetPoolSize();
+  m_numWorkers = 0;
+  m_processing = 0;
+  m_completed = 0;
   m_running = true;
-  
+
+  for (unsigned int i = 0; i < max_workers; ++i)
+    m_workers[i] = NULL;
+
   for (unsigned int priority = CJob::PRIORITY_LOW; priority <= CJob::PRIORITY_HIGH; ++priority)
+  {
     m_jobPause[priority] = false; // Set this priority to unpaused
+    m_processingPriority[priority] = 0;
+  }
+}
+
+unsigned int CJobManager::GetPoolSize()
+{
+  unsigned int workers = std::max(1, g_cpuInfo.getCPUCount()) + CJob::PRIORITY_HIGH;
+  if (workers < min_workers)
+    return min_workers;
+  return workers < max_workers ? workers : max_workers;
 }
 
 void CJobManager::CancelJobs()
@@ -185,18 +206,44 @@ void CJobManager::CancelJobs()
   CSingleLock lock(m_section);
   m_running = false;
 
-  // clear any pending jobs
-  for (unsigned int priority = CJob::PRIORITY_LOW; priority <= CJob::PRIORITY_HIGH; ++priority)
+  // cancel any pending jobs, and any callbacks on jobs still processing. AddJob() checks
+  // m_running under the index lock, so no jobs are added to a shard we've already been through.
+  for (unsigned int i = 0; i < max_workers; ++i)
   {
-    for_each(m_jobQueue[priority].begin(), m_jobQueue[priority].end(), mem_fun_ref(&CWorkItem::FreeJob));
-    m_jobQueue[priority].clear();
+    CSingleLock indexLock(m_index[i].m_section);
+    JobIndex &jobs = m_index[i].m_jobs;
+    for (JobIndex::iterator j = jobs.begin(); j != jobs.end();)
+    {
+      CWorkItem *item = j->second;
+      CJob *job = item->m_job;
+      if (cas(&item->m_state, CWorkItem::STATE_QUEUED, CWorkItem::STATE_CANCELLED) == CWorkItem::STATE_QUEUED)
+      {
+        delete job;
+        j = jobs.erase(j);
+      }
+      else
+      {
+        item->Cancel();
+        ++j;
+      }
+    }
   }
 
-  // cancel any callbacks on jobs still processing
-  for_each(m_processing.begin(), m_processing.end(), mem_fun_ref(&CWorkItem::Cancel));
+  // everything left in the queues has been cancelled, so discard it
+  for (unsigned int i = 0; i < max_workers; ++i)
+  {
+    CSingleLock queueLock(m_queues[i].m_section);
+    for (unsigned int priority = CJob::PRIORITY_LOW; priority <= CJob::PRIORITY_HIGH; ++priority)
+    {
+      CWorkQueue::Lane &lane = m_queues[i].m_lanes[priority];
+      for (CWorkQueue::Lane::iterator j = lane.begin(); j != lane.end(); ++j)
+        delete *j;
+      lane.clear();
+    }
+  }
 
   // tell our workers to finish
-  while (m_workers.size())
+  while (m_numWorkers)
   {
     lock.Leave();
     m_jobEvent.Set();
@@ -205,89 +252,183 @@ void CJobManager::CancelJobs()
   }
 }
 
+void CJobManager::Restart(unsigned int workers)
+{
+  CSingleLock lock(m_section);
+  if (workers)
+  { // leave every priority at least one worker
+    workers = std::max(workers, (unsigned int)CJob::PRIORITY_HIGH + 1);
+    m_poolSize = workers < max_workers ? workers : max_workers;
+  }
+  else
+    m_poolSize = GetPoolSize();
+  m_running = true;
+}
+
 CJobManager::~CJobManager()
 {
 }
 
 unsigned int CJobManager::AddJob(CJob *job, IJobCallback *callback, CJob::PRIORITY priority)
 {
-  CSingleLock lock(m_section);
-
   if (!m_running)
     return 0;
 
   // increment the job counter, ensuring 0 (invalid job) is never hit
-  m_jobCounter++;
-  if (m_jobCounter == 0)
-    m_jobCounter++;
+  unsigned int id;
+  do
+  {
+    id = (unsigned int)AtomicIncrement(&m_jobCounter);
+  } while (id == 0);
 
   // create a work item for this job
-  CWorkItem work(job, m_jobCounter, priority, callback);
-  m_jobQueue[priority].push_back(work);
+  CWorkItem *work = new CWorkItem(job, id, priority, callback);
+
+  // jobs queued from a job go on that worker's own queue, the rest are spread over all queues
+  CJobWorker *worker = GetCurrentWorker();
+  unsigned int queue = worker ? worker->GetQueue() : id % m_poolSize;
+
+  { // index and queue the job in one go, so CancelJobs() either finds both or we find it stopped
+    CIndexShard &index = GetIndex(id);
+    CSingleLock indexLock(index.m_section);
+    if (!m_running)
+    {
+      delete work;
+      return 0;
+    }
+    index.m_jobs[id] = work;
+
+    CSingleLock queueLock(m_queues[queue].m_section);
+    m_queues[queue].m_lanes[priority].push_back(work);
+  }
 
   StartWorkers(priority);
-  return work.m_id;
+  return id;
 }
 
 void CJobManager::CancelJob(unsigned int jobID)
 {
-  CSingleLock lock(m_section);
+  CIndexShard &index = GetIndex(jobID);
+  CSingleLock lock(index.m_section);
 
-  // check whether we have this job in the queue
-  for (unsigned int priority = CJob::PRIORITY_LOW; priority <= CJob::PRIORITY_HIGH; ++priority)
-  {
-    JobQueue::iterator i = find(m_jobQueue[priority].begin(), m_jobQueue[priority].end(), jobID);
-    if (i != m_jobQueue[priority].end())
-    {
-      delete i->m_job;
-      m_jobQueue[priority].erase(i);
-      return;
-    }
-  }
-  // or if we're processing it
-  Processing::iterator it = find(m_processing.begin(), m_processing.end(), jobID);
-  if (it != m_processing.end())
-    it->m_callback = NULL; // job is in progress, so only thing to do is to remove callback
+  if (CancelQueuedJob(jobID))
+    return;
+
+  // job is in progress, so only thing to do is to remove callback
+  JobIndex::iterator i = index.m_jobs.find(jobID);
+  if (i != index.m_jobs.end())
+    i->second->Cancel();
+}
+
+bool CJobManager::CancelQueuedJob(unsigned int jobID)
+{
+  CIndexShard &index = GetIndex(jobID);
+  CSingleLock lock(index.m_section);
+
+  JobIndex::iterator i = index.m_jobs.find(jobID);
+  if (i == index.m_jobs.end())
+    return false;
+
+  CWorkItem *item = i->second;
+  CJob *job = item->m_job;
+  // if the job is still queued, it's ours to delete. The worker that comes across the
+  // item in its queue will discard it, so we mustn't touch the item after this.
+  if (cas(&item->m_state, CWorkItem::STATE_QUEUED, CWorkItem::STATE_CANCELLED) != CWorkItem::STATE_QUEUED)
+    return false;
+
+  index.m_jobs.erase(i);
+  delete job;
+  return true;
 }
 
 void CJobManager::StartWorkers(CJob::PRIORITY priority)
 {
-  CSingleLock lock(m_section);
+  // always wake a worker - one that found no job but hasn't gone to sleep yet still
+  // counts as processing, and would otherwise sleep with this job queued
+  m_jobEvent.Set();
 
   // check how many free threads we have
-  if (m_processing.size() >= GetMaxWorkers(priority))
+  if ((unsigned int)m_processing >= GetMaxWorkers(priority))
     return;
 
   // do we have any sleeping threads?
-  if (m_processing.size() < m_workers.size())
-  {
-    m_jobEvent.Set();
+  if ((unsigned int)m_processing < m_numWorkers)
+    return;
+
+  CSingleLock lock(m_section);
+  if ((unsigned int)m_processing < m_numWorkers)
     return;
-  }
 
   // everyone is busy - we need more workers
-  m_workers.push_back(new CJobWorker(this));
+  for (unsigned int i = 0; i < m_poolSize; ++i)
+  {
+    if (!m_workers[i])
+    {
+      m_workers[i] = new CJobWorker(this, i);
+      m_numWorkers++;
+      return;
+    }
+  }
 }
 
-CJob *CJobManager::PopJob()
+bool CJobManager::ReserveWorker(CJob::PRIORITY priority)
 {
-  CSingleLock lock(m_section);
+  long maxWorkers = GetMaxWorkers(priority);
+  while (true)
+  {
+    long processing = m_processing;
+    if (processing >= maxWorkers)
+      return false;
+    if (cas(&m_processing, processing, processing + 1) == processing)
+      return true;
+  }
+}
+
+CJobManager::CWorkItem *CJobManager::PopItem(CWorkQueue &queue, CJob::PRIORITY priority)
+{
+  CSingleLock lock(queue.m_section);
+  CWorkQueue::Lane &lane = queue.m_lanes[priority];
+  while (!lane.empty())
+  {
+    CWorkItem *item = lane.front();
+    lane.pop_front();
+    if (cas(&item->m_state, CWorkItem::STATE_QUEUED, CWorkItem::STATE_PROCESSING) == CWorkItem::STATE_QUEUED)
+      return item;
+    // cancelled while queued - CancelJob() has already deleted the job
+    delete item;
+  }
+  return NULL;
+}
+
+CJob *CJobManager::PopJob(CJobWorker *worker)
+{
+  unsigned int own = worker->GetQueue();
+  unsigned int queues = m_poolSize;
   for (int priority = CJob::PRIORITY_HIGH; priority >= CJob::PRIORITY_LOW; --priority)
   {
     if (m_jobPause[priority]) // In case this priority is paused, skip it
       continue;
 
-    if (m_jobQueue[priority].size() && m_processing.size() < GetMaxWorkers(CJob::PRIORITY(priority)))
+    if (!ReserveWorker(CJob::PRIORITY(priority)))
+      continue;
+
+    // take from our own queue first, and steal from our siblings if it's empty
+    CWorkItem *item = PopItem(m_queues[own], CJob::PRIORITY(priority));
+    for (unsigned int i = 1; !item && i < queues; ++i)
+      item = PopItem(m_queues[(own + i) % queues], CJob::PRIORITY(priority));
+
+    if (!item)
     {
-      // pop the job off the queue
-      CWorkItem job = m_jobQueue[priority].front();
-      m_jobQueue[priority].pop_front();
-
-      // add to the processing vector
-      m_processing.push_back(job);
-      job.m_job->m_callback = this;
-      return job.m_job;
+      AtomicDecrement(&m_processing);
+      continue;
     }
+
+    AtomicIncrement(&m_processingPriority[priority]);
+
+    CSingleLock lock(m_queues[own].m_section);
+    m_queues[own].m_current = item;
+    item->m_job->m_callback = this;
+    return item->m_job;
   }
   return NULL;
 }
@@ -302,6 +443,9 @@ void CJobManager::UnPause(const CJob::PRIORITY &priority)
 {
   CSingleLock lock(m_section);
   m_jobPause[priority] = false;
+  // wake a worker in case jobs were queued while we were paused
+  if (m_numWorkers)
+    m_jobEvent.Set();
 }
 
 bool CJobManager::IsPaused(const CJob::PRIORITY &priority) const
@@ -312,49 +456,43 @@ bool CJobManager::IsPaused(const CJob::PRIORITY &priority) const
 
 bool CJobManager::IsProcessing(const CJob::PRIORITY &priority) const
 {
-  CSingleLock lock(m_section);
-
-  for(Processing::const_iterator it = m_processing.begin(); it < m_processing.end(); it++)
-  {
-    if (priority == it->m_priority)
-      return true;
-  }
-  return false;
+  return m_processingPriority[priority] > 0;
 }
 
 int CJobManager::IsProcessing(const std::string &pausedType) const
 {
   int jobsMatched = 0;
-  CSingleLock lock(m_section);
-  for(Processing::const_iterator it = m_processing.begin(); it < m_processing.end(); it++)
+  for (unsigned int i = 0; i < m_poolSize; ++i)
   {
-    if (pausedType == std::string(it->m_job->GetType()))
+    CSingleLock lock(m_queues[i].m_section);
+    const CWorkItem *current = m_queues[i].m_current;
+    if (current && pausedType == std::string(current->m_job->GetType()))
       jobsMatched++;
   }
   return jobsMatched;
 }
 
-CJob *CJobManager::GetNextJob(const CJobWorker *worker)
+unsigned int CJobManager::GetCompletedJobs() const
+{
+  return (unsigned int)m_completed;
+}
+
+CJob *CJobManager::GetNextJob(CJobWorker *worker)
 {
-  CSingleLock lock(m_section);
   while (m_running)
   {
-    // grab a job off the queue if we have one
-    CJob *job = PopJob();
+    // grab a job off the queues if we have one
+    CJob *job = PopJob(worker);
     if (job)
+    {
+      // we may have been woken for several jobs at once, so pass the wakeup on
+      if ((unsigned int)m_processing < m_numWorkers)
+        m_jobEvent.Set();
       return job;
-    // no jobs are left - sleep for 30 seconds to allow new jobs to come in
-    lock.Leave();
-    bool newJob = m_jobEvent.WaitMSec(30000);
-    lock.Enter();
-    if (!newJob)
-      break;
+    }
+    // no jobs are left - sleep until new jobs come in
+    m_jobEvent.WaitMSec(30000);
   }
-  // ensure no jobs have come in during the period after
-  // timeout and before we held the lock
-  CJob *job = PopJob();
-  if (job)
-    return job;
   // have no jobs
   RemoveWorker(worker);
   return NULL;
@@ -362,61 +500,96 @@ CJob *CJobManager::GetNextJob(const CJobWorker *worker)
 
 bool CJobManager::OnJobProgress(unsigned int progress, unsigned int total, const CJob *job) const
 {
-  CSingleLock lock(m_section);
-  // find the job in the processing queue, and check whether it's cancelled (no callback)
-  Processing::const_iterator i = find(m_processing.begin(), m_processing.end(), job);
-  if (i != m_processing.end())
+  // find the job amongst those processing, starting with the calling worker's
+  CJobWorker *worker = GetCurrentWorker();
+  unsigned int first = worker ? worker->GetQueue() : 0;
+  unsigned int queues = m_poolSize;
+  unsigned int id = 0;
+  for (unsigned int i = 0; !id && i < queues; ++i)
   {
-    CWorkItem item(*i);
-    lock.Leave(); // leave section prior to call
-    if (item.m_callback)
-    {
-      item.m_callback->OnJobProgress(item.m_id, progress, total, job);
-      return false;
-    }
+    const CWorkQueue &queue = m_queues[(first + i) % queues];
+    CSingleLock lock(queue.m_section);
+    if (queue.m_current && queue.m_current->m_job == job)
+      id = queue.m_current->m_id;
+  }
+  if (!id)
+    return true; // couldn't find the job
+
+  // check whether it's cancelled (no callback)
+  const CIndexShard &index = GetIndex(id);
+  CSingleLock lock(index.m_section);
+  JobIndex::const_iterator i = index.m_jobs.find(id);
+  if (i == index.m_jobs.end())
+    return true;
+  CWorkItem item(*i->second);
+  lock.Leave(); // leave section prior to call
+  if (item.m_callback)
+  {
+    item.m_callback->OnJobProgress(item.m_id, progress, total, job);
+    return false;
   }
-  return true; // couldn't find the job, or it's been cancelled
+  return true; // it's been cancelled
 }
 
-void CJobManager::OnJobComplete(bool success, CJob *job)
+void CJobManager::OnJobComplete(bool success, CJob *job, CJobWorker *worker)
 {
-  CSingleLock lock(m_section);
-  // remove the job from the processing queue
-  Processing::iterator i = find(m_processing.begin(), m_processing.end(), job);
-  if (i != m_processing.end())
+  // only this worker sets its current item, so it can be read without the lock
+  CWorkQueue &own = m_queues[worker->GetQueue()];
+  CWorkItem *work = own.m_current;
+  if (!work || work->m_job != job)
+    return;
+
+  // tell any listeners we're done with the job, then delete it
+  CIndexShard &index = GetIndex(work->m_id);
+  CSingleLock lock(index.m_section);
+  CWorkItem item(*work);
+  lock.Leave();
+  try
   {
-    // tell any listeners we're done with the job, then delete it
-    CWorkItem item(*i);
-    lock.Leave();
-    try
-    {
-      if (item.m_callback)
-        item.m_callback->OnJobComplete(item.m_id, success, item.m_job);
-    }
-    catch (...)
-    {
-      CLog::Log(LOGERROR, "%s error processing job %s", __FUNCTION__, item.m_job->GetType());
-    }
-    lock.Enter();
-    Processing::iterator j = find(m_processing.begin(), m_processing.end(), job);
-    if (j != m_processing.end())
-      m_processing.erase(j);
-    lock.Leave();
-    item.FreeJob();
+    if (item.m_callback)
+      item.m_callback->OnJobComplete(item.m_id, success, item.m_job);
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s error processing job %s", __FUNCTION__, item.m_job->GetType());
+  }
+  lock.Enter();
+  index.m_jobs.erase(work->m_id);
+  lock.Leave();
+
+  {
+    CSingleLock ownLock(own.m_section);
+    own.m_current = NULL;
   }
+  AtomicDecrement(&m_processingPriority[work->m_priority]);
+  AtomicDecrement(&m_processing);
+  AtomicIncrement(&m_completed);
+  work->FreeJob();
+  delete work;
 }
 
 void CJobManager::RemoveWorker(const CJobWorker *worker)
 {
   CSingleLock lock(m_section);
   // remove our worker
-  Workers::iterator i = find(m_workers.begin(), m_workers.end(), worker);
-  if (i != m_workers.end())
-    m_workers.erase(i); // workers auto-delete
+  for (unsigned int i = 0; i < max_workers; ++i)
+  {
+    if (m_workers[i] == worker)
+    {
+      m_workers[i] = NULL; // workers auto-delete
+      m_numWorkers--;
+      return;
+    }
+  }
 }
 
 unsigned int CJobManager::GetMaxWorkers(CJob::PRIORITY priority) const
 {
-  static const unsigned int max_workers = 5;
-  return max_workers - (CJob::PRIORITY_HIGH - priority);
+  return m_poolSize - (CJob::PRIORITY_HIGH - priority);
+}
+
+CJobWorker *CJobManager::GetCurrentWorker() const
+{
+  CJobWorker *worker = dynamic_cast<CJobWorker *>(CThread::GetCurrentThread());
+  return worker && worker->GetManager() == this ? worker : NULL;
 }
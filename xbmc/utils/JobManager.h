@@ -22,6 +22,7 @@
 #include <queue>
 #include <vector>
 #include <string>
+#include <boost/unordered_map.hpp>
 #include "threads/CriticalSection.h"
 #include "threads/Thread.h"
 #include "Job.h"
@@ -31,12 +32,19 @@ class CJobManager;
 class CJobWorker : public CThread
 {
 public:
-  CJobWorker(CJobManager *manager);
+  CJobWorker(CJobManager *manager, unsigned int queue);
   virtual ~CJobWorker();
 
   void Process();
+
+  /*! \brief index of the work queue owned by this worker */
+  unsigned int GetQueue() const { return m_queue; };
+
+  /*! \brief the job manager this worker takes its jobs from */
+  const CJobManager *GetManager() const { return m_jobManager; };
 private:
   CJobManager  *m_jobManager;
+  unsigned int  m_queue;
 };
 
 /*!
@@ -165,6 +173,14 @@ private:
  priority levels.  Lower priority jobs are executed only if there are sufficient
  spare worker threads free to allow for higher priority jobs that may arise.
 
+ Workers are kept in a persistent pool, sized by the number of cores, each owning a work
+ queue with one lane per priority.  New jobs are spread over the queues (or pushed on the
+ calling worker's own queue), and an idle worker steals from its siblings before going to
+ sleep.  Jobs are indexed by id so that cancellation and progress checks do not scan the
+ queues.  The index is split into shards by id, each with its own lock, so adding, running and
+ completing a job only takes the locks of the shard and queues involved; the manager's own lock
+ is left to pausing, cancelling and starting or stopping workers.
+
  \sa CJob and IJobCallback
  */
 class CJobManager
@@ -172,12 +188,19 @@ class CJobManager
   class CWorkItem
   {
   public:
+    enum STATE
+    {
+      STATE_QUEUED = 0,
+      STATE_PROCESSING,
+      STATE_CANCELLED
+    };
     CWorkItem(CJob *job, unsigned int id, CJob::PRIORITY priority, IJobCallback *callback)
     {
       m_job = job;
       m_id = id;
       m_callback = callback;
       m_priority = priority;
+      m_state = STATE_QUEUED;
     }
     bool operator==(unsigned int jobID) const
     {
@@ -200,6 +223,35 @@ class CJobManager
     unsigned int  m_id;
     IJobCallback *m_callback;
     CJob::PRIORITY m_priority;
+    volatile long m_state;  ///< STATE, changed with cas() as workers and CancelJob() race for queued items
+  };
+
+  typedef boost::unordered_map<unsigned int, CWorkItem*> JobIndex;
+
+  /*!
+   \brief A worker's queue of pending jobs, one lane per priority.
+   Each queue has its own lock, so the owning worker only contends with thieves and producers
+   that happen to pick the same queue. The lock also guards the item its worker is processing.
+   */
+  class CWorkQueue
+  {
+  public:
+    CWorkQueue() : m_current(NULL) {}
+    typedef std::deque<CWorkItem*> Lane;
+    Lane             m_lanes[CJob::PRIORITY_HIGH+1];
+    CWorkItem       *m_current;  ///< the item this queue's worker is processing
+    CCriticalSection m_section;
+  };
+
+  /*!
+   \brief A share of the job index, holding the jobs whose id maps to it.
+   Its lock may be held while taking a queue's lock, but not the other way around.
+   */
+  class CIndexShard
+  {
+  public:
+    JobIndex         m_jobs;
+    CCriticalSection m_section;
   };
 
 public:
@@ -226,6 +278,15 @@ public:
    */
   void CancelJob(unsigned int jobID);
 
+  /*!
+   \brief Cancel a job with the given id if it hasn't started processing.
+   Used to requeue a job at a different priority without losing work already in progress.
+   \param jobID the id of the job to cancel, retrieved previously from AddJob()
+   \return true if the job was still queued and has been cancelled, false if it is processing or unknown.
+   \sa CancelJob()
+   */
+  bool CancelQueuedJob(unsigned int jobID);
+
   /*!
    \brief Cancel all remaining jobs, preparing for shutdown
    Should be called prior to destroying any objects that may be being used as callbacks
@@ -233,6 +294,14 @@ public:
    */
   void CancelJobs();
 
+  /*!
+   \brief Re-start accepting jobs after CancelJobs()
+   Typically only used during testing.
+   \param workers the size of the worker pool, 0 to size it by the number of cores.
+   \sa CancelJobs()
+   */
+  void Restart(unsigned int workers = 0);
+
   /*!
    \brief Checks to see if any jobs of a specific type are currently processing.
    \param pausedType Job type to search for
@@ -272,6 +341,13 @@ public:
    */
   bool IsProcessing(const CJob::PRIORITY &priority) const;
 
+  /*!
+   \brief Retrieve the number of jobs that have been completed since startup.
+   Mainly useful to measure the throughput of the job manager.
+   \return the number of completed jobs.
+   */
+  unsigned int GetCompletedJobs() const;
+
 protected:
   friend class CJobWorker;
   friend class CJob;
@@ -281,16 +357,17 @@ protected:
    \param worker a pointer to the current CJobWorker instance requesting a job.
    \sa CJob
    */
-  CJob *GetNextJob(const CJobWorker *worker);
+  CJob *GetNextJob(CJobWorker *worker);
 
   /*!
    \brief Callback from CJobWorker after a job has completed.
    Calls IJobCallback::OnJobComplete(), and then destroys job.
    \param job a pointer to the calling subclassed CJob instance.
    \param success the result from the DoWork call
+   \param worker a pointer to the CJobWorker instance that processed the job.
    \sa IJobCallback, CJob
    */
-  void  OnJobComplete(bool success, CJob *job);
+  void  OnJobComplete(bool success, CJob *job, CJobWorker *worker);
 
   /*!
    \brief Callback from CJob to report progress and check for cancellation.
@@ -310,27 +387,58 @@ private:
   CJobManager const& operator=(CJobManager const&);
   virtual ~CJobManager();
 
-  /*! \brief Pop a job off the job queue and add to the processing queue ready to process
+  /*! \brief Pop a job off the worker's own queue, or steal one from a sibling, and mark it as processing
+   \param worker the worker that is to process the job.
    \return the job to process, NULL if no jobs are available
    */
-  CJob *PopJob();
+  CJob *PopJob(CJobWorker *worker);
+
+  /*! \brief The share of the job index holding a job
+   */
+  CIndexShard &GetIndex(unsigned int jobID) { return m_index[jobID % max_workers]; }
+  const CIndexShard &GetIndex(unsigned int jobID) const { return m_index[jobID % max_workers]; }
+
+  /*! \brief The worker of this manager running on the calling thread
+   \return the worker, NULL if called from any other thread
+   */
+  CJobWorker *GetCurrentWorker() const;
+
+  /*! \brief Pop the first job still queued on a lane of the given queue
+   Items that were cancelled while queued are discarded along the way.
+   \return the work item, NULL if the lane holds no queued jobs
+   */
+  CWorkItem *PopItem(CWorkQueue &queue, CJob::PRIORITY priority);
+
+  /*! \brief Reserve a processing slot for the given priority
+   \return true if the slot was reserved, false if too many jobs are already processing
+   */
+  bool ReserveWorker(CJob::PRIORITY priority);
 
   void StartWorkers(CJob::PRIORITY priority);
   void RemoveWorker(const CJobWorker *worker);
   unsigned int GetMaxWorkers(CJob::PRIORITY priority) const;
 
-  unsigned int m_jobCounter;
+  /*! \brief The size of the worker pool for the number of cores
+   Low priority jobs may use all cores, and each higher priority gets one more worker.
+   */
+  static unsigned int GetPoolSize();
 
-  typedef std::deque<CWorkItem>    JobQueue;
-  typedef std::vector<CWorkItem>   Processing;
-  typedef std::vector<CJobWorker*> Workers;
+  static const unsigned int min_workers = 5;
+  static const unsigned int max_workers = 32;
 
-  JobQueue   m_jobQueue[CJob::PRIORITY_HIGH+1];
-  bool       m_jobPause[CJob::PRIORITY_HIGH+1];
-  Processing m_processing;
-  Workers    m_workers;
+  volatile long m_jobCounter;
 
-  CCriticalSection m_section;
+  CIndexShard   m_index[max_workers];             ///< all queued and processing jobs, by id
+  CWorkQueue    m_queues[max_workers];            ///< work queue per worker, the first m_poolSize are used
+  CJobWorker   *m_workers[max_workers];           ///< the worker pool, started on demand
+  unsigned int  m_poolSize;                       ///< number of workers in the pool
+  unsigned int  m_numWorkers;
+  volatile bool m_jobPause[CJob::PRIORITY_HIGH+1];
+  volatile long m_processing;                     ///< number of jobs processing
+  volatile long m_processingPriority[CJob::PRIORITY_HIGH+1];
+  volatile long m_completed;
+
+  CCriticalSection m_section;                     ///< guards pausing, cancelling and the workers
   CEvent           m_jobEvent;
-  bool             m_running;
+  volatile bool    m_running;
 };
@@ -21,6 +21,7 @@
 #include "utils/FileOperationJob.h"
 #include "filesystem/File.h"
 #include "filesystem/Directory.h"
+#include "utils/StringUtils.h"
 #include "utils/URIUtils.h"
 
 #include "test/TestUtils.h"
@@ -299,3 +300,120 @@ TEST(TestFileOperationJob, GetFunctions)
   EXPECT_TRUE(XFILE::CFile::Delete(destfile));
   EXPECT_TRUE(XFILE::CDirectory::Remove(destpath));
 }
+
+static bool WriteTextFile(const CStdString &path, const CStdString &text)
+{
+  XFILE::CFile file;
+  if (!file.OpenForWrite(path, true))
+    return false;
+  bool result = file.Write(text.c_str(), text.size()) == (int)text.size();
+  file.Close();
+  return result;
+}
+
+static CStdString ReadTextFile(const CStdString &path)
+{
+  XFILE::CFile file;
+  char buf[256];
+  if (!file.Open(path))
+    return "";
+  int size = file.Read(buf, sizeof(buf));
+  return CStdString(buf, size > 0 ? size : 0);
+}
+
+/* a folder holding a few files and a subfolder with more, enough for the
+   files to be copied alongside each other while the folders have to wait */
+static const char *treeFiles[] = { "a", "b", "c", "d", "sub/e", "sub/f", "sub/g" };
+
+static bool WriteTree(const CStdString &root, const CStdString &tag)
+{
+  if (!XFILE::CDirectory::Create(root) ||
+      !XFILE::CDirectory::Create(URIUtils::AddFileToFolder(root, "sub")))
+    return false;
+  for (unsigned int i = 0; i < sizeof(treeFiles) / sizeof(treeFiles[0]); i++)
+  {
+    if (!WriteTextFile(URIUtils::AddFileToFolder(root, treeFiles[i]), CStdString(treeFiles[i]) + tag))
+      return false;
+  }
+  return true;
+}
+
+static bool CheckTree(const CStdString &root, const CStdString &tag)
+{
+  for (unsigned int i = 0; i < sizeof(treeFiles) / sizeof(treeFiles[0]); i++)
+  {
+    if (ReadTextFile(URIUtils::AddFileToFolder(root, treeFiles[i])) != CStdString(treeFiles[i]) + tag)
+      return false;
+  }
+  return true;
+}
+
+static void SetFolderItem(CFileItemList &items, const CStdString &path)
+{
+  CStdString folder(path);
+  URIUtils::AddSlashAtEnd(folder);
+  CFileItemPtr item(new CFileItem(folder, true));
+  item->Select(true);
+  items.Clear();
+  items.Add(item);
+}
+
+TEST(TestFileOperationJob, Folders)
+{
+  XFILE::CFile *tmpfile;
+  CStdString tmpfilepath;
+  CFileItemList items;
+  CFileOperationJob job;
+
+  ASSERT_TRUE((tmpfile = XBMC_CREATETEMPFILE("")));
+  tmpfilepath = XBMC_TEMPFILEPATH(tmpfile);
+  tmpfile->Close();
+
+  CStdString srcpath = tmpfilepath + ".src";
+  CStdString destpath = tmpfilepath + ".folders";
+  CStdString destfolder = URIUtils::AddFileToFolder(destpath, URIUtils::GetFileName(srcpath));
+  ASSERT_TRUE(WriteTree(srcpath, "1"));
+  ASSERT_TRUE(XFILE::CDirectory::Create(destpath));
+
+  // the folders have to be created before the files are copied into them
+  SetFolderItem(items, srcpath);
+  job.SetFileOperation(CFileOperationJob::ActionCopy, items, destpath);
+  EXPECT_TRUE(job.DoWork());
+  EXPECT_TRUE(CheckTree(destfolder, "1"));
+
+  // the old files are deleted before the new ones are copied over them
+  ASSERT_TRUE(WriteTree(srcpath, "2"));
+  job.SetFileOperation(CFileOperationJob::ActionReplace, items, destpath);
+  EXPECT_TRUE(job.DoWork());
+  EXPECT_TRUE(CheckTree(destfolder, "2"));
+
+  // and without a folder in between, only the change of action holds the copies back
+  ASSERT_TRUE(WriteTree(srcpath, "3"));
+  SetFolderItem(items, URIUtils::AddFileToFolder(srcpath, "sub"));
+  job.SetFileOperation(CFileOperationJob::ActionReplace, items, destfolder);
+  EXPECT_TRUE(job.DoWork());
+  for (unsigned int i = 0; i < sizeof(treeFiles) / sizeof(treeFiles[0]); i++)
+  {
+    CStdString tag = StringUtils::StartsWith(treeFiles[i], "sub/") ? "3" : "2";
+    EXPECT_EQ(CStdString(treeFiles[i]) + tag, ReadTextFile(URIUtils::AddFileToFolder(destfolder, treeFiles[i])));
+  }
+
+  // the files are deleted before the folders holding them
+  SetFolderItem(items, destfolder);
+  job.SetFileOperation(CFileOperationJob::ActionDelete, items, "");
+  EXPECT_TRUE(job.DoWork());
+  EXPECT_FALSE(XFILE::CDirectory::Exists(destfolder));
+
+  // and moved out of the folders before those are removed
+  SetFolderItem(items, srcpath);
+  job.SetFileOperation(CFileOperationJob::ActionMove, items, destpath);
+  EXPECT_TRUE(job.DoWork());
+  EXPECT_TRUE(CheckTree(destfolder, "3"));
+  EXPECT_FALSE(XFILE::CDirectory::Exists(srcpath));
+
+  SetFolderItem(items, destfolder);
+  job.SetFileOperation(CFileOperationJob::ActionDelete, items, "");
+  EXPECT_TRUE(job.DoWork());
+  EXPECT_TRUE(XFILE::CDirectory::Remove(destpath));
+  EXPECT_TRUE(XBMC_DELETETEMPFILE(tmpfile));
+}
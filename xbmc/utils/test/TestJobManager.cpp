@@ -21,9 +21,44 @@
 #include "utils/JobManager.h"
 #include "settings/Settings.h"
 #include "utils/SystemInfo.h"
+#include "utils/CPUInfo.h"
+#include "threads/Atomics.h"
+#include "threads/SystemClock.h"
 
 #include "gtest/gtest.h"
 
+#include <iostream>
+
+/* Trivial job used to measure the overhead of the job manager itself. */
+class CCountingJob : public CJob
+{
+public:
+  CCountingJob(volatile long *counter) : m_counter(counter) {}
+  virtual bool DoWork()
+  {
+    AtomicIncrement(m_counter);
+    return true;
+  }
+private:
+  volatile long *m_counter;
+};
+
+class CJobProducer : public IRunnable
+{
+public:
+  CJobProducer(unsigned int jobs, CJob::PRIORITY priority, volatile long *counter)
+    : m_jobs(jobs), m_priority(priority), m_counter(counter) {}
+  virtual void Run()
+  {
+    for (unsigned int i = 0; i < m_jobs; i++)
+      CJobManager::GetInstance().AddJob(new CCountingJob(m_counter), NULL, m_priority);
+  }
+private:
+  unsigned int m_jobs;
+  CJob::PRIORITY m_priority;
+  volatile long *m_counter;
+};
+
 /* CSysInfoJob::GetInternetState() will test for network connectivity. */
 class TestJobManager : public testing::Test
 {
@@ -48,10 +83,78 @@ protected:
 
   ~TestJobManager()
   {
+    /* each test gets a running job manager without leftovers from the others */
+    CJobManager::GetInstance().CancelJobs();
+    CJobManager::GetInstance().Restart();
     CSettings::Get().Unload();
   }
 };
 
+/* Throughput benchmark, reported as jobs/s for 1 up to (number of cores) workers running
+ * low priority jobs, each fed by 1 up to (number of cores) producers.
+ */
+TEST_F(TestJobManager, Throughput)
+{
+  static const unsigned int jobsPerRun = 20000;
+  unsigned int cores = std::max(1, g_cpuInfo.getCPUCount());
+
+  for (unsigned int workers = 1; workers <= cores; workers *= 2)
+  {
+    for (unsigned int producers = 1; producers <= cores; producers *= 2)
+    {
+      // the pool keeps a worker per priority above low on top of these
+      CJobManager::GetInstance().CancelJobs();
+      CJobManager::GetInstance().Restart(workers + CJob::PRIORITY_HIGH);
+
+      volatile long counter = 0;
+      std::vector<CThread*> threads;
+      std::vector<CJobProducer*> runnables;
+
+      unsigned int start = XbmcThreads::SystemClockMillis();
+      for (unsigned int i = 0; i < producers; i++)
+      {
+        CJobProducer *producer = new CJobProducer(jobsPerRun / producers, CJob::PRIORITY_LOW, &counter);
+        CThread *thread = new CThread(producer, "JobProducer");
+        thread->Create();
+        runnables.push_back(producer);
+        threads.push_back(thread);
+      }
+
+      long expected = (jobsPerRun / producers) * producers;
+      while (counter < expected && XbmcThreads::SystemClockMillis() - start < 60000)
+        XbmcThreads::ThreadSleep(1);
+      unsigned int elapsed = std::max(1u, XbmcThreads::SystemClockMillis() - start);
+
+      for (unsigned int i = 0; i < producers; i++)
+      {
+        threads[i]->WaitForThreadExit((unsigned int)-1);
+        delete threads[i];
+        delete runnables[i];
+      }
+
+      EXPECT_EQ(expected, counter);
+      std::cout << workers << " worker(s), " << producers << " producer(s), " << cores << " core(s): "
+                << (expected * 1000 / elapsed) << " jobs/s" << std::endl;
+    }
+  }
+}
+
+TEST_F(TestJobManager, CancelQueuedJob)
+{
+  volatile long counter = 0;
+
+  // jobs at a paused priority stay queued
+  CJobManager::GetInstance().Pause(CJob::PRIORITY_LOW);
+  unsigned int id = CJobManager::GetInstance().AddJob(new CCountingJob(&counter), NULL, CJob::PRIORITY_LOW);
+  EXPECT_NE(0u, id);
+  EXPECT_TRUE(CJobManager::GetInstance().CancelQueuedJob(id));
+  EXPECT_FALSE(CJobManager::GetInstance().CancelQueuedJob(id));
+  CJobManager::GetInstance().UnPause(CJob::PRIORITY_LOW);
+
+  XbmcThreads::ThreadSleep(50);
+  EXPECT_EQ(0, counter);
+}
+
 TEST_F(TestJobManager, AddJob)
 {
   CJob* job = new CSysInfoJob();
@@ -466,10 +466,8 @@ void CVideoDatabase::CreateViews()
 //********************************************************************************************************************************
 int CVideoDatabase::GetPathId(const CStdString& strPath)
 {
-  CStdString strSQL;
   try
   {
-    int idPath=-1;
     if (NULL == m_pDB.get()) return -1;
     if (NULL == m_pDS.get()) return -1;
 
@@ -479,17 +477,12 @@ int CVideoDatabase::GetPathId(const CStdString& strPath)
 
     URIUtils::AddSlashAtEnd(strPath1);
 
-    strSQL=PrepareSQL("select idPath from path where strPath='%s'",strPath1.c_str());
-    m_pDS->query(strSQL.c_str());
-    if (!m_pDS->eof())
-      idPath = m_pDS->fv("path.idPath").get_asInt();
-
-    m_pDS->close();
-    return idPath;
+    std::string idPath = GetSinglePreparedValue("select idPath from path where strPath=?", Params().Add(strPath1));
+    return idPath.empty() ? -1 : atoi(idPath.c_str());
   }
   catch (...)
   {
-    CLog::Log(LOGERROR, "%s unable to getpath (%s)", __FUNCTION__, strSQL.c_str());
+    CLog::Log(LOGERROR, "%s unable to getpath (%s)", __FUNCTION__, strPath.c_str());
   }
   return -1;
 }
@@ -602,6 +595,14 @@ int CVideoDatabase::RunQuery(const CStdString &sql)
   return rows;
 }
 
+bool CVideoDatabase::RunCursorQuery(const CStdString &sql)
+{
+  unsigned int time = XbmcThreads::SystemClockMillis();
+  bool ret = m_pDS->query_cursor(sql);
+  CLog::Log(LOGDEBUG, "%s took %d ms to open query: %s", __FUNCTION__, XbmcThreads::SystemClockMillis() - time, sql.c_str());
+  return ret;
+}
+
 bool CVideoDatabase::GetSubPaths(const CStdString &basepath, vector< pair<int,string> >& subpaths)
 {
   CStdString sql;
@@ -631,7 +632,6 @@ bool CVideoDatabase::GetSubPaths(const CStdString &basepath, vector< pair<int,st
 
 int CVideoDatabase::AddPath(const CStdString& strPath, const CStdString &strDateAdded /*= "" */)
 {
-  CStdString strSQL;
   try
   {
     int idPath = GetPathId(strPath);
@@ -648,17 +648,21 @@ int CVideoDatabase::AddPath(const CStdString& strPath, const CStdString &strDate
     URIUtils::AddSlashAtEnd(strPath1);
 
     // only set dateadded if we got one
+    bool added;
     if (!strDateAdded.empty())
-      strSQL=PrepareSQL("insert into path (idPath, strPath, strContent, strScraper, dateAdded) values (NULL,'%s','','', '%s')", strPath1.c_str(), strDateAdded.c_str());
+      added = ExecutePreparedQuery("insert into path (idPath, strPath, strContent, strScraper, dateAdded) values (NULL,?,'','',?)",
+                                   Params().Add(strPath1).Add(strDateAdded));
     else
-      strSQL=PrepareSQL("insert into path (idPath, strPath, strContent, strScraper) values (NULL,'%s','','')", strPath1.c_str());
-    m_pDS->exec(strSQL.c_str());
+      added = ExecutePreparedQuery("insert into path (idPath, strPath, strContent, strScraper) values (NULL,?,'','')",
+                                   Params().Add(strPath1));
+    if (!added)
+      return -1;
     idPath = (int)m_pDS->lastinsertid();
     return idPath;
   }
   catch (...)
   {
-    CLog::Log(LOGERROR, "%s unable to addpath (%s)", __FUNCTION__, strSQL.c_str());
+    CLog::Log(LOGERROR, "%s unable to addpath (%s)", __FUNCTION__, strPath.c_str());
   }
   return -1;
 }
@@ -688,7 +692,6 @@ bool CVideoDatabase::GetPathHash(const CStdString &path, CStdString &hash)
 //********************************************************************************************************************************
 int CVideoDatabase::AddFile(const CStdString& strFileNameAndPath)
 {
-  CStdString strSQL = "";
   try
   {
     int idFile;
@@ -702,25 +705,20 @@ int CVideoDatabase::AddFile(const CStdString& strFileNameAndPath)
     if (idPath < 0)
       return -1;
 
-    CStdString strSQL=PrepareSQL("select idFile from files where strFileName='%s' and idPath=%i", strFileName.c_str(),idPath);
-
-    m_pDS->query(strSQL.c_str());
-    if (m_pDS->num_rows() > 0)
-    {
-      idFile = m_pDS->fv("idFile").get_asInt() ;
-      m_pDS->close();
-      return idFile;
-    }
-    m_pDS->close();
+    std::string file = GetSinglePreparedValue("select idFile from files where strFileName=? and idPath=?",
+                                              Params().Add(strFileName).Add(idPath));
+    if (!file.empty())
+      return atoi(file.c_str());
 
-    strSQL=PrepareSQL("insert into files (idFile, idPath, strFileName) values(NULL, %i, '%s')", idPath, strFileName.c_str());
-    m_pDS->exec(strSQL.c_str());
+    if (!ExecutePreparedQuery("insert into files (idFile, idPath, strFileName) values(NULL, ?, ?)",
+                              Params().Add(idPath).Add(strFileName)))
+      return -1;
     idFile = (int)m_pDS->lastinsertid();
     return idFile;
   }
   catch (...)
   {
-    CLog::Log(LOGERROR, "%s unable to addfile (%s)", __FUNCTION__, strSQL.c_str());
+    CLog::Log(LOGERROR, "%s unable to addfile (%s)", __FUNCTION__, strFileNameAndPath.c_str());
   }
   return -1;
 }
@@ -921,15 +919,10 @@ int CVideoDatabase::GetFileId(const CStdString& strFilenameAndPath)
     int idPath = GetPathId(strPath);
     if (idPath >= 0)
     {
-      CStdString strSQL;
-      strSQL=PrepareSQL("select idFile from files where strFileName='%s' and idPath=%i", strFileName.c_str(),idPath);
-      m_pDS->query(strSQL.c_str());
-      if (m_pDS->num_rows() > 0)
-      {
-        int idFile = m_pDS->fv("files.idFile").get_asInt();
-        m_pDS->close();
-        return idFile;
-      }
+      std::string idFile = GetSinglePreparedValue("select idFile from files where strFileName=? and idPath=?",
+                                                  Params().Add(strFileName).Add(idPath));
+      if (!idFile.empty())
+        return atoi(idFile.c_str());
     }
   }
   catch (...)
@@ -6064,28 +6057,36 @@ bool CVideoDatabase::GetMoviesByWhere(const CStdString& strBaseDir, const Filter
 
     strSQL = PrepareSQL(strSQL, !extFilter.fields.empty() ? extFilter.fields.c_str() : "*") + strSQLExtra;
 
-    int iRowsFound = RunQuery(strSQL);
-    if (iRowsFound <= 0)
-      return iRowsFound == 0;
-
-    // store the total value of items as a property
-    if (total < iRowsFound)
-      total = iRowsFound;
-    items.SetProperty("total", total);
-    
+    // without any sorting to do, rows are read straight off a forward-only cursor
+    // rather than having the entire result set copied up front
+    bool streamed = sortDescription.sortBy == SortByNone;
+    int iRowsFound = 0;
     DatabaseResults results;
-    results.reserve(iRowsFound);
+    if (streamed)
+    {
+      if (!RunCursorQuery(strSQL))
+        return false;
+    }
+    else
+    {
+      iRowsFound = RunQuery(strSQL);
+      if (iRowsFound <= 0)
+        return iRowsFound == 0;
 
-    if (!SortUtils::SortFromDataset(sortDescription, MediaTypeMovie, m_pDS, results))
-      return false;
+      results.reserve(iRowsFound);
+      if (!SortUtils::SortFromDataset(sortDescription, MediaTypeMovie, m_pDS, results))
+        return false;
+      items.Reserve(results.size());
+    }
 
     // get data from returned rows
-    items.Reserve(results.size());
     const query_data &data = m_pDS->get_result_set().records;
-    for (DatabaseResults::const_iterator it = results.begin(); it != results.end(); it++)
+    DatabaseResults::const_iterator it = results.begin();
+    int iRowsRead = 0;
+    while (streamed ? m_pDS->next_row() : it != results.end())
     {
-      unsigned int targetRow = (unsigned int)it->at(FieldRow).asInteger();
-      const dbiplus::sql_record* const record = data.at(targetRow);
+      const dbiplus::sql_record* const record = streamed ? m_pDS->get_sql_record() : data.at((unsigned int)(it++)->at(FieldRow).asInteger());
+      iRowsRead++;
 
       CVideoInfoTag movie = GetDetailsForMovie(record);
       if (CProfilesManager::Get().GetMasterProfile().getLockMode() == LOCK_MODE_EVERYONE ||
@@ -6104,6 +6105,12 @@ bool CVideoDatabase::GetMoviesByWhere(const CStdString& strBaseDir, const Filter
       }
     }
 
+    // store the total value of items as a property
+    if (!streamed)
+      iRowsRead = iRowsFound;
+    if (iRowsRead > 0)
+      items.SetProperty("total", std::max(total, iRowsRead));
+
     // cleanup
     m_pDS->close();
     return true;
@@ -6170,28 +6177,36 @@ bool CVideoDatabase::GetTvShowsByWhere(const CStdString& strBaseDir, const Filte
 
     strSQL = PrepareSQL(strSQL, !extFilter.fields.empty() ? extFilter.fields.c_str() : "*") + strSQLExtra;
 
-    int iRowsFound = RunQuery(strSQL);
-    if (iRowsFound <= 0)
-      return iRowsFound == 0;
-
-    // store the total value of items as a property
-    if (total < iRowsFound)
-      total = iRowsFound;
-    items.SetProperty("total", total);
-    
+    // without any sorting to do, rows are read straight off a forward-only cursor
+    bool streamed = sorting.sortBy == SortByNone;
+    int iRowsFound = 0;
     DatabaseResults results;
-    results.reserve(iRowsFound);
-    if (!SortUtils::SortFromDataset(sorting, MediaTypeTvShow, m_pDS, results))
-      return false;
+    if (streamed)
+    {
+      if (!RunCursorQuery(strSQL))
+        return false;
+    }
+    else
+    {
+      iRowsFound = RunQuery(strSQL);
+      if (iRowsFound <= 0)
+        return iRowsFound == 0;
+
+      results.reserve(iRowsFound);
+      if (!SortUtils::SortFromDataset(sorting, MediaTypeTvShow, m_pDS, results))
+        return false;
+      items.Reserve(results.size());
+    }
 
     // get data from returned rows
-    items.Reserve(results.size());
     const query_data &data = m_pDS->get_result_set().records;
-    for (DatabaseResults::const_iterator it = results.begin(); it != results.end(); it++)
+    DatabaseResults::const_iterator it = results.begin();
+    int iRowsRead = 0;
+    while (streamed ? m_pDS->next_row() : it != results.end())
     {
-      unsigned int targetRow = (unsigned int)it->at(FieldRow).asInteger();
-      const dbiplus::sql_record* const record = data.at(targetRow);
-      
+      const dbiplus::sql_record* const record = streamed ? m_pDS->get_sql_record() : data.at((unsigned int)(it++)->at(FieldRow).asInteger());
+      iRowsRead++;
+
       CVideoInfoTag movie = GetDetailsForTvShow(record, false);
       if ((CProfilesManager::Get().GetMasterProfile().getLockMode() == LOCK_MODE_EVERYONE ||
            g_passwordManager.bMasterUser                                     ||
@@ -6218,6 +6233,12 @@ bool CVideoDatabase::GetTvShowsByWhere(const CStdString& strBaseDir, const Filte
       }
     }
 
+    // store the total value of items as a property
+    if (!streamed)
+      iRowsRead = iRowsFound;
+    if (iRowsRead > 0)
+      items.SetProperty("total", std::max(total, iRowsRead));
+
     Stack(items, VIDEODB_CONTENT_TVSHOWS, !filter.order.empty() || sorting.sortBy != SortByNone);
 
     // cleanup
@@ -6489,29 +6510,37 @@ bool CVideoDatabase::GetEpisodesByWhere(const CStdString& strBaseDir, const Filt
 
     strSQL = PrepareSQL(strSQL, !extFilter.fields.empty() ? extFilter.fields.c_str() : "*") + strSQLExtra;
 
-    int iRowsFound = RunQuery(strSQL);
-    if (iRowsFound <= 0)
-      return iRowsFound == 0;
-
-    // store the total value of items as a property
-    if (total < iRowsFound)
-      total = iRowsFound;
-    items.SetProperty("total", total);
-    
+    // without any sorting to do, rows are read straight off a forward-only cursor
+    bool streamed = sorting.sortBy == SortByNone;
+    int iRowsFound = 0;
     DatabaseResults results;
-    results.reserve(iRowsFound);
-    if (!SortUtils::SortFromDataset(sorting, MediaTypeEpisode, m_pDS, results))
-      return false;
-    
+    if (streamed)
+    {
+      if (!RunCursorQuery(strSQL))
+        return false;
+    }
+    else
+    {
+      iRowsFound = RunQuery(strSQL);
+      if (iRowsFound <= 0)
+        return iRowsFound == 0;
+
+      results.reserve(iRowsFound);
+      if (!SortUtils::SortFromDataset(sorting, MediaTypeEpisode, m_pDS, results))
+        return false;
+      items.Reserve(results.size());
+    }
+
     // get data from returned rows
-    items.Reserve(results.size());
     CLabelFormatter formatter("%H. %T", "");
 
     const query_data &data = m_pDS->get_result_set().records;
-    for (DatabaseResults::const_iterator it = results.begin(); it != results.end(); it++)
+    DatabaseResults::const_iterator it = results.begin();
+    int iRowsRead = 0;
+    while (streamed ? m_pDS->next_row() : it != results.end())
     {
-      unsigned int targetRow = (unsigned int)it->at(FieldRow).asInteger();
-      const dbiplus::sql_record* const record = data.at(targetRow);
+      const dbiplus::sql_record* const record = streamed ? m_pDS->get_sql_record() : data.at((unsigned int)(it++)->at(FieldRow).asInteger());
+      iRowsRead++;
 
       CVideoInfoTag movie = GetDetailsForEpisode(record);
       if (CProfilesManager::Get().GetMasterProfile().getLockMode() == LOCK_MODE_EVERYONE ||
@@ -6539,6 +6568,12 @@ bool CVideoDatabase::GetEpisodesByWhere(const CStdString& strBaseDir, const Filt
       }
     }
 
+    // store the total value of items as a property
+    if (!streamed)
+      iRowsRead = iRowsFound;
+    if (iRowsRead > 0)
+      items.SetProperty("total", std::max(total, iRowsRead));
+
     // cleanup
     m_pDS->close();
     return true;
@@ -9149,14 +9184,18 @@ void CVideoDatabase::InvalidatePathHash(const CStdString& strPath)
 
 bool CVideoDatabase::CommitTransaction()
 {
-  if (CDatabase::CommitTransaction())
-  { // number of items in the db has likely changed, so recalculate
+  if (!CDatabase::CommitTransaction())
+    return false;
+
+  // number of items in the db has likely changed, so recalculate
+  // (batched writes do this once the batch is ended)
+  if (!InBatch())
+  {
     g_infoManager.SetLibraryBool(LIBRARY_HAS_MOVIES, HasContent(VIDEODB_CONTENT_MOVIES));
     g_infoManager.SetLibraryBool(LIBRARY_HAS_TVSHOWS, HasContent(VIDEODB_CONTENT_TVSHOWS));
     g_infoManager.SetLibraryBool(LIBRARY_HAS_MUSICVIDEOS, HasContent(VIDEODB_CONTENT_MUSICVIDEOS));
-    return true;
   }
-  return false;
+  return true;
 }
 
 bool CVideoDatabase::SetSingleValue(VIDEODB_CONTENT_TYPE type, int dbId, int dbField, const std::string &strValue)
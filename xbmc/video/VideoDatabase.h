@@ -797,6 +797,14 @@ private:
    */
   int RunQuery(const CStdString &sql);
 
+  /*! \brief Open a query as a forward-only cursor on m_pDS
+   Rows are read one at a time with next_row() rather than copied up front, so this
+   should be used where the rows are processed in the order they are returned.
+   \param sql the select query to run.
+   \return true if the query was opened.
+   */
+  bool RunCursorQuery(const CStdString &sql);
+
   /*! \brief Update routine for base path of videos
    Only required for videodb version < 59
    \param table the table to update
@@ -105,6 +105,9 @@ namespace VIDEO
       // result in unexpected behaviour.
       m_bCanInterrupt = false;
 
+      // group the writes of several items into one transaction
+      m_database.BeginBatch();
+
       bool bCancelled = false;
       while (!bCancelled && m_pathsToScan.size())
       {
@@ -129,6 +132,8 @@ namespace VIDEO
           bCancelled = true;
       }
 
+      m_database.EndBatch();
+
       if (!bCancelled)
       {
         if (m_bClean)
@@ -1147,6 +1152,8 @@ namespace VIDEO
         movieDetails.m_resumePoint.IsSet())
       m_database.AddBookMarkToFile(pItem->GetPath(), movieDetails.m_resumePoint, CBookmark::RESUME);
 
+    // the item is complete, so this is a safe point to commit batched writes
+    m_database.BatchItemsAdded();
     m_database.Close();
 
     CFileItemPtr itemCopy = CFileItemPtr(new CFileItem(*pItem));
@@ -1373,6 +1380,8 @@ namespace VIDEO
             pDlgProgress->Progress();
           }
 
+          // don't keep others from writing to the database while we're online
+          m_database.CommitPendingBatch();
           CVideoInfoDownloader imdb(scraper);
           if (!imdb.GetEpisodeList(url, episodes))
             return INFO_NOT_FOUND;
@@ -1468,6 +1477,7 @@ namespace VIDEO
 
       if (bFound)
       {
+        m_database.CommitPendingBatch();
         CVideoInfoDownloader imdb(scraper);
         CFileItem item;
         item.SetPath(file->strPath);
@@ -1610,6 +1620,7 @@ namespace VIDEO
     if (m_handle && !url.strTitle.IsEmpty())
       m_handle->SetText(url.strTitle);
 
+    m_database.CommitPendingBatch();
     CVideoInfoDownloader imdb(scraper);
     bool ret = imdb.GetDetails(url, movieDetails, pDialog);
 
@@ -1894,6 +1905,8 @@ namespace VIDEO
   int CVideoInfoScanner::FindVideo(const CStdString &videoName, const ScraperPtr &scraper, CScraperUrl &url, CGUIDialogProgress *progress)
   {
     MOVIELIST movielist;
+    // don't keep others from writing to the database while we're online
+    m_database.CommitPendingBatch();
     CVideoInfoDownloader imdb(scraper);
     int returncode = imdb.FindMovie(videoName, movielist, progress);
     if (returncode < 0 || (returncode == 0 && (m_bStop || !DownloadFailed(progress))))
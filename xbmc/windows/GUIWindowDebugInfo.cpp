@@ -28,9 +28,11 @@
 #include "guilib/GUIControlFactory.h"
 #include "guilib/GUIFontManager.h"
 #include "guilib/GUITextLayout.h"
+#include "guilib/GUITextLayoutCache.h"
 #include "guilib/GUIWindowManager.h"
 #include "guilib/GUIControlProfiler.h"
 #include "GUIInfoManager.h"
+#include "GUILargeTextureManager.h"
 #include "utils/Variant.h"
 
 #include <climits>
@@ -103,13 +105,17 @@ void CGUIWindowDebugInfo::Process(unsigned int currentTime, CDirtyRegionList &di
     CStdString profiling = CGUIControlProfiler::IsRunning() ? " (profiling)" : "";
     CStdString strCores = g_cpuInfo.GetCoresUsageString();
 #if !defined(TARGET_POSIX)
-    info.Format("LOG: %sxbmc.log\nMEM: %"PRIu64"/%"PRIu64" KB - FPS: %2.1f fps\nCPU: %s%s", g_advancedSettings.m_logFolder.c_str(),
-                stat.ullAvailPhys/1024, stat.ullTotalPhys/1024, g_infoManager.GetFPS(), strCores.c_str(), profiling.c_str());
+    info.Format("LOG: %sxbmc.log\nMEM: %"PRIu64"/%"PRIu64" KB - FPS: %2.1f fps - Bools: %2.1f/frame\nCPU: %s%s", g_advancedSettings.m_logFolder.c_str(),
+                stat.ullAvailPhys/1024, stat.ullTotalPhys/1024, g_infoManager.GetFPS(), g_infoManager.GetBoolEvaluations(), strCores.c_str(), profiling.c_str());
 #else
     double dCPU = m_resourceCounter.GetCPUUsage();
-    info.Format("LOG: %sxbmc.log\nMEM: %"PRIu64"/%"PRIu64" KB - FPS: %2.1f fps\nCPU: %s (CPU-XBMC %4.2f%%%s)", g_advancedSettings.m_logFolder.c_str(),
-                stat.ullAvailPhys/1024, stat.ullTotalPhys/1024, g_infoManager.GetFPS(), strCores.c_str(), dCPU, profiling.c_str());
+    info.Format("LOG: %sxbmc.log\nMEM: %"PRIu64"/%"PRIu64" KB - FPS: %2.1f fps - Bools: %2.1f/frame\nCPU: %s (CPU-XBMC %4.2f%%%s)", g_advancedSettings.m_logFolder.c_str(),
+                stat.ullAvailPhys/1024, stat.ullTotalPhys/1024, g_infoManager.GetFPS(), g_infoManager.GetBoolEvaluations(), strCores.c_str(), dCPU, profiling.c_str());
 #endif
+    CGUILargeTextureManager::PrefetchStats prefetch = g_largeTextureManager.GetPrefetchStats();
+    info.AppendFormat("\nPREFETCH: %u queued, %u ready, %u late, %u unused", prefetch.requested, prefetch.hits, prefetch.late, prefetch.unused);
+    CGUITextLayoutCache::Stats layouts = CGUITextLayoutCache::Get().GetStats();
+    info.AppendFormat(" - TEXT: %u hits, %u misses, %u layouts (%u KB)", layouts.hits, layouts.misses, layouts.entries, layouts.characters * 4 / 1024);
   }
 
   // render the skin debug info